@@ -0,0 +1,804 @@
+/**
+* FluidSimBench.cpp
+*
+* Times the core FluidSim kernels across a range of square grid sizes, reporting
+* the cost per grid cell and the effective memory bandwidth of each kernel.
+*
+* Usage:
+*   fluidsim_bench [--sizes 64,128,...] [--min-time seconds] [--filter substring]
+*
+* Parallel kernels run on ThreadPool::global(), sized by FLUIDSIM_NUM_THREADS.
+*
+* Effective bandwidth counts every field a kernel must read or write exactly once per
+* cell (or per sample), so it is a lower bound on the real memory traffic and is only
+* meaningful for comparing runs of the same kernel against each other.
+*
+* @author Dustin Biser
+*/
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Grid.hpp"
+#include "FluidSim/DoubleBufferedGrid.hpp"
+#include "FluidSim/StaggeredGrid.hpp"
+#include "FluidSim/Grid3.hpp"
+#include "FluidSim/StaggeredGrid3.hpp"
+#include "FluidSim/Interp.hpp"
+#include "FluidSim/Advect.hpp"
+#include "FluidSim/ParticleGridInterp.hpp"
+#include "FluidSim/BlueNoise.hpp"
+#include "FluidSim/Parallel.hpp"
+#include "FluidSim/PressureSolver.hpp"
+#include "FluidSim/GaussSeidel.hpp"
+#include "FluidSim/PressureStencil.hpp"
+#include "FluidSim/ActiveCellList.hpp"
+#include "FluidSim/MultigridSolver.hpp"
+#include "FluidSim/Utils.hpp"
+using namespace FluidSim;
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+namespace {  // limit visibility to this file.
+
+//----------------------------------------------------------------------------------------
+// Benchmark Parameters
+//----------------------------------------------------------------------------------------
+const float32 kDt = 0.01f;
+const double kDefaultMinSeconds = 0.25;
+const uint32 kDefaultSizes[] = {64, 128, 256, 512, 1024, 2048, 4096};
+
+struct BenchSettings {
+	vector<uint32> sizes;
+	double minSeconds;
+	string filter;
+};
+
+// Written to after each kernel run so the compiler can not discard the work.
+volatile float32 g_sink = 0.0f;
+
+//----------------------------------------------------------------------------------------
+/**
+* Runs \c kernel repeatedly until at least \c minSeconds have elapsed, and returns the
+* average wall time in seconds of a single run.  \c kernel is always ran at least once.
+*/
+template <typename Func>
+double timeKernel(Func && kernel, double minSeconds, uint32 & outIterations) {
+	using namespace std::chrono;
+
+	steady_clock::time_point start = steady_clock::now();
+	duration<double> elapsed(0);
+	uint32 iterations = 0;
+
+	do {
+		kernel();
+		++iterations;
+		elapsed = duration_cast<duration<double> >(steady_clock::now() - start);
+	} while (elapsed.count() < minSeconds);
+
+	outIterations = iterations;
+	return elapsed.count() / double(iterations);
+}
+
+//----------------------------------------------------------------------------------------
+void printHeader() {
+	printf("%-28s %11s %12s %12s %10s %8s\n",
+			"kernel", "size", "cells", "ns/cell", "GB/s", "iters");
+}
+
+//----------------------------------------------------------------------------------------
+void printResult(
+		const string & kernelName,
+		uint32 size,
+		uint64 cells,
+		uint64 bytesPerRun,
+		double secondsPerRun,
+		uint32 iterations,
+		uint32 depth = 1
+) {
+	stringstream sizeString;
+	sizeString << size << "x" << size;
+	if (depth > 1) {
+		sizeString << "x" << depth;
+	}
+
+	double nsPerCell = secondsPerRun * 1.0e9 / double(cells);
+	double gbPerSecond = double(bytesPerRun) / secondsPerRun * 1.0e-9;
+
+	printf("%-28s %11s %12lu %12.3f %10.3f %8u\n",
+			kernelName.c_str(), sizeString.str().c_str(), cells, nsPerCell,
+			gbPerSecond, iterations);
+	fflush(stdout);
+}
+
+//----------------------------------------------------------------------------------------
+bool kernelEnabled(const BenchSettings & settings, const string & kernelName) {
+	return settings.filter.empty() ||
+			kernelName.find(settings.filter) != string::npos;
+}
+
+//----------------------------------------------------------------------------------------
+// Returns a uniformly distributed random number in [0,1).
+float32 randomUnit(uint32 & seed) {
+	return float32(randhash(seed++)) / (float32(UINT_MAX) + 1.0f);
+}
+
+//----------------------------------------------------------------------------------------
+// Cell centered GridSpec covering the unit square with size x size cells.
+GridSpec cellCenteredSpec(uint32 size) {
+	float32 dx = 1.0f / size;
+
+	GridSpec gridSpec;
+	gridSpec.width = size;
+	gridSpec.height = size;
+	gridSpec.cellLength = dx;
+	gridSpec.origin = vec2(dx, dx) * 0.5f;
+
+	return gridSpec;
+}
+
+//----------------------------------------------------------------------------------------
+/**
+* MAC velocity field covering the unit square, rotating counter-clockwise about its
+* center. The peak speed is chosen so that particles travel roughly two cells per kDt,
+* which makes backtraces land in neighboring cells as they do in the smoke demos.
+*/
+StaggeredGrid<float32> makeVortexVelocity(uint32 size) {
+	float32 dx = 1.0f / size;
+	float32 speed = 2.0f * dx / kDt;
+	vec2 center(0.5f, 0.5f);
+
+	GridSpec u_gridSpec;
+	u_gridSpec.width = size + 1;
+	u_gridSpec.height = size;
+	u_gridSpec.cellLength = dx;
+	u_gridSpec.origin = vec2(0, 0.5f*dx);
+
+	Grid<float32> u(u_gridSpec);
+	for (uint32 row(0); row < u.height(); ++row) {
+		for (uint32 col(0); col < u.width(); ++col) {
+			vec2 r = u.getPosition(col, row) - center;
+			u(col, row) = -speed * 2.0f * r.y;
+		}
+	}
+
+	GridSpec v_gridSpec;
+	v_gridSpec.width = size;
+	v_gridSpec.height = size + 1;
+	v_gridSpec.cellLength = dx;
+	v_gridSpec.origin = vec2(0.5f*dx, 0);
+
+	Grid<float32> v(v_gridSpec);
+	for (uint32 row(0); row < v.height(); ++row) {
+		for (uint32 col(0); col < v.width(); ++col) {
+			vec2 r = v.getPosition(col, row) - center;
+			v(col, row) = speed * 2.0f * r.x;
+		}
+	}
+
+	return StaggeredGrid<float32>(std::move(u), std::move(v));
+}
+
+//----------------------------------------------------------------------------------------
+Grid<float32> makeScalarField(uint32 size) {
+	Grid<float32> grid(cellCenteredSpec(size));
+
+	uint32 seed = size;
+	for (uint32 row(0); row < grid.height(); ++row) {
+		for (uint32 col(0); col < grid.width(); ++col) {
+			grid(col, row) = randomUnit(seed);
+		}
+	}
+
+	return grid;
+}
+
+//----------------------------------------------------------------------------------------
+// Closed box with solid walls.  The right hand side is the negative divergence of
+// a random face velocity field with zero velocity on solid faces, so that it sums
+// to zero and the pressure problem is solvable.
+void makePressureProblem(uint32 size, Grid<CellType> & cells, Grid<float32> & rhs) {
+	cells = Grid<CellType>(cellCenteredSpec(size));
+	cells.setAll(CellType::Fluid);
+	for (uint32 i(0); i < size; ++i) {
+		cells(0, i) = CellType::Solid;
+		cells(size-1, i) = CellType::Solid;
+		cells(i, 0) = CellType::Solid;
+		cells(i, size-1) = CellType::Solid;
+	}
+
+	auto isFluid = [&] (int32 col, int32 row) {
+		return cells.isValidCoord(col, row) && cells(col, row) == CellType::Fluid;
+	};
+
+	// u(col,row) is the face between cells (col-1,row) and (col,row), likewise v.
+	Grid<float32> u(size + 1, size, 1.0f, vec2(0.0f));
+	Grid<float32> v(size, size + 1, 1.0f, vec2(0.0f));
+	uint32 seed = size;
+	for (int32 row(0); row < int32(size); ++row) {
+		for (int32 col(0); col <= int32(size); ++col) {
+			u(col, row) = (isFluid(col-1, row) && isFluid(col, row)) ?
+					randomUnit(seed) - 0.5f : 0.0f;
+		}
+	}
+	for (int32 row(0); row <= int32(size); ++row) {
+		for (int32 col(0); col < int32(size); ++col) {
+			v(col, row) = (isFluid(col, row-1) && isFluid(col, row)) ?
+					randomUnit(seed) - 0.5f : 0.0f;
+		}
+	}
+
+	rhs = Grid<float32>(cells.gridSpec());
+	for (uint32 row(0); row < size; ++row) {
+		for (uint32 col(0); col < size; ++col) {
+			rhs(col, row) = -(u(col+1, row) - u(col, row) + v(col, row+1) - v(col, row));
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------
+void benchAdvect(const BenchSettings & settings, uint32 size, Execution execution) {
+	const string kernelName = (execution == Execution::Serial) ?
+			"advect" : "advect/parallel";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	StaggeredGrid<float32> velocity = makeVortexVelocity(size);
+	Grid<float32> quantity = makeScalarField(size);
+
+	uint64 cells = uint64(size) * size;
+	// Read quantity, u and v, write the advected quantity.
+	uint64 bytes = cells * (2 * sizeof(float32) + 2 * sizeof(float32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		advect(quantity, velocity, kDt, execution);
+		g_sink = quantity(size/2, size/2);
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, size, cells, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+// Steady-state stepping with a DoubleBufferedGrid, no allocation per call.
+void benchAdvectDoubleBuffered(const BenchSettings & settings, uint32 size) {
+	const string kernelName = "advect/double-buffered";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	StaggeredGrid<float32> velocity = makeVortexVelocity(size);
+	DoubleBufferedGrid<float32> quantity(makeScalarField(size));
+
+	uint64 cells = uint64(size) * size;
+	uint64 bytes = cells * (2 * sizeof(float32) + 2 * sizeof(float32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		advect(quantity, velocity, kDt);
+		g_sink = quantity.front()(size/2, size/2);
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, size, cells, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+// Density and temperature advected together, as in SmokeSim::advectQuantities.
+void benchAdvectFused(const BenchSettings & settings, uint32 size, bool fused) {
+	const string kernelName = fused ? "advect2/fused" : "advect2/separate";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	StaggeredGrid<float32> velocity = makeVortexVelocity(size);
+	Grid<float32> density = makeScalarField(size);
+	Grid<float32> temperature = makeScalarField(size);
+	Grid<float32> tmp_density(density.gridSpec());
+	Grid<float32> tmp_temperature(temperature.gridSpec());
+
+	uint64 cells = uint64(size) * size;
+	// Read both quantities, u and v, write both advected quantities.
+	uint64 bytes = cells * (4 * sizeof(float32) + 2 * sizeof(float32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		if (fused) {
+			const Grid<float32> * quantities[] = { &density, &temperature };
+			Grid<float32> * destinations[] = { &tmp_density, &tmp_temperature };
+			advect(quantities, destinations, 2, velocity, kDt);
+			density.swap(tmp_density);
+			temperature.swap(tmp_temperature);
+		} else {
+			advect(density, velocity, kDt);
+			advect(temperature, velocity, kDt);
+		}
+		g_sink = density(size/2, size/2) + temperature(size/2, size/2);
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, size, cells, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+// Fused density and temperature advection restricted to an ActiveCellList holding
+// a disc of smoke covering about 9% of the grid.  ns/cell is per grid cell, so it
+// compares directly with advect2/fused.
+void benchAdvectSparse(const BenchSettings & settings, uint32 size) {
+	const string kernelName = "advect2/sparse";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	StaggeredGrid<float32> velocity = makeVortexVelocity(size);
+	Grid<float32> density = makeScalarField(size);
+	Grid<float32> temperature = makeScalarField(size);
+	Grid<float32> tmp_density(density.gridSpec());
+	Grid<float32> tmp_temperature(temperature.gridSpec());
+
+	ActiveCellList smokeCells(size, size);
+	float32 radius = size / 6.0f;
+	for (uint32 row(0); row < size; ++row) {
+		for (uint32 col(0); col < size; ++col) {
+			float32 x = col - 0.5f * size;
+			float32 y = row - 0.5f * size;
+			if (x * x + y * y < radius * radius) {
+				smokeCells.insert(col, row);
+			}
+		}
+	}
+
+	uint64 cells = uint64(size) * size;
+	uint64 bytes = uint64(smokeCells.size()) * (4 * sizeof(float32) +
+			2 * sizeof(float32) + sizeof(uint32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		const Grid<float32> * quantities[] = { &density, &temperature };
+		Grid<float32> * destinations[] = { &tmp_density, &tmp_temperature };
+		advect(quantities, destinations, 2, velocity, kDt, smokeCells);
+		density.swap(tmp_density);
+		temperature.swap(tmp_temperature);
+		g_sink = density(size/2, size/2) + temperature(size/2, size/2);
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, size, cells, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+// Backtrace distance, in time steps of the vortex field, for the layout benchmarks.
+// Particles travel up to ~32 cells, so samples land far from the cell being written
+// and the quantity grid is read with little locality along columns.
+const float32 kLongStepScale = 16.0f;
+
+//----------------------------------------------------------------------------------------
+// Random-access-heavy advection of a quantity stored with cell layout L.
+template <typename L>
+void benchAdvectLayout(const BenchSettings & settings, uint32 size,
+		const string & kernelName)
+{
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	typedef Grid<float32, AlignedAllocator<float32>, L> LayoutGrid;
+
+	StaggeredGrid<float32> velocity = makeVortexVelocity(size);
+	Grid<float32> field = makeScalarField(size);
+	LayoutGrid quantity(field.gridSpec());
+	LayoutGrid tmp_quantity(field.gridSpec());
+	for (uint32 row(0); row < size; ++row) {
+		for (uint32 col(0); col < size; ++col) {
+			quantity(col, row) = field(col, row);
+		}
+	}
+
+	uint64 cells = uint64(size) * size;
+	uint64 bytes = cells * (2 * sizeof(float32) + 2 * sizeof(float32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		advect(quantity, tmp_quantity, velocity, kLongStepScale * kDt);
+		quantity.swap(tmp_quantity);
+		g_sink = quantity(size/2, size/2);
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, size, cells, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+// Side of the cube with about as many cells as a size x size grid, so that 3D kernels
+// are timed at comparable cell counts.
+uint32 cubeSide(uint32 size) {
+	return std::max(2u, uint32(std::pow(double(size) * size, 1.0 / 3.0) + 0.5));
+}
+
+//----------------------------------------------------------------------------------------
+// 3D MAC velocity field in the unit cube, rotating about the z axis as in
+// makeVortexVelocity, with a gentle upward drift.
+StaggeredGrid3<float32> makeVortexVelocity3(uint32 side) {
+	float32 dx = 1.0f / side;
+	float32 speed = 2.0f * dx / kDt;
+	vec3 center(0.5f);
+
+	GridSpec3 cells = { side, side, side, dx, vec3(0.5f * dx) };
+	StaggeredGrid3<float32> velocity(cells);
+
+	for (uint32 layer(0); layer < velocity.u.depth(); ++layer) {
+		for (uint32 row(0); row < velocity.u.height(); ++row) {
+			for (uint32 col(0); col < velocity.u.width(); ++col) {
+				vec3 r = velocity.u.getPosition(col, row, layer) - center;
+				velocity.u(col, row, layer) = -speed * 2.0f * r.y;
+			}
+		}
+	}
+	for (uint32 layer(0); layer < velocity.v.depth(); ++layer) {
+		for (uint32 row(0); row < velocity.v.height(); ++row) {
+			for (uint32 col(0); col < velocity.v.width(); ++col) {
+				vec3 r = velocity.v.getPosition(col, row, layer) - center;
+				velocity.v(col, row, layer) = speed * 2.0f * r.x;
+			}
+		}
+	}
+	velocity.w.setAll(0.25f * speed);
+
+	return velocity;
+}
+
+//----------------------------------------------------------------------------------------
+// Density and temperature advected together through a 3D vortex.
+void benchAdvect3(const BenchSettings & settings, uint32 size, Execution execution) {
+	const string kernelName = (execution == Execution::Serial) ?
+			"advect3/fused" : "advect3/fused-parallel";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	const uint32 side = cubeSide(size);
+	StaggeredGrid3<float32> velocity = makeVortexVelocity3(side);
+	GridSpec3 spec = { side, side, side, 1.0f / side, vec3(0.5f / side) };
+	Grid3<float32> density(spec);
+	Grid3<float32> temperature(spec);
+	Grid3<float32> tmp_density(spec);
+	Grid3<float32> tmp_temperature(spec);
+
+	uint32 seed = side;
+	for (uint32 layer(0); layer < side; ++layer) {
+		for (uint32 row(0); row < side; ++row) {
+			for (uint32 col(0); col < side; ++col) {
+				density(col, row, layer) = randomUnit(seed);
+				temperature(col, row, layer) = randomUnit(seed);
+			}
+		}
+	}
+
+	uint64 cells = uint64(side) * side * side;
+	// Read both quantities, u, v and w, write both advected quantities.
+	uint64 bytes = cells * (4 * sizeof(float32) + 3 * sizeof(float32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		const Grid3<float32> * quantities[] = { &density, &temperature };
+		Grid3<float32> * destinations[] = { &tmp_density, &tmp_temperature };
+		advect(quantities, destinations, 2, velocity, kDt, execution);
+		density.swap(tmp_density);
+		temperature.swap(tmp_temperature);
+		g_sink = density(side/2, side/2, side/2);
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, side, cells, bytes, seconds, iterations, side);
+}
+
+//----------------------------------------------------------------------------------------
+void benchBilinear(const BenchSettings & settings, uint32 size, bool batched) {
+	const string kernelName = batched ? "bilinear/batch" : "bilinear";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	Grid<float32> grid = makeScalarField(size);
+
+	// One random sample position per grid cell, stored both as vec2s and in
+	// structure-of-arrays form for the batched kernel.
+	uint64 cells = uint64(size) * size;
+	vector<vec2> positions(cells);
+	vector<float32> x(cells);
+	vector<float32> y(cells);
+	uint32 seed = 7;
+	for (uint64 i(0); i < cells; ++i) {
+		x[i] = positions[i].x = randomUnit(seed);
+		y[i] = positions[i].y = randomUnit(seed);
+	}
+	vector<float32> results(cells);
+
+	// Read position, one grid value and write the result.
+	uint64 bytes = cells * (sizeof(vec2) + 2 * sizeof(float32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		if (batched) {
+			bilinear(grid, x.data(), y.data(), results.data(), uint32(cells));
+		} else {
+			for (uint64 i(0); i < cells; ++i) {
+				results[i] = bilinear(grid, positions[i]);
+			}
+		}
+		g_sink = results[cells/2];
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, size, cells, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+void benchInterpParticlesToGrid(const BenchSettings & settings, uint32 size) {
+	const string kernelName = "interpParticlesToGrid";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	GridSpec gridSpec = cellCenteredSpec(size);
+	gridSpec.origin = vec2(0.0f);
+	Grid<float32> grid(gridSpec);
+	Grid<float32> weights(gridSpec);
+
+	// One particle per grid cell.  Particles are kept out of the last row and column
+	// since their kernel support would reach past the edge of the grid.
+	uint64 cells = uint64(size) * size;
+	vector<vec2> positions(cells);
+	vector<float32> attributes(cells);
+	float32 extent = float32(size - 1) / size;
+	uint32 seed = 11;
+	for (uint64 i(0); i < cells; ++i) {
+		positions[i].x = randomUnit(seed) * extent;
+		positions[i].y = randomUnit(seed) * extent;
+		attributes[i] = randomUnit(seed);
+	}
+
+	// Read particle positions and attributes, write grid and weights.
+	uint64 bytes = cells * (sizeof(vec2) + sizeof(float32)) +
+			cells * (2 * sizeof(float32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		interpParticlesToGrid(grid, weights, positions, attributes, linear,
+				gridSpec.cellLength);
+		g_sink = grid(size/2, size/2);
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, size, cells, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+/**
+* Blue noise sampling over the unit square with a minimum sample distance of one grid
+* cell.  Cost is reported per generated sample rather than per grid cell.
+*/
+void benchBlueNoise(const BenchSettings & settings, uint32 size) {
+	const string kernelName = "BlueNoise::distributeSamples";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	vector<vec2> samples;
+	uint32 maxSamples = size * size;
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		BlueNoise::distributeSamples(vec2(0.0f), vec2(1.0f), 1.0f / size,
+				maxSamples, samples);
+		g_sink = samples.back().x;
+	}, settings.minSeconds, iterations);
+
+	uint64 numSamples = samples.size();
+	uint64 bytes = numSamples * sizeof(vec2);
+
+	printResult(kernelName, size, numSamples, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+enum class PressureBench {
+	Pcg, PcgMultigrid, Multigrid
+};
+
+//----------------------------------------------------------------------------------------
+// One full pressure solve from a zero initial guess.
+void benchPressure(const BenchSettings & settings, uint32 size, PressureBench method) {
+	const string kernelName =
+			(method == PressureBench::Pcg) ? "pressure/pcg" :
+			(method == PressureBench::PcgMultigrid) ? "pressure/pcg-multigrid" :
+			"pressure/multigrid";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	Grid<CellType> cells;
+	Grid<float32> rhs;
+	makePressureProblem(size, cells, rhs);
+	Grid<float32> pressure(rhs.gridSpec());
+
+	const float32 tolerance = 1.0e-4f;
+	PressureSolver pcg(tolerance, 1000);
+	if (method == PressureBench::PcgMultigrid) {
+		pcg.setPreconditioner(Preconditioner::Multigrid);
+		pcg.multigrid().setExecution(Execution::Parallel);
+	}
+	MultigridSolver multigrid(tolerance, 100);
+	multigrid.setExecution(Execution::Parallel);
+
+	PressureSolveResult result;
+	uint64 numCells = uint64(size) * size;
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		pressure.setAll(0);
+		if (method == PressureBench::Multigrid) {
+			result = multigrid.solve(cells, rhs, pressure);
+		} else {
+			result = pcg.solve(cells, rhs, pressure);
+		}
+		g_sink = pressure(size/2, size/2);
+	}, settings.minSeconds, iterations);
+
+	// Rough traffic estimate: about 12 floats per cell per iteration.
+	uint64 bytes = numCells * result.iterations * 12 * sizeof(float32);
+
+	printResult(kernelName, size, numCells, bytes, seconds, iterations);
+	printf("    %u solver iterations, residual %g\n", result.iterations,
+			result.residual);
+}
+
+//----------------------------------------------------------------------------------------
+// SmokeSim's fixed count of Gauss-Seidel sweeps.
+void benchGaussSeidel(const BenchSettings & settings, uint32 size,
+		GaussSeidelOrdering ordering)
+{
+	const string kernelName = (ordering == GaussSeidelOrdering::Lexicographic) ?
+			"pressure/gs-lexicographic" : "pressure/gs-redblack";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	const uint32 kSweeps = 40;
+
+	Grid<CellType> cells;
+	Grid<float32> rhs;
+	makePressureProblem(size, cells, rhs);
+	Grid<float32> pressure(rhs.gridSpec());
+
+	uint64 numCells = uint64(size) * size;
+	// Per sweep: read cell types of 5 cells, rhs, 5 pressures, write one pressure.
+	uint64 bytes = numCells * kSweeps * (5 * sizeof(CellType) + 7 * sizeof(float32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		pressure.setAll(0);
+		gaussSeidel(cells, rhs, pressure, kSweeps, ordering, Execution::Parallel);
+		g_sink = pressure(size/2, size/2);
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, size, numCells, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+// Red-black sweeps driven by a prebuilt PressureStencil instead of cell types.
+void benchGaussSeidelStencil(const BenchSettings & settings, uint32 size) {
+	const string kernelName = "pressure/gs-stencil";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	const uint32 kSweeps = 40;
+
+	Grid<CellType> cells;
+	Grid<float32> rhs;
+	makePressureProblem(size, cells, rhs);
+	Grid<float32> pressure(rhs.gridSpec());
+	PressureStencil stencil(cells);
+
+	uint64 numCells = uint64(size) * size;
+	// Per sweep: read neighbor bits, inverse diagonal, rhs, 5 pressures, write one
+	// pressure.
+	uint64 bytes = numCells * kSweeps * (sizeof(uint8) + 8 * sizeof(float32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		pressure.setAll(0);
+		gaussSeidel(stencil, rhs, pressure, kSweeps, GaussSeidelOrdering::RedBlack,
+				Execution::Parallel);
+		g_sink = pressure(size/2, size/2);
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, size, numCells, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+// Red-black sweeps over the PressureStencil's fluid cell list.  On this closed box
+// nearly every cell is fluid, so this measures the overhead of the sparse path.
+void benchGaussSeidelSparse(const BenchSettings & settings, uint32 size) {
+	const string kernelName = "pressure/gs-sparse";
+	if (!kernelEnabled(settings, kernelName)) return;
+
+	const uint32 kSweeps = 40;
+
+	Grid<CellType> cells;
+	Grid<float32> rhs;
+	makePressureProblem(size, cells, rhs);
+	Grid<float32> pressure(rhs.gridSpec());
+	PressureStencil stencil(cells);
+
+	uint64 numCells = uint64(size) * size;
+	// Per sweep: read the cell index, neighbor bits, inverse diagonal, rhs and 5
+	// pressures, write one pressure.
+	uint64 bytes = numCells * kSweeps * (sizeof(uint32) + sizeof(uint8) +
+			8 * sizeof(float32));
+
+	uint32 iterations;
+	double seconds = timeKernel([&] {
+		pressure.setAll(0);
+		gaussSeidel(stencil, stencil.fluidCells(), rhs, pressure, kSweeps,
+				GaussSeidelOrdering::RedBlack, Execution::Parallel);
+		g_sink = pressure(size/2, size/2);
+	}, settings.minSeconds, iterations);
+
+	printResult(kernelName, size, numCells, bytes, seconds, iterations);
+}
+
+//----------------------------------------------------------------------------------------
+vector<uint32> parseSizes(const char * list) {
+	vector<uint32> sizes;
+
+	stringstream stream(list);
+	string token;
+	while (getline(stream, token, ',')) {
+		uint32 size = uint32(strtoul(token.c_str(), nullptr, 10));
+		if (size > 1) {
+			sizes.push_back(size);
+		}
+	}
+
+	return sizes;
+}
+
+//----------------------------------------------------------------------------------------
+void printUsage(const char * program) {
+	printf("Usage: %s [--sizes 64,128,...] [--min-time seconds] [--filter substring]\n",
+			program);
+}
+
+} // end namespace
+
+
+//----------------------------------------------------------------------------------------
+int main(int argc, char ** argv) {
+	BenchSettings settings;
+	settings.sizes.assign(std::begin(kDefaultSizes), std::end(kDefaultSizes));
+	settings.minSeconds = kDefaultMinSeconds;
+
+	for (int i(1); i < argc; ++i) {
+		bool hasValue = (i + 1 < argc);
+
+		if (strcmp(argv[i], "--sizes") == 0 && hasValue) {
+			settings.sizes = parseSizes(argv[++i]);
+		} else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+			settings.minSeconds = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+			settings.filter = argv[++i];
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	printf("threads: %u (set FLUIDSIM_NUM_THREADS to override)\n\n",
+			ThreadPool::global().numThreads());
+	printHeader();
+	for (uint32 size : settings.sizes) {
+		benchAdvect(settings, size, Execution::Serial);
+		benchAdvect(settings, size, Execution::Parallel);
+		benchAdvectDoubleBuffered(settings, size);
+		benchAdvectFused(settings, size, false);
+		benchAdvectFused(settings, size, true);
+		benchAdvectSparse(settings, size);
+		benchAdvectLayout<RowMajorLayout>(settings, size, "advect/layout-row-major");
+		benchAdvectLayout<BrickedLayout<>>(settings, size, "advect/layout-bricked");
+		benchAdvectLayout<ZOrderLayout>(settings, size, "advect/layout-z-order");
+		benchAdvect3(settings, size, Execution::Serial);
+		benchAdvect3(settings, size, Execution::Parallel);
+		benchBilinear(settings, size, false);
+		benchBilinear(settings, size, true);
+		benchInterpParticlesToGrid(settings, size);
+		benchBlueNoise(settings, size);
+		benchGaussSeidel(settings, size, GaussSeidelOrdering::Lexicographic);
+		benchGaussSeidel(settings, size, GaussSeidelOrdering::RedBlack);
+		benchGaussSeidelStencil(settings, size);
+		benchGaussSeidelSparse(settings, size);
+		benchPressure(settings, size, PressureBench::Pcg);
+		benchPressure(settings, size, PressureBench::PcgMultigrid);
+		benchPressure(settings, size, PressureBench::Multigrid);
+	}
+
+	return 0;
+}
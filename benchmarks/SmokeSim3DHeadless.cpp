@@ -0,0 +1,140 @@
+/**
+* SmokeSim3DHeadless.cpp
+*
+* Runs SmokeSim3D, the CPU port of the GpuSmokeSim3D pipeline, without a window
+* and prints the wall time of each stage for every frame, followed by the
+* average over all frames.
+*
+* Usage:
+*   fluidsim_smoke3d [--frames count] [--size cells] [--jacobi iterations]
+*                    [--parallel]
+*
+* Parallel stages run on ThreadPool::global(), sized by FLUIDSIM_NUM_THREADS.
+*
+* @author Dustin Biser
+*/
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/SmokeSim3D.hpp"
+#include "FluidSim/ThreadPool.hpp"
+using namespace FluidSim;
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace {  // limit visibility to this file.
+
+const uint32 kDefaultFrames = 100;
+
+struct RunSettings {
+	uint32 frames;
+	uint32 size;
+	uint32 jacobiIterations;
+	Execution execution;
+};
+
+//----------------------------------------------------------------------------------------
+void printHeader() {
+	printf("%8s %10s %10s %10s %10s %10s %10s %10s\n",
+			"frame", "inject", "advect", "buoyancy", "divergence", "pressure",
+			"project", "total");
+}
+
+//----------------------------------------------------------------------------------------
+// Prints stage times in milliseconds.
+void printTimings(const char * label, const SmokeSim3DTimings & timings) {
+	printf("%8s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+			label,
+			timings.inject * 1.0e3,
+			timings.advect * 1.0e3,
+			timings.buoyancy * 1.0e3,
+			timings.divergence * 1.0e3,
+			timings.pressure * 1.0e3,
+			timings.project * 1.0e3,
+			timings.total() * 1.0e3);
+	fflush(stdout);
+}
+
+//----------------------------------------------------------------------------------------
+void accumulate(SmokeSim3DTimings & sum, const SmokeSim3DTimings & timings) {
+	sum.inject += timings.inject;
+	sum.advect += timings.advect;
+	sum.buoyancy += timings.buoyancy;
+	sum.divergence += timings.divergence;
+	sum.pressure += timings.pressure;
+	sum.project += timings.project;
+}
+
+//----------------------------------------------------------------------------------------
+void printUsage(const char * program) {
+	printf("Usage: %s [--frames count] [--size cells] [--jacobi iterations] "
+			"[--parallel]\n", program);
+}
+
+} // end namespace
+
+
+//----------------------------------------------------------------------------------------
+int main(int argc, char ** argv) {
+	RunSettings settings;
+	settings.frames = kDefaultFrames;
+	settings.size = SmokeSim3D::kGridSize;
+	settings.jacobiIterations = SmokeSim3D::kJacobiIterations;
+	settings.execution = Execution::Serial;
+
+	for (int i(1); i < argc; ++i) {
+		bool hasValue = (i + 1 < argc);
+
+		if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+			settings.frames = uint32(atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--size") == 0 && hasValue) {
+			settings.size = uint32(atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--jacobi") == 0 && hasValue) {
+			settings.jacobiIterations = uint32(atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--parallel") == 0) {
+			settings.execution = Execution::Parallel;
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	SmokeSim3D smokeSim(settings.size, settings.size, settings.size);
+	smokeSim.setExecution(settings.execution);
+	smokeSim.setJacobiIterations(settings.jacobiIterations);
+
+	printf("grid: %ux%ux%u, jacobi iterations: %u, threads: %u\n\n",
+			settings.size, settings.size, settings.size, settings.jacobiIterations,
+			settings.execution == Execution::Serial ?
+					1u : ThreadPool::global().numThreads());
+	printf("Stage wall times in milliseconds.\n");
+	printHeader();
+
+	SmokeSim3DTimings sum = SmokeSim3DTimings();
+	for (uint32 frame(0); frame < settings.frames; ++frame) {
+		smokeSim.step();
+		accumulate(sum, smokeSim.lastStepTimings());
+
+		char label[16];
+		snprintf(label, sizeof(label), "%u", frame);
+		printTimings(label, smokeSim.lastStepTimings());
+	}
+
+	if (settings.frames > 0) {
+		SmokeSim3DTimings average = sum;
+		const double scale = 1.0 / settings.frames;
+		average.inject *= scale;
+		average.advect *= scale;
+		average.buoyancy *= scale;
+		average.divergence *= scale;
+		average.pressure *= scale;
+		average.project *= scale;
+
+		printf("\n");
+		printTimings("average", average);
+	}
+
+	return 0;
+}
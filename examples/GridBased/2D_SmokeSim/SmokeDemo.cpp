@@ -0,0 +1,141 @@
+#include "SmokeDemo.hpp"
+
+#include <iostream>
+using namespace std;
+
+
+//----------------------------------------------------------------------------------------
+int main() {
+    shared_ptr<GlfwOpenGlWindow> smokeDemo = SmokeDemo::getInstance();
+    smokeDemo->create(kScreenWidth,
+                      kScreenHeight,
+                      "2D Smoke Simulation",
+                      1/60.0f);
+
+    return 0;
+}
+
+//---------------------------------------------------------------------------------------
+static void snapshotDensity(const Simulation & simulation, Grid<float32> & frame) {
+    frame = static_cast<const SmokeSim &>(simulation).density();
+}
+
+//---------------------------------------------------------------------------------------
+SmokeDemo::SmokeDemo()
+    : asyncSim(smokeSim, snapshotDensity)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+shared_ptr<GlfwOpenGlWindow> SmokeDemo::getInstance() {
+    static GlfwOpenGlWindow * instance = new SmokeDemo();
+    if (p_instance == nullptr) {
+        p_instance = shared_ptr<GlfwOpenGlWindow>(instance);
+    }
+
+    return p_instance;
+}
+
+//----------------------------------------------------------------------------------------
+void SmokeDemo::init() {
+    cout << "\nInitializing Simulation." << endl;
+
+    smokeSim.init();
+
+    smokeGraphics.init(smokeSim.density());
+    smokeGraphics.uploadSolidCellData(smokeSim.cells());
+
+    asyncSim.start(kDt);
+}
+
+//----------------------------------------------------------------------------------------
+void SmokeDemo::logic() {
+    // Keep drawing the previous texture if the next step is not done yet.
+    const Grid<float32> * density = asyncSim.beginReadLatest();
+    if (density != nullptr) {
+        smokeGraphics.uploadTextureData(*density);
+        asyncSim.endRead();
+    }
+}
+
+//----------------------------------------------------------------------------------------
+void SmokeDemo::draw() {
+    smokeGraphics.draw();
+}
+
+//----------------------------------------------------------------------------------------
+void SmokeDemo::keyInput(int key, int action, int mods) {
+    // Solver settings are changed on the simulation thread, between steps.
+    if (action == GLFW_PRESS && key == GLFW_KEY_P) {
+        asyncSim.post([](Simulation & simulation) {
+            SmokeSim & smokeSim = static_cast<SmokeSim &>(simulation);
+            PressureMethod method = smokeSim.getPressureMethod();
+            if (method == PressureMethod::PCG) {
+                smokeSim.setPressureMethod(PressureMethod::Multigrid);
+                cout << "Pressure solver: Multigrid" << endl;
+            } else if (method == PressureMethod::Multigrid) {
+                smokeSim.setPressureMethod(PressureMethod::GaussSeidel);
+                cout << "Pressure solver: Gauss-Seidel" << endl;
+            } else {
+                smokeSim.setPressureMethod(PressureMethod::PCG);
+                cout << "Pressure solver: PCG" << endl;
+            }
+        });
+    }
+
+    if (action == GLFW_PRESS && key == GLFW_KEY_O) {
+        asyncSim.post([](Simulation & simulation) {
+            SmokeSim & smokeSim = static_cast<SmokeSim &>(simulation);
+            if (smokeSim.getGaussSeidelOrdering() == GaussSeidelOrdering::RedBlack) {
+                smokeSim.setGaussSeidelOrdering(GaussSeidelOrdering::Lexicographic);
+                cout << "Gauss-Seidel ordering: lexicographic" << endl;
+            } else {
+                smokeSim.setGaussSeidelOrdering(GaussSeidelOrdering::RedBlack);
+                cout << "Gauss-Seidel ordering: red-black" << endl;
+            }
+        });
+    }
+
+    if (action == GLFW_PRESS && key == GLFW_KEY_M) {
+        asyncSim.post([](Simulation & simulation) {
+            SmokeSim & smokeSim = static_cast<SmokeSim &>(simulation);
+            AdvectionMethod method = smokeSim.getAdvectionMethod();
+            if (method == AdvectionMethod::MacCormack) {
+                smokeSim.setAdvectionMethod(AdvectionMethod::SemiLagrangian);
+                cout << "Advection: semi-Lagrangian" << endl;
+            } else if (method == AdvectionMethod::SemiLagrangian) {
+                smokeSim.setAdvectionMethod(AdvectionMethod::MonotoneCubic);
+                cout << "Advection: semi-Lagrangian, monotone cubic" << endl;
+            } else {
+                smokeSim.setAdvectionMethod(AdvectionMethod::MacCormack);
+                cout << "Advection: MacCormack" << endl;
+            }
+        });
+    }
+
+}
+
+//----------------------------------------------------------------------------------------
+void SmokeDemo::cleanup() {
+    asyncSim.stop();
+
+    vec2 max_vel = smokeSim.maxVelocity();
+    cout << "max_u: " << max_vel.x << endl;
+    cout << "max_v: " << max_vel.y << endl;
+    cout << "Last frame: " << smokeSim.lastSubstepCount() << " substeps, dt <= "
+         << smokeSim.lastTimeStep() << endl;
+    if (smokeSim.getPressureMethod() != PressureMethod::GaussSeidel) {
+        const PressureSolveResult & lastPressureSolve = smokeSim.lastPressureSolveResult();
+        cout << "Pressure solve iterations: " << lastPressureSolve.iterations
+             << ", residual: " << lastPressureSolve.residual << endl;
+    }
+    cout << "Frames simulated: " << asyncSim.stepsCompleted() << endl;
+    cout << endl;
+
+    cout << "Simulation Clean Up" << endl;
+
+    smokeGraphics.cleanup();
+
+    cout << " ... Good Bye." << endl;
+}
@@ -0,0 +1,47 @@
+/**
+* @brief SmokeDemo.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "SmokeSim.hpp"
+#include "SmokeGraphics.hpp"
+
+#include "Utils/GlfwOpenGlWindow.hpp"
+
+#include "FluidSim/AsyncSimulation.hpp"
+
+#include <memory>
+
+/**
+* Interactive window for SmokeSim, rendering its density.  SmokeSim steps on its
+* own thread through an AsyncSimulation, so texture upload and drawing overlap
+* the next step, and each frame shows the newest density available.  The 'P'
+* key cycles the pressure solver, 'O' toggles the Gauss-Seidel ordering, and 'M'
+* cycles the advection of the smoke.
+*/
+class SmokeDemo : public GlfwOpenGlWindow {
+
+public:
+    ~SmokeDemo() { }
+
+    static std::shared_ptr<GlfwOpenGlWindow> getInstance();
+
+private:
+    SmokeDemo(); // Singleton. Prevent direct construction.
+
+    SmokeSim smokeSim;
+    SmokeGraphics smokeGraphics;
+
+    // Density snapshots handed from the simulation thread to the render thread.
+    AsyncSimulation< Grid<float32> > asyncSim;
+
+    virtual void init();
+    virtual void logic();
+    virtual void draw();
+    virtual void keyInput(int key, int action, int mods);
+    virtual void cleanup();
+
+};
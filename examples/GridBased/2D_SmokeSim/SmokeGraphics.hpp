@@ -7,13 +7,12 @@
 #pragma once
 
 #include "FluidSim/Grid.hpp"
+#include "FluidSim/CellType.hpp"
 using namespace FluidSim;
 
 #include <Synergy/Synergy.hpp>
 using namespace Synergy;
 
-enum class CellType : bool;
-
 //----------------------------------------------------------------------------------------
 // Graphics Parameters
 //----------------------------------------------------------------------------------------
@@ -1,48 +1,50 @@
 #include "SmokeSim.hpp"
-#include "SmokeGraphics.hpp"
+#include "Headless/HeadlessSimulations.hpp"
 
 #include "FluidSim/Interp.hpp"
 #include "FluidSim/Advect.hpp"
+#include "FluidSim/GaussSeidel.hpp"
+#include "FluidSim/Projection.hpp"
 
 #include <cmath>
-#include <iostream>
 #include <algorithm>
+#include <memory>
 using namespace std;
 
 #include <glm/glm.hpp>
 
 
 //----------------------------------------------------------------------------------------
-int main() {
-    shared_ptr<GlfwOpenGlWindow> smokeDemo = SmokeSim::getInstance();
-    smokeDemo->create(kScreenWidth,
-                      kScreenHeight,
-                      "2D Smoke Simulation",
-                      1/60.0f);
-
-    return 0;
+unique_ptr<Simulation> createSmokeSim() {
+    return unique_ptr<Simulation>(new SmokeSim());
 }
 
-//---------------------------------------------------------------------------------------
-shared_ptr<GlfwOpenGlWindow> SmokeSim::getInstance() {
-    static GlfwOpenGlWindow * instance = new SmokeSim();
-    if (p_instance == nullptr) {
-        p_instance = shared_ptr<GlfwOpenGlWindow>(instance);
-    }
-
-    return p_instance;
+//----------------------------------------------------------------------------------------
+SmokeSim::SmokeSim()
+    : timeStep(kTargetCfl, kMaxSubsteps),
+      frameCount(0),
+      max_vel(0,0),
+      fluid_max_vel(0,0),
+      lastSubsteps(0),
+      lastDt(0)
+{
+    pressureSolver.setTolerance(kPressureTolerance);
+    pressureSolver.setMaxIterations(kPressureMaxIterations);
+    multigridSolver.setTolerance(kPressureTolerance);
+    multigridSolver.setExecution(Execution::Parallel);
+    lastPressureSolve = PressureSolveResult();
 }
 
 //----------------------------------------------------------------------------------------
 void SmokeSim::init() {
-    cout << "\nInitializing Simulation." << endl;
-
+    frameCount = 0;
     max_vel = vec2(0,0);
+    fluid_max_vel = vec2(0,0);
+    lastSubsteps = 0;
+    lastDt = 0;
+    lastPressureSolve = PressureSolveResult();
 
     initGridData();
-
-    smokeGraphics.init(densityGrid);
-    smokeGraphics.uploadSolidCellData(cellGrid);
 }
 
 //----------------------------------------------------------------------------------------
@@ -60,6 +62,20 @@ static void fillGrid(Grid<float32> & grid,
     }
 }
 
+//----------------------------------------------------------------------------------------
+static void activateCells(ActiveCellList & cells,
+                          int32 start_col,
+                          int32 col_span,
+                          int32 start_row,
+                          int32 row_span)
+{
+    for(int32 row(start_row); row < start_row + row_span; ++row) {
+        for(int32 col(start_col); col < start_col + col_span; ++col) {
+            cells.insert(col, row);
+        }
+    }
+}
+
 //----------------------------------------------------------------------------------------
 void SmokeSim::initGridData() {
 
@@ -87,6 +103,15 @@ void SmokeSim::initGridData() {
         temperatureGrid.setAll(kTemp_0); // Set to ambient temperature
     }
 
+    //-- Advection destinations for density and temperature, swapped in each step.
+    tmp_density = densityGrid;
+    tmp_temperature = temperatureGrid;
+    mac_density = densityGrid;
+    mac_temperature = temperatureGrid;
+
+    // Both buffers hold ambient values everywhere outside of smokeCells.
+    smokeCells.resize(kGridWidth, kGridHeight);
+
     //-- Cell Grid
     {
         GridSpec gridSpec;
@@ -124,6 +149,9 @@ void SmokeSim::initGridData() {
             }
         }
 
+        // Must be rebuilt whenever solid cells change.
+        pressureStencil.build(cellGrid);
+
     }
 
     //-- Pressure Grid
@@ -175,269 +203,271 @@ void SmokeSim::initGridData() {
 
         tmp_velocity = velocityGrid;
     }
+
+    //-- Row scratch buffers for batched interpolation
+    rowSamples_x.resize(kGridWidth);
+    rowSamples_y.resize(kGridWidth);
+    rowDensity.resize(kGridWidth);
+    rowTemperature.resize(kGridWidth);
 }
 
 //----------------------------------------------------------------------------------------
-void SmokeSim::advectQuantities() {
+void SmokeSim::advectQuantities(float32 dt) {
     //-- Advect the velocity field
-    tmp_velocity = velocityGrid;
-    advect(tmp_velocity.u, velocityGrid, kDt);
-    advect(tmp_velocity.v, velocityGrid, kDt);
-    velocityGrid = tmp_velocity;
+    // Both components are traced through the old velocity field before the new
+    // components are swapped in.  Only faces next to fluid cells are visited,
+    // faces between two solid cells keep the solid velocity.
+    advect(velocityGrid.u, tmp_velocity.u, velocityGrid, dt, pressureStencil.uFaces());
+    advect(velocityGrid.v, tmp_velocity.v, velocityGrid, dt, pressureStencil.vFaces());
+    velocityGrid.u.swap(tmp_velocity.u);
+    velocityGrid.v.swap(tmp_velocity.v);
 
     //-- Advect other quantities
-    advect(densityGrid, velocityGrid, kDt);
-    advect(temperatureGrid, velocityGrid, kDt);
+    // Smoke can only move into cells within the CFL distance of smokeCells, plus
+    // one cell of slack for rounding in the backtrace.  Advected velocities are
+    // interpolated from the projected ones, so maxFluidSpeed() still bounds them.
+    uint32 reach = uint32(std::ceil(maxFluidSpeed() * dt * inv_kDx)) + 1;
+    smokeCells.dilate(reach);
+    smokeCells.sort();
+
+    // Density and temperature are co-located, so trace each cell only once.
+    // MacCormack keeps far more of the smoke's detail at the same resolution.
+    const Grid<float32> * quantities[] = { &densityGrid, &temperatureGrid };
+    Grid<float32> * destinations[] = { &tmp_density, &tmp_temperature };
+    if (advectionMethod == AdvectionMethod::MacCormack) {
+        Grid<float32> * scratch[] = { &mac_density, &mac_temperature };
+        advectMacCormack(quantities, destinations, scratch, 2, velocityGrid, dt,
+                smokeCells);
+    } else if (advectionMethod == AdvectionMethod::MonotoneCubic) {
+        advect<MonotoneCubicInterp>(quantities, destinations, 2, velocityGrid, dt,
+                smokeCells);
+    } else {
+        advect(quantities, destinations, 2, velocityGrid, dt, smokeCells);
+    }
+    densityGrid.swap(tmp_density);
+    temperatureGrid.swap(tmp_temperature);
+
+    pruneSmokeCells();
+}
+
+//----------------------------------------------------------------------------------------
+void SmokeSim::pruneSmokeCells() {
+    // Cells that have returned to ambient are reset in both buffers and dropped,
+    // so that the cost of advection follows the smoke rather than the grid.
+    for (int32 i(int32(smokeCells.size()) - 1); i >= 0; --i) {
+        uint32 col = smokeCells.col(i);
+        uint32 row = smokeCells.row(i);
+
+        if (std::abs(densityGrid(col,row)) < kSmokeThreshold &&
+            std::abs(temperatureGrid(col,row) - kTemp_0) < kSmokeThreshold)
+        {
+            densityGrid(col,row) = 0;
+            tmp_density(col,row) = 0;
+            temperatureGrid(col,row) = kTemp_0;
+            tmp_temperature(col,row) = kTemp_0;
+            smokeCells.erase(col,row);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+float32 SmokeSim::maxFluidSpeed() const {
+    // Found by subtractPressureGradient(), as part of the projection pass.
+    return std::max(fluid_max_vel.x, fluid_max_vel.y);
 }
 
 //----------------------------------------------------------------------------------------
-void SmokeSim::addForces() {
+void SmokeSim::addForces(float32 dt) {
 
    //-- Buoyant Force:
+   // Density and temperature are sampled at the fluid v-faces, gathered kGridWidth
+   // at a time for the batched bilinear kernel.  Faces between two solid cells are
+   // skipped so they keep the solid velocity.
+   Grid<float32> & v = velocityGrid.v;
+   const ActiveCellList & faces = pressureStencil.vFaces();
    float32 force;
-   float32 density;
-   float32 temp;
    vec2 worldPos;
-   for(uint32 row(0); row < kGridHeight; ++row) {
-       for(uint32 col(0); col < kGridWidth; ++col) {
-           worldPos = velocityGrid.v.getPosition(col,row);
-           density = bilinear(densityGrid, worldPos);
-           temp = bilinear(temperatureGrid, worldPos);
+   for(uint32 begin(0); begin < faces.size(); begin += kGridWidth) {
+       uint32 count = std::min(faces.size() - begin, uint32(kGridWidth));
+
+       for(uint32 i(0); i < count; ++i) {
+           worldPos = v.getPosition(faces.col(begin + i), faces.row(begin + i));
+           rowSamples_x[i] = worldPos.x;
+           rowSamples_y[i] = worldPos.y;
+       }
 
-           force = -kBuoyant_d * density + kBuoyant_t * (temp - kTemp_0);
+       bilinear(densityGrid, rowSamples_x.data(), rowSamples_y.data(),
+               rowDensity.data(), count);
+       bilinear(temperatureGrid, rowSamples_x.data(), rowSamples_y.data(),
+               rowTemperature.data(), count);
 
-           velocityGrid.v(col,row) += kDt * force;
+       for(uint32 i(0); i < count; ++i) {
+           force = -kBuoyant_d * rowDensity[i] +
+                   kBuoyant_t * (rowTemperature[i] - kTemp_0);
+
+           v(faces.col(begin + i), faces.row(begin + i)) += dt * force;
        }
    }
 
 }
 
 //----------------------------------------------------------------------------------------
-void SmokeSim::computeRHS() {
-    Grid<float32> & u = velocityGrid.u;
-    Grid<float32> & v = velocityGrid.v;
-
-    float32 scale = kDensity * kDx / kDt;
-
-
-    for(int32 row(0); row < cellGrid.height(); ++row) {
-        for (int32 col(0); col < cellGrid.width(); ++col) {
-            if (cellGrid(col, row) == CellType::Fluid) {
-                float32 delta_u( u(col+1, row) - u(col,row) );
-                float32 delta_v( v(col, row+1) - v(col, row) );
-
-                rhsGrid(col,row) =  scale * (delta_u + delta_v);
-            }
-        }
-    }
-
-
-    // Update RHS based on solid boundaries:
-    for(int32 row(0); row < cellGrid.height(); ++row) {
-        for(int32 col(0); col < cellGrid.width(); ++col) {
+void SmokeSim::computeRHS(float32 dt) {
+    // rhs = -(density * dx / dt) * div(u), so that Ap = rhs with A the positive
+    // definite fluid-cell Laplacian.
+    float32 scale = -kDensity * kDx / dt;
 
-            if (cellGrid(col,row) == CellType::Fluid) {
-
-                // Left Neighbor
-                if (cellGrid(col-1,row) == CellType::Solid) {
-                   rhsGrid(col,row) += scale * (u(col,row) - u_solid);
-                }
-                // Right Neighbor
-                if (cellGrid(col+1,row) == CellType::Solid) {
-                    rhsGrid(col,row) -= scale * (u(col+1,row) - u_solid);
-                }
-                // Bottom Neighbor
-                if (cellGrid(col,row-1) == CellType::Solid) {
-                    rhsGrid(col,row) += scale * (v(col,row) - v_solid);
-                }
-                // Top Neighbor
-                if (cellGrid(col,row+1) == CellType::Solid) {
-                    rhsGrid(col,row) -= scale * (v(col,row+1) - v_solid);
-                }
-
-            }
-
-        }
-    }
+    computePressureRhs(velocityGrid, pressureStencil, pressureStencil.fluidCells(),
+            scale, vec2(u_solid, v_solid), rhsGrid, Execution::Parallel);
 }
 //----------------------------------------------------------------------------------------
 void SmokeSim::computePressure() {
     // Want to solve the system Ap = b
     Grid<float32> & p = pressureGrid;
 
+    if (pressureMethod == PressureMethod::PCG) {
+        lastPressureSolve = pressureSolver.solve(pressureStencil, rhsGrid, p);
+        return;
+    } else if (pressureMethod == PressureMethod::Multigrid) {
+        lastPressureSolve = multigridSolver.solve(pressureStencil, rhsGrid, p);
+        return;
+    }
+
     //-- Set pressure to all zeros for initial guess
 //    p.setAll(0);
 
-    float32 numFluidNeighbors;
-    float32 neighborPressureSum;
-
-    //-- Apply Gauss-Seidel iterations to Poisson-pressure problem:
-    for(int32 iteration(0); iteration < kJacobiIterations; ++iteration) {
-
-        for (int32 row(0); row < cellGrid.height(); ++row) {
-            for (int32 col(0); col < cellGrid.width(); ++col) {
-
-                if(cellGrid(col,row) == CellType::Fluid) {
-
-                    numFluidNeighbors = 0;
-                    neighborPressureSum = 0;
-
-                    // Left Neighbor
-                    if (cellGrid(col-1,row) == CellType::Fluid) {
-                        ++numFluidNeighbors;
-                        neighborPressureSum += p(col-1,row);
-                    }
-                    // Right Neighbor
-                    if (cellGrid(col+1,row) == CellType::Fluid) {
-                        ++numFluidNeighbors;
-                        neighborPressureSum += p(col+1,row);
-                    }
-                    // Bottom Neighbor
-                    if (cellGrid(col, row-1) == CellType::Fluid) {
-                        ++numFluidNeighbors;
-                        neighborPressureSum += p(col,row-1);
-                    }
-                    // Top Neighbor
-                    if (cellGrid(col, row+1) == CellType::Fluid) {
-                        ++numFluidNeighbors;
-                        neighborPressureSum += p(col,row+1);
-                    }
-
-                    p(col,row) = -1 / numFluidNeighbors *
-                            (rhsGrid(col,row) - neighborPressureSum);
-
-                }
-            }
-        }
+    //-- Apply Gauss-Seidel iterations to Poisson-pressure problem.  The
+    // lexicographic sweep keeps the original CellType kernel for comparison.
+    if (gaussSeidelOrdering == GaussSeidelOrdering::RedBlack) {
+        gaussSeidel(pressureStencil, pressureStencil.fluidCells(), rhsGrid, p,
+                kJacobiIterations, gaussSeidelOrdering, Execution::Parallel);
+    } else {
+        gaussSeidel(cellGrid, rhsGrid, p, kJacobiIterations, gaussSeidelOrdering,
+                Execution::Parallel);
     }
 }
 
 //----------------------------------------------------------------------------------------
-void SmokeSim::subtractPressureGradient() {
+void SmokeSim::subtractPressureGradient(float32 dt) {
     // Here we update the velocity field by subtracting off the pressure gradient
     // making the field "divergence free"/incompressible.
+    float32 scale = dt / (kDensity*kDx);
 
-    Grid<float32> & u = velocityGrid.u;
-    Grid<float32> & v = velocityGrid.v;
-    Grid<float32> & p = pressureGrid;
-
-    float32 scale = kDt / (kDensity*kDx);
-    float32 value;
-
-    for(int32 row(0); row < cellGrid.height(); ++row) {
-        for(int32 col(0); col < cellGrid.width(); ++col) {
-
-            if (cellGrid(col,row) == CellType::Fluid) {
-                value = scale * p(col,row);
-                u(col,row) -= value;
-                u(col+1,row) += value;
+    FluidSim::subtractPressureGradient(velocityGrid, pressureStencil,
+            pressureStencil.fluidCells(), pressureGrid, scale, vec2(u_solid, v_solid),
+            Execution::Parallel, &fluid_max_vel);
 
-                v(col,row) -= value;
-                v(col,row+1) += value;
-            }
-
-        }
-    }
-
-    for(int32 row(0); row < cellGrid.height(); ++row) {
-        for(int32 col(0); col < cellGrid.width(); ++col) {
-
-            if (cellGrid(col,row) == CellType::Solid) {
-                u(col,row) = u_solid;
-                u(col+1,row) = u_solid;
-                v(col,row) = v_solid;
-                v(col,row+1) = v_solid;
-            }
+    max_vel = glm::max(max_vel, fluid_max_vel);
+}
 
-        }
-    }
+//----------------------------------------------------------------------------------------
+void SmokeSim::injectSmoke() {
+    fillGrid(densityGrid, 35, 10, 1, 6, 1.0f);
+    fillGrid(temperatureGrid, 35, 10, 1, 6, kTemp_0 + 200);
+    activateCells(smokeCells, 35, 10, 1, 6);
 }
 
 //----------------------------------------------------------------------------------------
-void SmokeSim::computeMaxVelocity() {
-    Grid<float32> & u = velocityGrid.u;
-    Grid<float32> & v = velocityGrid.v;
+void SmokeSim::step(float32 dt) {
 
-    for(int32 row(0); row < u.height(); ++row) {
-        for(int32 col(0); col < u.width(); ++col) {
-            max_vel.x = std::max(u(col,row), max_vel.x);
-        }
+    //-- Inject density and temperature:
+    if (frameCount < kInjectFrames) {
+        injectSmoke();
     }
-
-    for(int32 row(0); row < v.height(); ++row) {
-        for(int32 col(0); col < v.width(); ++col) {
-            max_vel.y = std::max(v(col,row), max_vel.y);
-        }
+    ++frameCount;
+
+    //-- Split the frame into substeps that respect kTargetCfl.
+    lastSubsteps = 0;
+    lastDt = 0;
+    float32 remaining = dt;
+    while (remaining > 0) {
+        float32 h = timeStep.substep(dt, remaining, maxFluidSpeed(), kDx);
+        substep(h);
+
+        remaining -= h;
+        lastDt = std::max(lastDt, h);
+        ++lastSubsteps;
     }
 }
 
 //----------------------------------------------------------------------------------------
-void SmokeSim::clampMaxVelocity() {
-    Grid<float32> & u = velocityGrid.u;
-    Grid<float32> & v = velocityGrid.v;
-
-    float32 max_cfl_velocity = 2.5f * kDx / kDt;
-
-    float32 value;
-    for(int32 row(0); row < u.height(); ++row) {
-        for(int32 col(0); col < u.width(); ++col) {
-            value =  u(col,row);
-            u(col,row) = std::min(value, max_cfl_velocity);
-        }
-    }
-    for(int32 row(0); row < v.height(); ++row) {
-        for(int32 col(0); col < v.width(); ++col) {
-            value =  v(col,row);
-            v(col,row) = std::min(value, max_cfl_velocity);
-        }
-    }
+void SmokeSim::substep(float32 dt) {
+    advectQuantities(dt);
+    addForces(dt);
 
+    computeRHS(dt);
+    computePressure();
+    subtractPressureGradient(dt);
 }
 
 //----------------------------------------------------------------------------------------
-void SmokeSim::logic() {
+vector<FieldView> SmokeSim::fields() const {
+    vector<FieldView> result;
+    result.push_back(makeFieldView("density", densityGrid));
+    result.push_back(makeFieldView("temperature", temperatureGrid));
+    result.push_back(makeFieldView("pressure", pressureGrid));
+    result.push_back(makeFieldView("u", velocityGrid.u));
+    result.push_back(makeFieldView("v", velocityGrid.v));
+
+    return result;
+}
 
-    //-- Inject density and temperature:
-    static uint counter = 0;
-    if (counter < 80) {
-        fillGrid(densityGrid, 35, 10, 1, 6, 1.0f);
-        fillGrid(temperatureGrid, 35, 10, 1, 6, kTemp_0 + 200);
-        counter++;
-    }
+//----------------------------------------------------------------------------------------
+void SmokeSim::setPressureMethod(PressureMethod method) {
+    pressureMethod = method;
+}
 
-    advectQuantities();
-    addForces();
+//----------------------------------------------------------------------------------------
+PressureMethod SmokeSim::getPressureMethod() const {
+    return pressureMethod;
+}
 
-    computeRHS();
-    computePressure();
-    subtractPressureGradient();
+//----------------------------------------------------------------------------------------
+void SmokeSim::setGaussSeidelOrdering(GaussSeidelOrdering ordering) {
+    gaussSeidelOrdering = ordering;
+}
 
-    clampMaxVelocity();
-    computeMaxVelocity();
+//----------------------------------------------------------------------------------------
+GaussSeidelOrdering SmokeSim::getGaussSeidelOrdering() const {
+    return gaussSeidelOrdering;
+}
 
-    smokeGraphics.uploadTextureData(densityGrid);
+//----------------------------------------------------------------------------------------
+void SmokeSim::setAdvectionMethod(AdvectionMethod method) {
+    advectionMethod = method;
 }
 
 //----------------------------------------------------------------------------------------
-void SmokeSim::draw() {
-    smokeGraphics.draw();
+AdvectionMethod SmokeSim::getAdvectionMethod() const {
+    return advectionMethod;
 }
 
 //----------------------------------------------------------------------------------------
-void SmokeSim::keyInput(int key, int action, int mods) {
+const Grid<float32> & SmokeSim::density() const {
+    return densityGrid;
+}
 
+//----------------------------------------------------------------------------------------
+const Grid<CellType> & SmokeSim::cells() const {
+    return cellGrid;
 }
 
 //----------------------------------------------------------------------------------------
-void SmokeSim::cleanup() {
-    cout << "max_u: " << max_vel.x << endl;
-    cout << "max_v: " << max_vel.y << endl;
-    cout << "CFL Condtion, max(velocity) <= " << 5 * kDx / kDt << endl;
-    cout << endl;
+const PressureSolveResult & SmokeSim::lastPressureSolveResult() const {
+    return lastPressureSolve;
+}
 
-    cout << "Simulation Clean Up" << endl;
+//----------------------------------------------------------------------------------------
+vec2 SmokeSim::maxVelocity() const {
+    return max_vel;
+}
 
-    smokeGraphics.cleanup();
+//----------------------------------------------------------------------------------------
+uint32 SmokeSim::lastSubstepCount() const {
+    return lastSubsteps;
+}
 
-    cout << " ... Good Bye." << endl;
+//----------------------------------------------------------------------------------------
+float32 SmokeSim::lastTimeStep() const {
+    return lastDt;
 }
@@ -6,23 +6,33 @@
 
 #pragma once
 
-#include "SmokeGraphics.hpp"
-
 #include "FluidSim/NumericTypes.hpp"
 #include "FluidSim/Grid.hpp"
 #include "FluidSim/StaggeredGrid.hpp"
+#include "FluidSim/CellType.hpp"
+#include "FluidSim/PressureSolver.hpp"
+#include "FluidSim/MultigridSolver.hpp"
+#include "FluidSim/GaussSeidel.hpp"
+#include "FluidSim/PressureStencil.hpp"
+#include "FluidSim/ActiveCellList.hpp"
+#include "FluidSim/CflTimeStep.hpp"
+#include "FluidSim/Simulation.hpp"
 using namespace FluidSim;
 
-#include "Utils/GlfwOpenGlWindow.hpp"
-
 #include <glm/glm.hpp>
 using namespace glm;
 
+#include <vector>
+
 //----------------------------------------------------------------------------------------
 // Simulation Parameters
 //----------------------------------------------------------------------------------------
 const float32 kDt = 0.01;
 const int32 kJacobiIterations = 40;
+const float32 kPressureTolerance = 1.0e-5f; // PCG relative residual tolerance.
+const uint32 kPressureMaxIterations = 200;  // PCG iteration cap.
+const float32 kTargetCfl = 2.5f; // Cells the fastest fluid may cross per substep.
+const uint32 kMaxSubsteps = 8;   // Substeps per frame before the CFL limit gives.
 
 //----------------------------------------------------------------------------------------
 // Fluid Parameters
@@ -31,6 +41,7 @@ const float32 kTemp_0 = 273.0f; // Ambient Temperature in Kelvin
 const float32 kBuoyant_d = 0.8f;// Density coefficient for buoyant force.
 const float32 kBuoyant_t = 0.24f; // Temperature coefficient for buoyant force.
 const float32 kDensity = 1.0f;
+const float32 kSmokeThreshold = 1.0e-4f; // Smoke below this is reset to ambient.
 
 //----------------------------------------------------------------------------------------
 // Grid Parameters
@@ -43,46 +54,105 @@ const float32 inv_kDx = 1.0f/kDx;
 const float32 u_solid = 0.0f; // horizontal velocity of solid boundaries.
 const float32 v_solid = 0.0f; // vertical velocity of solid boundaries.
 
+//----------------------------------------------------------------------------------------
+// Source Parameters
+//----------------------------------------------------------------------------------------
+const uint32 kInjectFrames = 80; // Smoke is injected during the first kInjectFrames.
+
 
-enum class CellType : bool {
-    Fluid, Solid
+// Method used to solve for pressure, cycled with the 'P' key.
+enum class PressureMethod {
+    GaussSeidel, PCG, Multigrid
 };
 
-class SmokeSim : public GlfwOpenGlWindow {
+// Method used to advect density and temperature, cycled with the 'M' key.
+// MonotoneCubic is semi-Lagrangian advection sampled with monotoneCubic().
+enum class AdvectionMethod {
+    SemiLagrangian, MonotoneCubic, MacCormack
+};
+
+/**
+* 2D smoke simulation on a MAC grid, with no dependence on a window or OpenGL
+* context.  SmokeDemo renders it interactively, while the headless runner steps
+* it as fast as possible.  Its fields() are density, temperature, pressure, u and
+* v.
+*/
+class SmokeSim : public Simulation {
 
 public:
+    SmokeSim();
+
     ~SmokeSim() { }
 
-    static std::shared_ptr<GlfwOpenGlWindow> getInstance();
+    virtual void init();
+    virtual void step(float32 dt);
+    virtual std::vector<FieldView> fields() const;
 
-private:
-    SmokeSim() = default; // Singleton. Prevent direct construction.
+    void setPressureMethod(PressureMethod method);
+    PressureMethod getPressureMethod() const;
+
+    void setGaussSeidelOrdering(GaussSeidelOrdering ordering);
+    GaussSeidelOrdering getGaussSeidelOrdering() const;
+
+    void setAdvectionMethod(AdvectionMethod method);
+    AdvectionMethod getAdvectionMethod() const;
+
+    const Grid<float32> & density() const;
+    const Grid<CellType> & cells() const;
+    const PressureSolveResult & lastPressureSolveResult() const;
+
+    // Largest |u| and |v| seen since init().
+    vec2 maxVelocity() const;
+
+    // Number of substeps the last call to step() took, and the length of the
+    // longest one.  Calm flow takes one substep per frame.
+    uint32 lastSubstepCount() const;
+    float32 lastTimeStep() const;
 
+private:
     StaggeredGrid<float32> velocityGrid;
     StaggeredGrid<float32> tmp_velocity;
     Grid<float32> densityGrid;
     Grid<float32> temperatureGrid;
+    Grid<float32> tmp_density;
+    Grid<float32> tmp_temperature;
+    Grid<float32> mac_density;     // MacCormack backward advection results.
+    Grid<float32> mac_temperature;
     Grid<float32> pressureGrid;
     Grid<float32> rhsGrid; // rhs of Ap = b
     Grid<CellType> cellGrid;
-
-    SmokeGraphics smokeGraphics;
-
+    PressureStencil pressureStencil; // Derived from cellGrid.
+    ActiveCellList smokeCells; // Cells whose density or temperature is not ambient.
+
+    PressureMethod pressureMethod = PressureMethod::PCG;
+    GaussSeidelOrdering gaussSeidelOrdering = GaussSeidelOrdering::RedBlack;
+    AdvectionMethod advectionMethod = AdvectionMethod::MacCormack;
+    PressureSolver pressureSolver;
+    MultigridSolver multigridSolver;
+    PressureSolveResult lastPressureSolve;
+
+    // Scratch space for sampling one grid row at a time with batched bilinear().
+    std::vector<float32> rowSamples_x;
+    std::vector<float32> rowSamples_y;
+    std::vector<float32> rowDensity;
+    std::vector<float32> rowTemperature;
+
+    CflTimeStep timeStep;
+    uint32 frameCount; // Calls to step() since init().
     vec2 max_vel;
-
-    virtual void init();
-    virtual void logic();
-    virtual void draw();
-    virtual void keyInput(int key, int action, int mods);
-    virtual void cleanup();
+    vec2 fluid_max_vel; // Largest |u| and |v| over fluid faces, after projection.
+    uint32 lastSubsteps;
+    float32 lastDt;
 
     void initGridData();
-    void advectQuantities();
-    void addForces();
-    void computeRHS();
+    void injectSmoke();
+    void substep(float32 dt);
+    void advectQuantities(float32 dt);
+    void pruneSmokeCells();
+    float32 maxFluidSpeed() const;
+    void addForces(float32 dt);
+    void computeRHS(float32 dt);
     void computePressure();
-    void subtractPressureGradient();
-    void computeMaxVelocity();
-    void clampMaxVelocity();
+    void subtractPressureGradient(float32 dt);
 
 };
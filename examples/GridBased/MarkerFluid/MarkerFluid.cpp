@@ -1,7 +1,7 @@
 // MarkerFluid.cpp
 
 #include "MarkerFluid.hpp"
-#include "Renderer.hpp"
+#include "Headless/HeadlessSimulations.hpp"
 
 #include "Utils/Timer.hpp"
 #include "Utils.hpp"
@@ -14,14 +14,12 @@ using namespace FluidSim;
 #include <glm/gtx/norm.hpp>
 
 #include <iostream>
+#include <memory>
 using namespace std;
 
 //---------------------------------------------------------------------------------------
-int main () {
-    shared_ptr<GlfwOpenGlWindow> demo = MarkerFluid::getInstance();
-    demo->create(kScreenWidth, kScreenWidth, "Marker Particle Fluid Simulation");
-    
-    return 0;
+unique_ptr<Simulation> createMarkerFluid() {
+	return unique_ptr<Simulation>(new MarkerFluid());
 }
 
 //---------------------------------------------------------------------------------------
@@ -31,37 +29,31 @@ MarkerFluid::MarkerFluid() {
 
 //---------------------------------------------------------------------------------------
 MarkerFluid::~MarkerFluid() {
-	delete timer;
-	delete renderer;
-}
-
-//---------------------------------------------------------------------------------------
-shared_ptr<GlfwOpenGlWindow> MarkerFluid::getInstance() {
-	static GlfwOpenGlWindow * instance = new MarkerFluid();
-	if (p_instance == nullptr) {
-		p_instance = shared_ptr<GlfwOpenGlWindow>(instance);
-	}
 
-	return p_instance;
 }
 
 //---------------------------------------------------------------------------------------
 void MarkerFluid::init() {
 	setupGridData();
 
-	uint32 maxParticles = 4000;
-	distributeFluidParticles(maxParticles);
+	distributeFluidParticles(kMaxParticles);
 	setInitialParticleVelocities();
+}
 
+//---------------------------------------------------------------------------------------
+const std::vector<vec2> & MarkerFluid::getParticlePositions() const {
+	return particlePositions;
+}
 
-	renderer = new Renderer(
-			kScreenWidth,
-			kScreenHeight,
-			kGridWidth,
-			kGridHeight,
-			maxParticles
-	);
-	renderer->setSampleRadius(0.0022f);
+//---------------------------------------------------------------------------------------
+vector<FieldView> MarkerFluid::fields() const {
+	vector<FieldView> result;
+	result.push_back(makeFieldView("position", &particlePositions[0].x,
+			uint32(particlePositions.size()), 2, 2));
+	result.push_back(makeFieldView("u", velocityGrid.u));
+	result.push_back(makeFieldView("v", velocityGrid.v));
+
+	return result;
 }
 
 
@@ -74,8 +66,8 @@ void MarkerFluid::distributeFluidParticles (
 	float minSampleDistance = 0.012f;
 
 
-	timer = new Timer();
-	timer->start();
+	Timer timer;
+	timer.start();
 	BlueNoise::distributeSamples(
 			domainMin,
 			domainMax,
@@ -83,14 +75,14 @@ void MarkerFluid::distributeFluidParticles (
 			maxParticles,
 			particlePositions
 	);
-	timer->stop();
+	timer.stop();
 
 	if(particleVelocities.size() != particlePositions.size()) {
 		particleVelocities.resize(particlePositions.size());
 	}
 
 	cout << endl;
-	cout << "Time: " << timer->getElapsedTime() << " sec" << endl;
+	cout << "Time: " << timer.getElapsedTime() << " sec" << endl;
 	cout << "NumParticles: " << particlePositions.size() << endl;
 }
 
@@ -132,19 +124,19 @@ void MarkerFluid::setupGridData() {
 }
 
 //---------------------------------------------------------------------------------------
-void MarkerFluid::advectVelocity() {
+void MarkerFluid::advectVelocity(float32 dt) {
 	//-- Advect velocity field
 	tmp_grid = velocityGrid;
-	advect(tmp_grid.u, velocityGrid, kDt);
-	advect(tmp_grid.v, velocityGrid, kDt);
+	advect(tmp_grid.u, velocityGrid, dt);
+	advect(tmp_grid.v, velocityGrid, dt);
 	velocityGrid = tmp_grid;
 }
 
 //---------------------------------------------------------------------------------------
 // Copies velocity components from particleVelocities into partcle velocity caches.
 void MarkerFluid::updateParticleVelocityCache() {
-	particle_u_velocity_cache.reserve(particleVelocities.size());
-	particle_v_velocity_cache.reserve(particleVelocities.size());
+	particle_u_velocity_cache.resize(particleVelocities.size());
+	particle_v_velocity_cache.resize(particleVelocities.size());
 
 	uint32 index = 0;
 	for (const vec2 & velocity : particleVelocities) {
@@ -167,13 +159,13 @@ void MarkerFluid::transferParticlesVelocitiesToGrid() {
 }
 
 //---------------------------------------------------------------------------------------
-void MarkerFluid::updateParticlePositions() {
+void MarkerFluid::updateParticlePositions(float32 dt) {
 	for(vec2 & position : particlePositions) {
 		float32 u = bilinear(velocityGrid.u, position);
 		float32 v = bilinear(velocityGrid.v, position);
 
 		// Euler update to particle position.
-		position += vec2(u,v)*kDt;
+		position += vec2(u,v)*dt;
 	}
 }
 
@@ -208,13 +200,13 @@ void MarkerFluid::computeMaxVelocity() {
 }
 
 //---------------------------------------------------------------------------------------
-void MarkerFluid::logic() {
+void MarkerFluid::step(float32 dt) {
 
-	advectVelocity();
+	advectVelocity(dt);
 
 	transferParticlesVelocitiesToGrid();
 
-//	updateParticlePositions();
+//	updateParticlePositions(dt);
 
 //	addForces();
 //
@@ -222,19 +214,3 @@ void MarkerFluid::logic() {
 //	computePressure();
 //	projectVelocity();
 }
-
-//---------------------------------------------------------------------------------------
-void MarkerFluid::draw() {
-//	renderer->renderGrid();
-	renderer->renderSamples(particlePositions);
-}
-
-//---------------------------------------------------------------------------------------
-void MarkerFluid::keyInput(int key, int action, int mods) {
-
-}
-
-//---------------------------------------------------------------------------------------
-void MarkerFluid::cleanup() {
-
-}
@@ -3,18 +3,11 @@
 #pragma once
 
 
-#include "Utils/GlfwOpenGlWindow.hpp"
-
 #include <FluidSim/StaggeredGrid.hpp>
+#include <FluidSim/Simulation.hpp>
 
 #include <vector>
 
-//---------------------------------------------------------------------------------------
-// Forward Declarations
-//---------------------------------------------------------------------------------------
-class Renderer;
-class Timer;
-
 //---------------------------------------------------------------------------------------
 // Simulation Constants
 //---------------------------------------------------------------------------------------
@@ -27,15 +20,24 @@ const float32 kGridCellLength = 1.0f / kGridWidth;
 
 const float32 kDt = 0.02f;
 
+const uint32 kMaxParticles = 4000;
+
 //---------------------------------------------------------------------------------------
 
-class MarkerFluid : public GlfwOpenGlWindow {
+// Marker particle fluid, with no dependence on a window or OpenGL context.
+// MarkerFluidDemo renders it interactively.  Its fields() are the particle
+// positions and the u and v velocity components.
+class MarkerFluid : public FluidSim::Simulation {
 public:
 	MarkerFluid();
 
 	~MarkerFluid();
 
-	static std::shared_ptr<GlfwOpenGlWindow> getInstance();
+	virtual void init();
+	virtual void step(float32 dt);
+	virtual std::vector<FluidSim::FieldView> fields() const;
+
+	const std::vector<vec2> & getParticlePositions() const;
 
 private:
 	FluidSim::StaggeredGrid<float32> velocityGrid;
@@ -46,27 +48,17 @@ private:
 	std::vector<float32> particle_u_velocity_cache;
 	std::vector<float32> particle_v_velocity_cache;
 
-
-	Timer * timer;
-	Renderer * renderer;
-
-	virtual void init();
-	virtual void logic();
-	virtual void draw();
-	virtual void keyInput(int key, int action, int mods);
-	virtual void cleanup();
-
 	void setupGridData();
 	void distributeFluidParticles(uint32 maxParticles);
 	void setInitialParticleVelocities();
 
-	void advectVelocity();
+	void advectVelocity(float32 dt);
 	void transferParticlesVelocitiesToGrid();
 	void updateParticleVelocityCache();
 
 
 	// TODO Dustin - Implement these methods:
-	void updateParticlePositions();
+	void updateParticlePositions(float32 dt);
 	void addForces();
 
 	void computeRHS();
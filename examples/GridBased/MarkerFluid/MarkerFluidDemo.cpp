@@ -0,0 +1,71 @@
+// MarkerFluidDemo.cpp
+
+#include "MarkerFluidDemo.hpp"
+#include "Renderer.hpp"
+
+using namespace std;
+
+//---------------------------------------------------------------------------------------
+int main () {
+    shared_ptr<GlfwOpenGlWindow> demo = MarkerFluidDemo::getInstance();
+    demo->create(kScreenWidth, kScreenWidth, "Marker Particle Fluid Simulation");
+    
+    return 0;
+}
+
+//---------------------------------------------------------------------------------------
+MarkerFluidDemo::MarkerFluidDemo()
+	: renderer(nullptr)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+MarkerFluidDemo::~MarkerFluidDemo() {
+	delete renderer;
+}
+
+//---------------------------------------------------------------------------------------
+shared_ptr<GlfwOpenGlWindow> MarkerFluidDemo::getInstance() {
+	static GlfwOpenGlWindow * instance = new MarkerFluidDemo();
+	if (p_instance == nullptr) {
+		p_instance = shared_ptr<GlfwOpenGlWindow>(instance);
+	}
+
+	return p_instance;
+}
+
+//---------------------------------------------------------------------------------------
+void MarkerFluidDemo::init() {
+	markerFluid.init();
+
+	renderer = new Renderer(
+			kScreenWidth,
+			kScreenHeight,
+			kGridWidth,
+			kGridHeight,
+			kMaxParticles
+	);
+	renderer->setSampleRadius(0.0022f);
+}
+
+//---------------------------------------------------------------------------------------
+void MarkerFluidDemo::logic() {
+	markerFluid.step(kDt);
+}
+
+//---------------------------------------------------------------------------------------
+void MarkerFluidDemo::draw() {
+//	renderer->renderGrid();
+	renderer->renderSamples(markerFluid.getParticlePositions());
+}
+
+//---------------------------------------------------------------------------------------
+void MarkerFluidDemo::keyInput(int key, int action, int mods) {
+
+}
+
+//---------------------------------------------------------------------------------------
+void MarkerFluidDemo::cleanup() {
+
+}
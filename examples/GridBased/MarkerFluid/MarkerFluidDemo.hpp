@@ -0,0 +1,39 @@
+// MarkerFluidDemo.hpp
+
+#pragma once
+
+#include "MarkerFluid.hpp"
+
+#include "Utils/GlfwOpenGlWindow.hpp"
+
+#include <memory>
+
+//---------------------------------------------------------------------------------------
+// Forward Declarations
+//---------------------------------------------------------------------------------------
+class Renderer;
+
+//---------------------------------------------------------------------------------------
+
+// Interactive window for MarkerFluid, stepping it once per frame and rendering
+// its marker particles.
+class MarkerFluidDemo : public GlfwOpenGlWindow {
+public:
+	MarkerFluidDemo();
+
+	~MarkerFluidDemo();
+
+	static std::shared_ptr<GlfwOpenGlWindow> getInstance();
+
+private:
+	MarkerFluid markerFluid;
+
+	Renderer * renderer;
+
+	virtual void init();
+	virtual void logic();
+	virtual void draw();
+	virtual void keyInput(int key, int action, int mods);
+	virtual void cleanup();
+
+};
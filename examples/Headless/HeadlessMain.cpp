@@ -0,0 +1,117 @@
+/**
+* HeadlessMain.cpp
+*
+* Steps one of the example simulations without a window or OpenGL context, as
+* fast as possible, optionally writing its fields to raw files for offline
+* rendering or comparison.
+*
+* Usage:
+*   fluidsim_headless <smoke|smoke3d|sph|marker> [--frames count] [--dt seconds]
+*                     [--output prefix] [--interval frames] [--parallel]
+*
+* --parallel applies to smoke3d and sph.  See FluidSim::writeFields() for the
+* output file format.
+*
+* @author Dustin Biser
+*/
+
+#include "HeadlessSimulations.hpp"
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/HeadlessRunner.hpp"
+#include "FluidSim/SmokeSim3D.hpp"
+#include "FluidSim/Exception.hpp"
+using namespace FluidSim;
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+
+namespace {  // limit visibility to this file.
+
+//----------------------------------------------------------------------------------------
+void printUsage(const char * program) {
+	printf("Usage: %s <smoke|smoke3d|sph|marker> [--frames count] [--dt seconds] "
+			"[--output prefix] [--interval frames] [--parallel]\n", program);
+}
+
+//----------------------------------------------------------------------------------------
+// Returns nullptr for an unknown simulation name.
+std::unique_ptr<Simulation> createSimulation(const std::string & name,
+		Execution execution)
+{
+	if (name == "smoke") {
+		return createSmokeSim();
+	} else if (name == "sph") {
+		return createSphSim(execution);
+	} else if (name == "marker") {
+		return createMarkerFluid();
+	} else if (name == "smoke3d") {
+		SmokeSim3D * smokeSim = new SmokeSim3D();
+		smokeSim->setExecution(execution);
+		return std::unique_ptr<Simulation>(smokeSim);
+	}
+
+	return std::unique_ptr<Simulation>();
+}
+
+} // end namespace
+
+
+//----------------------------------------------------------------------------------------
+int main(int argc, char ** argv) {
+	if (argc < 2) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	const std::string name = argv[1];
+	HeadlessSettings settings;
+	Execution execution = Execution::Serial;
+
+	for (int i(2); i < argc; ++i) {
+		bool hasValue = (i + 1 < argc);
+
+		if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+			settings.frames = uint32(atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--dt") == 0 && hasValue) {
+			settings.dt = float32(atof(argv[++i]));
+		} else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+			settings.outputPrefix = argv[++i];
+		} else if (strcmp(argv[i], "--interval") == 0 && hasValue) {
+			settings.outputInterval = uint32(atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--parallel") == 0) {
+			execution = Execution::Parallel;
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	std::unique_ptr<Simulation> simulation = createSimulation(name, execution);
+	if (!simulation) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	try {
+		HeadlessResult result = runHeadless(*simulation, settings);
+
+		printf("%s: %u frames, dt %g, %.3f s stepping (%.1f frames/s)",
+				name.c_str(), result.frames, settings.dt, result.stepSeconds,
+				result.framesPerSecond());
+		if (result.framesWritten > 0) {
+			printf(", %u frames written in %.3f s", result.framesWritten,
+					result.outputSeconds);
+		}
+		printf("\n");
+	} catch (const FluidSim::Exception & e) {
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
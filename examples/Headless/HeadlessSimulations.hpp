@@ -0,0 +1,19 @@
+/**
+* @brief HeadlessSimulations.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/Simulation.hpp"
+#include "FluidSim/Parallel.hpp"
+
+#include <memory>
+
+// Factories for the example simulations, each defined alongside its
+// simulation so that the example's global parameters stay within one
+// translation unit.
+std::unique_ptr<FluidSim::Simulation> createSmokeSim();
+std::unique_ptr<FluidSim::Simulation> createSphSim(FluidSim::Execution execution);
+std::unique_ptr<FluidSim::Simulation> createMarkerFluid();
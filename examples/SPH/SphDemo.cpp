@@ -0,0 +1,81 @@
+#include "SphDemo.hpp"
+
+#include <iostream>
+using namespace std;
+
+
+//----------------------------------------------------------------------------------------
+int main() {
+    shared_ptr<GlfwOpenGlWindow> sphDemo = SphDemo::getInstance();
+    sphDemo->create(kScreenWidth, kScreenHeight, "SPH Fluid Simulation");
+
+    return 0;
+}
+
+//---------------------------------------------------------------------------------------
+// Interleaves particle positions for SphGraphics.
+static void snapshotPositions(const FluidSim::Simulation & simulation,
+                              vector<vec2> & frame) {
+    const ParticleArrays & particles = static_cast<const SphSim &>(simulation).getParticles();
+
+    frame.resize(particles.size());
+    for(uint32 i = 0; i < particles.size(); ++i) {
+        frame[i] = particles.position(i);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+SphDemo::SphDemo()
+    : asyncSim(sphSim, snapshotPositions)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+shared_ptr<GlfwOpenGlWindow> SphDemo::getInstance() {
+    static GlfwOpenGlWindow * instance = new SphDemo();
+    if (p_instance == nullptr) {
+        p_instance = shared_ptr<GlfwOpenGlWindow>(instance);
+    }
+
+    return p_instance;
+}
+
+//----------------------------------------------------------------------------------------
+void SphDemo::init() {
+    cout << "\nInitializing Simulation." << endl;
+
+    sphSim.init();
+
+    vector<vec2> positions;
+    snapshotPositions(sphSim, positions);
+    sphGraphics.init(positions);
+
+    asyncSim.start(kDt);
+}
+
+//----------------------------------------------------------------------------------------
+void SphDemo::logic() {
+    const vector<vec2> * positions = asyncSim.beginReadLatest();
+    if (positions != nullptr) {
+        sphGraphics.UpdateGL(*positions);
+        asyncSim.endRead();
+    }
+}
+
+//----------------------------------------------------------------------------------------
+void SphDemo::draw() {
+    sphGraphics.draw();
+}
+
+//----------------------------------------------------------------------------------------
+void SphDemo::keyInput(int key, int action, int mods) {
+
+}
+
+//----------------------------------------------------------------------------------------
+void SphDemo::cleanup() {
+    asyncSim.stop();
+
+    cout << "Simulation Clean Up" << " ... Good Bye." << endl;
+}
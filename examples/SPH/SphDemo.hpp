@@ -0,0 +1,46 @@
+/**
+* @brief SphDemo.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "SphSim.hpp"
+#include "SphGraphics.hpp"
+
+#include "Utils/GlfwOpenGlWindow.hpp"
+
+#include "FluidSim/AsyncSimulation.hpp"
+
+#include <memory>
+
+/**
+* Interactive window for SphSim, rendering its particles.  SphSim steps on its
+* own thread through an AsyncSimulation, and each frame draws the newest
+* particle snapshot available.
+*/
+class SphDemo : public GlfwOpenGlWindow {
+
+public:
+    ~SphDemo() { }
+
+    static std::shared_ptr<GlfwOpenGlWindow> getInstance();
+
+private:
+    SphDemo(); // Singleton. Prevent direct construction.
+
+    SphSim sphSim;
+    SphGraphics sphGraphics;
+
+    // Particle position snapshots handed from the simulation thread to the render
+    // thread.
+    FluidSim::AsyncSimulation< vector<vec2> > asyncSim;
+
+    virtual void init();
+    virtual void logic();
+    virtual void draw();
+    virtual void keyInput(int key, int action, int mods);
+    virtual void cleanup();
+
+};
@@ -4,10 +4,10 @@
 #include <glm/gtc/type_ptr.hpp>
 
 //----------------------------------------------------------------------------------------
-void SphGraphics::init(const vector<Particle> & particles) {
+void SphGraphics::init(const vector<vec2> & positions) {
     SetupShaders();
     SetupCamera();
-    SetupVboData(particles);
+    SetupVboData(positions);
     SetupUniforms();
 
     glEnable(GL_DEPTH_TEST);
@@ -35,7 +35,9 @@ void SphGraphics::SetupCamera() {
 }
 
 //----------------------------------------------------------------------------------------
-void SphGraphics::SetupVboData(const vector<Particle> & particles) {
+void SphGraphics::SetupVboData(const vector<vec2> & positions) {
+    numParticles = GLsizei(positions.size());
+
     glGenVertexArrays(1, &vao);
     glBindVertexArray(vao);
 
@@ -51,17 +53,13 @@ void SphGraphics::SetupVboData(const vector<Particle> & particles) {
         glGenBuffers(1, &vbo_particlePositions);
         glBindBuffer(GL_ARRAY_BUFFER, vbo_particlePositions);
 
-        // TODO Dustin - Try extracting position data from all Particles and tightly
-        // packing it into the VBO.  Check for performance increase.  May have
-        // better GPU cache hit rate.
-
+        // Positions are tightly packed.
         GLuint particlePositionIndex = 1;
-        GLsizeiptr particlePositionBytes = sizeof(Particle) * kNumParticles;
-        const GLvoid * data = glm::value_ptr(particles[0].position);
+        GLsizeiptr particlePositionBytes = sizeof(vec2) * positions.size();
+        const GLvoid * data = positions.data();
         glBufferData(GL_ARRAY_BUFFER, particlePositionBytes, data, GL_STREAM_DRAW);
 
-        GLsizei stride = sizeof(Particle);
-        glVertexAttribPointer(particlePositionIndex, 2, GL_FLOAT, GL_FALSE, stride, 0);
+        glVertexAttribPointer(particlePositionIndex, 2, GL_FLOAT, GL_FALSE, 0, 0);
 
         // Advance position attribute data once per instance.
         glVertexAttribDivisor(particlePositionIndex, 1);
@@ -120,10 +118,10 @@ void SphGraphics::SetupUniforms() {
 }
 
 //----------------------------------------------------------------------------------------
-void SphGraphics::UpdateGL(const vector<Particle> & particles) {
+void SphGraphics::UpdateGL(const vector<vec2> & positions) {
     glBindBuffer(GL_ARRAY_BUFFER, vbo_particlePositions);
-    const GLvoid * data = glm::value_ptr(particles[0].position);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Particle)*kNumParticles, data);
+    const GLvoid * data = positions.data();
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vec2)*positions.size(), data);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     CHECK_GL_ERRORS;
 }
@@ -131,7 +129,7 @@ void SphGraphics::UpdateGL(const vector<Particle> & particles) {
 //----------------------------------------------------------------------------------------
 void SphGraphics::draw() {
     shaderProgram.enable();
-        glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 10,  GLsizei(kNumParticles));
+        glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 10, numParticles);
     shaderProgram.disable();
 
     CHECK_GL_ERRORS;
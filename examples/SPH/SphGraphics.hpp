@@ -9,21 +9,21 @@
 #include <Synergy/Synergy.hpp>
 using namespace Synergy;
 
+#include <glm/glm.hpp>
+
 #include <vector>
 using std::vector;
 
-struct Particle;
-
 class SphGraphics {
 public:
-    void init(const vector<Particle> & particles);
+    void init(const vector<glm::vec2> & positions);
     void draw();
 
     void SetupShaders();
     void SetupUniforms();
     void SetupCamera();
-    void SetupVboData(const vector<Particle> & particles);
-    void UpdateGL(const vector<Particle> & particles);
+    void SetupVboData(const vector<glm::vec2> & positions);
+    void UpdateGL(const vector<glm::vec2> & positions);
 
 private:
     ShaderProgram shaderProgram;
@@ -31,4 +31,5 @@ private:
     GLuint vao;
     GLuint vbo_particlePositions;
     GLuint vbo_circle_vertices;
+    GLsizei numParticles;
 };
@@ -1,4 +1,5 @@
 #include "SphSim.hpp"
+#include "Headless/HeadlessSimulations.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
@@ -6,78 +7,130 @@
 #include <glm/gtx/fast_square_root.hpp>
 using namespace glm;
 
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 using namespace std;
 
 #include <cstdlib>
 
-//----------------------------------------------------------------------------------------
-int main() {
-    shared_ptr<GlfwOpenGlWindow> sphDemo = SphSim::getInstance();
-    sphDemo->create(kScreenWidth, kScreenHeight, "SPH Fluid Simulation");
-
-    return 0;
-}
+using FluidSim::Execution;
+using FluidSim::FieldView;
+using FluidSim::Simulation;
+using FluidSim::makeFieldView;
+using FluidSim::parallelFor;
 
-//---------------------------------------------------------------------------------------
-SphSim::SphSim() {
+//----------------------------------------------------------------------------------------
+unique_ptr<Simulation> createSphSim(Execution execution) {
+    SphSim * sphSim = new SphSim();
+    sphSim->setExecution(execution);
+    return unique_ptr<Simulation>(sphSim);
 }
 
 //---------------------------------------------------------------------------------------
-shared_ptr<GlfwOpenGlWindow> SphSim::getInstance() {
-    static GlfwOpenGlWindow * instance = new SphSim();
-    if (p_instance == nullptr) {
-        p_instance = shared_ptr<GlfwOpenGlWindow>(instance);
-    }
+SphSim::SphSim(uint32 numParticles, const vec2 & domainSize)
+    : numParticles(numParticles),
+      domainSize(domainSize),
+      execution(Execution::Parallel),
+      steps(0),
+      neighborListBuilds(0)
+{
 
-    return p_instance;
 }
 
 //----------------------------------------------------------------------------------------
 void SphSim::init() {
-    cout << "\nInitializing Simulation." << endl;
+    particles.clear();
+    steps = 0;
+    neighborListBuilds = 0;
+    neighborListX.clear();
+    neighborListY.clear();
+
+    // Cells cover the domain, with a partial column and row at its far edges.
+    cellIndex.resize(uint32(domainSize.x / kCellSize) + 1,
+                     uint32(domainSize.y / kCellSize) + 1,
+                     kCellSize);
 
     InitializeWalls();
     InitializeParticles();
+}
+
+//----------------------------------------------------------------------------------------
+void SphSim::setExecution(Execution execution) {
+    this->execution = execution;
+}
+
+//----------------------------------------------------------------------------------------
+Execution SphSim::getExecution() const {
+    return execution;
+}
+
+//----------------------------------------------------------------------------------------
+const ParticleArrays & SphSim::getParticles() const {
+    return particles;
+}
+
+//----------------------------------------------------------------------------------------
+uint32 SphSim::getSteps() const {
+    return steps;
+}
 
-    sphGraphics.init(particles);
+//----------------------------------------------------------------------------------------
+uint32 SphSim::getNeighborListBuilds() const {
+    return neighborListBuilds;
 }
+
+//----------------------------------------------------------------------------------------
+vector<FieldView> SphSim::fields() const {
+    // Each attribute array is read in place.
+    const uint32 count = particles.size();
+
+    vector<FieldView> result;
+    result.push_back(makeFieldView("x", particles.x.data(), count, 1, 1));
+    result.push_back(makeFieldView("y", particles.y.data(), count, 1, 1));
+    result.push_back(makeFieldView("vx", particles.vx.data(), count, 1, 1));
+    result.push_back(makeFieldView("vy", particles.vy.data(), count, 1, 1));
+    result.push_back(makeFieldView("density", particles.density.data(), count, 1, 1));
+    result.push_back(makeFieldView("pressure", particles.pressure.data(), count, 1, 1));
+
+    return result;
+}
+
 //----------------------------------------------------------------------------------------
 void SphSim::InitializeWalls() {
     walls.resize(kNumWalls);
 
     walls[0] = Wall(vec2(1,0), 0);
     walls[1] = Wall(vec2(0,1), 0);
-    walls[2] = Wall(vec2(-1,0), kViewWidth);
-    walls[3] = Wall(vec2(0,-1), kViewHeight);
+    walls[2] = Wall(vec2(-1,0), domainSize.x);
+    walls[3] = Wall(vec2(0,-1), domainSize.y);
 }
 
 //----------------------------------------------------------------------------------------
 void SphSim::InitializeParticles() {
-    particles.resize(kNumParticles, Particle());
+    particles.reserve(numParticles);
 
     const float32 dx = 2*kParticleRadius;
     const float32 dy = 2*kParticleRadius;
-    const float32 particlesPerRow = 30;
-    float32 x_start = kViewWidth / 6.0f;
+    float32 x_start = domainSize.x / 6.0f;
     float32 x = x_start;
-    float32 y = kViewHeight / 3.0f;
+    float32 y = domainSize.y / 3.0f;
+
+    // Rows of 30, widened if needed so that the rows fit below the top wall.
+    const uint32 numRows = uint32((domainSize.y - y) / dy) + 1;
+    const uint32 particlesPerRow = std::max(30u, (numParticles + numRows - 1) / numRows);
 
 //    srand(0);
 //    const int32 MAX_INIT_VELOCITY = 5;
 
-    Particle * p;
-    for(uint32 i=0, j=1; i < kNumParticles; ++i, ++j) {
-        p = &particles[i];
-        p->mass = kParticleMass;
-        p->position = vec2(x, y);
-        p->next = nullptr;
+    for(uint32 i=0, j=1; i < numParticles; ++i, ++j) {
+        particles.push_back(vec2(x, y));
 
         // Sudo-Random initial velocity
 //        float32 e = i*0.001f + j*0.002f;
 //        float32 vx_rand = rand() % MAX_INIT_VELOCITY + e;
 //        float32 vy_rand = rand() % MAX_INIT_VELOCITY - e;
-//        p->velocity = vec2(vx_rand, vy_rand);
+//        particles.setVelocity(i, vec2(vx_rand, vy_rand));
 
         x += dx;
 
@@ -90,273 +143,248 @@ void SphSim::InitializeParticles() {
 }
 
 //----------------------------------------------------------------------------------------
-// Returns grid cell coordinates for the location of the particle.
-static void ComputeGridCoordates(const Particle & p, GridCoord & outGridCoord) {
-    static const float32 one_over_kCellSize = 1.0f / kCellSize;
-
-    outGridCoord.col = p.position.x * one_over_kCellSize;
-    outGridCoord.row = p.position.y * one_over_kCellSize;
-}
-
-//----------------------------------------------------------------------------------------
+/**
+* Sorts particles by cell, so that the particles of each cell of cellIndex are
+* contiguous.  Invalidates neighbors, which hold particle indices.
+*/
 void SphSim::UpdateGrid() {
-    grid.clear();
-
-    GridCoord gridCoord;
-    for(Particle & p : particles) {
-        ComputeGridCoordates(p, gridCoord);
-        Particle * p_head = grid.at(gridCoord);
-
-        // Prevent p and p.next from referencing the same object.
-        if (p_head != &p) {
-            // Attach p to the beginning of the particle list at grid cell (x,y),
-            // while retaining other Particles in the list.
-            p.next = p_head;
-            grid.at(gridCoord) = &p;
-        }
-    }
+    cellIndex.build(particles.x.data(), particles.y.data(), numParticles, execution);
+    particles.permute(cellIndex.order().data(), sortScratch, execution);
 }
 
 //----------------------------------------------------------------------------------------
 /*
  * Apply gravity force to all particles.
  */
-void SphSim::ApplyBodyForces() {
-    for(Particle &p : particles) {
-        p.velocity.y -= 9.8f * kDt;
-    }
+void SphSim::ApplyBodyForces(float32 dt) {
+    // Computed once, so every particle gets the same rounded change however
+    // the loop is split and vectorized.
+    const float32 deltaVy = 9.8f * dt;
+
+    float32 * vy = particles.vy.data();
+    parallelFor(execution, 0, numParticles, [&] (uint32 begin, uint32 end) {
+        for(uint32 i = begin; i < end; ++i) {
+            vy[i] -= deltaVy;
+        }
+    });
 }
 
 //----------------------------------------------------------------------------------------
-void SphSim::AdvanceParticles() {
-    for(Particle &p : particles) {
-        // Constrain velocity to prevent unbound values.
-        {
-            p.velocity.x = (p.velocity.x > 0) ?
-		            std::min(p.velocity.x,kMaxVelocityComponent) :
-                    std::max(p.velocity.x, -kMaxVelocityComponent);
-
-            p.velocity.y = (p.velocity.y > 0) ?
-		            std::min(p.velocity.y, kMaxVelocityComponent) :
-					std::max(p.velocity.y, -kMaxVelocityComponent);
+void SphSim::AdvanceParticles(float32 dt) {
+    float32 * x = particles.x.data();
+    float32 * y = particles.y.data();
+    float32 * vx = particles.vx.data();
+    float32 * vy = particles.vy.data();
+
+    parallelFor(execution, 0, numParticles, [&] (uint32 begin, uint32 end) {
+        for(uint32 i = begin; i < end; ++i) {
+            // Constrain velocity to prevent unbound values.
+            vx[i] = std::min(std::max(vx[i], -kMaxVelocityComponent), kMaxVelocityComponent);
+            vy[i] = std::min(std::max(vy[i], -kMaxVelocityComponent), kMaxVelocityComponent);
+
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
         }
-
-        p.position.x += p.velocity.x * kDt;
-        p.position.y += p.velocity.y * kDt;
-    }
+    });
 }
 
 //----------------------------------------------------------------------------------------
 void SphSim::ResolveWallCollisions() {
-    for(Particle &p : particles) {
-        for(const Wall &wall : walls) {
-            vec2 n = wall.normal;
-            // Distance between particle and wall along wall's normal.
-            float32 distanceToWall = wall.d + dot(p.position, n);
-
-            if (distanceToWall < kParticleRadius) {
-                // Particle is intersecting wall.
-
-                // Move particle out of wall by projecting the particle's position
-                // along the wall's surface normal.
-                float32 overlap = kParticleRadius - distanceToWall;
-                p.position += overlap * n;
-
-                float32 relativeVelocity = dot(n, p.velocity);
-                if (relativeVelocity < 0.0f) {
-                    // Particle is approaching wall.
-                    p.velocity -= (1 + kCoefficientOfRestitution ) *
-                                  dot(p.velocity, n) * n;
+    parallelFor(execution, 0, numParticles, [&] (uint32 begin, uint32 end) {
+        for(uint32 i = begin; i < end; ++i) {
+            vec2 position = particles.position(i);
+            vec2 velocity = particles.velocity(i);
+
+            for(const Wall &wall : walls) {
+                vec2 n = wall.normal;
+                // Distance between particle and wall along wall's normal.
+                float32 distanceToWall = wall.d + dot(position, n);
+
+                if (distanceToWall < kParticleRadius) {
+                    // Particle is intersecting wall.
+
+                    // Move particle out of wall by projecting the particle's position
+                    // along the wall's surface normal.
+                    float32 overlap = kParticleRadius - distanceToWall;
+                    position += overlap * n;
+
+                    float32 relativeVelocity = dot(n, velocity);
+                    if (relativeVelocity < 0.0f) {
+                        // Particle is approaching wall.
+                        velocity -= (1 + kCoefficientOfRestitution ) *
+                                      dot(velocity, n) * n;
+                    }
                 }
             }
+
+            particles.setPosition(i, position);
+            particles.setVelocity(i, velocity);
         }
-    }
+    });
 }
 
 //----------------------------------------------------------------------------------------
 /**
-* Computes the grid coordinates for Particle p's current grid cell,
-* and all adjacent cells, and stores them in the array outNeighborGridCoords.
-*
-* Valid Grid Coords are placed in the front of outNeighborGridCoords with the Particle p's
-* current cell at outNeighborGridCoords[0].  The number of valid GridCoords are placed in
-* outNumValidGridCoords.
+* Returns true if neighbors has not been built for the current particles, or if
+* some particle has moved more than kNeighborSkin / 2 since it was, so that a
+* pair within kH may be missing from it.
 */
-void SphSim::ComputeNeighborGridCoords(const Particle & p,
-                                         GridCoord (& outNeighborGridCoords)[kGridCellNeighbors],
-                                         uint32 & outNumValidGridCoords) {
-    GridCoord gridCoord;
-    ComputeGridCoordates(p, gridCoord);
-
-    uint32 n = 0;
-
-    // Place p's coordinates first in array, so p's cell is check first for neighbors.
-    outNeighborGridCoords[n++] = gridCoord;
-
-    for(int32 row = gridCoord.row - 1; row <= gridCoord.row + 1; ++row) {
-        for(int32 col = gridCoord.col - 1; col <= gridCoord.col + 1; ++col) {
-            if(col == gridCoord.col && row == gridCoord.row)
-                continue;
+bool SphSim::NeighborListsExpired() const {
+    if (neighbors.size() != numParticles || neighborListX.size() != numParticles) {
+        return true;
+    }
 
-            if ( (col >= 0) && (col < kGridWidth) ) {
-                if ( (row >= 0) && (row < kGridHeight) ) {
-                    outNeighborGridCoords[n++] = GridCoord(col, row);
-                }
+    const float32 * x = particles.x.data();
+    const float32 * y = particles.y.data();
+    const float32 maxDisplacement2 = 0.25f * kNeighborSkin * kNeighborSkin;
+
+    // Any chunk may set the flag, so the result does not depend on the split.
+    std::atomic<uint32> expired(0);
+    parallelFor(execution, 0, numParticles, [&] (uint32 begin, uint32 end) {
+        for(uint32 i = begin; i < end; ++i) {
+            float32 dx = x[i] - neighborListX[i];
+            float32 dy = y[i] - neighborListY[i];
+            if (dx*dx + dy*dy > maxDisplacement2) {
+                expired.store(1, std::memory_order_relaxed);
+                return;
             }
         }
-    }
+    });
 
-    outNumValidGridCoords = n;
+    return expired.load() != 0;
 }
 
 //----------------------------------------------------------------------------------------
 /**
-* For each Particle, determines the neighbors within a distance kH and copies their data
-* into the \c neighbors array for fast lookup later.
-*
-* Neighbors are only considered that reside in the Particle's current cell, and all
-* adjacent cells.
+* For each particle, lists the indices of and distances to the other particles
+* within a distance kH + kNeighborSkin, for fast lookup later, after re-sorting
+* the particles with UpdateGrid().  While the lists are still valid, only their
+* distances are updated.
 */
 void SphSim::UpdateNeighbors() {
+    if (!NeighborListsExpired()) {
+        neighbors.updateDistances(particles.x.data(), particles.y.data(), execution);
+        return;
+    }
 
-    // TODO Dustin -  See if it's possible to sample from different grid cells
-    // uniformly, rather than getting all particles from a cell before moving to
-    // the next cell. This could help improve accuracy since only kGridCellNeighbors
-    // are used in density computation.
-    // 1. Enqueue each non-null Particle * of grid for each neighbor grid coord.
-    // 2. while(queue is not empty)
-    //      2a. Dequeue the next Particle *.
-    //      2b. Do computation using the Particle.
-    //      2c. If Particle->next is non-null, enqueue it.
-
-    GridCoord neighborGridCoords[kGridCellNeighbors];
-    uint32 numValidGridCoords;
-
-    for(uint32 p_index = 0; p_index < kNumParticles; ++p_index) {
-        Particle & pi = particles[p_index];
-
-        ComputeNeighborGridCoords(pi, neighborGridCoords, numValidGridCoords);
-
-        uint32 n_index = 0; // neighbor index
-
-        // Loop over all adjacent cells of Particle pi, including pi's own cell.
-        for(uint32 i = 0; i < numValidGridCoords; ++i) {
-            const GridCoord & gridCoord = neighborGridCoords[i];
-
-            // Loop over all particles within each grid cell.
-            for(Particle * pj = grid.at(gridCoord); // pj are neighbors to Particle pi.
-                pj != nullptr && n_index < kMaxNeighborParticles;
-                pj = pj->next) {
-
-                float32 dx = pi.position.x - pj->position.x;
-                float32 dy = pi.position.y - pj->position.y;
-                float32 r2 = dx*dx + dy*dy;
-
-                if (r2 > kH*kH || r2 < kEpsilon)
-                    continue;
-
-                // pj is within a distance kH of pi, so count it as a neighbor and store
-                // a copy of it for later retrieval.
-                neighbors[p_index].particles[n_index] = *pj;
-                neighbors[p_index].r[n_index] = std::sqrt(r2);
-                ++n_index;
-            }
-        }
+    UpdateGrid();
+    neighbors.build(cellIndex, particles.x.data(), particles.y.data(), numParticles,
+                    kH + kNeighborSkin, 0.0f, execution);
 
-        neighbors[p_index].numActiveNeighbors = n_index;
-    }
+    neighborListX.assign(particles.x.begin(), particles.x.begin() + numParticles);
+    neighborListY.assign(particles.y.begin(), particles.y.begin() + numParticles);
+    ++neighborListBuilds;
 }
 
 //----------------------------------------------------------------------------------------
 void SphSim::ComputeDensity() {
-    for(uint32 p_index = 0; p_index < kNumParticles; ++p_index) {
-        Particle & pi = particles[p_index];
-
-        pi.density = kMinDensity;
+    float32 * density = particles.density.data();
 
-        Neighbors neighborData = neighbors[p_index];
+    const float32 * distances = neighbors.distances();
 
-        for(uint32 n_index = 0; n_index < neighborData.numActiveNeighbors; ++n_index) {
-            Particle & pj = neighborData.particles[n_index];
-            float32 r = neighborData.r[n_index];
+    parallelFor(execution, 0, numParticles, [&] (uint32 begin, uint32 end) {
+        for(uint32 p_index = begin; p_index < end; ++p_index) {
+            float32 sum = kMinDensity;
+            const uint32 n_end = neighbors.end(p_index);
+            for(uint32 n_index = neighbors.begin(p_index); n_index < n_end; ++n_index) {
+                float32 r = distances[n_index];
+                if (r > kH || r < kMinNeighborDistance) {
+                    continue;
+                }
 
-            float32 value = (kH * kH) - (r * r);
+                float32 value = (kH * kH) - (r * r);
 
-            pi.density += pj.mass * kNormPoly6 * (value * value * value);
+                sum += kParticleMass * kNormPoly6 * (value * value * value);
+            }
 
+            density[p_index] = sum;
         }
-    }
+    });
 }
 
 //----------------------------------------------------------------------------------------
 void SphSim::ComputePressure() {
-    for(uint32 p_index = 0; p_index < kNumParticles; ++p_index) {
-        Particle & pi = particles[p_index];
-        pi.pressure = kStiffness * (pi.density - kRestDensity);
-    }
+    const float32 * density = particles.density.data();
+    float32 * pressure = particles.pressure.data();
+
+    parallelFor(execution, 0, numParticles, [&] (uint32 begin, uint32 end) {
+        for(uint32 p_index = begin; p_index < end; ++p_index) {
+            pressure[p_index] = kStiffness * (density[p_index] - kRestDensity);
+        }
+    });
 }
 
 //----------------------------------------------------------------------------------------
-void SphSim::ApplyInternalForces() {
-    for(uint32 p_index = 0; p_index < kNumParticles; ++p_index) {
-        Particle & pi = particles[p_index];
-
-        vec2 force_pressure(0.0f, 0.0f);
-        vec2 force_viscosity(0.0f, 0.0f);
+void SphSim::ApplyInternalForces(float32 dt) {
+    const float32 * x = particles.x.data();
+    const float32 * y = particles.y.data();
+    const float32 * vx = particles.vx.data();
+    const float32 * vy = particles.vy.data();
+    const float32 * density = particles.density.data();
+    const float32 * pressure = particles.pressure.data();
+    const uint32 * indices = neighbors.indices();
+    const float32 * distances = neighbors.distances();
+
+    // Every particle's forces are computed from the velocities at the start of
+    // the pass, so changes are accumulated in deltaV and applied afterwards.
+    // Each particle only writes its own entry, so particles can be processed
+    // concurrently without atomics, unlike a symmetric pairwise scatter.
+    deltaV.resize(numParticles);
+
+    parallelFor(execution, 0, numParticles, [&] (uint32 begin, uint32 end) {
+        for(uint32 p_index = begin; p_index < end; ++p_index) {
+            vec2 force_pressure(0.0f, 0.0f);
+            vec2 force_viscosity(0.0f, 0.0f);
+
+            const vec2 position_i(x[p_index], y[p_index]);
+            const vec2 velocity_i(vx[p_index], vy[p_index]);
+
+            const uint32 n_end = neighbors.end(p_index);
+            for(uint32 n_index = neighbors.begin(p_index); n_index < n_end; ++n_index) {
+                float32 r = distances[n_index];
+                if (r > kH || r < kMinNeighborDistance) {
+                    continue;
+                }
 
-        Neighbors neighborData = neighbors[p_index];
+                const uint32 j = indices[n_index];
+                vec2 r_dir = (position_i - vec2(x[j], y[j])) / r;
+                float32 a = (kH - r);
 
-        for(uint32 n_index = 0; n_index < neighborData.numActiveNeighbors; ++n_index) {
-            const Particle & pj = neighborData.particles[n_index];
+                force_pressure -= kParticleMass * (pressure[p_index] + pressure[j]) /
+                    (2 * density[j]) * (a * a) * r_dir;
 
-            float32 r = neighborData.r[n_index];
-            vec2 r_dir = (pi.position - pj.position) / r;
-            float32 a = (kH - r);
+                force_viscosity += kParticleMass * (vec2(vx[j], vy[j]) - velocity_i) /
+                    density[j] * a;
+            }
 
-            force_pressure -= pj.mass * (pi.pressure + pj.pressure) / (2 * pj.density) *
-                (a * a) * r_dir;
+            force_pressure *= kNormGradSpiky;
+            force_viscosity *= kNormViscosity * kDynamicViscosity;
 
-            force_viscosity += pj.mass * (pj.velocity - pi.velocity) / pj.density * a;
+            deltaV[p_index] = (force_pressure + force_viscosity) * dt / density[p_index];
         }
+    });
 
-        force_pressure *= kNormGradSpiky;
-        force_viscosity *= kNormViscosity * kDynamicViscosity;
-
-        pi.velocity += (force_pressure + force_viscosity) * kDt / pi.density;
-    }
+    parallelFor(execution, 0, numParticles, [&] (uint32 begin, uint32 end) {
+        for(uint32 p_index = begin; p_index < end; ++p_index) {
+            particles.vx[p_index] += deltaV[p_index].x;
+            particles.vy[p_index] += deltaV[p_index].y;
+        }
+    });
 }
 
 //----------------------------------------------------------------------------------------
-void SphSim::logic() {
-    ApplyBodyForces();
-    AdvanceParticles();
+void SphSim::step(float32 dt) {
+    ++steps;
+
+    ApplyBodyForces(dt);
+    AdvanceParticles(dt);
     ResolveWallCollisions();
-    UpdateGrid();
 
-    ComputeDensity();
     UpdateNeighbors();
-
+    ComputeDensity();
     ComputePressure();
 
-    ApplyInternalForces();
-    AdvanceParticles();
+    ApplyInternalForces(dt);
+    AdvanceParticles(dt);
     ResolveWallCollisions();
-    UpdateGrid();
-
-    sphGraphics.UpdateGL(particles);
-}
-
-//----------------------------------------------------------------------------------------
-void SphSim::draw() {
-    sphGraphics.draw();
-}
-
-//----------------------------------------------------------------------------------------
-void SphSim::keyInput(int key, int action, int mods) {
-
-}
-
-//----------------------------------------------------------------------------------------
-void SphSim::cleanup() {
-    cout << "Simulation Clean Up" << " ... Good Bye." << endl;
 }
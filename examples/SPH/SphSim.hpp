@@ -6,18 +6,25 @@
 
 #pragma once
 
-#include "SphGraphics.hpp"
-
-#include "Utils/GlfwOpenGlWindow.hpp"
 #include "FluidSim/NumericTypes.hpp"
 #include "FluidSim/Utils.hpp"
+#include "FluidSim/Simulation.hpp"
+#include "FluidSim/ParticleArrays.hpp"
+#include "FluidSim/ParticleCellIndex.hpp"
+#include "FluidSim/NeighborList.hpp"
+#include "FluidSim/Parallel.hpp"
 using FluidSim::PI;
+using FluidSim::Execution;
+using FluidSim::ParticleArrays;
+using FluidSim::ParticleCellIndex;
+using FluidSim::NeighborList;
 
 #include <glm/glm.hpp>
+using glm::vec2;
 using glm::vec3;
 
-#include <memory>
-using std::shared_ptr;
+#include <vector>
+using std::vector;
 
 #include <cmath>
 // using pow
@@ -35,13 +42,12 @@ const float32 kFrameRate = 100.0f;
 const float32 kDt = 1.0f / kFrameRate;
 const float32 kEpsilon = 0.000001f;
 
-const uint32 kMaxNeighborParticles = 64;
 const uint32 kNumWalls = 4;
 
 //----------------------------------------------------------------------------------------
 // Fluid Parameters
 //----------------------------------------------------------------------------------------
-const uint32 kNumParticles = 2500;
+const uint32 kNumParticles = 2500; // Default particle count.
 const float32 kParticleMass = 0.0036f;
 const float32 kParticleRadius = 0.04f;
 const float32 kMinDensity = 9.75f; // mass/volume
@@ -67,25 +73,17 @@ const float32 kNormViscosity = 10 / (3 * PI * pow(kH,2));
 // Normalization constants for gradient of smoothing kernels.
 const float32 kNormGradSpiky = -30 / (PI * pow(kH,5));
 
+// Neighbors closer than this have no direction between them and are skipped.
+const float32 kMinNeighborDistance = 0.001f; // sqrt(kEpsilon)
+
 //----------------------------------------------------------------------------------------
-// Grid Parameters
+// Neighbor Search Parameters
 //----------------------------------------------------------------------------------------
-const float32 kCellSize = kH;
-const uint32 kGridWidth = uint32(kViewWidth / kCellSize) + 1; // In units of kCellSize.
-const uint32 kGridHeight = uint32(kViewHeight / kCellSize) + 1; // In units of kCellSize.
-const uint32 kGridCellCount = kGridWidth * kGridHeight;
-const uint32 kGridCellNeighbors = 9;
-
+// Neighbor lists hold every pair within kH + kNeighborSkin, and are reused until
+// some particle has moved kNeighborSkin / 2 since they were built.
+const float32 kNeighborSkin = kH * 0.1f;
+const float32 kCellSize = kH + kNeighborSkin;
 
-struct Particle {
-    vec2 position;
-    vec2 velocity;
-    float32 mass;
-    float32 density;
-    float32 pressure;
-
-    Particle * next;
-};
 
 struct Wall {
     vec2 normal;
@@ -95,65 +93,31 @@ struct Wall {
     Wall(vec2 normal, float32 d) : normal(normal), d(d) { }
 };
 
-struct GridCoord {
-    GridCoord()
-        : col(0), row(0) { }
-
-    GridCoord(uint32 inCol, uint32 inRow)
-        : col(inCol), row(inRow) { }
-
-    uint32 col;
-    uint32 row;
-};
-
-struct Neighbors {
-    // The i-th element is the i-th Neighboring Particle.
-    Particle particles[kMaxNeighborParticles];
-
-    // The i-th element of r represents the distance between a target Particle and
-    // its i-th neighbor.
-    float32 r[kMaxNeighborParticles];
-
-    // Number of neighbors affecting a target Particle.
-    // These neighbors will be at the beginning of arrays \c particles and \c r.
-    uint32 numActiveNeighbors = 0;
-};
-
-/*
-* CellGrid is a 2D spatial data structure that is composed of axis aligned cells.  Each
-* cell is square and has side length equal to kCellSize.  The grid has dimension equal
-* to kGridWidth x kGridHeight.  Grid coordinates are oriented so that the bottom left
-* of the grid marks the cell (0,0), where as cell (x,y) is located x cells to the right,
-* and y cells up from cell (0,0).
-*/
-struct CellGrid {
-    CellGrid() {
-        for(Particle * & p : data) {
-            p = nullptr;
-        }
-    }
-
-    Particle * & at(uint32 col, uint32 row) {
-        return data[col + row * kGridWidth];
-    }
-
-    Particle * & at(const GridCoord & gridCoord) {
-        return at(gridCoord.col, gridCoord.row);
-    }
-
-    void clear() {
-        for(Particle * & p : data) {
-            p = nullptr;
-        }
-    }
-
-    Particle * data[kGridCellCount];
-    const uint32 numRows = kGridHeight;
-    const uint32 numColumns = kGridWidth;
-};
-
 /**
-* Smoothed Paticle Hydrodynamics (SPH) Simulation
+* Smoothed Paticle Hydrodynamics (SPH) Simulation, with no dependence on a window
+* or OpenGL context.  SphDemo renders it interactively, while the headless runner
+* steps it as fast as possible.  Its fields() are the x, y, vx, vy, density and
+* pressure arrays of its particles.
+*
+* Particles are stored as a ParticleArrays, so each pass only streams the
+* attributes it uses, and all particles have mass kParticleMass.
+*
+* Neighbors are kept in Verlet lists: a NeighborList of every pair within
+* kH + kNeighborSkin, however dense the fluid gets.  Until some particle has
+* moved more than half the skin since the lists were built, no pair can have
+* come within kH without being listed, so each step only updates the listed
+* distances, and the density and force passes skip pairs beyond kH.  Otherwise
+* particles are sorted by cell of a ParticleCellIndex with kCellSize cells
+* covering the domain, so neighbors are found in three contiguous ranges of
+* particles, one per row of the 3x3 cells around each particle, and the lists
+* are rebuilt.
+*
+* With Execution::Parallel, the default, every pass of a step, including the
+* sort and neighbor search, is split across FluidSim::ThreadPool::global(),
+* whose threads claim chunks of particles until none remain.  Each particle's
+* density, pressure and velocity change is gathered from its neighbors and
+* written only to its own entries, so no atomics are needed, and results are
+* identical to Execution::Serial.
 *
 * Coordinate System: origin at bottom left corner of screen with standard axis
 *       +y
@@ -161,42 +125,69 @@ struct CellGrid {
 *       |
 *        --> +x
 */
-class SphSim : public GlfwOpenGlWindow {
+class SphSim : public FluidSim::Simulation {
 
 public:
+    /// Simulates \c numParticles particles in a box with its lower left corner
+    /// at the origin, starting in a block of rows of at least 30.
+    explicit SphSim(uint32 numParticles = kNumParticles,
+                    const vec2 & domainSize = vec2(kViewWidth, kViewHeight));
+
     ~SphSim() { }
 
-    static std::shared_ptr<GlfwOpenGlWindow> getInstance();
+    virtual void init();
+    virtual void step(float32 dt);
+    virtual std::vector<FluidSim::FieldView> fields() const;
+
+    void setExecution(Execution execution);
 
-private:
-    SphSim(); // Singleton. Prevent direct construction.
+    Execution getExecution() const;
 
-    virtual void init();
-    virtual void logic();
-    virtual void draw();
-    virtual void keyInput(int key, int action, int mods);
-    virtual void cleanup();
+    const ParticleArrays & getParticles() const;
+
+    /// Number of calls to step() since init().
+    uint32 getSteps() const;
 
+    /// Number of steps since init() that rebuilt the neighbor lists, rather
+    /// than reusing them.  Relative to getSteps(), this is how often the
+    /// particles are sorted and searched for neighbors.
+    uint32 getNeighborListBuilds() const;
+
+private:
     void InitializeWalls();
     void InitializeParticles();
 
-    void ApplyBodyForces();
-    void AdvanceParticles();
+    void ApplyBodyForces(float32 dt);
+    void AdvanceParticles(float32 dt);
     void ResolveWallCollisions();
     void UpdateGrid();
+    bool NeighborListsExpired() const;
     void UpdateNeighbors();
     void ComputeDensity();
     void ComputePressure();
-    void ApplyInternalForces();
-    void ComputeNeighborGridCoords(const Particle & p,
-                                   GridCoord (& outNeighborGridCoords)[kGridCellNeighbors],
-                                   uint32 & outNumValidGridCoords);
+    void ApplyInternalForces(float32 dt);
 
-    SphGraphics sphGraphics;
-
-    vector<Particle> particles;
+    uint32 numParticles;
+    vec2 domainSize;
+    Execution execution;
+    ParticleArrays particles;
     vector<Wall> walls;
-    CellGrid grid;
-    Neighbors neighbors[kNumParticles];
+
+    ParticleCellIndex cellIndex;
+
+    // Holds the previous particle order after UpdateGrid().
+    ParticleArrays sortScratch;
+
+    // Particles within kH + kNeighborSkin of each particle when last built,
+    // valid until the next UpdateGrid(), and the particle positions then.
+    NeighborList neighbors;
+    vector<float32> neighborListX;
+    vector<float32> neighborListY;
+
+    uint32 steps;
+    uint32 neighborListBuilds;
+
+    // Velocity change of each particle from internal forces.
+    vector<vec2> deltaV;
 
 };
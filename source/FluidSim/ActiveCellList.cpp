@@ -0,0 +1,171 @@
+// ActiveCellList.cpp
+
+#include "ActiveCellList.hpp"
+
+#include <algorithm>
+
+using namespace FluidSim;
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+ActiveCellList::ActiveCellList()
+	: m_width(0),
+	  m_height(0),
+	  m_sorted(true)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+ActiveCellList::ActiveCellList(uint32 width, uint32 height)
+	: m_width(0),
+	  m_height(0),
+	  m_sorted(true)
+{
+	resize(width, height);
+}
+
+//---------------------------------------------------------------------------------------
+void ActiveCellList::resize(uint32 width, uint32 height) {
+	m_width = width;
+	m_height = height;
+	m_cells.clear();
+	m_slots.assign(size_t(width) * height, 0);
+	m_sorted = true;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ActiveCellList::width() const {
+	return m_width;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ActiveCellList::height() const {
+	return m_height;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ActiveCellList::size() const {
+	return uint32(m_cells.size());
+}
+
+//---------------------------------------------------------------------------------------
+bool ActiveCellList::empty() const {
+	return m_cells.empty();
+}
+
+//---------------------------------------------------------------------------------------
+void ActiveCellList::insert(uint32 col, uint32 row) {
+	uint32 index = row * m_width + col;
+	if (m_slots[index] != 0) {
+		return;
+	}
+
+	if (!m_cells.empty() && index < m_cells.back()) {
+		m_sorted = false;
+	}
+	m_cells.push_back(index);
+	m_slots[index] = uint32(m_cells.size());
+}
+
+//---------------------------------------------------------------------------------------
+void ActiveCellList::erase(uint32 col, uint32 row) {
+	uint32 index = row * m_width + col;
+	uint32 slot = m_slots[index];
+	if (slot == 0) {
+		return;
+	}
+
+	uint32 last = m_cells.back();
+	if (last != index) {
+		m_sorted = false;
+	}
+	m_cells[slot - 1] = last;
+	m_slots[last] = slot;
+
+	m_cells.pop_back();
+	m_slots[index] = 0;
+}
+
+//---------------------------------------------------------------------------------------
+bool ActiveCellList::contains(uint32 col, uint32 row) const {
+	return m_slots[row * m_width + col] != 0;
+}
+
+//---------------------------------------------------------------------------------------
+void ActiveCellList::clear() {
+	for (uint32 index : m_cells) {
+		m_slots[index] = 0;
+	}
+	m_cells.clear();
+	m_sorted = true;
+}
+
+//---------------------------------------------------------------------------------------
+void ActiveCellList::dilate(uint32 radius) {
+	if (radius == 0) {
+		return;
+	}
+
+	// Only the cells present before dilation are expanded.
+	const uint32 numCells = size();
+	for (uint32 i(0); i < numCells; ++i) {
+		uint32 col = m_cells[i] % m_width;
+		uint32 row = m_cells[i] / m_width;
+
+		uint32 colBegin = (col > radius) ? col - radius : 0;
+		uint32 rowBegin = (row > radius) ? row - radius : 0;
+		uint32 colEnd = std::min(col + radius + 1, m_width);
+		uint32 rowEnd = std::min(row + radius + 1, m_height);
+
+		for (uint32 j(rowBegin); j < rowEnd; ++j) {
+			for (uint32 k(colBegin); k < colEnd; ++k) {
+				insert(k, j);
+			}
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void ActiveCellList::sort() {
+	std::sort(m_cells.begin(), m_cells.end());
+
+	for (uint32 i(0); i < size(); ++i) {
+		m_slots[m_cells[i]] = i + 1;
+	}
+	m_sorted = true;
+}
+
+//---------------------------------------------------------------------------------------
+bool ActiveCellList::isSorted() const {
+	return m_sorted;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ActiveCellList::operator [] (uint32 i) const {
+	return m_cells[i];
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ActiveCellList::col(uint32 i) const {
+	return m_cells[i] % m_width;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ActiveCellList::row(uint32 i) const {
+	return m_cells[i] / m_width;
+}
+
+//---------------------------------------------------------------------------------------
+const uint32 * ActiveCellList::begin() const {
+	return m_cells.data();
+}
+
+//---------------------------------------------------------------------------------------
+const uint32 * ActiveCellList::end() const {
+	return m_cells.data() + m_cells.size();
+}
+
+} // end namespace FluidSim
@@ -0,0 +1,100 @@
+/**
+* ActiveCellList.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+
+#include <vector>
+
+namespace FluidSim {
+
+/**
+* Compact list of the active cells of a width x height grid, such as the fluid
+* cells of a mostly solid domain, or the cells that currently carry smoke.
+*
+* Cells are stored as row-major indices (row * width + col).  insert(), erase()
+* and contains() are O(1), so the list can be kept up to date incrementally
+* from step to step, and kernels that accept an ActiveCellList only visit the
+* listed cells.  erase() moves the last cell into the freed slot, so call
+* sort() after a batch of updates to restore row-major order for cache friendly
+* traversal.
+*/
+class ActiveCellList {
+public:
+    ActiveCellList();
+
+    ActiveCellList(uint32 width, uint32 height);
+
+    /// Empties the list and sets the size of the underlying grid.
+    void resize(uint32 width, uint32 height);
+
+    uint32 width() const;
+
+    uint32 height() const;
+
+    /// Number of active cells.
+    uint32 size() const;
+
+    bool empty() const;
+
+    /// Adds cell (col,row) if it is not already in the list.
+    void insert(uint32 col, uint32 row);
+
+    /// Removes cell (col,row) if it is in the list.
+    void erase(uint32 col, uint32 row);
+
+    bool contains(uint32 col, uint32 row) const;
+
+    /// Removes every cell, in time proportional to size().
+    void clear();
+
+    /// Adds every cell within \c radius cells (in both directions) of a cell
+    /// already in the list.
+    void dilate(uint32 radius);
+
+    /// Sorts the list into row-major order.
+    void sort();
+
+    /// True if the list is in row-major order, which holds after sort() and as
+    /// long as cells are only inserted in increasing order.
+    bool isSorted() const;
+
+    /// Row-major index of the i-th active cell.
+    uint32 operator [] (uint32 i) const;
+
+    uint32 col(uint32 i) const;
+
+    uint32 row(uint32 i) const;
+
+    const uint32 * begin() const;
+
+    const uint32 * end() const;
+
+    /// Calls \c func(row, colBegin, colEnd) for every run of consecutive cells
+    /// of one row among entries [begin, end) of the list.  Kernels iterate spans
+    /// rather than single cells to avoid decoding each index, and to reuse their
+    /// dense row loops.  For a sorted list, spans are visited in row-major order.
+    template <typename Func>
+    void forEachSpan(uint32 begin, uint32 end, Func && func) const;
+
+private:
+    uint32 m_width;
+    uint32 m_height;
+
+    // Row-major indices of the active cells.
+    std::vector<uint32> m_cells;
+
+    // For every cell of the grid, its position in m_cells plus one, or zero if
+    // the cell is not active.
+    std::vector<uint32> m_slots;
+
+    bool m_sorted;
+};
+
+} // end namespace FluidSim
+
+#include "ActiveCellList.inl"
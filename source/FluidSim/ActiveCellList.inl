@@ -0,0 +1,49 @@
+#include "ActiveCellList.hpp"
+
+#include <algorithm>
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+template <typename Func>
+void ActiveCellList::forEachSpan(uint32 begin, uint32 end, Func && func) const {
+    uint32 i = begin;
+    while (i < end) {
+        uint32 first = m_cells[i];
+        uint32 row = first / m_width;
+        uint32 colBegin = first - row * m_width;
+
+        // Longest run that stays within the row and the entry range.
+        uint32 length = std::min(m_width - colBegin, end - i);
+
+        if (m_sorted) {
+            // Indices are sorted and unique, so entry i + k - 1 continues the run
+            // exactly when it equals first + k - 1.  Whole rows are found in one
+            // step, otherwise binary search for the end of the run.
+            if (m_cells[i + length - 1] != first + length - 1) {
+                uint32 lo = 1;
+                uint32 hi = length;
+                while (lo + 1 < hi) {
+                    uint32 mid = (lo + hi) / 2;
+                    if (m_cells[i + mid - 1] == first + mid - 1) {
+                        lo = mid;
+                    } else {
+                        hi = mid;
+                    }
+                }
+                length = lo;
+            }
+        } else {
+            uint32 k = 1;
+            while (k < length && m_cells[i + k] == first + k) {
+                ++k;
+            }
+            length = k;
+        }
+
+        func(row, colBegin, colBegin + length);
+        i += length;
+    }
+}
+
+} // end namespace FluidSim
@@ -7,20 +7,204 @@
 #pragma once
 
 #include "Grid.hpp"
+#include "DoubleBufferedGrid.hpp"
 #include "StaggeredGrid.hpp"
+#include "Grid3.hpp"
+#include "StaggeredGrid3.hpp"
+#include "Parallel.hpp"
+#include "ActiveCellList.hpp"
+#include "Interp.hpp"
 
 namespace FluidSim {
 
 typedef double TimeStep;
 
-template<typename U, typename V>
+/**
+* Semi-Lagrangian advection of \c quantity through \c velocity over one time step.
+*
+* With Execution::Parallel, rows of \c quantity are split into tiles that are
+* advected concurrently on ThreadPool::global().  Results are bit-identical to
+* Execution::Serial.
+*
+* Allocates a temporary Grid on every call.  Per-frame code should prefer the
+* overloads below that write into a persistent destination.
+*
+* Any cell Layout may be used for \c quantity; the result does not depend on it.
+*
+* The 2D overloads sample the advected quantities through the interpolation
+* policy \c Interp, see Interp.hpp, e.g. advect<MonotoneCubicInterp>(...) for
+* sharper results than the default BilinearInterp.  Backtraces always sample
+* \c velocity bilinearly.
+*/
+template<typename Interp = BilinearInterp, typename U, typename V, typename Allocator, typename Layout>
+void advect(
+		Grid<V, Allocator, Layout> & quantity,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        Execution execution = Execution::Serial
+);
+
+/**
+* Semi-Lagrangian advection of \c quantity, writing the result into
+* \c destination, which must have the same GridSpec as \c quantity and must not
+* alias it.  No memory is allocated.
+*/
+template<typename Interp = BilinearInterp, typename U, typename V, typename Allocator, typename Layout>
+void advect(
+        const Grid<V, Allocator, Layout> & quantity,
+        Grid<V, Allocator, Layout> & destination,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        Execution execution = Execution::Serial
+);
+
+/**
+* Advects quantity.front() into quantity.back() and then swaps the buffers, so
+* that front() holds the advected field.  No memory is allocated.
+*/
+template<typename Interp = BilinearInterp, typename U, typename V>
+void advect(
+        DoubleBufferedGrid<V> & quantity,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        Execution execution = Execution::Serial
+);
+
+/**
+* Semi-Lagrangian advection of several co-located quantities through \c velocity.
+*
+* The backtrace is computed once per cell and reused to sample every grid in
+* \c quantities, writing the results to the matching grid in \c destinations.
+* All quantities and destinations must share the same GridSpec, otherwise a
+* FluidSim::Exception is thrown.  Destinations must not alias any of the sources.
+* No memory is allocated, so callers that keep their destination grids between
+* steps can simply swap them with the sources afterwards.
+*
+* Each destination receives exactly what advect(quantity, velocity, dt) would
+* have produced for its source.
+*/
+template<typename Interp = BilinearInterp, typename U, typename V>
+void advect(
+        const Grid<V> * const * quantities,
+        Grid<V> * const * destinations,
+        uint32 numQuantities,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        Execution execution = Execution::Serial
+);
+
+/**
+* Sparse advection that only visits the cells in \c cells, whose size must
+* match \c quantity.  Listed cells of \c destination receive exactly what the
+* dense overload computes; all other cells are left untouched.  Callers are
+* responsible for keeping the list a superset of the cells that can become
+* non-zero, e.g. by dilating it by the CFL distance before each step.
+*/
+template<typename Interp = BilinearInterp, typename U, typename V>
 void advect(
-		Grid<V> & quantity,
+        const Grid<V> & quantity,
+        Grid<V> & destination,
         const StaggeredGrid<U> & velocity,
-        TimeStep dt
+        TimeStep dt,
+        const ActiveCellList & cells,
+        Execution execution = Execution::Serial
+);
+
+/**
+* Sparse variant of the multi-quantity advect() above.
+*/
+template<typename Interp = BilinearInterp, typename U, typename V>
+void advect(
+        const Grid<V> * const * quantities,
+        Grid<V> * const * destinations,
+        uint32 numQuantities,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        const ActiveCellList & cells,
+        Execution execution = Execution::Serial
+);
+
+/**
+* MacCormack advection of \c quantity into \c destination, which is second
+* order accurate and so much less diffusive than advect().  It runs advect()
+* forward over \c dt into \c destination, then backward over -dt into
+* \c scratch, and adds half the difference between \c quantity and that round
+* trip as an error correction:
+*
+*     destination = forward + (quantity - backward) / 2
+*
+* The result is clamped to the range of the values bilinear() blended for the
+* forward step, which keeps the scheme stable and free of new extrema.  Both
+* passes sample through \c Interp, and monotoneCubic() stays within that
+* range too.
+*
+* All three grids must share a GridSpec, otherwise a FluidSim::Exception is
+* thrown, and none may alias another.  No memory is allocated.  Costs about
+* three times as much as advect(), as each cell is backtraced three times.
+*/
+template<typename Interp = BilinearInterp, typename U, typename V>
+void advectMacCormack(
+        const Grid<V> & quantity,
+        Grid<V> & destination,
+        Grid<V> & scratch,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        Execution execution = Execution::Serial
+);
+
+/**
+* Sparse, multi-quantity variant of advectMacCormack(), for the cells in
+* \c cells.  Under the same conditions as the sparse advect(), listed cells of
+* each destination receive exactly what the dense version computes, and all
+* other cells of the destinations are left untouched.  Each quantity needs its
+* own scratch grid.
+*/
+template<typename Interp = BilinearInterp, typename U, typename V>
+void advectMacCormack(
+        const Grid<V> * const * quantities,
+        Grid<V> * const * destinations,
+        Grid<V> * const * scratch,
+        uint32 numQuantities,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        const ActiveCellList & cells,
+        Execution execution = Execution::Serial
+);
+
+/**
+* Semi-Lagrangian advection of a 3D \c quantity through \c velocity, writing
+* the result into \c destination, which must have the same GridSpec3 as
+* \c quantity and must not alias it.  Backtraces use two stage Runge-Kutta
+* and trilinear() in single precision.  No memory is allocated.
+*
+* With Execution::Parallel, the rows of all layers are split into tiles that
+* are advected concurrently on ThreadPool::global().  Results are
+* bit-identical to Execution::Serial.
+*/
+template<typename U, typename V>
+void advect(
+        const Grid3<V> & quantity,
+        Grid3<V> & destination,
+        const StaggeredGrid3<U> & velocity,
+        TimeStep dt,
+        Execution execution = Execution::Serial
+);
+
+/**
+* 3D variant of the multi-quantity advect(), backtracing each cell once for all
+* \c numQuantities co-located grids.  Throws a FluidSim::Exception if the
+* GridSpec3s differ.
+*/
+template<typename U, typename V>
+void advect(
+        const Grid3<V> * const * quantities,
+        Grid3<V> * const * destinations,
+        uint32 numQuantities,
+        const StaggeredGrid3<U> & velocity,
+        TimeStep dt,
+        Execution execution = Execution::Serial
 );
 
 } // end namespace FluidSim
 
 #include "Advect.inl"
-
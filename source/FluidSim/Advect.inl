@@ -1,44 +1,437 @@
 #include "Advect.hpp"
 
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+
 using glm::dvec2;
 
 namespace FluidSim {
 
 //----------------------------------------------------------------------------------------
 /**
-* Semi-Lagrangian advection of \c quantity, based on \c velocityField.
+* Backtraces grid point (col,row) of \c q through \c velocity to the world
+* location of the particle that will end up there after time step \c dt, using
+* two stage Runge-Kutta.
+*/
+template<typename U, typename V, typename Allocator, typename Layout>
+static inline dvec2 backtrace (
+        const Grid<V, Allocator, Layout> & q,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        uint32 col,
+        uint32 row
+) {
+    dvec2 worldPos = q.getPosition(col,row);
+    dvec2 u = bilinear(velocity, worldPos);
+
+    dvec2 x_mid = worldPos - (0.5 * dt * u);
+    u = bilinear(velocity, x_mid);
+    return worldPos - (dt * u);
+}
+
+//----------------------------------------------------------------------------------------
+/**
+* Advects rows [rowBegin, rowEnd) of \c quantity, writing results into \c q_new.
+* Each output cell only reads \c velocity and \c quantity, so disjoint row ranges may
+* be processed concurrently.
+*/
+template<typename Interp, typename U, typename V, typename Allocator, typename Layout>
+static void advectRows (
+		const Grid<V, Allocator, Layout> & quantity,
+        Grid<V, Allocator, Layout> & q_new,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        uint32 rowBegin,
+        uint32 rowEnd
+) {
+    const Grid<V, Allocator, Layout> & q = quantity;
+
+    for (uint32 row(rowBegin); row < rowEnd; ++row) {
+        for (uint32 col(0); col < q.width(); ++col) {
+            // World location of the particle that will be at grid point (col,row)
+            // in dt time.
+            dvec2 x_p = backtrace(q, velocity, dt, col, row);
+
+            q_new(col, row) = Interp::sample(q, x_p);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+/**
+* Same as advectRows, but reuses each backtraced position to sample all
+* \c numQuantities co-located grids.
+*/
+template<typename Interp, typename U, typename V>
+static void advectRows (
+        const Grid<V> * const * quantities,
+        Grid<V> * const * destinations,
+        uint32 numQuantities,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        uint32 rowBegin,
+        uint32 rowEnd
+) {
+    const Grid<V> & q = *quantities[0];
+
+    for (uint32 row(rowBegin); row < rowEnd; ++row) {
+        for (uint32 col(0); col < q.width(); ++col) {
+            dvec2 x_p = backtrace(q, velocity, dt, col, row);
+
+            for (uint32 k(0); k < numQuantities; ++k) {
+                (*destinations[k])(col, row) = Interp::sample(*quantities[k], x_p);
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+/**
+* Advects entries [begin, end) of \c cells, writing results for
+* \c numQuantities co-located grids.  Each listed cell receives exactly what
+* advectRows would have written to it.
+*/
+template<typename Interp, typename U, typename V>
+static void advectCells (
+        const Grid<V> * const * quantities,
+        Grid<V> * const * destinations,
+        uint32 numQuantities,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        const ActiveCellList & cells,
+        uint32 begin,
+        uint32 end
+) {
+    const Grid<V> & q = *quantities[0];
+
+    cells.forEachSpan(begin, end, [&] (uint32 row, uint32 colBegin, uint32 colEnd) {
+        for (uint32 col(colBegin); col < colEnd; ++col) {
+            dvec2 x_p = backtrace(q, velocity, dt, col, row);
+
+            for (uint32 k(0); k < numQuantities; ++k) {
+                (*destinations[k])(col, row) = Interp::sample(*quantities[k], x_p);
+            }
+        }
+    });
+}
+
+//----------------------------------------------------------------------------------------
+/**
+* MacCormack correction of cell (col,row) of \c numQuantities co-located
+* grids.  \c destinations hold the forward and \c scratch the backward
+* semi-Lagrangian results, and the corrected value is limited to the samples
+* the forward step blended.
 */
 template<typename U, typename V>
-void advect (
-		Grid<V> & quantity,
+static inline void correctCell (
+        const Grid<V> * const * quantities,
+        Grid<V> * const * destinations,
+        Grid<V> * const * scratch,
+        uint32 numQuantities,
         const StaggeredGrid<U> & velocity,
-        TimeStep dt
+        TimeStep dt,
+        uint32 col,
+        uint32 row
+) {
+    dvec2 x_p = backtrace(*quantities[0], velocity, dt, col, row);
+
+    V minValue, maxValue;
+    for (uint32 k(0); k < numQuantities; ++k) {
+        const Grid<V> & q = *quantities[k];
+        V & forward = (*destinations[k])(col, row);
+        V corrected = forward + V(0.5) * (q(col, row) - (*scratch[k])(col, row));
+
+        bilinearMinMax(q, vec2(x_p), minValue, maxValue);
+        forward = std::max(minValue, std::min(corrected, maxValue));
+    }
+}
+
+//----------------------------------------------------------------------------------------
+/**
+* 3D counterpart of backtrace(), for grid point (col,row,layer) of \c q.
+*/
+template<typename U, typename V>
+static inline vec3 backtrace (
+        const Grid3<V> & q,
+        const StaggeredGrid3<U> & velocity,
+        float32 dt,
+        uint32 col,
+        uint32 row,
+        uint32 layer
 ) {
-    Grid<V> & q = quantity;
+    vec3 worldPos = q.getPosition(col,row,layer);
+    vec3 u = trilinear(velocity, worldPos);
 
-    dvec2 worldPos; // World location within grid to be updated.
-    dvec2 x_p; // World location of the particle that will be at worldPos in dt time.
-    dvec2 x_mid; // Temporary
-    dvec2 u; // Velocity at a given world position.
-    Grid<V> q_new = quantity; // Deep copy.
+    vec3 x_mid = worldPos - (0.5f * dt * u);
+    u = trilinear(velocity, x_mid);
+    return worldPos - (dt * u);
+}
+
+//----------------------------------------------------------------------------------------
+/**
+* Advects rows [rowBegin, rowEnd) of \c numQuantities co-located 3D grids,
+* where rows are numbered layer by layer, row + layer * height.
+*/
+template<typename U, typename V>
+static void advectRows (
+        const Grid3<V> * const * quantities,
+        Grid3<V> * const * destinations,
+        uint32 numQuantities,
+        const StaggeredGrid3<U> & velocity,
+        TimeStep dt,
+        uint32 rowBegin,
+        uint32 rowEnd
+) {
+    const Grid3<V> & q = *quantities[0];
+    const float32 dt_f = float32(dt);
+
+    for (uint32 r(rowBegin); r < rowEnd; ++r) {
+        const uint32 row = r % q.height();
+        const uint32 layer = r / q.height();
 
-    for (uint32 row(0); row < q.height(); ++row) {
         for (uint32 col(0); col < q.width(); ++col) {
-            worldPos = q.getPosition(col,row);
-            u = bilinear(velocity, worldPos);
+            vec3 x_p = backtrace(q, velocity, dt_f, col, row, layer);
 
-            // Backtrace to particle location that will end up at worldPos at the next
-            // time step dt.
-            // Two stage Runge-Kutta:
-            x_mid = worldPos - (0.5 * dt * u);
-            u = bilinear(velocity, x_mid);
-            x_p = worldPos - (dt * u);
+            for (uint32 k(0); k < numQuantities; ++k) {
+                (*destinations[k])(col, row, layer) = trilinear(*quantities[k], x_p);
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------
+/**
+* Semi-Lagrangian advection of \c quantity, based on \c velocityField.
+*/
+template<typename Interp, typename U, typename V, typename Allocator, typename Layout>
+void advect (
+		Grid<V, Allocator, Layout> & quantity,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        Execution execution
+) {
+    // Every cell is overwritten, so there is no need to copy quantity first.
+    Grid<V, Allocator, Layout> q_new(quantity.gridSpec(), quantity.layout());
+
+    advect<Interp>(quantity, q_new, velocity, dt, execution);
+
+    quantity = std::move(q_new);
+}
+
+//----------------------------------------------------------------------------------------
+template<typename Interp, typename U, typename V, typename Allocator, typename Layout>
+void advect (
+        const Grid<V, Allocator, Layout> & quantity,
+        Grid<V, Allocator, Layout> & destination,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        Execution execution
+) {
+    if (quantity.gridSpec() != destination.gridSpec()) {
+        throw FluidSim::Exception("GridSpecs do not match.");
+    }
+
+    parallelFor(execution, 0, quantity.height(), [&] (uint32 rowBegin, uint32 rowEnd) {
+        advectRows<Interp>(quantity, destination, velocity, dt, rowBegin, rowEnd);
+    });
+}
+
+//----------------------------------------------------------------------------------------
+template<typename Interp, typename U, typename V>
+void advect (
+        DoubleBufferedGrid<V> & quantity,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        Execution execution
+) {
+    advect<Interp>(quantity.front(), quantity.back(), velocity, dt, execution);
+    quantity.swap();
+}
+
+//----------------------------------------------------------------------------------------
+template<typename Interp, typename U, typename V>
+void advect (
+        const Grid<V> * const * quantities,
+        Grid<V> * const * destinations,
+        uint32 numQuantities,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        Execution execution
+) {
+    if (numQuantities == 0) {
+        return;
+    }
+
+    const GridSpec spec = quantities[0]->gridSpec();
+    for (uint32 k(0); k < numQuantities; ++k) {
+        if (quantities[k]->gridSpec() != spec || destinations[k]->gridSpec() != spec) {
+            throw FluidSim::Exception("GridSpecs do not match.");
+        }
+    }
+
+    parallelFor(execution, 0, spec.height, [&] (uint32 rowBegin, uint32 rowEnd) {
+        advectRows<Interp>(quantities, destinations, numQuantities, velocity, dt,
+                rowBegin, rowEnd);
+    });
+}
+
+//----------------------------------------------------------------------------------------
+template<typename Interp, typename U, typename V>
+void advect (
+        const Grid<V> & quantity,
+        Grid<V> & destination,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        const ActiveCellList & cells,
+        Execution execution
+) {
+    const Grid<V> * quantities[] = { &quantity };
+    Grid<V> * destinations[] = { &destination };
+
+    advect<Interp>(quantities, destinations, 1, velocity, dt, cells, execution);
+}
+
+//----------------------------------------------------------------------------------------
+template<typename Interp, typename U, typename V>
+void advect (
+        const Grid<V> * const * quantities,
+        Grid<V> * const * destinations,
+        uint32 numQuantities,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        const ActiveCellList & cells,
+        Execution execution
+) {
+    if (numQuantities == 0) {
+        return;
+    }
+
+    const GridSpec spec = quantities[0]->gridSpec();
+    for (uint32 k(0); k < numQuantities; ++k) {
+        if (quantities[k]->gridSpec() != spec || destinations[k]->gridSpec() != spec) {
+            throw FluidSim::Exception("GridSpecs do not match.");
+        }
+    }
+    if (cells.width() != spec.width || cells.height() != spec.height) {
+        throw FluidSim::Exception("ActiveCellList does not match GridSpec.");
+    }
+
+    parallelFor(execution, 0, cells.size(), [&] (uint32 begin, uint32 end) {
+        advectCells<Interp>(quantities, destinations, numQuantities, velocity, dt,
+                cells, begin, end);
+    });
+}
+
+//----------------------------------------------------------------------------------------
+template<typename Interp, typename U, typename V>
+void advectMacCormack (
+        const Grid<V> & quantity,
+        Grid<V> & destination,
+        Grid<V> & scratch,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        Execution execution
+) {
+    if (scratch.gridSpec() != quantity.gridSpec()) {
+        throw FluidSim::Exception("GridSpecs do not match.");
+    }
+
+    advect<Interp>(quantity, destination, velocity, dt, execution);
+    advect<Interp>(destination, scratch, velocity, -dt, execution);
+
+    const Grid<V> * quantities[] = { &quantity };
+    Grid<V> * destinations[] = { &destination };
+    Grid<V> * scratches[] = { &scratch };
+
+    parallelFor(execution, 0, quantity.height(), [&] (uint32 rowBegin, uint32 rowEnd) {
+        for (uint32 row(rowBegin); row < rowEnd; ++row) {
+            for (uint32 col(0); col < quantity.width(); ++col) {
+                correctCell(quantities, destinations, scratches, 1, velocity, dt,
+                        col, row);
+            }
+        }
+    });
+}
+
+//----------------------------------------------------------------------------------------
+template<typename Interp, typename U, typename V>
+void advectMacCormack (
+        const Grid<V> * const * quantities,
+        Grid<V> * const * destinations,
+        Grid<V> * const * scratch,
+        uint32 numQuantities,
+        const StaggeredGrid<U> & velocity,
+        TimeStep dt,
+        const ActiveCellList & cells,
+        Execution execution
+) {
+    if (numQuantities == 0) {
+        return;
+    }
+    for (uint32 k(0); k < numQuantities; ++k) {
+        if (scratch[k]->gridSpec() != quantities[0]->gridSpec()) {
+            throw FluidSim::Exception("GridSpecs do not match.");
+        }
+    }
+
+    // Forward into destinations, then backward from destinations into scratch.
+    advect<Interp>(quantities, destinations, numQuantities, velocity, dt, cells,
+            execution);
+    advect<Interp>(const_cast<const Grid<V> * const *>(destinations), scratch,
+            numQuantities, velocity, -dt, cells, execution);
+
+    parallelFor(execution, 0, cells.size(), [&] (uint32 begin, uint32 end) {
+        cells.forEachSpan(begin, end, [&] (uint32 row, uint32 colBegin, uint32 colEnd) {
+            for (uint32 col(colBegin); col < colEnd; ++col) {
+                correctCell(quantities, destinations, scratch, numQuantities,
+                        velocity, dt, col, row);
+            }
+        });
+    });
+}
+
+//----------------------------------------------------------------------------------------
+template<typename U, typename V>
+void advect (
+        const Grid3<V> & quantity,
+        Grid3<V> & destination,
+        const StaggeredGrid3<U> & velocity,
+        TimeStep dt,
+        Execution execution
+) {
+    const Grid3<V> * quantities[] = { &quantity };
+    Grid3<V> * destinations[] = { &destination };
+
+    advect(quantities, destinations, 1, velocity, dt, execution);
+}
+
+//----------------------------------------------------------------------------------------
+template<typename U, typename V>
+void advect (
+        const Grid3<V> * const * quantities,
+        Grid3<V> * const * destinations,
+        uint32 numQuantities,
+        const StaggeredGrid3<U> & velocity,
+        TimeStep dt,
+        Execution execution
+) {
+    if (numQuantities == 0) {
+        return;
+    }
 
-            q_new(col, row) = bilinear(q, x_p);
+    const GridSpec3 spec = quantities[0]->gridSpec();
+    for (uint32 k(0); k < numQuantities; ++k) {
+        if (quantities[k]->gridSpec() != spec || destinations[k]->gridSpec() != spec) {
+            throw FluidSim::Exception("GridSpecs do not match.");
         }
     }
 
-    q = std::move(q_new);
+    parallelFor(execution, 0, spec.height * spec.depth,
+            [&] (uint32 rowBegin, uint32 rowEnd) {
+        advectRows(quantities, destinations, numQuantities, velocity, dt,
+                rowBegin, rowEnd);
+    });
 }
 
 } // end namespace FluidSim
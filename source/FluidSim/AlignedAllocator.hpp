@@ -0,0 +1,60 @@
+/**
+* AlignedAllocator.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+
+#include <cstddef>
+
+namespace FluidSim {
+
+/// Alignment, in bytes, of Grid storage and of padded Grid rows.
+const uint32 kCacheLineSize = 64;
+
+/**
+* Standard allocator returning storage aligned to \c Alignment bytes, which must
+* be a power of two.  This is the default allocator of Grid, so that grid rows
+* start on cache line boundaries and SIMD kernels may use aligned loads.
+*
+* Custom allocators, e.g. for huge pages or NUMA-local memory, only need to
+* provide the same allocate() and deallocate() members.
+*/
+template <typename T, uint32 Alignment = kCacheLineSize>
+class AlignedAllocator {
+public:
+    static_assert((Alignment & (Alignment - 1)) == 0,
+            "Alignment must be a power of two.");
+
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator();
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> & other);
+
+    /// Returns uninitialized storage for \c n objects of type T.
+    T * allocate(size_t n);
+
+    void deallocate(T * p, size_t n);
+};
+
+template <typename T, typename U, uint32 Alignment>
+bool operator == (const AlignedAllocator<T, Alignment> &,
+                  const AlignedAllocator<U, Alignment> &);
+
+template <typename T, typename U, uint32 Alignment>
+bool operator != (const AlignedAllocator<T, Alignment> &,
+                  const AlignedAllocator<U, Alignment> &);
+
+} // end namespace FluidSim
+
+#include "AlignedAllocator.inl"
@@ -0,0 +1,60 @@
+#include "AlignedAllocator.hpp"
+
+#include <cstdint>
+#include <new>
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+template <typename T, uint32 Alignment>
+AlignedAllocator<T, Alignment>::AlignedAllocator() {
+
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, uint32 Alignment>
+template <typename U>
+AlignedAllocator<T, Alignment>::AlignedAllocator(const AlignedAllocator<U, Alignment> &) {
+
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, uint32 Alignment>
+T * AlignedAllocator<T, Alignment>::allocate(size_t n) {
+    // Over-allocate, and keep the pointer returned by operator new just in front
+    // of the aligned block so that deallocate() can recover it.
+    size_t bytes = n * sizeof(T) + Alignment - 1 + sizeof(void *);
+    void * raw = ::operator new(bytes);
+
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void *);
+    uintptr_t aligned = (start + Alignment - 1) & ~uintptr_t(Alignment - 1);
+    reinterpret_cast<void **>(aligned)[-1] = raw;
+
+    return reinterpret_cast<T *>(aligned);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, uint32 Alignment>
+void AlignedAllocator<T, Alignment>::deallocate(T * p, size_t) {
+    if (p != nullptr) {
+        ::operator delete(reinterpret_cast<void **>(p)[-1]);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename U, uint32 Alignment>
+bool operator == (const AlignedAllocator<T, Alignment> &,
+                  const AlignedAllocator<U, Alignment> &)
+{
+    return true;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename U, uint32 Alignment>
+bool operator != (const AlignedAllocator<T, Alignment> &,
+                  const AlignedAllocator<U, Alignment> &)
+{
+    return false;
+}
+
+} // end namespace FluidSim
@@ -0,0 +1,96 @@
+/**
+* AsyncSimulation.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Simulation.hpp"
+#include "FluidSim/FrameQueue.hpp"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FluidSim {
+
+/**
+* Steps a Simulation on its own thread, so that simulating the next frame
+* overlaps rendering the current one.
+*
+* After each step the simulation thread copies whatever the renderer needs
+* into a Frame of a FrameQueue, using the SnapshotFunc, and the render thread
+* picks up the newest Frame with beginReadLatest().  The simulation thread
+* then steps once more, and waits before the following step until the renderer
+* has taken that Frame.  So it computes one frame ahead while the renderer draws,
+* and takes one step per frame drawn rather than running faster than the display.
+*
+* While running, the Simulation must only be touched from the simulation
+* thread; use post() to change its settings from the render thread.
+*/
+template <typename Frame>
+class AsyncSimulation {
+public:
+    typedef std::function<void (const Simulation &, Frame &)> SnapshotFunc;
+    typedef std::function<void (Simulation &)> Command;
+
+    AsyncSimulation(Simulation & simulation, const SnapshotFunc & snapshot,
+            uint32 queueCapacity = 3);
+
+    /// Calls stop().
+    ~AsyncSimulation();
+
+    AsyncSimulation(const AsyncSimulation &) = delete;
+    AsyncSimulation & operator = (const AsyncSimulation &) = delete;
+
+    /// Starts stepping the simulation by \c dt seconds per frame.  Does
+    /// nothing if already running.
+    void start(float32 dt);
+
+    /// Waits for the step in flight, if any, then joins the simulation thread.
+    /// Commands still pending are run before returning.
+    void stop();
+
+    bool isRunning() const;
+
+    /// Runs \c command on the simulation thread before its next step, or
+    /// immediately if not running.
+    void post(const Command & command);
+
+    /// Newest simulated Frame, or nullptr if none was completed since the last
+    /// call.  The Frame stays valid until endRead().  Rethrows any exception
+    /// thrown by the simulation thread, which stops it.
+    const Frame * beginReadLatest();
+
+    void endRead();
+
+    /// Steps completed since construction.
+    uint64 stepsCompleted() const;
+
+private:
+    void run(float32 dt);
+    void runCommands();
+
+    Simulation & m_simulation;
+    SnapshotFunc m_snapshot;
+    FrameQueue<Frame> m_frames;
+
+    std::thread m_thread;
+    std::atomic<bool> m_stopRequested;
+    std::atomic<uint64> m_stepsCompleted;
+
+    // Guards m_commands and m_error.
+    std::mutex m_mutex;
+    std::vector<Command> m_commands;
+    std::exception_ptr m_error;
+    std::atomic<bool> m_failed;
+};
+
+} // end namespace FluidSim
+
+#include "AsyncSimulation.inl"
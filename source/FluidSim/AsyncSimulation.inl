@@ -0,0 +1,144 @@
+#include "AsyncSimulation.hpp"
+
+#include <chrono>
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+AsyncSimulation<Frame>::AsyncSimulation(
+        Simulation & simulation,
+        const SnapshotFunc & snapshot,
+        uint32 queueCapacity
+)
+    : m_simulation(simulation),
+      m_snapshot(snapshot),
+      m_frames(queueCapacity),
+      m_thread(),
+      m_stopRequested(false),
+      m_stepsCompleted(0),
+      m_failed(false)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+AsyncSimulation<Frame>::~AsyncSimulation() {
+    stop();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+void AsyncSimulation<Frame>::start(float32 dt) {
+    if (m_thread.joinable()) {
+        return;
+    }
+
+    m_stopRequested = false;
+    m_thread = std::thread(&AsyncSimulation<Frame>::run, this, dt);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+void AsyncSimulation<Frame>::stop() {
+    if (m_thread.joinable()) {
+        m_stopRequested = true;
+        m_thread.join();
+    }
+    runCommands();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+bool AsyncSimulation<Frame>::isRunning() const {
+    return m_thread.joinable() && !m_failed;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+void AsyncSimulation<Frame>::post(const Command & command) {
+    if (!m_thread.joinable()) {
+        command(m_simulation);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_commands.push_back(command);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+const Frame * AsyncSimulation<Frame>::beginReadLatest() {
+    if (m_failed) {
+        stop();
+        m_failed = false;
+
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(error, m_error);
+        }
+        std::rethrow_exception(error);
+    }
+
+    return m_frames.beginReadLatest();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+void AsyncSimulation<Frame>::endRead() {
+    m_frames.endRead();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+uint64 AsyncSimulation<Frame>::stepsCompleted() const {
+    return m_stepsCompleted;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+void AsyncSimulation<Frame>::runCommands() {
+    std::vector<Command> commands;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        commands.swap(m_commands);
+    }
+
+    for (const Command & command : commands) {
+        command(m_simulation);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+void AsyncSimulation<Frame>::run(float32 dt) {
+    try {
+        while (!m_stopRequested) {
+            // Step no further ahead than the Frame the renderer has yet to
+            // take, so the simulation runs at the rate frames are drawn.
+            Frame * frame = nullptr;
+            if (m_frames.unreadFrames() == 0) {
+                frame = m_frames.beginWrite();
+            }
+            if (frame == nullptr) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+
+            runCommands();
+            m_simulation.step(dt);
+            m_snapshot(m_simulation, *frame);
+
+            m_frames.endWrite();
+            ++m_stepsCompleted;
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_error = std::current_exception();
+        m_failed = true;
+    }
+}
+
+} // end namespace FluidSim
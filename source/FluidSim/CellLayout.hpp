@@ -0,0 +1,121 @@
+/**
+* CellLayout.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+
+#include <cstddef>
+
+namespace FluidSim {
+
+/*
+* Cell layouts decide where in memory a Grid keeps each of its cells, and are
+* passed to Grid as its Layout template parameter.  Every layout provides:
+*
+*   size_t setup(width, height, border, alignRows, elementSize)
+*       Prepares indexing of a width x height grid with \c border extra cells on
+*       each side, and returns the number of elements to allocate.
+*
+*   size_t first() const
+*       Index of cell (0,0) within the allocation.
+*
+*   std::ptrdiff_t offset(int32 col, int32 row) const
+*       Element offset of cell (col,row) from cell (0,0).  Border cells have
+*       coordinates in [-border, 0) and [width, width + border).
+*
+* Grid semantics are identical for every layout, only memory order differs.
+*/
+
+/**
+* Rows stored one after another, so that cell (col,row) is at
+* row * pitch() + col from cell (0,0).  This is the default layout of Grid, and
+* the only one that raw row kernels such as the batched bilinear() accept.
+*/
+class RowMajorLayout {
+public:
+    RowMajorLayout();
+
+    size_t setup(uint32 width, uint32 height, uint32 border, bool alignRows,
+            size_t elementSize);
+
+    size_t first() const;
+
+    std::ptrdiff_t offset(int32 col, int32 row) const;
+
+    /// Number of elements between the starts of consecutive rows.
+    uint32 pitch() const;
+
+private:
+    uint32 m_pitch;
+    size_t m_first;
+};
+
+/**
+* Square bricks of 2^Log2BrickSize cells on a side, each stored contiguously in
+* row-major order, with the bricks themselves in row-major order.  Vertical
+* neighbors are at most one brick apart, rather than a full grid row, so
+* random access with short range locality, such as semi-Lagrangian
+* backtraces, touches far fewer cache lines and pages on large grids.
+*
+* The grid is padded up to whole bricks.  GridLayout::alignRows is ignored,
+* since a brick of 64 floats already spans whole cache lines.
+*/
+template <uint32 Log2BrickSize = 3>
+class BrickedLayout {
+public:
+    static const uint32 kBrickSize = 1u << Log2BrickSize;
+
+    BrickedLayout();
+
+    size_t setup(uint32 width, uint32 height, uint32 border, bool alignRows,
+            size_t elementSize);
+
+    size_t first() const;
+
+    std::ptrdiff_t offset(int32 col, int32 row) const;
+
+private:
+    uint32 m_border;
+    uint32 m_bricksPerRow;
+    std::ptrdiff_t m_first;
+
+    /// Index of cell (x,y), counted from the lower left border cell.
+    std::ptrdiff_t index(uint32 x, uint32 y) const;
+};
+
+/**
+* Z-order (Morton) curve, which keeps every aligned 2^k x 2^k square of cells
+* contiguous at all scales k.
+*
+* Both extents, border included, are rounded up to powers of two.  Square
+* power of two grids need no padding, but e.g. a 4096x4097 staggered face grid
+* occupies 8192x4096 elements.  GridLayout::alignRows is ignored.
+*/
+class ZOrderLayout {
+public:
+    ZOrderLayout();
+
+    size_t setup(uint32 width, uint32 height, uint32 border, bool alignRows,
+            size_t elementSize);
+
+    size_t first() const;
+
+    std::ptrdiff_t offset(int32 col, int32 row) const;
+
+private:
+    uint32 m_border;
+    uint32 m_log2Square; // Log2 of the side of the Z-ordered squares.
+    uint32 m_squareMask;
+    std::ptrdiff_t m_first;
+
+    /// Index of cell (x,y), counted from the lower left border cell.
+    std::ptrdiff_t index(uint32 x, uint32 y) const;
+};
+
+} // end namespace FluidSim
+
+#include "CellLayout.inl"
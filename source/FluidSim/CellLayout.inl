@@ -0,0 +1,188 @@
+#include "CellLayout.hpp"
+
+#include "FluidSim/AlignedAllocator.hpp"
+
+#include <algorithm>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+// Spreads the low 16 bits of x over the even bits of the result.
+inline uint32 spreadBits(uint32 x) {
+#if defined(__BMI2__)
+    return _pdep_u32(x, 0x55555555u);
+#else
+    x &= 0x0000ffffu;
+    x = (x | (x << 8)) & 0x00ff00ffu;
+    x = (x | (x << 4)) & 0x0f0f0f0fu;
+    x = (x | (x << 2)) & 0x33333333u;
+    x = (x | (x << 1)) & 0x55555555u;
+    return x;
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+// Smallest k such that 2^k >= x.
+inline uint32 log2Ceil(uint32 x) {
+    uint32 k = 0;
+    while ((uint64(1) << k) < x) {
+        ++k;
+    }
+    return k;
+}
+
+//---------------------------------------------------------------------------------------
+inline RowMajorLayout::RowMajorLayout()
+    : m_pitch(0),
+      m_first(0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+inline size_t RowMajorLayout::setup(
+        uint32 width,
+        uint32 height,
+        uint32 border,
+        bool alignRows,
+        size_t elementSize
+) {
+    uint32 lead = border; // Elements in front of cell (0,row).
+    m_pitch = width + 2 * border;
+
+    if (alignRows) {
+        // Smallest number of elements that spans a whole number of cache lines.
+        uint32 step = kCacheLineSize;
+        while (step % elementSize != 0) {
+            step += kCacheLineSize;
+        }
+        step /= uint32(elementSize);
+
+        lead = (border + step - 1) / step * step;
+        m_pitch = (lead + width + border + step - 1) / step * step;
+    }
+
+    m_first = size_t(border) * m_pitch + lead;
+
+    return size_t(m_pitch) * (height + 2 * border);
+}
+
+//---------------------------------------------------------------------------------------
+inline size_t RowMajorLayout::first() const {
+    return m_first;
+}
+
+//---------------------------------------------------------------------------------------
+inline std::ptrdiff_t RowMajorLayout::offset(int32 col, int32 row) const {
+    return std::ptrdiff_t(row) * m_pitch + col;
+}
+
+//---------------------------------------------------------------------------------------
+inline uint32 RowMajorLayout::pitch() const {
+    return m_pitch;
+}
+
+//---------------------------------------------------------------------------------------
+template <uint32 Log2BrickSize>
+BrickedLayout<Log2BrickSize>::BrickedLayout()
+    : m_border(0),
+      m_bricksPerRow(0),
+      m_first(0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+template <uint32 Log2BrickSize>
+size_t BrickedLayout<Log2BrickSize>::setup(
+        uint32 width,
+        uint32 height,
+        uint32 border,
+        bool,
+        size_t
+) {
+    m_border = border;
+    m_bricksPerRow = (width + 2 * border + kBrickSize - 1) / kBrickSize;
+    uint32 bricksPerColumn = (height + 2 * border + kBrickSize - 1) / kBrickSize;
+    m_first = index(border, border);
+
+    return size_t(m_bricksPerRow) * bricksPerColumn * kBrickSize * kBrickSize;
+}
+
+//---------------------------------------------------------------------------------------
+template <uint32 Log2BrickSize>
+size_t BrickedLayout<Log2BrickSize>::first() const {
+    return size_t(m_first);
+}
+
+//---------------------------------------------------------------------------------------
+template <uint32 Log2BrickSize>
+std::ptrdiff_t BrickedLayout<Log2BrickSize>::index(uint32 x, uint32 y) const {
+    const uint32 mask = kBrickSize - 1;
+    std::ptrdiff_t brick = std::ptrdiff_t(y >> Log2BrickSize) * m_bricksPerRow +
+            (x >> Log2BrickSize);
+
+    return (brick << (2 * Log2BrickSize)) + ((y & mask) << Log2BrickSize) + (x & mask);
+}
+
+//---------------------------------------------------------------------------------------
+template <uint32 Log2BrickSize>
+std::ptrdiff_t BrickedLayout<Log2BrickSize>::offset(int32 col, int32 row) const {
+    return index(uint32(col + int32(m_border)), uint32(row + int32(m_border))) - m_first;
+}
+
+//---------------------------------------------------------------------------------------
+inline ZOrderLayout::ZOrderLayout()
+    : m_border(0),
+      m_log2Square(0),
+      m_squareMask(0),
+      m_first(0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+inline size_t ZOrderLayout::setup(
+        uint32 width,
+        uint32 height,
+        uint32 border,
+        bool,
+        size_t
+) {
+    uint32 log2Width = log2Ceil(width + 2 * border);
+    uint32 log2Height = log2Ceil(height + 2 * border);
+
+    // The longer side is made of a row, or column, of Z-ordered squares as
+    // large as the shorter side.
+    m_border = border;
+    m_log2Square = std::min(log2Width, log2Height);
+    m_squareMask = (1u << m_log2Square) - 1;
+    m_first = index(border, border);
+
+    return size_t(1) << (log2Width + log2Height);
+}
+
+//---------------------------------------------------------------------------------------
+inline size_t ZOrderLayout::first() const {
+    return size_t(m_first);
+}
+
+//---------------------------------------------------------------------------------------
+inline std::ptrdiff_t ZOrderLayout::index(uint32 x, uint32 y) const {
+    // At most one of x and y lies beyond the first square.
+    std::ptrdiff_t square = std::ptrdiff_t((x | y) >> m_log2Square);
+
+    return (square << (2 * m_log2Square)) +
+            (spreadBits(x & m_squareMask) | (spreadBits(y & m_squareMask) << 1));
+}
+
+//---------------------------------------------------------------------------------------
+inline std::ptrdiff_t ZOrderLayout::offset(int32 col, int32 row) const {
+    return index(uint32(col + int32(m_border)), uint32(row + int32(m_border))) - m_first;
+}
+
+} // end namespace FluidSim
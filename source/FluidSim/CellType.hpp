@@ -0,0 +1,16 @@
+/**
+* CellType.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+namespace FluidSim {
+
+/// Classification of grid cells used to mask the pressure projection.
+enum class CellType : bool {
+    Fluid, Solid
+};
+
+} // end namespace FluidSim
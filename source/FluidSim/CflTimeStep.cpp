@@ -0,0 +1,71 @@
+// CflTimeStep.cpp
+
+#include "CflTimeStep.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+CflTimeStep::CflTimeStep(float32 targetCfl, uint32 maxSubsteps)
+	: m_targetCfl(1.0f),
+	  m_maxSubsteps(1)
+{
+	setTargetCfl(targetCfl);
+	setMaxSubsteps(maxSubsteps);
+}
+
+//---------------------------------------------------------------------------------------
+void CflTimeStep::setTargetCfl(float32 cfl) {
+	if (!(cfl > 0.0f)) {
+		throw FluidSim::Exception("Target CFL number must be positive.");
+	}
+	m_targetCfl = cfl;
+}
+
+//---------------------------------------------------------------------------------------
+float32 CflTimeStep::targetCfl() const {
+	return m_targetCfl;
+}
+
+//---------------------------------------------------------------------------------------
+void CflTimeStep::setMaxSubsteps(uint32 count) {
+	if (count == 0) {
+		throw FluidSim::Exception("At least one substep is required per frame.");
+	}
+	m_maxSubsteps = count;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 CflTimeStep::maxSubsteps() const {
+	return m_maxSubsteps;
+}
+
+//---------------------------------------------------------------------------------------
+float32 CflTimeStep::cflTimeStep(float32 maxSpeed, float32 cellLength) const {
+	if (maxSpeed <= 0.0f) {
+		return std::numeric_limits<float32>::infinity();
+	}
+	return m_targetCfl * cellLength / maxSpeed;
+}
+
+//---------------------------------------------------------------------------------------
+float32 CflTimeStep::substep(
+		float32 frameDt,
+		float32 remaining,
+		float32 maxSpeed,
+		float32 cellLength
+) const {
+	float32 dt = std::max(cflTimeStep(maxSpeed, cellLength), frameDt / m_maxSubsteps);
+
+	if (dt >= remaining) {
+		return remaining;
+	} else if (2.0f * dt > remaining) {
+		return 0.5f * remaining;
+	}
+	return dt;
+}
+
+} // end namespace FluidSim
@@ -0,0 +1,58 @@
+/**
+* CflTimeStep.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+
+namespace FluidSim {
+
+/**
+* Chooses time steps from a target CFL number, the number of cells the fastest
+* fluid moves per step:
+*
+*     cfl = maxSpeed * dt / cellLength
+*
+* A frame of frameDt seconds is split into substeps, each as long as the
+* target allows, so calm flow takes a single step per frame and violent flow
+* takes several.  Substeps are never shorter than frameDt / maxSubsteps, which
+* bounds the work per frame at the cost of letting the CFL number grow past the
+* target in the most violent flow.
+*/
+class CflTimeStep {
+public:
+    explicit CflTimeStep(float32 targetCfl = 1.0f, uint32 maxSubsteps = 8);
+
+    /// Throws a FluidSim::Exception unless \c cfl > 0.
+    void setTargetCfl(float32 cfl);
+
+    float32 targetCfl() const;
+
+    /// Throws a FluidSim::Exception if \c count is 0.
+    void setMaxSubsteps(uint32 count);
+
+    uint32 maxSubsteps() const;
+
+    /// Largest dt for which maxSpeed * dt / cellLength <= targetCfl(), or
+    /// infinity if \c maxSpeed is 0.
+    float32 cflTimeStep(float32 maxSpeed, float32 cellLength) const;
+
+    /**
+    * Length of the next substep of a frame of \c frameDt seconds, of which
+    * \c remaining are left to simulate.  Returns \c remaining once it fits in
+    * one step, and splits the last two substeps evenly rather than leaving a
+    * sliver at the end of the frame.  Subtracting each result from \c remaining
+    * reaches exactly 0.
+    */
+    float32 substep(float32 frameDt, float32 remaining, float32 maxSpeed,
+            float32 cellLength) const;
+
+private:
+    float32 m_targetCfl;
+    uint32 m_maxSubsteps;
+};
+
+} // end namespace FluidSim
@@ -0,0 +1,49 @@
+/**
+* DoubleBufferedGrid.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/Grid.hpp"
+
+namespace FluidSim {
+
+/**
+* Pair of equally sized Grids used for ping-pong updates.  Kernels read from
+* front() and write to back(), then swap() exchanges the two buffers without
+* copying or allocating.
+*/
+template <typename T>
+class DoubleBufferedGrid {
+public:
+    DoubleBufferedGrid();
+
+    DoubleBufferedGrid(const GridSpec & spec);
+
+    /// Both buffers take the GridSpec and layout of \c initial, and front() is a
+    /// deep copy of it.
+    explicit DoubleBufferedGrid(const Grid<T> & initial);
+
+    Grid<T> & front();
+
+    const Grid<T> & front() const;
+
+    Grid<T> & back();
+
+    const Grid<T> & back() const;
+
+    /// Makes back() the new front() and vice versa.
+    void swap();
+
+    GridSpec gridSpec() const;
+
+private:
+    Grid<T> m_buffers[2];
+    uint32 m_front;
+};
+
+} // end namespace FluidSim.
+
+#include "DoubleBufferedGrid.inl"
@@ -0,0 +1,67 @@
+#include "DoubleBufferedGrid.hpp"
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+DoubleBufferedGrid<T>::DoubleBufferedGrid()
+    : m_front(0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+DoubleBufferedGrid<T>::DoubleBufferedGrid(const GridSpec & spec)
+    : m_buffers{Grid<T>(spec), Grid<T>(spec)},
+      m_front(0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+DoubleBufferedGrid<T>::DoubleBufferedGrid(const Grid<T> & initial)
+    : m_buffers{initial, Grid<T>(initial.gridSpec(), initial.layout())},
+      m_front(0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+Grid<T> & DoubleBufferedGrid<T>::front() {
+    return m_buffers[m_front];
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+const Grid<T> & DoubleBufferedGrid<T>::front() const {
+    return m_buffers[m_front];
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+Grid<T> & DoubleBufferedGrid<T>::back() {
+    return m_buffers[1 - m_front];
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+const Grid<T> & DoubleBufferedGrid<T>::back() const {
+    return m_buffers[1 - m_front];
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+void DoubleBufferedGrid<T>::swap() {
+    m_front = 1 - m_front;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+GridSpec DoubleBufferedGrid<T>::gridSpec() const {
+    return m_buffers[m_front].gridSpec();
+}
+
+} // end namespace FluidSim
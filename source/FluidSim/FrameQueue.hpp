@@ -0,0 +1,89 @@
+/**
+* FrameQueue.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace FluidSim {
+
+/**
+* Bounded, lock-free, single producer / single consumer queue of frames, for
+* handing simulation snapshots from a simulation thread to a render thread.
+*
+* All frames are allocated up front and written in place, so a producer that
+* reuses a slot's storage never allocates.  The producer fills the slot
+* returned by beginWrite() and publishes it with endWrite().  The consumer only
+* cares about the newest frame: beginReadLatest() discards any older published
+* frames, freeing their slots, and the returned frame stays valid until
+* endRead().
+*
+* Exactly one thread may call the producer methods, and exactly one thread the
+* consumer methods.
+*/
+template <typename Frame>
+class FrameQueue {
+public:
+    /// Queue of \c capacity frames, which must be at least 2 so that the
+    /// producer can write while the consumer reads.  Throws a
+    /// FluidSim::Exception otherwise.
+    explicit FrameQueue(uint32 capacity = 3);
+
+    FrameQueue(const FrameQueue &) = delete;
+    FrameQueue & operator = (const FrameQueue &) = delete;
+
+    uint32 capacity() const;
+
+    /// Producer: slot for the next frame, or nullptr if every slot is
+    /// published or being read.  Contents are whatever was last written there.
+    Frame * beginWrite();
+
+    /// Producer: publishes the frame returned by the last beginWrite().
+    void endWrite();
+
+    /// Consumer: newest published frame, or nullptr if nothing was published
+    /// since the last endRead().  Older published frames are dropped.
+    const Frame * beginReadLatest();
+
+    /// Consumer: returns the frame from the last beginReadLatest() to the
+    /// producer.
+    void endRead();
+
+    /// Number of published frames not yet released by the consumer, including
+    /// one being read.
+    uint32 size() const;
+
+    /// Published frames that beginReadLatest() has neither returned nor
+    /// dropped yet.  Safe to call from either thread.
+    uint32 unreadFrames() const;
+
+    /// Total frames dropped by beginReadLatest() in favor of newer ones.
+    uint64 droppedFrames() const;
+
+private:
+    std::vector<Frame> m_frames;
+
+    // Monotonic counters; slot i of the ring is m_frames[i % capacity].
+    // Frames in [m_head, m_tail) are published, and m_head is only advanced
+    // past a frame once the consumer has released it.
+    std::atomic<uint64> m_head;
+    std::atomic<uint64> m_tail;
+
+    // Frames before this one were returned or dropped by beginReadLatest().
+    std::atomic<uint64> m_taken;
+
+    // Consumer only.
+    uint64 m_reading;
+    bool m_isReading;
+    std::atomic<uint64> m_dropped;
+};
+
+} // end namespace FluidSim
+
+#include "FrameQueue.inl"
@@ -0,0 +1,105 @@
+#include "FrameQueue.hpp"
+#include "FluidSim/Exception.hpp"
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+FrameQueue<Frame>::FrameQueue(uint32 capacity)
+    : m_frames(),
+      m_head(0),
+      m_tail(0),
+      m_taken(0),
+      m_reading(0),
+      m_isReading(false),
+      m_dropped(0)
+{
+    if (capacity < 2) {
+        throw FluidSim::Exception("FrameQueue capacity must be at least 2.");
+    }
+    m_frames.resize(capacity);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+uint32 FrameQueue<Frame>::capacity() const {
+    return uint32(m_frames.size());
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+Frame * FrameQueue<Frame>::beginWrite() {
+    const uint64 tail = m_tail.load(std::memory_order_relaxed);
+    const uint64 head = m_head.load(std::memory_order_acquire);
+    if (tail - head >= m_frames.size()) {
+        return nullptr;
+    }
+
+    return &m_frames[tail % m_frames.size()];
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+void FrameQueue<Frame>::endWrite() {
+    const uint64 tail = m_tail.load(std::memory_order_relaxed);
+    m_tail.store(tail + 1, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+const Frame * FrameQueue<Frame>::beginReadLatest() {
+    if (m_isReading) {
+        endRead();
+    }
+
+    const uint64 head = m_head.load(std::memory_order_relaxed);
+    const uint64 tail = m_tail.load(std::memory_order_acquire);
+    if (head == tail) {
+        return nullptr;
+    }
+
+    // Release the stale frames to the producer, but keep the newest one until
+    // endRead().
+    m_reading = tail - 1;
+    m_isReading = true;
+    m_taken.store(tail, std::memory_order_release);
+    if (m_reading != head) {
+        m_dropped.fetch_add(m_reading - head, std::memory_order_relaxed);
+        m_head.store(m_reading, std::memory_order_release);
+    }
+
+    return &m_frames[m_reading % m_frames.size()];
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+void FrameQueue<Frame>::endRead() {
+    if (m_isReading) {
+        m_isReading = false;
+        m_head.store(m_reading + 1, std::memory_order_release);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+uint32 FrameQueue<Frame>::size() const {
+    const uint64 head = m_head.load(std::memory_order_acquire);
+    const uint64 tail = m_tail.load(std::memory_order_acquire);
+    return uint32(tail - head);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+uint32 FrameQueue<Frame>::unreadFrames() const {
+    const uint64 taken = m_taken.load(std::memory_order_acquire);
+    const uint64 tail = m_tail.load(std::memory_order_acquire);
+    return uint32(tail - taken);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Frame>
+uint64 FrameQueue<Frame>::droppedFrames() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+} // end namespace FluidSim
@@ -0,0 +1,315 @@
+// GaussSeidel.cpp
+
+#include "GaussSeidel.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+
+using namespace FluidSim;
+
+
+namespace {  // limit visibility to this file.
+
+//---------------------------------------------------------------------------------------
+// Relaxes a single cell, treating neighbors outside of the grid as solid.
+inline void relaxBorderCell(
+		const Grid<CellType> & cells,
+		const Grid<float32> & rhs,
+		Grid<float32> & p,
+		int32 col,
+		int32 row
+) {
+	if (cells(col,row) != CellType::Fluid) {
+		return;
+	}
+
+	auto isFluid = [&] (int32 i, int32 j) {
+		return cells.isValidCoord(i, j) && cells(i, j) == CellType::Fluid;
+	};
+
+	float32 numFluidNeighbors = 0;
+	float32 neighborPressureSum = 0;
+
+	if (isFluid(col-1, row)) { ++numFluidNeighbors; neighborPressureSum += p(col-1,row); }
+	if (isFluid(col+1, row)) { ++numFluidNeighbors; neighborPressureSum += p(col+1,row); }
+	if (isFluid(col, row-1)) { ++numFluidNeighbors; neighborPressureSum += p(col,row-1); }
+	if (isFluid(col, row+1)) { ++numFluidNeighbors; neighborPressureSum += p(col,row+1); }
+
+	if (numFluidNeighbors > 0) {
+		p(col,row) = (rhs(col,row) + neighborPressureSum) / numFluidNeighbors;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// Relaxes cells colStart, colStart + colStep, ... of \c row, in increasing order.
+// Interior cells use 0/1 fluid weights instead of branches, which gives the same
+// sums as the branching form and lets the compiler vectorize the loop.
+void relaxRow(
+		const Grid<CellType> & cells,
+		const Grid<float32> & rhs,
+		Grid<float32> & p,
+		uint32 row,
+		uint32 colStart,
+		uint32 colStep
+) {
+	const uint32 width = cells.width();
+	const uint32 height = cells.height();
+
+	if (row == 0 || row == height - 1 || width < 3) {
+		for (uint32 col(colStart); col < width; col += colStep) {
+			relaxBorderCell(cells, rhs, p, col, row);
+		}
+		return;
+	}
+
+	uint32 col = colStart;
+	if (col == 0) {
+		relaxBorderCell(cells, rhs, p, 0, row);
+		col += colStep;
+	}
+
+	const CellType * c = &cells(0, row);
+	const CellType * cBelow = &cells(0, row - 1);
+	const CellType * cAbove = &cells(0, row + 1);
+	const float32 * b = &rhs(0, row);
+	float32 * x = &p(0, row);
+	const float32 * xBelow = &p(0, row - 1);
+	const float32 * xAbove = &p(0, row + 1);
+
+	for (; col < width - 1; col += colStep) {
+		float32 fL = float32(c[col-1] == CellType::Fluid);
+		float32 fR = float32(c[col+1] == CellType::Fluid);
+		float32 fB = float32(cBelow[col] == CellType::Fluid);
+		float32 fT = float32(cAbove[col] == CellType::Fluid);
+
+		float32 numFluidNeighbors = fL + fR + fB + fT;
+		float32 neighborPressureSum =
+				fL * x[col-1] + fR * x[col+1] + fB * xBelow[col] + fT * xAbove[col];
+
+		if (c[col] == CellType::Fluid && numFluidNeighbors > 0) {
+			x[col] = (b[col] + neighborPressureSum) / numFluidNeighbors;
+		}
+	}
+
+	if (col == width - 1) {
+		relaxBorderCell(cells, rhs, p, width - 1, row);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+inline void relaxBorderCell(
+		const PressureStencil & stencil,
+		const Grid<float32> & rhs,
+		Grid<float32> & p,
+		uint32 col,
+		uint32 row
+) {
+	float32 inverseDiagonal = stencil.inverseDiagonal(col,row);
+	if (inverseDiagonal == 0.0f) {
+		return;
+	}
+
+	uint8 mask = stencil.neighbors(col,row);
+	float32 neighborPressureSum = 0;
+
+	if (mask & PressureStencil::kLeftFluid) { neighborPressureSum += p(col-1,row); }
+	if (mask & PressureStencil::kRightFluid) { neighborPressureSum += p(col+1,row); }
+	if (mask & PressureStencil::kBottomFluid) { neighborPressureSum += p(col,row-1); }
+	if (mask & PressureStencil::kTopFluid) { neighborPressureSum += p(col,row+1); }
+
+	p(col,row) = (rhs(col,row) + neighborPressureSum) * inverseDiagonal;
+}
+
+//---------------------------------------------------------------------------------------
+// Relaxes cells colStart, colStart + colStep, ... of \c row that are less than
+// \c colEnd, in increasing order.
+void relaxSpan(
+		const PressureStencil & stencil,
+		const Grid<float32> & rhs,
+		Grid<float32> & p,
+		uint32 row,
+		uint32 colStart,
+		uint32 colEnd,
+		uint32 colStep
+) {
+	const uint32 width = stencil.width();
+	const uint32 height = stencil.height();
+
+	if (row == 0 || row == height - 1 || width < 3) {
+		for (uint32 col(colStart); col < colEnd; col += colStep) {
+			relaxBorderCell(stencil, rhs, p, col, row);
+		}
+		return;
+	}
+
+	uint32 col = colStart;
+	if (col == 0 && col < colEnd) {
+		relaxBorderCell(stencil, rhs, p, 0, row);
+		col += colStep;
+	}
+
+	const uint8 * mask = &stencil.neighborGrid()(0, row);
+	const float32 * inverseDiagonal = &stencil.inverseDiagonalGrid()(0, row);
+	const float32 * b = &rhs(0, row);
+	float32 * x = &p(0, row);
+	const float32 * xBelow = &p(0, row - 1);
+	const float32 * xAbove = &p(0, row + 1);
+
+	const uint32 interiorEnd = std::min(colEnd, width - 1);
+	for (; col < interiorEnd; col += colStep) {
+		uint8 m = mask[col];
+		float32 fL = float32((m >> 1) & 1);
+		float32 fR = float32((m >> 2) & 1);
+		float32 fB = float32((m >> 3) & 1);
+		float32 fT = float32((m >> 4) & 1);
+
+		float32 neighborPressureSum =
+				fL * x[col-1] + fR * x[col+1] + fB * xBelow[col] + fT * xAbove[col];
+		float32 updated = (b[col] + neighborPressureSum) * inverseDiagonal[col];
+
+		x[col] = (inverseDiagonal[col] != 0.0f) ? updated : x[col];
+	}
+
+	if (col == width - 1 && col < colEnd) {
+		relaxBorderCell(stencil, rhs, p, width - 1, row);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+inline void relaxRow(
+		const PressureStencil & stencil,
+		const Grid<float32> & rhs,
+		Grid<float32> & p,
+		uint32 row,
+		uint32 colStart,
+		uint32 colStep
+) {
+	relaxSpan(stencil, rhs, p, row, colStart, stencil.width(), colStep);
+}
+
+//---------------------------------------------------------------------------------------
+// Shared sweep driver for the CellType and PressureStencil variants.
+template <typename Cells>
+void sweep(
+		const Cells & cells,
+		const Grid<float32> & rhs,
+		Grid<float32> & pressure,
+		uint32 iterations,
+		GaussSeidelOrdering ordering,
+		Execution execution
+) {
+	const uint32 height = cells.height();
+
+	for (uint32 iteration(0); iteration < iterations; ++iteration) {
+		if (ordering == GaussSeidelOrdering::Lexicographic) {
+			for (uint32 row(0); row < height; ++row) {
+				relaxRow(cells, rhs, pressure, row, 0, 1);
+			}
+			continue;
+		}
+
+		for (uint32 color(0); color < 2; ++color) {
+			parallelFor(execution, 0, height, [&] (uint32 rowBegin, uint32 rowEnd) {
+				for (uint32 row(rowBegin); row < rowEnd; ++row) {
+					relaxRow(cells, rhs, pressure, row, (row + color) & 1, 2);
+				}
+			});
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// Sweep driver for the sparse variant.  Each run of consecutive listed cells is
+// relaxed with the same span kernel as the dense sweep.
+void sweep(
+		const PressureStencil & stencil,
+		const ActiveCellList & cells,
+		const Grid<float32> & rhs,
+		Grid<float32> & pressure,
+		uint32 iterations,
+		GaussSeidelOrdering ordering,
+		Execution execution
+) {
+	for (uint32 iteration(0); iteration < iterations; ++iteration) {
+		if (ordering == GaussSeidelOrdering::Lexicographic) {
+			cells.forEachSpan(0, cells.size(),
+					[&] (uint32 row, uint32 colBegin, uint32 colEnd) {
+				relaxSpan(stencil, rhs, pressure, row, colBegin, colEnd, 1);
+			});
+			continue;
+		}
+
+		for (uint32 color(0); color < 2; ++color) {
+			parallelFor(execution, 0, cells.size(), [&] (uint32 begin, uint32 end) {
+				cells.forEachSpan(begin, end,
+						[&] (uint32 row, uint32 colBegin, uint32 colEnd) {
+					uint32 colStart = colBegin + ((colBegin + row + color) & 1);
+					relaxSpan(stencil, rhs, pressure, row, colStart, colEnd, 2);
+				});
+			});
+		}
+	}
+}
+
+} // end namespace
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+void gaussSeidel(
+		const Grid<CellType> & cells,
+		const Grid<float32> & rhs,
+		Grid<float32> & pressure,
+		uint32 iterations,
+		GaussSeidelOrdering ordering,
+		Execution execution
+) {
+	if (rhs.gridSpec() != pressure.gridSpec() ||
+		cells.width() != rhs.width() || cells.height() != rhs.height())
+	{
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	sweep(cells, rhs, pressure, iterations, ordering, execution);
+}
+
+//---------------------------------------------------------------------------------------
+void gaussSeidel(
+		const PressureStencil & stencil,
+		const Grid<float32> & rhs,
+		Grid<float32> & pressure,
+		uint32 iterations,
+		GaussSeidelOrdering ordering,
+		Execution execution
+) {
+	if (rhs.gridSpec() != pressure.gridSpec() ||
+		stencil.width() != rhs.width() || stencil.height() != rhs.height())
+	{
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	sweep(stencil, rhs, pressure, iterations, ordering, execution);
+}
+
+//---------------------------------------------------------------------------------------
+void gaussSeidel(
+		const PressureStencil & stencil,
+		const ActiveCellList & cells,
+		const Grid<float32> & rhs,
+		Grid<float32> & pressure,
+		uint32 iterations,
+		GaussSeidelOrdering ordering,
+		Execution execution
+) {
+	if (rhs.gridSpec() != pressure.gridSpec() ||
+		stencil.width() != rhs.width() || stencil.height() != rhs.height() ||
+		cells.width() != rhs.width() || cells.height() != rhs.height())
+	{
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	sweep(stencil, cells, rhs, pressure, iterations, ordering, execution);
+}
+
+} // end namespace FluidSim
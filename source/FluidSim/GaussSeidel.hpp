@@ -0,0 +1,79 @@
+/**
+* GaussSeidel.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Grid.hpp"
+#include "FluidSim/CellType.hpp"
+#include "FluidSim/Parallel.hpp"
+#include "FluidSim/PressureStencil.hpp"
+#include "FluidSim/ActiveCellList.hpp"
+
+namespace FluidSim {
+
+/// Order in which gaussSeidel() visits cells during a sweep.
+enum class GaussSeidelOrdering {
+    /// Row by row, left to right.  Each cell reads neighbors updated earlier in
+    /// the same sweep, so the sweep is inherently serial.
+    Lexicographic,
+
+    /// All cells with even (col + row) first, then all odd cells.  Cells of one
+    /// color only read cells of the other color, so each half sweep runs in
+    /// parallel, with the same convergence rate per sweep.
+    RedBlack
+};
+
+/**
+* Applies \c iterations Gauss-Seidel sweeps to the pressure system Ap = \c rhs
+* described in PressureSolver.hpp, updating \c pressure in place:
+*
+*     p(col,row) = (rhs(col,row) + sum of fluid neighbor pressures) / numFluidNeighbors
+*
+* Solid cells and fluid cells without fluid neighbors are left untouched.  With
+* GaussSeidelOrdering::Lexicographic, \c execution is ignored.  With RedBlack,
+* Execution::Parallel is bit-identical to Execution::Serial.
+*/
+void gaussSeidel(
+        const Grid<CellType> & cells,
+        const Grid<float32> & rhs,
+        Grid<float32> & pressure,
+        uint32 iterations,
+        GaussSeidelOrdering ordering = GaussSeidelOrdering::RedBlack,
+        Execution execution = Execution::Parallel
+);
+
+/**
+* Same as above, but reads neighbor types and the diagonal from a prebuilt
+* PressureStencil, multiplying by the stored 1/numFluidNeighbors instead of
+* dividing.  Results may differ from the CellType version in the last bit.
+*/
+void gaussSeidel(
+        const PressureStencil & stencil,
+        const Grid<float32> & rhs,
+        Grid<float32> & pressure,
+        uint32 iterations,
+        GaussSeidelOrdering ordering = GaussSeidelOrdering::RedBlack,
+        Execution execution = Execution::Parallel
+);
+
+/**
+* Sparse variant that only relaxes the cells in \c cells, typically
+* stencil.fluidCells().  If \c cells holds every active cell of \c stencil in
+* row-major order, the result matches the dense PressureStencil version for
+* either ordering.
+*/
+void gaussSeidel(
+        const PressureStencil & stencil,
+        const ActiveCellList & cells,
+        const Grid<float32> & rhs,
+        Grid<float32> & pressure,
+        uint32 iterations,
+        GaussSeidelOrdering ordering = GaussSeidelOrdering::RedBlack,
+        Execution execution = Execution::Parallel
+);
+
+} // end namespace FluidSim
@@ -7,6 +7,8 @@
 #pragma once
 
 #include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/GridFwd.hpp"
+#include "FluidSim/CellLayout.hpp"
 
 namespace FluidSim {
 
@@ -20,7 +22,57 @@ struct GridSpec {
 	bool operator != (const GridSpec & other) const;
 };
 
-template <typename T>
+/**
+* Storage options for a Grid.  With the default RowMajorLayout and these
+* defaults, storage is tightly packed, so that data()[row * width + col] is
+* cell (col,row).
+*/
+struct GridLayout {
+    /// Number of extra cells kept on each side of the grid.  Cells with
+    /// coordinates in [-border, width + border) x [-border, height + border) are
+    /// addressable through Grid::at(), or data() and pitch().
+    uint32 border;
+
+    /// If true, each row is padded so that cell (0,row) starts on a
+    /// kCacheLineSize boundary.  Only RowMajorLayout has rows to pad.
+    bool alignRows;
+
+    GridLayout(uint32 border = 0, bool alignRows = false);
+
+    bool operator == (const GridLayout & other) const;
+    bool operator != (const GridLayout & other) const;
+};
+
+/**
+* How Grid::fillBorder() extends the grid cells into the border.
+*/
+enum class BorderPolicy {
+    Clamp,    // Copy of the nearest edge cell.
+    Zero,     // T(0).
+    Periodic, // Copy of the cell on the opposite side of the grid.
+    Reflect   // Mirror image across the grid edge, so cell -1 copies cell 0.
+};
+
+/// Index of the grid cell that border cell \c index copies under \c policy,
+/// along an axis of \c size cells.  Not meaningful for BorderPolicy::Zero.
+inline int32 borderSource(int32 index, int32 size, BorderPolicy policy);
+
+/**
+* Two dimensional array of cell values, positioned in the world by a GridSpec.
+*
+* Storage comes from \c Allocator, by default aligned to kCacheLineSize, and
+* cells are ordered in memory by \c Layout, see CellLayout.hpp.  With the
+* default RowMajorLayout, cell (col,row) lives at data()[row * pitch() + col],
+* where pitch() is width() for the default GridLayout, and larger when rows are
+* padded or a border is requested.  Other layouts only change memory order;
+* every member behaves the same.
+*
+* Border cells are not updated when grid cells are written.  Call fillBorder()
+* once the grid cells are final, e.g. once per time step, after which stencils
+* and interpolation can read up to border() cells past each edge without
+* bounds checks.
+*/
+template <typename T, typename Allocator, typename Layout>
 class Grid {
 public:
     Grid();
@@ -28,13 +80,14 @@ public:
     Grid(uint32 width,
          uint32 height,
          float32 cellLength,
-         vec2 origin);
+         vec2 origin,
+         const GridLayout & layout = GridLayout());
 
-    Grid(const GridSpec & spec);
+    Grid(const GridSpec & spec, const GridLayout & layout = GridLayout());
 
-    Grid(const Grid<T> & other);
+    Grid(const Grid & other);
 
-    Grid(Grid<T> && other); // move constructor
+    Grid(Grid && other); // move constructor
 
     ~Grid();
 
@@ -48,6 +101,15 @@ public:
 
 	GridSpec gridSpec() const;
 
+	GridLayout layout() const;
+
+	/// Number of elements between the starts of consecutive rows.  Only
+	/// available with RowMajorLayout.
+	uint32 pitch() const;
+
+	/// Number of extra cells on each side of the grid, see GridLayout.
+	uint32 border() const;
+
 	/// Returns true if point p intersects Grid.  Returns false otherwise.
 	bool contains(const vec2 & p) const;
 
@@ -78,28 +140,52 @@ public:
 
 	T & operator () (const glm::uvec2 & gridCoord) const;
 
-    Grid<T> & operator = (Grid<T> && other);
+	/// Like operator(), but also accepts the coordinates of border cells, from
+	/// -border() to width()+border()-1 and height()+border()-1.
+	T & at(int32 col, int32 row) const;
+
+    Grid & operator = (Grid && other);
 
-    Grid<T> & operator = (const Grid<T> & other);
+    /// Deep copy, including the layout of \c other.
+    Grid & operator = (const Grid & other);
 
-	Grid<T> & operator /= (const Grid<T> & other);
+	Grid & operator /= (const Grid & other);
 
+    /// Sets every cell, including border cells.
     void setAll(const T & val);
 
+    /// Overwrites all border cells, corners included, from the grid cells
+    /// according to \c policy.  Does nothing if the grid has no border.
+    void fillBorder(BorderPolicy policy);
+
+	/// Exchanges storage, GridSpec and layout with \c other without copying or
+	/// allocating.
+	void swap(Grid & other);
+
+    /// Pointer to cell (0,0).  Other cells are found through pitch() with
+    /// RowMajorLayout, and through the layout's offset() otherwise.
     const T * data() const;
 
+    T * data();
+
 private:
-    T * m_data;
+    Allocator m_allocator;
+
+    T * m_storage;     // Start of the allocation, including border and padding.
+    T * m_data;        // Cell (0,0) within m_storage.
+    size_t m_storageSize; // Number of elements in m_storage.
 
     uint32 m_height;
     uint32 m_width;
+    GridLayout m_layout;
+    Layout m_cellLayout;
     float32 m_cellLength;
     vec2 m_origin;
 
+    void allocate(uint32 width, uint32 height, const GridLayout & layout);
+    void release();
 };
 
 } // end namespace FluidSim.
 
 #include "Grid.inl"
-
-
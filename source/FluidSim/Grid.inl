@@ -2,6 +2,8 @@
 
 #include "FluidSim/Utils.hpp"
 
+#include <algorithm>
+#include <new>
 #include <utility>
 
 #include <glm/gtx/norm.hpp>
@@ -26,11 +28,51 @@ inline bool GridSpec::operator != (
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-Grid<T>::Grid()
-    : m_data(nullptr),
-      m_height(0.0f),
-      m_width(0.0f),
+inline GridLayout::GridLayout(uint32 border, bool alignRows)
+	: border(border),
+	  alignRows(alignRows)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+inline bool GridLayout::operator == (const GridLayout & other) const {
+	return border == other.border && alignRows == other.alignRows;
+}
+
+//---------------------------------------------------------------------------------------
+inline bool GridLayout::operator != (const GridLayout & other) const {
+	return !(*this == other);
+}
+
+//---------------------------------------------------------------------------------------
+inline int32 borderSource(int32 index, int32 size, BorderPolicy policy) {
+	switch (policy) {
+		case BorderPolicy::Periodic: {
+			int32 i = index % size;
+			return (i < 0) ? i + size : i;
+		}
+		case BorderPolicy::Reflect: {
+			int32 period = 2 * size;
+			int32 i = index % period;
+			if (i < 0) {
+				i += period;
+			}
+			return (i < size) ? i : period - 1 - i;
+		}
+		default:
+			return std::min(std::max(index, 0), size - 1);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+Grid<T, Allocator, Layout>::Grid()
+    : m_storage(nullptr),
+      m_data(nullptr),
+      m_storageSize(0),
+      m_height(0),
+      m_width(0),
       m_cellLength(0.0f),
       m_origin(vec2(0.0f))
 {
@@ -38,93 +80,148 @@ Grid<T>::Grid()
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-Grid<T>::Grid(
+template <typename T, typename Allocator, typename Layout>
+Grid<T, Allocator, Layout>::Grid(
         uint32 width,
         uint32 height,
         float32 cellLength,
-        vec2 origin)
+        vec2 origin,
+        const GridLayout & layout)
 
-    : m_height(height),
-      m_width(width),
+    : m_storage(nullptr),
+      m_data(nullptr),
+      m_storageSize(0),
       m_cellLength(cellLength),
       m_origin(origin)
 {
-    m_data = new T[width * height];
+    allocate(width, height, layout);
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-Grid<T>::Grid(const GridSpec & spec)
-    : m_height(spec.height),
-      m_width(spec.width),
+template <typename T, typename Allocator, typename Layout>
+Grid<T, Allocator, Layout>::Grid(const GridSpec & spec, const GridLayout & layout)
+    : m_storage(nullptr),
+      m_data(nullptr),
+      m_storageSize(0),
       m_cellLength(spec.cellLength),
       m_origin(spec.origin)
 {
-    m_data = new T[m_width * m_height];
+    allocate(spec.width, spec.height, layout);
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-Grid<T>::Grid(const Grid<T> & other)
-    : m_width(other.m_width),
-      m_height(other.m_height),
+template <typename T, typename Allocator, typename Layout>
+Grid<T, Allocator, Layout>::Grid(const Grid & other)
+    : m_allocator(other.m_allocator),
+      m_storage(nullptr),
+      m_data(nullptr),
+      m_storageSize(0),
       m_cellLength(other.m_cellLength),
       m_origin(other.m_origin)
 {
-    //-- Perform deep copy:
-    uint32 num_elements = m_width * m_height;
-    m_data = new T [num_elements];
-    std::memcpy(m_data, other.m_data, sizeof(T)*num_elements);
+    //-- Perform deep copy, border and padding included:
+    allocate(other.m_width, other.m_height, other.m_layout);
+    std::copy(other.m_storage, other.m_storage + m_storageSize, m_storage);
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-Grid<T>::Grid(Grid<T> && other)
-    : m_data(other.m_data),
-      m_width(other.m_width),
+template <typename T, typename Allocator, typename Layout>
+Grid<T, Allocator, Layout>::Grid(Grid && other)
+    : m_allocator(std::move(other.m_allocator)),
+      m_storage(other.m_storage),
+      m_data(other.m_data),
+      m_storageSize(other.m_storageSize),
       m_height(other.m_height),
+      m_width(other.m_width),
+      m_layout(other.m_layout),
+      m_cellLayout(other.m_cellLayout),
       m_cellLength(other.m_cellLength),
       m_origin(other.m_origin)
 {
+    other.m_storage = nullptr;
     other.m_data = nullptr;
+    other.m_storageSize = 0;
     other.m_height = 0;
     other.m_width = 0;
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-Grid<T>::~Grid() {
-    delete [] m_data;
+template <typename T, typename Allocator, typename Layout>
+Grid<T, Allocator, Layout>::~Grid() {
+    release();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+void Grid<T, Allocator, Layout>::allocate(
+        uint32 width,
+        uint32 height,
+        const GridLayout & layout
+) {
+    m_width = width;
+    m_height = height;
+    m_layout = layout;
+
+    m_storageSize = m_cellLayout.setup(width, height, layout.border, layout.alignRows,
+            sizeof(T));
+    if (width == 0 || height == 0) {
+        m_storageSize = 0;
+    }
+    if (m_storageSize == 0) {
+        m_storage = nullptr;
+        m_data = nullptr;
+        return;
+    }
+
+    m_storage = m_allocator.allocate(m_storageSize);
+    for (size_t i(0); i < m_storageSize; ++i) {
+        ::new (static_cast<void *>(m_storage + i)) T;
+    }
+    m_data = m_storage + m_cellLayout.first();
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-uint32 Grid<T>::width() const {
+template <typename T, typename Allocator, typename Layout>
+void Grid<T, Allocator, Layout>::release() {
+    if (m_storage != nullptr) {
+        for (size_t i(0); i < m_storageSize; ++i) {
+            m_storage[i].~T();
+        }
+        m_allocator.deallocate(m_storage, m_storageSize);
+    }
+
+    m_storage = nullptr;
+    m_data = nullptr;
+    m_storageSize = 0;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+uint32 Grid<T, Allocator, Layout>::width() const {
     return m_width;
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-uint32 Grid<T>::height() const {
+template <typename T, typename Allocator, typename Layout>
+uint32 Grid<T, Allocator, Layout>::height() const {
     return m_height;
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-vec2 Grid<T>::origin() const {
+template <typename T, typename Allocator, typename Layout>
+vec2 Grid<T, Allocator, Layout>::origin() const {
     return m_origin;
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-float32 Grid<T>::cellLength() const {
+template <typename T, typename Allocator, typename Layout>
+float32 Grid<T, Allocator, Layout>::cellLength() const {
     return m_cellLength;
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-GridSpec Grid<T>::gridSpec() const {
+template <typename T, typename Allocator, typename Layout>
+GridSpec Grid<T, Allocator, Layout>::gridSpec() const {
 	GridSpec gridSpec = {
 			m_width,
 			m_height,
@@ -136,8 +233,26 @@ GridSpec Grid<T>::gridSpec() const {
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-vec2 Grid<T>::getPosition(uint32 col, uint32 row) const {
+template <typename T, typename Allocator, typename Layout>
+GridLayout Grid<T, Allocator, Layout>::layout() const {
+	return m_layout;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+uint32 Grid<T, Allocator, Layout>::pitch() const {
+	return m_cellLayout.pitch();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+uint32 Grid<T, Allocator, Layout>::border() const {
+	return m_layout.border;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+vec2 Grid<T, Allocator, Layout>::getPosition(uint32 col, uint32 row) const {
     vec2 coords(col,row);
     coords *= m_cellLength;
     return m_origin + coords;
@@ -145,44 +260,58 @@ vec2 Grid<T>::getPosition(uint32 col, uint32 row) const {
 
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-vec2 Grid<T>::getPosition(const glm::uvec2 & index) const {
+template <typename T, typename Allocator, typename Layout>
+vec2 Grid<T, Allocator, Layout>::getPosition(const glm::uvec2 & index) const {
 	return getPosition(index.x, index.y);
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-T & Grid<T>::operator () (uint32 col, uint32 row) const {
+template <typename T, typename Allocator, typename Layout>
+T & Grid<T, Allocator, Layout>::operator () (uint32 col, uint32 row) const {
 	assert(isValidCoord(col, row));
 
-    return m_data[m_width*row + col];
+    return m_data[m_cellLayout.offset(int32(col), int32(row))];
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-T & Grid<T>::operator () (const glm::uvec2 & gridCoord) const {
+template <typename T, typename Allocator, typename Layout>
+T & Grid<T, Allocator, Layout>::operator () (const glm::uvec2 & gridCoord) const {
 	assert(isValidCoord(gridCoord.x, gridCoord.y));
 
-	return m_data[m_width*gridCoord.y + gridCoord.x];
+	return m_data[m_cellLayout.offset(int32(gridCoord.x), int32(gridCoord.y))];
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+T & Grid<T, Allocator, Layout>::at(int32 col, int32 row) const {
+	assert(col >= -int32(m_layout.border) && col < int32(m_width + m_layout.border) &&
+		   row >= -int32(m_layout.border) && row < int32(m_height + m_layout.border));
+
+	return m_data[m_cellLayout.offset(col, row)];
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-Grid<T> & Grid<T>::operator = (Grid<T> && other) {
+template <typename T, typename Allocator, typename Layout>
+Grid<T, Allocator, Layout> & Grid<T, Allocator, Layout>::operator = (Grid && other) {
     if (this == &other)
         return *this;
 
-    if(m_data != nullptr) {
-        delete [] m_data;
-    }
+    release();
 
+    m_allocator = std::move(other.m_allocator);
+    m_storage = other.m_storage;
     m_data = other.m_data;
+    m_storageSize = other.m_storageSize;
     m_height = other.m_height;
     m_width = other.m_width;
+    m_layout = other.m_layout;
+    m_cellLayout = other.m_cellLayout;
     m_cellLength = other.m_cellLength;
     m_origin = other.m_origin;
 
+    other.m_storage = nullptr;
     other.m_data = nullptr;
+    other.m_storageSize = 0;
     other.m_height = 0;
     other.m_width = 0;
 
@@ -190,48 +319,97 @@ Grid<T> & Grid<T>::operator = (Grid<T> && other) {
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-Grid<T> & Grid<T>::operator = (const Grid<T> & other) {
+template <typename T, typename Allocator, typename Layout>
+Grid<T, Allocator, Layout> & Grid<T, Allocator, Layout>::operator = (const Grid & other) {
     if (this == &other)
         return *this;
 
 	//-- Allocate new memory only if there is a difference between Grid sizes:
-	if (m_width != other.m_width || m_height != other.m_height) {
-		m_width = other.m_width;
-		m_height = other.m_height;
-
-		delete [] m_data;
-		m_data = new T [m_width * m_height];
+	if (m_width != other.m_width || m_height != other.m_height ||
+		m_layout != other.m_layout)
+	{
+		release();
+		allocate(other.m_width, other.m_height, other.m_layout);
 	}
 
     m_cellLength = other.m_cellLength;
     m_origin = other.m_origin;
 
-    uint32 num_elements = m_width * m_height;
-
-	// Perform deep copy of data.
-    std::memcpy(m_data, other.m_data, sizeof(T)*num_elements);
+	// Perform deep copy of data, border and padding included.
+    std::copy(other.m_storage, other.m_storage + m_storageSize, m_storage);
 
     return *this;
 };
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-void Grid<T>::setAll(const T & val) {
-    for(int i(0); i < (m_height * m_width); ++i) {
-        m_data[i] = val;
+template <typename T, typename Allocator, typename Layout>
+void Grid<T, Allocator, Layout>::setAll(const T & val) {
+    std::fill(m_storage, m_storage + m_storageSize, val);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+void Grid<T, Allocator, Layout>::fillBorder(BorderPolicy policy) {
+    const int32 border = int32(m_layout.border);
+    const int32 width = int32(m_width);
+    const int32 height = int32(m_height);
+    if (border == 0 || width == 0 || height == 0) {
+        return;
+    }
+
+    //-- Left and right of each grid row.
+    for (int32 row(0); row < height; ++row) {
+        for (int32 i(1); i <= border; ++i) {
+            const int32 cols[2] = { -i, width - 1 + i };
+            for (int32 col : cols) {
+                at(col,row) = (policy == BorderPolicy::Zero) ?
+                        T(0) : at(borderSource(col, width, policy), row);
+            }
+        }
+    }
+
+    //-- Whole rows below and above the grid, which fills the corners as well.
+    for (int32 i(1); i <= border; ++i) {
+        const int32 rows[2] = { -i, height - 1 + i };
+        for (int32 row : rows) {
+            const int32 source = borderSource(row, height, policy);
+            for (int32 col(-border); col < width + border; ++col) {
+                at(col,row) = (policy == BorderPolicy::Zero) ? T(0) : at(col,source);
+            }
+        }
     }
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-const T * Grid<T>::data() const {
+template <typename T, typename Allocator, typename Layout>
+void Grid<T, Allocator, Layout>::swap(Grid & other) {
+	std::swap(m_allocator, other.m_allocator);
+	std::swap(m_storage, other.m_storage);
+	std::swap(m_data, other.m_data);
+	std::swap(m_storageSize, other.m_storageSize);
+	std::swap(m_height, other.m_height);
+	std::swap(m_width, other.m_width);
+	std::swap(m_layout, other.m_layout);
+	std::swap(m_cellLayout, other.m_cellLayout);
+	std::swap(m_cellLength, other.m_cellLength);
+	std::swap(m_origin, other.m_origin);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+const T * Grid<T, Allocator, Layout>::data() const {
+    return m_data;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+T * Grid<T, Allocator, Layout>::data() {
     return m_data;
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-glm::ivec2 Grid<T>::gridCoordOf(const glm::vec2 & p) const {
+template <typename T, typename Allocator, typename Layout>
+glm::ivec2 Grid<T, Allocator, Layout>::gridCoordOf(const glm::vec2 & p) const {
 	assert(m_cellLength > 0.0f);
 
 	vec2 relativePos = p - m_origin;
@@ -243,8 +421,8 @@ glm::ivec2 Grid<T>::gridCoordOf(const glm::vec2 & p) const {
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-bool Grid<T>::contains(const vec2 & p) const {
+template <typename T, typename Allocator, typename Layout>
+bool Grid<T, Allocator, Layout>::contains(const vec2 & p) const {
 	vec2 relPos = p - m_origin;
 
 	return (relPos.x > 0) &&
@@ -254,8 +432,8 @@ bool Grid<T>::contains(const vec2 & p) const {
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-bool Grid<T>::isValidCoord(int32 col, int32 row) const {
+template <typename T, typename Allocator, typename Layout>
+bool Grid<T, Allocator, Layout>::isValidCoord(int32 col, int32 row) const {
 	return (col > -1) &&
 		   (col < m_width) &&
 		   (row > -1) &&
@@ -263,20 +441,20 @@ bool Grid<T>::isValidCoord(int32 col, int32 row) const {
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-bool Grid<T>::isValidCoord(const glm::ivec2 & gridCoord) const {
+template <typename T, typename Allocator, typename Layout>
+bool Grid<T, Allocator, Layout>::isValidCoord(const glm::ivec2 & gridCoord) const {
 	return isValidCoord(gridCoord.x, gridCoord.y);
 }
 
 //---------------------------------------------------------------------------------------
-template <typename T>
-Grid<T> & Grid<T>::operator /= (const Grid<T> & other) {
+template <typename T, typename Allocator, typename Layout>
+Grid<T, Allocator, Layout> & Grid<T, Allocator, Layout>::operator /= (const Grid & other) {
 	assert (this->m_height == other.m_height &&
 			this->m_width == other.m_width);
 
-	for (int j(0); j < m_height; ++j) {
-		for (int i(0); i < m_width; ++i) {
-			m_data[j*m_width + i] = m_data[j*m_width + i] / other.m_data[j*m_width + i];
+	for (uint32 row(0); row < m_height; ++row) {
+		for (uint32 col(0); col < m_width; ++col) {
+			(*this)(col,row) = (*this)(col,row) / other(col,row);
 		}
 	}
 
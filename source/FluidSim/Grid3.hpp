@@ -0,0 +1,135 @@
+/**
+* Grid3.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Grid.hpp"
+
+namespace FluidSim {
+
+struct GridSpec3 {
+    uint32 width;
+    uint32 height;
+    uint32 depth;
+    float32 cellLength;
+    vec3 origin;
+
+    bool operator == (const GridSpec3 & other) const;
+    bool operator != (const GridSpec3 & other) const;
+};
+
+/**
+* Three dimensional array of cell values, positioned in the world by a
+* GridSpec3.  The 3D counterpart of Grid, sharing its GridLayout options,
+* BorderPolicy values and default AlignedAllocator.
+*
+* Cells are stored with col varying fastest, then row, then layer, so cell
+* (col,row,layer) lives at data()[layer * slicePitch() + row * pitch() + col].
+* Rows, and therefore slices, are padded to whole cache lines when
+* GridLayout::alignRows is set, and GridLayout::border adds that many cells on
+* all six sides.
+*/
+template <typename T, typename Allocator>
+class Grid3 {
+public:
+    Grid3();
+
+    Grid3(uint32 width,
+          uint32 height,
+          uint32 depth,
+          float32 cellLength,
+          vec3 origin,
+          const GridLayout & layout = GridLayout());
+
+    Grid3(const GridSpec3 & spec, const GridLayout & layout = GridLayout());
+
+    Grid3(const Grid3 & other);
+
+    Grid3(Grid3 && other); // move constructor
+
+    ~Grid3();
+
+    uint32 width() const;
+
+    uint32 height() const;
+
+    uint32 depth() const;
+
+    vec3 origin() const;
+
+    float32 cellLength() const;
+
+    GridSpec3 gridSpec() const;
+
+    GridLayout layout() const;
+
+    /// Number of elements between the starts of consecutive rows.
+    uint32 pitch() const;
+
+    /// Number of elements between the starts of consecutive layers.
+    size_t slicePitch() const;
+
+    /// Number of extra cells on each side of the grid, see GridLayout.
+    uint32 border() const;
+
+    /// Returns the position of grid node (col,row,layer), taking into account
+    /// the Grid3 origin and cell length.
+    vec3 getPosition(uint32 col, uint32 row, uint32 layer) const;
+
+    /// Returns true if (col,row,layer) lies within the grid, excluding border
+    /// cells.
+    bool isValidCoord(int32 col, int32 row, int32 layer) const;
+
+    T & operator () (uint32 col, uint32 row, uint32 layer) const;
+
+    /// Like operator(), but also accepts the coordinates of border cells.
+    T & at(int32 col, int32 row, int32 layer) const;
+
+    Grid3 & operator = (Grid3 && other);
+
+    /// Deep copy, including the layout of \c other.
+    Grid3 & operator = (const Grid3 & other);
+
+    /// Sets every cell, including border cells.
+    void setAll(const T & val);
+
+    /// Overwrites all border cells, edges and corners included, from the grid
+    /// cells according to \c policy.  Does nothing if the grid has no border.
+    void fillBorder(BorderPolicy policy);
+
+    /// Exchanges storage, GridSpec3 and layout with \c other without copying or
+    /// allocating.
+    void swap(Grid3 & other);
+
+    /// Pointer to cell (0,0,0).
+    const T * data() const;
+
+    T * data();
+
+private:
+    Allocator m_allocator;
+
+    T * m_storage;        // Start of the allocation, including border and padding.
+    T * m_data;           // Cell (0,0,0) within m_storage.
+    size_t m_storageSize; // Number of elements in m_storage.
+
+    uint32 m_width;
+    uint32 m_height;
+    uint32 m_depth;
+    uint32 m_pitch;
+    size_t m_slicePitch;
+    GridLayout m_layout;
+    float32 m_cellLength;
+    vec3 m_origin;
+
+    void allocate(uint32 width, uint32 height, uint32 depth, const GridLayout & layout);
+    void release();
+};
+
+} // end namespace FluidSim.
+
+#include "Grid3.inl"
@@ -0,0 +1,422 @@
+#include "Grid3.hpp"
+
+#include "FluidSim/Utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include <glm/gtx/norm.hpp>
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+inline bool GridSpec3::operator == (const GridSpec3 & other) const {
+    return (width == other.width &&
+            height == other.height &&
+            depth == other.depth &&
+            approxEqual(cellLength, other.cellLength) &&
+            approxEqual(glm::length2(origin - other.origin), 0.0f));
+}
+
+//---------------------------------------------------------------------------------------
+inline bool GridSpec3::operator != (const GridSpec3 & other) const {
+    return !(*this == other);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+Grid3<T, Allocator>::Grid3()
+    : m_storage(nullptr),
+      m_data(nullptr),
+      m_storageSize(0),
+      m_width(0),
+      m_height(0),
+      m_depth(0),
+      m_pitch(0),
+      m_slicePitch(0),
+      m_cellLength(0.0f),
+      m_origin(vec3(0.0f))
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+Grid3<T, Allocator>::Grid3(
+        uint32 width,
+        uint32 height,
+        uint32 depth,
+        float32 cellLength,
+        vec3 origin,
+        const GridLayout & layout)
+
+    : m_storage(nullptr),
+      m_data(nullptr),
+      m_storageSize(0),
+      m_cellLength(cellLength),
+      m_origin(origin)
+{
+    allocate(width, height, depth, layout);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+Grid3<T, Allocator>::Grid3(const GridSpec3 & spec, const GridLayout & layout)
+    : m_storage(nullptr),
+      m_data(nullptr),
+      m_storageSize(0),
+      m_cellLength(spec.cellLength),
+      m_origin(spec.origin)
+{
+    allocate(spec.width, spec.height, spec.depth, layout);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+Grid3<T, Allocator>::Grid3(const Grid3 & other)
+    : m_allocator(other.m_allocator),
+      m_storage(nullptr),
+      m_data(nullptr),
+      m_storageSize(0),
+      m_cellLength(other.m_cellLength),
+      m_origin(other.m_origin)
+{
+    //-- Perform deep copy, border and padding included:
+    allocate(other.m_width, other.m_height, other.m_depth, other.m_layout);
+    std::copy(other.m_storage, other.m_storage + m_storageSize, m_storage);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+Grid3<T, Allocator>::Grid3(Grid3 && other)
+    : m_allocator(std::move(other.m_allocator)),
+      m_storage(other.m_storage),
+      m_data(other.m_data),
+      m_storageSize(other.m_storageSize),
+      m_width(other.m_width),
+      m_height(other.m_height),
+      m_depth(other.m_depth),
+      m_pitch(other.m_pitch),
+      m_slicePitch(other.m_slicePitch),
+      m_layout(other.m_layout),
+      m_cellLength(other.m_cellLength),
+      m_origin(other.m_origin)
+{
+    other.m_storage = nullptr;
+    other.m_data = nullptr;
+    other.m_storageSize = 0;
+    other.m_width = 0;
+    other.m_height = 0;
+    other.m_depth = 0;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+Grid3<T, Allocator>::~Grid3() {
+    release();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+void Grid3<T, Allocator>::allocate(
+        uint32 width,
+        uint32 height,
+        uint32 depth,
+        const GridLayout & layout
+) {
+    m_width = width;
+    m_height = height;
+    m_depth = depth;
+    m_layout = layout;
+
+    // Rows are laid out exactly as in a row-major Grid, and slices are stacked
+    // height + 2 * border rows apart.
+    RowMajorLayout rows;
+    size_t sliceSize = rows.setup(width, height, layout.border, layout.alignRows,
+            sizeof(T));
+    m_pitch = rows.pitch();
+    m_slicePitch = sliceSize;
+
+    m_storageSize = sliceSize * (depth + 2 * layout.border);
+    if (width == 0 || height == 0 || depth == 0) {
+        m_storageSize = 0;
+    }
+    if (m_storageSize == 0) {
+        m_storage = nullptr;
+        m_data = nullptr;
+        return;
+    }
+
+    m_storage = m_allocator.allocate(m_storageSize);
+    for (size_t i(0); i < m_storageSize; ++i) {
+        ::new (static_cast<void *>(m_storage + i)) T;
+    }
+    m_data = m_storage + size_t(layout.border) * m_slicePitch + rows.first();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+void Grid3<T, Allocator>::release() {
+    if (m_storage != nullptr) {
+        for (size_t i(0); i < m_storageSize; ++i) {
+            m_storage[i].~T();
+        }
+        m_allocator.deallocate(m_storage, m_storageSize);
+    }
+
+    m_storage = nullptr;
+    m_data = nullptr;
+    m_storageSize = 0;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+uint32 Grid3<T, Allocator>::width() const {
+    return m_width;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+uint32 Grid3<T, Allocator>::height() const {
+    return m_height;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+uint32 Grid3<T, Allocator>::depth() const {
+    return m_depth;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+vec3 Grid3<T, Allocator>::origin() const {
+    return m_origin;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+float32 Grid3<T, Allocator>::cellLength() const {
+    return m_cellLength;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+GridSpec3 Grid3<T, Allocator>::gridSpec() const {
+    GridSpec3 gridSpec = {
+            m_width,
+            m_height,
+            m_depth,
+            m_cellLength,
+            m_origin
+    };
+
+    return gridSpec;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+GridLayout Grid3<T, Allocator>::layout() const {
+    return m_layout;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+uint32 Grid3<T, Allocator>::pitch() const {
+    return m_pitch;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+size_t Grid3<T, Allocator>::slicePitch() const {
+    return m_slicePitch;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+uint32 Grid3<T, Allocator>::border() const {
+    return m_layout.border;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+vec3 Grid3<T, Allocator>::getPosition(uint32 col, uint32 row, uint32 layer) const {
+    return m_origin + vec3(col, row, layer) * m_cellLength;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+bool Grid3<T, Allocator>::isValidCoord(int32 col, int32 row, int32 layer) const {
+    return (col > -1) && (col < int32(m_width)) &&
+           (row > -1) && (row < int32(m_height)) &&
+           (layer > -1) && (layer < int32(m_depth));
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+T & Grid3<T, Allocator>::operator () (uint32 col, uint32 row, uint32 layer) const {
+    assert(isValidCoord(col, row, layer));
+
+    return m_data[layer * m_slicePitch + size_t(row) * m_pitch + col];
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+T & Grid3<T, Allocator>::at(int32 col, int32 row, int32 layer) const {
+    assert(col >= -int32(m_layout.border) && col < int32(m_width + m_layout.border) &&
+           row >= -int32(m_layout.border) && row < int32(m_height + m_layout.border) &&
+           layer >= -int32(m_layout.border) && layer < int32(m_depth + m_layout.border));
+
+    return m_data[std::ptrdiff_t(layer) * std::ptrdiff_t(m_slicePitch) +
+            std::ptrdiff_t(row) * m_pitch + col];
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+Grid3<T, Allocator> & Grid3<T, Allocator>::operator = (Grid3 && other) {
+    if (this == &other)
+        return *this;
+
+    release();
+
+    m_allocator = std::move(other.m_allocator);
+    m_storage = other.m_storage;
+    m_data = other.m_data;
+    m_storageSize = other.m_storageSize;
+    m_width = other.m_width;
+    m_height = other.m_height;
+    m_depth = other.m_depth;
+    m_pitch = other.m_pitch;
+    m_slicePitch = other.m_slicePitch;
+    m_layout = other.m_layout;
+    m_cellLength = other.m_cellLength;
+    m_origin = other.m_origin;
+
+    other.m_storage = nullptr;
+    other.m_data = nullptr;
+    other.m_storageSize = 0;
+    other.m_width = 0;
+    other.m_height = 0;
+    other.m_depth = 0;
+
+    return *this;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+Grid3<T, Allocator> & Grid3<T, Allocator>::operator = (const Grid3 & other) {
+    if (this == &other)
+        return *this;
+
+    //-- Allocate new memory only if there is a difference between Grid3 sizes:
+    if (m_width != other.m_width || m_height != other.m_height ||
+        m_depth != other.m_depth || m_layout != other.m_layout)
+    {
+        release();
+        allocate(other.m_width, other.m_height, other.m_depth, other.m_layout);
+    }
+
+    m_cellLength = other.m_cellLength;
+    m_origin = other.m_origin;
+
+    // Perform deep copy of data, border and padding included.
+    std::copy(other.m_storage, other.m_storage + m_storageSize, m_storage);
+
+    return *this;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+void Grid3<T, Allocator>::setAll(const T & val) {
+    std::fill(m_storage, m_storage + m_storageSize, val);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+void Grid3<T, Allocator>::fillBorder(BorderPolicy policy) {
+    const int32 border = int32(m_layout.border);
+    const int32 width = int32(m_width);
+    const int32 height = int32(m_height);
+    const int32 depth = int32(m_depth);
+    if (border == 0 || m_storage == nullptr) {
+        return;
+    }
+
+    auto fill = [&] (int32 col, int32 row, int32 layer,
+            int32 srcCol, int32 srcRow, int32 srcLayer)
+    {
+        at(col,row,layer) = (policy == BorderPolicy::Zero) ?
+                T(0) : at(srcCol,srcRow,srcLayer);
+    };
+
+    for (int32 i(1); i <= border; ++i) {
+        //-- Left and right of each grid row.
+        for (int32 layer(0); layer < depth; ++layer) {
+            for (int32 row(0); row < height; ++row) {
+                const int32 cols[2] = { -i, width - 1 + i };
+                for (int32 col : cols) {
+                    fill(col, row, layer,
+                            borderSource(col, width, policy), row, layer);
+                }
+            }
+        }
+    }
+
+    for (int32 i(1); i <= border; ++i) {
+        //-- Whole rows below and above each grid layer.
+        for (int32 layer(0); layer < depth; ++layer) {
+            const int32 rows[2] = { -i, height - 1 + i };
+            for (int32 row : rows) {
+                const int32 srcRow = borderSource(row, height, policy);
+                for (int32 col(-border); col < width + border; ++col) {
+                    fill(col, row, layer, col, srcRow, layer);
+                }
+            }
+        }
+    }
+
+    for (int32 i(1); i <= border; ++i) {
+        //-- Whole layers in front of and behind the grid.
+        const int32 layers[2] = { -i, depth - 1 + i };
+        for (int32 layer : layers) {
+            const int32 srcLayer = borderSource(layer, depth, policy);
+            for (int32 row(-border); row < height + border; ++row) {
+                for (int32 col(-border); col < width + border; ++col) {
+                    fill(col, row, layer, col, row, srcLayer);
+                }
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+void Grid3<T, Allocator>::swap(Grid3 & other) {
+    std::swap(m_allocator, other.m_allocator);
+    std::swap(m_storage, other.m_storage);
+    std::swap(m_data, other.m_data);
+    std::swap(m_storageSize, other.m_storageSize);
+    std::swap(m_width, other.m_width);
+    std::swap(m_height, other.m_height);
+    std::swap(m_depth, other.m_depth);
+    std::swap(m_pitch, other.m_pitch);
+    std::swap(m_slicePitch, other.m_slicePitch);
+    std::swap(m_layout, other.m_layout);
+    std::swap(m_cellLength, other.m_cellLength);
+    std::swap(m_origin, other.m_origin);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+const T * Grid3<T, Allocator>::data() const {
+    return m_data;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+T * Grid3<T, Allocator>::data() {
+    return m_data;
+}
+
+} // end namespace FluidSim
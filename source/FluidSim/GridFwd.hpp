@@ -0,0 +1,22 @@
+/**
+* GridFwd.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/AlignedAllocator.hpp"
+
+// Forward Declarations, carrying the default allocators and cell layout.
+namespace FluidSim {
+	class RowMajorLayout;
+
+	template <typename T,
+	          typename Allocator = AlignedAllocator<T>,
+	          typename Layout = RowMajorLayout>
+	class Grid;
+
+	template <typename T, typename Allocator = AlignedAllocator<T>>
+	class Grid3;
+}
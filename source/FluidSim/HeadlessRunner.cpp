@@ -0,0 +1,122 @@
+// HeadlessRunner.cpp
+
+#include "HeadlessRunner.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+using namespace FluidSim;
+
+
+namespace {  // limit visibility to this file.
+
+//---------------------------------------------------------------------------------------
+double secondsSince(const std::chrono::steady_clock::time_point & start) {
+	using namespace std::chrono;
+	return duration_cast<duration<double> >(steady_clock::now() - start).count();
+}
+
+//---------------------------------------------------------------------------------------
+std::string fieldFileName(const std::string & prefix, const FieldView & field,
+		uint32 frame)
+{
+	char frameString[16];
+	snprintf(frameString, sizeof(frameString), "%06u", frame);
+
+	return prefix + field.name + "." + frameString + ".raw";
+}
+
+//---------------------------------------------------------------------------------------
+void writeField(const FieldView & field, const std::string & fileName,
+		std::vector<float32> & row)
+{
+	std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary);
+	if (!file) {
+		throw FluidSim::Exception("Unable to open " + fileName + " for writing.");
+	}
+
+	// Rows are packed into a contiguous buffer, dropping padding and any
+	// interleaved data between elements.
+	row.resize(size_t(field.width) * field.components);
+	for (uint32 z(0); z < field.depth; ++z) {
+		for (uint32 y(0); y < field.height; ++y) {
+			const float32 * src = field.data + z * field.slicePitch + y * field.rowPitch;
+			for (uint32 x(0); x < field.width; ++x) {
+				std::copy(src, src + field.components, &row[size_t(x) * field.components]);
+				src += field.elementStride;
+			}
+			file.write(reinterpret_cast<const char *>(row.data()),
+					std::streamsize(row.size() * sizeof(float32)));
+		}
+	}
+
+	if (!file) {
+		throw FluidSim::Exception("Unable to write " + fileName + ".");
+	}
+}
+
+} // end namespace
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+HeadlessSettings::HeadlessSettings(uint32 frames, float32 dt)
+	: frames(frames),
+	  dt(dt),
+	  outputPrefix(),
+	  outputInterval(1)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+double HeadlessResult::framesPerSecond() const {
+	return (stepSeconds > 0.0) ? frames / stepSeconds : 0.0;
+}
+
+//---------------------------------------------------------------------------------------
+HeadlessResult runHeadless(Simulation & simulation, const HeadlessSettings & settings) {
+	using namespace std::chrono;
+
+	HeadlessResult result = HeadlessResult();
+	const bool writeOutput = !settings.outputPrefix.empty();
+	const uint32 interval = std::max(1u, settings.outputInterval);
+
+	steady_clock::time_point start = steady_clock::now();
+	simulation.init();
+	result.stepSeconds += secondsSince(start);
+
+	for (uint32 frame(1); frame <= settings.frames; ++frame) {
+		start = steady_clock::now();
+		simulation.step(settings.dt);
+		result.stepSeconds += secondsSince(start);
+		++result.frames;
+
+		if (writeOutput && frame % interval == 0) {
+			start = steady_clock::now();
+			writeFields(simulation.fields(), settings.outputPrefix, frame);
+			result.outputSeconds += secondsSince(start);
+			++result.framesWritten;
+		}
+	}
+
+	return result;
+}
+
+//---------------------------------------------------------------------------------------
+void writeFields(
+		const std::vector<FieldView> & fields,
+		const std::string & prefix,
+		uint32 frame
+) {
+	std::vector<float32> row;
+	for (const FieldView & field : fields) {
+		writeField(field, fieldFileName(prefix, field, frame), row);
+	}
+}
+
+} // end namespace FluidSim
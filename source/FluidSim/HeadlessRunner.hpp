@@ -0,0 +1,62 @@
+/**
+* HeadlessRunner.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Simulation.hpp"
+
+#include <string>
+#include <vector>
+
+namespace FluidSim {
+
+/// Options for runHeadless().
+struct HeadlessSettings {
+    uint32 frames;        // Number of calls to Simulation::step().
+    float32 dt;           // Seconds passed to each step.
+
+    /// Path prefix of output files, see writeFields().  Empty disables output.
+    std::string outputPrefix;
+
+    /// Fields are written after every outputInterval-th frame.
+    uint32 outputInterval;
+
+    HeadlessSettings(uint32 frames = 100, float32 dt = 0.01f);
+};
+
+/// Outcome of runHeadless().
+struct HeadlessResult {
+    uint32 frames;         // Frames stepped.
+    uint32 framesWritten;  // Frames whose fields were written.
+    double stepSeconds;    // Wall time spent in init() and step().
+    double outputSeconds;  // Wall time spent writing fields.
+
+    /// Simulated frames per second of wall time, excluding output.
+    double framesPerSecond() const;
+};
+
+/**
+* Calls \c simulation.init(), then steps it \c settings.frames times back to
+* back, with no frame limiter, window or OpenGL context.  If
+* \c settings.outputPrefix is set, the fields of every
+* \c settings.outputInterval-th frame are written with writeFields().
+*/
+HeadlessResult runHeadless(Simulation & simulation, const HeadlessSettings & settings);
+
+/**
+* Writes each field to the file \c prefix + name + "." + frame + ".raw", with the
+* frame number zero padded to six digits.  Files hold the field's elements as
+* raw native endian float32s, components interleaved, x varying fastest, then y,
+* then z.  Throws a FluidSim::Exception if a file can not be written.
+*/
+void writeFields(
+        const std::vector<FieldView> & fields,
+        const std::string & prefix,
+        uint32 frame
+);
+
+} // end namespace FluidSim
@@ -0,0 +1,490 @@
+// Interp.cpp
+
+#include "Interp.hpp"
+#include "FluidSim/Grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// The SIMD kernels are compiled for their instruction sets with target
+// attributes, whatever the library's own flags, and picked at run time from
+// the instructions the CPU supports.  Other compilers use the scalar loops.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define FLUIDSIM_SIMD_DISPATCH 1
+#include <immintrin.h>
+#define FLUIDSIM_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+using namespace FluidSim;
+
+
+namespace {  // limit visibility to this file.
+
+// Number of AoS positions de-interleaved per call to the SoA kernel.
+const uint32 kPositionChunkSize = 256;
+
+//---------------------------------------------------------------------------------------
+// Grid layout values shared by the scalar and SIMD kernels.
+struct BilinearParams {
+	const float32 * data;
+	int32 pitch; // Elements between rows of data.
+	float32 originX;
+	float32 originY;
+	float32 cellLength;
+	float32 minX; // Smallest sampled grid x-coordinate, -border.
+	float32 minY; // Smallest sampled grid y-coordinate, -border.
+	float32 maxX; // Largest sampled grid x-coordinate, width - 1 + border.
+	float32 maxY; // Largest sampled grid y-coordinate, height - 1 + border.
+	int32 maxCol; // Column of maxX.
+	int32 maxRow; // Row of maxY.
+
+	explicit BilinearParams(const Grid<float32> & grid)
+		: data(grid.data()),
+		  pitch(int32(grid.pitch())),
+		  originX(grid.origin().x),
+		  originY(grid.origin().y),
+		  cellLength(grid.cellLength()),
+		  minX(-float32(grid.border())),
+		  minY(-float32(grid.border())),
+		  maxX(float32(grid.width() + grid.border() - 1)),
+		  maxY(float32(grid.height() + grid.border() - 1)),
+		  maxCol(int32(grid.width() + grid.border()) - 1),
+		  maxRow(int32(grid.height() + grid.border()) - 1) { }
+};
+
+//---------------------------------------------------------------------------------------
+// Single sample, using the same operation order as the SIMD kernels below so that
+// the tail of a batch matches its vectorized body.
+inline float32 bilinearSample(const BilinearParams & g, float32 px, float32 py) {
+	float32 gx = (px - g.originX) / g.cellLength;
+	float32 gy = (py - g.originY) / g.cellLength;
+
+	gx = std::min(std::max(gx, g.minX), g.maxX);
+	gy = std::min(std::max(gy, g.minY), g.maxY);
+
+	float32 x1 = std::floor(gx);
+	float32 y1 = std::floor(gy);
+	float32 a = gx - x1;
+	float32 b = gy - y1;
+
+	int32 i1 = int32(x1);
+	int32 j1 = int32(y1);
+	int32 i2 = std::min(i1 + 1, g.maxCol);
+	int32 j2 = std::min(j1 + 1, g.maxRow);
+
+	const float32 * row1 = g.data + j1 * g.pitch;
+	const float32 * row2 = g.data + j2 * g.pitch;
+
+	float32 fR1 = (1.0f - a) * row1[i1] + a * row1[i2];
+	float32 fR2 = (1.0f - a) * row2[i1] + a * row2[i2];
+
+	return (1.0f - b) * fR1 + b * fR2;
+}
+
+// Batched kernel that processes as many samples as fill its registers, and
+// returns the number processed.  The caller finishes the rest with scalar code.
+typedef uint32 (*SimdKernel)(const BilinearParams & g, const float32 * x,
+		const float32 * y, float32 * result, uint32 count);
+
+//---------------------------------------------------------------------------------------
+// Kernel for CPUs without any of the instruction sets below.
+uint32 scalarOnly(
+		const BilinearParams &,
+		const float32 *,
+		const float32 *,
+		float32 *,
+		uint32
+) {
+	return 0;
+}
+
+#if defined(FLUIDSIM_SIMD_DISPATCH)
+//---------------------------------------------------------------------------------------
+// Processes samples 8 at a time. Returns the number of samples processed.
+FLUIDSIM_TARGET("avx2")
+uint32 bilinearAvx2(
+		const BilinearParams & g,
+		const float32 * x,
+		const float32 * y,
+		float32 * result,
+		uint32 count
+) {
+	const __m256 originX = _mm256_set1_ps(g.originX);
+	const __m256 originY = _mm256_set1_ps(g.originY);
+	const __m256 cellLength = _mm256_set1_ps(g.cellLength);
+	const __m256 minX = _mm256_set1_ps(g.minX);
+	const __m256 minY = _mm256_set1_ps(g.minY);
+	const __m256 maxX = _mm256_set1_ps(g.maxX);
+	const __m256 maxY = _mm256_set1_ps(g.maxY);
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	const __m256i pitch = _mm256_set1_epi32(g.pitch);
+	const __m256i maxCol = _mm256_set1_epi32(g.maxCol);
+	const __m256i maxRow = _mm256_set1_epi32(g.maxRow);
+	const __m256i oneI = _mm256_set1_epi32(1);
+
+	uint32 i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 gx = _mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), originX),
+				cellLength);
+		__m256 gy = _mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(y + i), originY),
+				cellLength);
+
+		gx = _mm256_min_ps(_mm256_max_ps(gx, minX), maxX);
+		gy = _mm256_min_ps(_mm256_max_ps(gy, minY), maxY);
+
+		__m256 x1 = _mm256_floor_ps(gx);
+		__m256 y1 = _mm256_floor_ps(gy);
+		__m256 a = _mm256_sub_ps(gx, x1);
+		__m256 b = _mm256_sub_ps(gy, y1);
+
+		__m256i i1 = _mm256_cvttps_epi32(x1);
+		__m256i j1 = _mm256_cvttps_epi32(y1);
+		__m256i i2 = _mm256_min_epi32(_mm256_add_epi32(i1, oneI), maxCol);
+		__m256i j2 = _mm256_min_epi32(_mm256_add_epi32(j1, oneI), maxRow);
+
+		__m256i row1 = _mm256_mullo_epi32(j1, pitch);
+		__m256i row2 = _mm256_mullo_epi32(j2, pitch);
+
+		__m256 f11 = _mm256_i32gather_ps(g.data, _mm256_add_epi32(row1, i1), 4);
+		__m256 f21 = _mm256_i32gather_ps(g.data, _mm256_add_epi32(row1, i2), 4);
+		__m256 f12 = _mm256_i32gather_ps(g.data, _mm256_add_epi32(row2, i1), 4);
+		__m256 f22 = _mm256_i32gather_ps(g.data, _mm256_add_epi32(row2, i2), 4);
+
+		__m256 oneMinusA = _mm256_sub_ps(one, a);
+		__m256 fR1 = _mm256_add_ps(_mm256_mul_ps(oneMinusA, f11), _mm256_mul_ps(a, f21));
+		__m256 fR2 = _mm256_add_ps(_mm256_mul_ps(oneMinusA, f12), _mm256_mul_ps(a, f22));
+
+		__m256 value = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, b), fR1),
+				_mm256_mul_ps(b, fR2));
+
+		_mm256_storeu_ps(result + i, value);
+	}
+
+	return i;
+}
+
+//---------------------------------------------------------------------------------------
+// Processes samples 4 at a time. Returns the number of samples processed.
+FLUIDSIM_TARGET("sse4.1")
+uint32 bilinearSse41(
+		const BilinearParams & g,
+		const float32 * x,
+		const float32 * y,
+		float32 * result,
+		uint32 count
+) {
+	const __m128 originX = _mm_set1_ps(g.originX);
+	const __m128 originY = _mm_set1_ps(g.originY);
+	const __m128 cellLength = _mm_set1_ps(g.cellLength);
+	const __m128 minX = _mm_set1_ps(g.minX);
+	const __m128 minY = _mm_set1_ps(g.minY);
+	const __m128 maxX = _mm_set1_ps(g.maxX);
+	const __m128 maxY = _mm_set1_ps(g.maxY);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	const __m128i pitch = _mm_set1_epi32(g.pitch);
+	const __m128i maxCol = _mm_set1_epi32(g.maxCol);
+	const __m128i maxRow = _mm_set1_epi32(g.maxRow);
+	const __m128i oneI = _mm_set1_epi32(1);
+
+	// SSE has no gather instruction, so indices are spilled and loaded individually.
+	alignas(16) int32 index11[4], index21[4], index12[4], index22[4];
+
+	uint32 i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 gx = _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(x + i), originX), cellLength);
+		__m128 gy = _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(y + i), originY), cellLength);
+
+		gx = _mm_min_ps(_mm_max_ps(gx, minX), maxX);
+		gy = _mm_min_ps(_mm_max_ps(gy, minY), maxY);
+
+		__m128 x1 = _mm_floor_ps(gx);
+		__m128 y1 = _mm_floor_ps(gy);
+		__m128 a = _mm_sub_ps(gx, x1);
+		__m128 b = _mm_sub_ps(gy, y1);
+
+		__m128i i1 = _mm_cvttps_epi32(x1);
+		__m128i j1 = _mm_cvttps_epi32(y1);
+		__m128i i2 = _mm_min_epi32(_mm_add_epi32(i1, oneI), maxCol);
+		__m128i j2 = _mm_min_epi32(_mm_add_epi32(j1, oneI), maxRow);
+
+		__m128i row1 = _mm_mullo_epi32(j1, pitch);
+		__m128i row2 = _mm_mullo_epi32(j2, pitch);
+
+		_mm_store_si128((__m128i *) index11, _mm_add_epi32(row1, i1));
+		_mm_store_si128((__m128i *) index21, _mm_add_epi32(row1, i2));
+		_mm_store_si128((__m128i *) index12, _mm_add_epi32(row2, i1));
+		_mm_store_si128((__m128i *) index22, _mm_add_epi32(row2, i2));
+
+		const float32 * d = g.data;
+		__m128 f11 = _mm_set_ps(d[index11[3]], d[index11[2]], d[index11[1]], d[index11[0]]);
+		__m128 f21 = _mm_set_ps(d[index21[3]], d[index21[2]], d[index21[1]], d[index21[0]]);
+		__m128 f12 = _mm_set_ps(d[index12[3]], d[index12[2]], d[index12[1]], d[index12[0]]);
+		__m128 f22 = _mm_set_ps(d[index22[3]], d[index22[2]], d[index22[1]], d[index22[0]]);
+
+		__m128 oneMinusA = _mm_sub_ps(one, a);
+		__m128 fR1 = _mm_add_ps(_mm_mul_ps(oneMinusA, f11), _mm_mul_ps(a, f21));
+		__m128 fR2 = _mm_add_ps(_mm_mul_ps(oneMinusA, f12), _mm_mul_ps(a, f22));
+
+		__m128 value = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, b), fR1),
+				_mm_mul_ps(b, fR2));
+
+		_mm_storeu_ps(result + i, value);
+	}
+
+	return i;
+}
+#endif // FLUIDSIM_SIMD_DISPATCH
+
+//---------------------------------------------------------------------------------------
+// Scalar form of monotoneCubicSpan() in Interp.inl, written with the same operation
+// order as the AVX2 kernel below.
+inline float32 cubicSpan(float32 f0, float32 f1, float32 f2, float32 f3, float32 t) {
+	float32 delta = f2 - f1;
+	float32 limit = 3.0f * std::abs(delta);
+
+	float32 d1 = 0.5f * (f2 - f0);
+	float32 d2 = 0.5f * (f3 - f1);
+	d1 = (delta * d1 > 0.0f) ? std::min(std::max(d1, -limit), limit) : 0.0f;
+	d2 = (delta * d2 > 0.0f) ? std::min(std::max(d2, -limit), limit) : 0.0f;
+
+	float32 c2 = 3.0f * delta - 2.0f * d1 - d2;
+	float32 c3 = d1 + d2 - 2.0f * delta;
+	float32 value = f1 + t * (d1 + t * (c2 + t * c3));
+
+	return std::min(std::max(value, std::min(f1, f2)), std::max(f1, f2));
+}
+
+//---------------------------------------------------------------------------------------
+inline float32 monotoneCubicSample(const BilinearParams & g, float32 px, float32 py) {
+	float32 gx = (px - g.originX) / g.cellLength;
+	float32 gy = (py - g.originY) / g.cellLength;
+
+	gx = std::min(std::max(gx, g.minX), g.maxX);
+	gy = std::min(std::max(gy, g.minY), g.maxY);
+
+	float32 x1 = std::floor(gx);
+	float32 y1 = std::floor(gy);
+	float32 a = gx - x1;
+	float32 b = gy - y1;
+
+	const int32 minCol = int32(g.minX);
+	const int32 minRow = int32(g.minY);
+
+	int32 i1 = int32(x1);
+	int32 j1 = int32(y1);
+	int32 i0 = std::max(i1 - 1, minCol);
+	int32 i2 = std::min(i1 + 1, g.maxCol);
+	int32 i3 = std::min(i1 + 2, g.maxCol);
+	int32 j[4] = {
+		std::max(j1 - 1, minRow),
+		j1,
+		std::min(j1 + 1, g.maxRow),
+		std::min(j1 + 2, g.maxRow)
+	};
+
+	float32 rows[4];
+	for (int32 k(0); k < 4; ++k) {
+		const float32 * row = g.data + j[k] * g.pitch;
+		rows[k] = cubicSpan(row[i0], row[i1], row[i2], row[i3], a);
+	}
+
+	return cubicSpan(rows[0], rows[1], rows[2], rows[3], b);
+}
+
+#if defined(FLUIDSIM_SIMD_DISPATCH)
+//---------------------------------------------------------------------------------------
+FLUIDSIM_TARGET("avx2")
+inline __m256 cubicSpan(__m256 f0, __m256 f1, __m256 f2, __m256 f3, __m256 t) {
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 two = _mm256_set1_ps(2.0f);
+	const __m256 three = _mm256_set1_ps(3.0f);
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+	__m256 delta = _mm256_sub_ps(f2, f1);
+	__m256 limit = _mm256_mul_ps(three, _mm256_andnot_ps(signMask, delta));
+	__m256 negLimit = _mm256_xor_ps(limit, signMask);
+
+	__m256 d1 = _mm256_mul_ps(half, _mm256_sub_ps(f2, f0));
+	__m256 d2 = _mm256_mul_ps(half, _mm256_sub_ps(f3, f1));
+	__m256 keep1 = _mm256_cmp_ps(_mm256_mul_ps(delta, d1), zero, _CMP_GT_OQ);
+	__m256 keep2 = _mm256_cmp_ps(_mm256_mul_ps(delta, d2), zero, _CMP_GT_OQ);
+	d1 = _mm256_and_ps(keep1, _mm256_min_ps(_mm256_max_ps(d1, negLimit), limit));
+	d2 = _mm256_and_ps(keep2, _mm256_min_ps(_mm256_max_ps(d2, negLimit), limit));
+
+	__m256 c2 = _mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(three, delta),
+			_mm256_mul_ps(two, d1)), d2);
+	__m256 c3 = _mm256_sub_ps(_mm256_add_ps(d1, d2), _mm256_mul_ps(two, delta));
+
+	__m256 value = _mm256_add_ps(c2, _mm256_mul_ps(t, c3));
+	value = _mm256_add_ps(d1, _mm256_mul_ps(t, value));
+	value = _mm256_add_ps(f1, _mm256_mul_ps(t, value));
+
+	return _mm256_min_ps(_mm256_max_ps(value, _mm256_min_ps(f1, f2)),
+			_mm256_max_ps(f1, f2));
+}
+
+//---------------------------------------------------------------------------------------
+// Processes samples 8 at a time, with 16 gathers each. Returns the number of samples
+// processed.  Without AVX2 gathers, loading the 16 samples of each lane one at a
+// time leaves little for SSE to speed up, so there is no SSE4.1 form.
+FLUIDSIM_TARGET("avx2")
+uint32 monotoneCubicAvx2(
+		const BilinearParams & g,
+		const float32 * x,
+		const float32 * y,
+		float32 * result,
+		uint32 count
+) {
+	const __m256 originX = _mm256_set1_ps(g.originX);
+	const __m256 originY = _mm256_set1_ps(g.originY);
+	const __m256 cellLength = _mm256_set1_ps(g.cellLength);
+	const __m256 minX = _mm256_set1_ps(g.minX);
+	const __m256 minY = _mm256_set1_ps(g.minY);
+	const __m256 maxX = _mm256_set1_ps(g.maxX);
+	const __m256 maxY = _mm256_set1_ps(g.maxY);
+
+	const __m256i pitch = _mm256_set1_epi32(g.pitch);
+	const __m256i minCol = _mm256_set1_epi32(int32(g.minX));
+	const __m256i minRow = _mm256_set1_epi32(int32(g.minY));
+	const __m256i maxCol = _mm256_set1_epi32(g.maxCol);
+	const __m256i maxRow = _mm256_set1_epi32(g.maxRow);
+	const __m256i oneI = _mm256_set1_epi32(1);
+	const __m256i twoI = _mm256_set1_epi32(2);
+
+	uint32 i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 gx = _mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), originX),
+				cellLength);
+		__m256 gy = _mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(y + i), originY),
+				cellLength);
+
+		gx = _mm256_min_ps(_mm256_max_ps(gx, minX), maxX);
+		gy = _mm256_min_ps(_mm256_max_ps(gy, minY), maxY);
+
+		__m256 x1 = _mm256_floor_ps(gx);
+		__m256 y1 = _mm256_floor_ps(gy);
+		__m256 a = _mm256_sub_ps(gx, x1);
+		__m256 b = _mm256_sub_ps(gy, y1);
+
+		__m256i i1 = _mm256_cvttps_epi32(x1);
+		__m256i j1 = _mm256_cvttps_epi32(y1);
+		__m256i i0 = _mm256_max_epi32(_mm256_sub_epi32(i1, oneI), minCol);
+		__m256i i2 = _mm256_min_epi32(_mm256_add_epi32(i1, oneI), maxCol);
+		__m256i i3 = _mm256_min_epi32(_mm256_add_epi32(i1, twoI), maxCol);
+		__m256i j[4] = {
+			_mm256_max_epi32(_mm256_sub_epi32(j1, oneI), minRow),
+			j1,
+			_mm256_min_epi32(_mm256_add_epi32(j1, oneI), maxRow),
+			_mm256_min_epi32(_mm256_add_epi32(j1, twoI), maxRow)
+		};
+
+		__m256 rows[4];
+		for (int32 k(0); k < 4; ++k) {
+			__m256i row = _mm256_mullo_epi32(j[k], pitch);
+			__m256 f0 = _mm256_i32gather_ps(g.data, _mm256_add_epi32(row, i0), 4);
+			__m256 f1 = _mm256_i32gather_ps(g.data, _mm256_add_epi32(row, i1), 4);
+			__m256 f2 = _mm256_i32gather_ps(g.data, _mm256_add_epi32(row, i2), 4);
+			__m256 f3 = _mm256_i32gather_ps(g.data, _mm256_add_epi32(row, i3), 4);
+			rows[k] = cubicSpan(f0, f1, f2, f3, a);
+		}
+
+		_mm256_storeu_ps(result + i, cubicSpan(rows[0], rows[1], rows[2], rows[3], b));
+	}
+
+	return i;
+}
+#endif // FLUIDSIM_SIMD_DISPATCH
+
+//---------------------------------------------------------------------------------------
+// Widest kernel that the CPU running the library supports.
+SimdKernel selectBilinearKernel() {
+#if defined(FLUIDSIM_SIMD_DISPATCH)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return bilinearAvx2;
+	} else if (__builtin_cpu_supports("sse4.1")) {
+		return bilinearSse41;
+	}
+#endif
+	return scalarOnly;
+}
+
+//---------------------------------------------------------------------------------------
+SimdKernel selectMonotoneCubicKernel() {
+#if defined(FLUIDSIM_SIMD_DISPATCH)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return monotoneCubicAvx2;
+	}
+#endif
+	return scalarOnly;
+}
+
+} // end namespace
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+void bilinear(
+		const Grid<float32> & grid,
+		const float32 * x,
+		const float32 * y,
+		float32 * result,
+		uint32 count
+) {
+	static const SimdKernel bilinearSimd = selectBilinearKernel();
+	const BilinearParams params(grid);
+
+	uint32 i = bilinearSimd(params, x, y, result, count);
+
+	// Remaining samples that do not fill a SIMD register.
+	for (; i < count; ++i) {
+		result[i] = bilinearSample(params, x[i], y[i]);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void bilinear(
+		const Grid<float32> & grid,
+		const vec2 * positions,
+		float32 * result,
+		uint32 count
+) {
+	float32 x[kPositionChunkSize];
+	float32 y[kPositionChunkSize];
+
+	for (uint32 begin(0); begin < count; begin += kPositionChunkSize) {
+		uint32 chunkSize = std::min(kPositionChunkSize, count - begin);
+
+		for (uint32 i(0); i < chunkSize; ++i) {
+			x[i] = positions[begin + i].x;
+			y[i] = positions[begin + i].y;
+		}
+
+		bilinear(grid, x, y, result + begin, chunkSize);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void monotoneCubic(
+		const Grid<float32> & grid,
+		const float32 * x,
+		const float32 * y,
+		float32 * result,
+		uint32 count
+) {
+	static const SimdKernel monotoneCubicSimd = selectMonotoneCubicKernel();
+	const BilinearParams params(grid);
+
+	uint32 i = monotoneCubicSimd(params, x, y, result, count);
+
+	for (; i < count; ++i) {
+		result[i] = monotoneCubicSample(params, x[i], y[i]);
+	}
+}
+
+} // end namespace FluidSim
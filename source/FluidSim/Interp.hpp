@@ -7,24 +7,137 @@
 #pragma once
 
 #include "NumericTypes.hpp"
+#include "GridFwd.hpp"
 
 // Forward Declaration
 namespace FluidSim {
-	template <typename T> class Grid;
 	template <typename T> class StaggeredGrid;
+	template <typename T> class StaggeredGrid3;
 }
 
 
 namespace FluidSim {
 
-    template <typename T>
-    T bilinear(const Grid<T> & grid, const vec2 & worldPos);
+    /**
+    * Bilinear interpolation of \c grid at \c worldPos.  Positions outside the
+    * grid are clamped to its edge cells, or to the outermost border cells if the
+    * grid has a border, in which case the border should be up to date (see
+    * Grid::fillBorder()).
+    */
+    template <typename T, typename Allocator, typename Layout>
+    T bilinear(const Grid<T, Allocator, Layout> & grid, const vec2 & worldPos);
 
 
     template <typename T>
     tvec2<T> bilinear(const StaggeredGrid<T> & grid, const vec2 & worldPos);
 
 
+    /**
+    * Smallest and largest of the four samples that bilinear(grid, worldPos)
+    * blends, written to \c minValue and \c maxValue.  Used to limit higher
+    * order advection schemes to values the grid already holds near
+    * \c worldPos.
+    */
+    template <typename T, typename Allocator, typename Layout>
+    void bilinearMinMax(const Grid<T, Allocator, Layout> & grid, const vec2 & worldPos,
+            T & minValue, T & maxValue);
+
+
+    /**
+    * Monotone cubic interpolation of \c grid at \c worldPos, from the 4x4 cells
+    * around it.  Each axis is a Catmull-Rom spline whose slopes are limited as in
+    * Fritsch-Carlson, so the result never leaves the range of the four samples
+    * that bilinear(grid, worldPos) blends, and bilinearMinMax() bounds it.
+    * Linear fields are reproduced exactly away from the grid edges.  Positions
+    * are clamped as in bilinear(), and the stencil is clamped to the same cells.
+    * T must be a floating point scalar.
+    */
+    template <typename T, typename Allocator, typename Layout>
+    T monotoneCubic(const Grid<T, Allocator, Layout> & grid, const vec2 & worldPos);
+
+
+    template <typename T>
+    tvec2<T> monotoneCubic(const StaggeredGrid<T> & grid, const vec2 & worldPos);
+
+
+    /**
+    * Interpolation policies, passed as template arguments to advect() and
+    * advectMacCormack() so that the sampling scheme is chosen at compile time
+    * and inlined, where an interpFunc<T> would be an indirect call per sample.
+    */
+    struct BilinearInterp {
+        template <typename T, typename Allocator, typename Layout>
+        static T sample(const Grid<T, Allocator, Layout> & grid, const vec2 & worldPos) {
+            return bilinear(grid, worldPos);
+        }
+    };
+
+    struct MonotoneCubicInterp {
+        template <typename T, typename Allocator, typename Layout>
+        static T sample(const Grid<T, Allocator, Layout> & grid, const vec2 & worldPos) {
+            return monotoneCubic(grid, worldPos);
+        }
+    };
+
+
+	/**
+	* Batched bilinear interpolation of \c grid at \c count world positions, given in
+	* structure-of-arrays form as \c x[i], \c y[i].  Interpolated values are written
+	* to \c result[i].
+	*
+	* Positions are clamped to the grid exactly as in bilinear(grid, worldPos), but
+	* arithmetic is done in single precision.  The kernel is chosen at run time
+	* from what the CPU supports: 8 samples at a time with AVX2, 4 with SSE4.1, or
+	* one at a time otherwise.
+	*/
+	void bilinear(
+			const Grid<float32> & grid,
+			const float32 * x,
+			const float32 * y,
+			float32 * result,
+			uint32 count
+	);
+
+
+	/// Batched bilinear interpolation of \c grid at the \c count world positions
+	/// \c positions[i], written to \c result[i].
+	void bilinear(
+			const Grid<float32> & grid,
+			const vec2 * positions,
+			float32 * result,
+			uint32 count
+	);
+
+
+	/**
+	* Batched monotoneCubic() interpolation of \c grid at \c count world positions,
+	* given in structure-of-arrays form as \c x[i], \c y[i], and written to
+	* \c result[i].  Arithmetic is done in single precision, 8 samples at a time
+	* when the CPU supports AVX2, which is checked at run time.
+	*/
+	void monotoneCubic(
+			const Grid<float32> & grid,
+			const float32 * x,
+			const float32 * y,
+			float32 * result,
+			uint32 count
+	);
+
+
+	/**
+	* Trilinear interpolation of \c grid at \c worldPos, clamped to the grid, or
+	* to its border cells if it has a border, as in bilinear().  Weights are
+	* computed in single precision.
+	*/
+	template <typename T, typename Allocator>
+	T trilinear(const Grid3<T, Allocator> & grid, const vec3 & worldPos);
+
+
+	/// Trilinear interpolation of each component of \c grid at \c worldPos.
+	template <typename T>
+	tvec3<T> trilinear(const StaggeredGrid3<T> & grid, const vec3 & worldPos);
+
+
 	inline float32 linear(const vec2 & x, float32 h);
 }
 
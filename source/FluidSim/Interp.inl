@@ -1,6 +1,11 @@
 #include "Interp.hpp"
 #include "FluidSim/Grid.hpp"
 #include "FluidSim/StaggeredGrid.hpp"
+#include "FluidSim/Grid3.hpp"
+#include "FluidSim/StaggeredGrid3.hpp"
+
+#include <algorithm>
+#include <cstddef>
 
 #include <cmath>
 
@@ -10,13 +15,14 @@ using glm::clamp;
 namespace FluidSim {
 
 //----------------------------------------------------------------------------------------
-template <typename T>
-T bilinear(const Grid<T> & grid, const vec2 & worldPos) {
+template <typename T, typename Allocator, typename Layout>
+T bilinear(const Grid<T, Allocator, Layout> & grid, const vec2 & worldPos) {
     dvec2 gridCoords = dvec2(worldPos - grid.origin()) / double(grid.cellLength());
 
-    // Clamp gridCoords to be within valid grid coordinate range.
-	glm::dvec2 p = glm::clamp(glm::dvec2(gridCoords),
-			dvec2(0,0), dvec2(grid.width()-1, grid.height()-1));
+    // Clamp gridCoords to the grid, extended by any border cells.
+    double border = double(grid.border());
+	glm::dvec2 p = glm::clamp(glm::dvec2(gridCoords), dvec2(-border, -border),
+			dvec2(grid.width()-1, grid.height()-1) + border);
 
     double x1 = floor(p.x);
     double x2 = ceil(p.x);
@@ -27,13 +33,13 @@ T bilinear(const Grid<T> & grid, const vec2 & worldPos) {
     double a = (p.x - x1);
     double b = (p.y - y1);
 
-	uint32 ux1 = uint32(x1);
-	uint32 ux2 = uint32(x2);
-	uint32 uy1 = uint32(y1);
-	uint32 uy2 = uint32(y2);
+	int32 ix1 = int32(x1);
+	int32 ix2 = int32(x2);
+	int32 iy1 = int32(y1);
+	int32 iy2 = int32(y2);
 
-    T fR1( (1.0f - a) * grid(ux1,uy1) + a * grid(ux2,uy1) );
-    T fR2( (1.0f - a) * grid(ux1,uy2) + a * grid(ux2,uy2) );
+    T fR1( (1.0f - a) * grid.at(ix1,iy1) + a * grid.at(ix2,iy1) );
+    T fR2( (1.0f - a) * grid.at(ix1,iy2) + a * grid.at(ix2,iy2) );
 
     return (1 - b)*fR1 + b*fR2;
 }
@@ -48,6 +54,143 @@ tvec2<T> bilinear(const StaggeredGrid<T> & grid, const vec2 & worldPos) {
     return tvec2<T>(uValue,vValue);
 }
 
+//----------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+void bilinearMinMax(const Grid<T, Allocator, Layout> & grid, const vec2 & worldPos,
+        T & minValue, T & maxValue)
+{
+    // Same cell selection as bilinear().
+    dvec2 gridCoords = dvec2(worldPos - grid.origin()) / double(grid.cellLength());
+    double border = double(grid.border());
+    dvec2 p = glm::clamp(gridCoords, dvec2(-border, -border),
+            dvec2(grid.width()-1, grid.height()-1) + border);
+
+    int32 ix1 = int32(floor(p.x));
+    int32 ix2 = int32(ceil(p.x));
+    int32 iy1 = int32(floor(p.y));
+    int32 iy2 = int32(ceil(p.y));
+
+    const T & a = grid.at(ix1,iy1);
+    const T & b = grid.at(ix2,iy1);
+    const T & c = grid.at(ix1,iy2);
+    const T & d = grid.at(ix2,iy2);
+
+    minValue = std::min(std::min(a, b), std::min(c, d));
+    maxValue = std::max(std::max(a, b), std::max(c, d));
+}
+
+//----------------------------------------------------------------------------------------
+// Cubic Hermite interpolation between f1 and f2, at 0 <= t <= 1, with Catmull-Rom
+// slopes limited so that the curve stays within [f1, f2].  Slopes of the wrong
+// sign are zeroed, and the rest are limited to 3 * |f2 - f1| (Fritsch-Carlson).
+template <typename T>
+static inline T monotoneCubicSpan(T f0, T f1, T f2, T f3, float32 t) {
+    T delta = f2 - f1;
+    T limit = 3.0f * std::abs(delta);
+
+    T d1 = 0.5f * (f2 - f0);
+    T d2 = 0.5f * (f3 - f1);
+    d1 = (delta * d1 > T(0)) ? std::min(std::max(d1, -limit), limit) : T(0);
+    d2 = (delta * d2 > T(0)) ? std::min(std::max(d2, -limit), limit) : T(0);
+
+    T c2 = 3.0f * delta - 2.0f * d1 - d2;
+    T c3 = d1 + d2 - 2.0f * delta;
+    T value = f1 + t * (d1 + t * (c2 + t * c3));
+
+    // Rounding can leave the polynomial an ulp outside [f1, f2].
+    return std::min(std::max(value, std::min(f1, f2)), std::max(f1, f2));
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T, typename Allocator, typename Layout>
+T monotoneCubic(const Grid<T, Allocator, Layout> & grid, const vec2 & worldPos) {
+    // Same cell selection as bilinear().
+    dvec2 gridCoords = dvec2(worldPos - grid.origin()) / double(grid.cellLength());
+    double border = double(grid.border());
+    dvec2 p = glm::clamp(gridCoords, dvec2(-border, -border),
+            dvec2(grid.width()-1, grid.height()-1) + border);
+
+    double x1 = floor(p.x);
+    double y1 = floor(p.y);
+    float32 a = float32(p.x - x1);
+    float32 b = float32(p.y - y1);
+
+    const int32 minCell = -int32(grid.border());
+    const int32 maxCol = int32(grid.width() + grid.border()) - 1;
+    const int32 maxRow = int32(grid.height() + grid.border()) - 1;
+
+    int32 i[4], j[4];
+    i[1] = int32(x1);
+    j[1] = int32(y1);
+    i[0] = std::max(i[1] - 1, minCell);
+    j[0] = std::max(j[1] - 1, minCell);
+    i[2] = std::min(i[1] + 1, maxCol);
+    j[2] = std::min(j[1] + 1, maxRow);
+    i[3] = std::min(i[1] + 2, maxCol);
+    j[3] = std::min(j[1] + 2, maxRow);
+
+    T rows[4];
+    for (int32 k(0); k < 4; ++k) {
+        rows[k] = monotoneCubicSpan(grid.at(i[0],j[k]), grid.at(i[1],j[k]),
+                grid.at(i[2],j[k]), grid.at(i[3],j[k]), a);
+    }
+
+    return monotoneCubicSpan(rows[0], rows[1], rows[2], rows[3], b);
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+tvec2<T> monotoneCubic(const StaggeredGrid<T> & grid, const vec2 & worldPos) {
+    return tvec2<T>(monotoneCubic(grid.u, worldPos), monotoneCubic(grid.v, worldPos));
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T, typename Allocator>
+T trilinear(const Grid3<T, Allocator> & grid, const vec3 & worldPos) {
+    const int32 border = int32(grid.border());
+    const int32 maxCol = int32(grid.width()) - 1 + border;
+    const int32 maxRow = int32(grid.height()) - 1 + border;
+    const int32 maxLayer = int32(grid.depth()) - 1 + border;
+
+    vec3 p = (worldPos - grid.origin()) / grid.cellLength();
+    p = glm::clamp(p, vec3(-float32(border)),
+            vec3(float32(maxCol), float32(maxRow), float32(maxLayer)));
+
+    vec3 p0 = glm::floor(p);
+    vec3 f = p - p0;
+
+    int32 i = int32(p0.x);
+    int32 j = int32(p0.y);
+    int32 k = int32(p0.z);
+
+    // Offsets to the upper neighbors, which collapse onto the lower ones for
+    // samples on the last plane of the grid.
+    std::ptrdiff_t di = (i < maxCol) ? 1 : 0;
+    std::ptrdiff_t dj = (j < maxRow) ? std::ptrdiff_t(grid.pitch()) : 0;
+    std::ptrdiff_t dk = (k < maxLayer) ? std::ptrdiff_t(grid.slicePitch()) : 0;
+
+    const T * c = &grid.at(i, j, k);
+
+    T c00 = (1.0f - f.x) * c[0] + f.x * c[di];
+    T c10 = (1.0f - f.x) * c[dj] + f.x * c[dj + di];
+    T c01 = (1.0f - f.x) * c[dk] + f.x * c[dk + di];
+    T c11 = (1.0f - f.x) * c[dk + dj] + f.x * c[dk + dj + di];
+
+    T c0 = (1.0f - f.y) * c00 + f.y * c10;
+    T c1 = (1.0f - f.y) * c01 + f.y * c11;
+
+    return (1.0f - f.z) * c0 + f.z * c1;
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+tvec3<T> trilinear(const StaggeredGrid3<T> & grid, const vec3 & worldPos) {
+    return tvec3<T>(
+            trilinear(grid.u, worldPos),
+            trilinear(grid.v, worldPos),
+            trilinear(grid.w, worldPos));
+}
+
 //----------------------------------------------------------------------------------------
 // Linear interpolation kernel
 inline float32 linear(const vec2 & x, float32 h) {
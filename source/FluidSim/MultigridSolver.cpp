@@ -0,0 +1,558 @@
+// MultigridSolver.cpp
+
+#include "MultigridSolver.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace FluidSim;
+
+
+namespace {  // limit visibility to this file.
+
+// Levels stop being coarsened once either dimension is at or below this size.
+const uint32 kCoarsestSize = 4;
+
+// Red-black sweep pairs applied on the coarsest level.
+const uint32 kCoarsestSweeps = 20;
+
+// Scale applied to the summed fine-face couplings when building a coarse level.
+// Matches rediscretizing the Laplacian at twice the cell length.
+const float32 kCoarseCouplingScale = 0.5f;
+
+// Side of the block of fine cells that a coarse cell restricts its residual from.
+const uint32 kRestrictionSize = 4;
+
+//---------------------------------------------------------------------------------------
+float32 maxAbs(const Grid<float32> & a) {
+	float32 result = 0.0f;
+	for (uint32 row(0); row < a.height(); ++row) {
+		const float32 * x = &a(0,row);
+		for (uint32 col(0); col < a.width(); ++col) {
+			result = std::max(result, std::abs(x[col]));
+		}
+	}
+	return result;
+}
+
+//---------------------------------------------------------------------------------------
+// Copies the cells of src into dst, leaving the layout and border of dst as is.
+void copyCells(const Grid<float32> & src, Grid<float32> & dst) {
+	for (uint32 row(0); row < src.height(); ++row) {
+		const float32 * x = &src(0,row);
+		std::copy(x, x + src.width(), &dst(0,row));
+	}
+}
+
+} // end namespace
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+MultigridSolver::MultigridSolver(float32 tolerance, uint32 maxCycles)
+	: m_tolerance(tolerance),
+	  m_maxCycles(maxCycles),
+	  m_smoothingSweeps(2),
+	  m_execution(Execution::Serial),
+	  m_revision(0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::setTolerance(float32 tolerance) {
+	m_tolerance = tolerance;
+}
+
+//---------------------------------------------------------------------------------------
+float32 MultigridSolver::tolerance() const {
+	return m_tolerance;
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::setMaxCycles(uint32 maxCycles) {
+	m_maxCycles = maxCycles;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 MultigridSolver::maxCycles() const {
+	return m_maxCycles;
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::setExecution(Execution execution) {
+	m_execution = execution;
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::setSmoothingSweeps(uint32 sweeps) {
+	m_smoothingSweeps = sweeps;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 MultigridSolver::numLevels() const {
+	return uint32(m_levels.size());
+}
+
+//---------------------------------------------------------------------------------------
+// Bilinear interpolation between cell-centered levels: a fine cell takes 9/16 of
+// its parent, 3/16 of the two coarse cells adjacent to its quadrant and 1/16 of
+// the diagonal one.  Coarse cells that are outside the grid or outside the
+// system are dropped and the remaining weights renormalized, so corrections do
+// not leak through solid walls.
+void MultigridSolver::prolongationStencil(
+		const Grid<float32> & coarseDiag,
+		int32 fineCol,
+		int32 fineRow,
+		ProlongationStencil & stencil
+) {
+	const int32 parentCol = fineCol / 2;
+	const int32 parentRow = fineRow / 2;
+	const int32 cols[2] = { parentCol, parentCol + ((fineCol & 1) ? 1 : -1) };
+	const int32 rows[2] = { parentRow, parentRow + ((fineRow & 1) ? 1 : -1) };
+	const float32 weights[2] = { 0.75f, 0.25f };
+
+	stencil.count = 0;
+	float32 totalWeight = 0.0f;
+	for (uint32 j(0); j < 2; ++j) {
+		for (uint32 i(0); i < 2; ++i) {
+			if (!coarseDiag.isValidCoord(cols[i], rows[j]) ||
+				coarseDiag(cols[i], rows[j]) == 0.0f)
+			{
+				continue;
+			}
+
+			stencil.col[stencil.count] = uint32(cols[i]);
+			stencil.row[stencil.count] = uint32(rows[j]);
+			stencil.weight[stencil.count] = weights[i] * weights[j];
+			totalWeight += weights[i] * weights[j];
+			++stencil.count;
+		}
+	}
+
+	for (uint32 k(0); k < stencil.count; ++k) {
+		stencil.weight[k] /= totalWeight;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::allocate(const GridSpec & spec) {
+	if (!m_levels.empty() && m_levels[0].diag.gridSpec() == spec) {
+		return;
+	}
+
+	m_levels.clear();
+	m_revision = 0;
+
+	GridSpec levelSpec = spec;
+	while (true) {
+		Level level;
+		level.diag = Grid<float32>(levelSpec);
+		level.couple_i = Grid<float32>(levelSpec);
+		level.couple_j = Grid<float32>(levelSpec);
+		level.x = Grid<float32>(levelSpec);
+		level.b = Grid<float32>(levelSpec);
+		level.r = Grid<float32>(levelSpec);
+		m_levels.push_back(std::move(level));
+
+		if (levelSpec.width <= kCoarsestSize || levelSpec.height <= kCoarsestSize) {
+			break;
+		}
+
+		// Coarse cell centers sit at the center of their 2x2 children.
+		levelSpec.origin += vec2(0.5f * levelSpec.cellLength);
+		levelSpec.width = (levelSpec.width + 1) / 2;
+		levelSpec.height = (levelSpec.height + 1) / 2;
+		levelSpec.cellLength *= 2.0f;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::buildFineLevel(const PressureStencil & stencil) {
+	Level & level = m_levels[0];
+
+	// Neighbor bits are only set for fluid cells, so each one is a fluid face.
+	for (uint32 row(0); row < stencil.height(); ++row) {
+		const uint8 * mask = &stencil.neighborGrid()(0,row);
+		for (uint32 col(0); col < stencil.width(); ++col) {
+			const uint8 m = mask[col];
+			level.couple_i(col,row) = (m & PressureStencil::kRightFluid) ? 1.0f : 0.0f;
+			level.couple_j(col,row) = (m & PressureStencil::kTopFluid) ? 1.0f : 0.0f;
+		}
+	}
+
+	for (uint32 row(0); row < stencil.height(); ++row) {
+		for (uint32 col(0); col < stencil.width(); ++col) {
+			float32 diag = level.couple_i(col,row) + level.couple_j(col,row);
+			if (col > 0) { diag += level.couple_i(col-1,row); }
+			if (row > 0) { diag += level.couple_j(col,row-1); }
+			level.diag(col,row) = diag;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::buildCoarseLevel(uint32 fine) {
+	const Level & f = m_levels[fine];
+	Level & c = m_levels[fine + 1];
+
+	const uint32 fineWidth = f.diag.width();
+	const uint32 fineHeight = f.diag.height();
+	const uint32 width = c.diag.width();
+	const uint32 height = c.diag.height();
+
+	for (uint32 row(0); row < height; ++row) {
+		for (uint32 col(0); col < width; ++col) {
+			// Fine faces crossing the right and top edge of this coarse cell.
+			uint32 rightCol = 2*col + 1;
+			uint32 topRow = 2*row + 1;
+
+			float32 couple_i = 0.0f;
+			if (rightCol < fineWidth) {
+				for (uint32 j(2*row); j < std::min(2*row + 2, fineHeight); ++j) {
+					couple_i += f.couple_i(rightCol, j);
+				}
+			}
+
+			float32 couple_j = 0.0f;
+			if (topRow < fineHeight) {
+				for (uint32 i(2*col); i < std::min(2*col + 2, fineWidth); ++i) {
+					couple_j += f.couple_j(i, topRow);
+				}
+			}
+
+			c.couple_i(col,row) = kCoarseCouplingScale * couple_i;
+			c.couple_j(col,row) = kCoarseCouplingScale * couple_j;
+		}
+	}
+
+	for (uint32 row(0); row < height; ++row) {
+		for (uint32 col(0); col < width; ++col) {
+			float32 diag = c.couple_i(col,row) + c.couple_j(col,row);
+			if (col > 0) { diag += c.couple_i(col-1,row); }
+			if (row > 0) { diag += c.couple_j(col,row-1); }
+			c.diag(col,row) = diag;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+/**
+* Stores the prolongation stencil of every fine cell, and scatters its weights
+* into the restriction weights of the coarse cells it reads from, so that
+* neither transfer recomputes stencils during a V-cycle.
+*/
+void MultigridSolver::buildTransferWeights(uint32 fine) {
+	Level & f = m_levels[fine];
+	Level & c = m_levels[fine + 1];
+
+	const uint32 fineWidth = f.diag.width();
+	const uint32 fineHeight = f.diag.height();
+	const uint32 width = c.diag.width();
+	const uint32 numWeights = kRestrictionSize * kRestrictionSize;
+
+	f.prolongation.resize(fineWidth * fineHeight);
+	c.restriction.assign(width * c.diag.height() * numWeights, 0.0f);
+
+	for (uint32 row(0); row < fineHeight; ++row) {
+		for (uint32 col(0); col < fineWidth; ++col) {
+			ProlongationStencil & stencil = f.prolongation[row * fineWidth + col];
+			if (f.diag(col,row) == 0.0f) {
+				stencil.count = 0;
+				continue;
+			}
+
+			prolongationStencil(c.diag, int32(col), int32(row), stencil);
+			for (uint32 k(0); k < stencil.count; ++k) {
+				// Offset of this fine cell within the coarse cell's 4x4 block.
+				uint32 i = col + 1 - 2*stencil.col[k];
+				uint32 j = row + 1 - 2*stencil.row[k];
+				uint32 coarseIndex = stencil.row[k] * width + stencil.col[k];
+				c.restriction[coarseIndex * numWeights + j * kRestrictionSize + i] =
+						stencil.weight[k];
+			}
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::setup(const Grid<CellType> & cells) {
+	m_stencil.build(cells);
+	setup(m_stencil);
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::setup(const PressureStencil & stencil) {
+	allocate(stencil.neighborGrid().gridSpec());
+	if (m_revision == stencil.revision()) {
+		return;
+	}
+
+	buildFineLevel(stencil);
+	for (uint32 level(0); level + 1 < m_levels.size(); ++level) {
+		buildCoarseLevel(level);
+		buildTransferWeights(level);
+	}
+	m_revision = stencil.revision();
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::smooth(uint32 levelIndex, uint32 color) {
+	Level & level = m_levels[levelIndex];
+	const uint32 width = level.diag.width();
+	const uint32 height = level.diag.height();
+
+	// Cells of one color only read cells of the other color, so rows can be
+	// updated concurrently.
+	parallelFor(m_execution, 0, height, [&] (uint32 rowBegin, uint32 rowEnd) {
+		Grid<float32> & x = level.x;
+
+		for (uint32 row(rowBegin); row < rowEnd; ++row) {
+			for (uint32 col((row + color) & 1); col < width; col += 2) {
+				float32 diag = level.diag(col,row);
+				if (diag == 0.0f) {
+					continue;
+				}
+
+				float32 sum = level.b(col,row);
+				if (col > 0) {
+					sum += level.couple_i(col-1,row) * x(col-1,row);
+				}
+				if (col < width-1) {
+					sum += level.couple_i(col,row) * x(col+1,row);
+				}
+				if (row > 0) {
+					sum += level.couple_j(col,row-1) * x(col,row-1);
+				}
+				if (row < height-1) {
+					sum += level.couple_j(col,row) * x(col,row+1);
+				}
+
+				x(col,row) = sum / diag;
+			}
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::computeResidual(uint32 levelIndex) {
+	Level & level = m_levels[levelIndex];
+	const uint32 width = level.diag.width();
+	const uint32 height = level.diag.height();
+
+	parallelFor(m_execution, 0, height, [&] (uint32 rowBegin, uint32 rowEnd) {
+		const Grid<float32> & x = level.x;
+
+		for (uint32 row(rowBegin); row < rowEnd; ++row) {
+			for (uint32 col(0); col < width; ++col) {
+				float32 diag = level.diag(col,row);
+				if (diag == 0.0f) {
+					level.r(col,row) = 0.0f;
+					continue;
+				}
+
+				float32 Ax = diag * x(col,row);
+				if (col > 0) {
+					Ax -= level.couple_i(col-1,row) * x(col-1,row);
+				}
+				if (col < width-1) {
+					Ax -= level.couple_i(col,row) * x(col+1,row);
+				}
+				if (row > 0) {
+					Ax -= level.couple_j(col,row-1) * x(col,row-1);
+				}
+				if (row < height-1) {
+					Ax -= level.couple_j(col,row) * x(col,row+1);
+				}
+
+				level.r(col,row) = level.b(col,row) - Ax;
+			}
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::restrictResidual(uint32 fine) {
+	const Level & f = m_levels[fine];
+	Level & c = m_levels[fine + 1];
+
+	const int32 fineWidth = int32(f.r.width());
+	const int32 fineHeight = int32(f.r.height());
+	const uint32 width = c.b.width();
+	const uint32 numWeights = kRestrictionSize * kRestrictionSize;
+	const int32 size = int32(kRestrictionSize);
+
+	// Transpose of prolongateCorrection(): each coarse cell gathers the residual
+	// of the fine cells in its 4x4 block, with the weights precomputed by
+	// buildTransferWeights().
+	parallelFor(m_execution, 0, c.b.height(), [&] (uint32 rowBegin, uint32 rowEnd) {
+		for (uint32 row(rowBegin); row < rowEnd; ++row) {
+			for (uint32 col(0); col < width; ++col) {
+				c.x(col,row) = 0.0f;
+
+				if (c.diag(col,row) == 0.0f) {
+					c.b(col,row) = 0.0f;
+					continue;
+				}
+
+				const float32 * weights = &c.restriction[(row * width + col) * numWeights];
+				const int32 i0 = int32(2*col) - 1;
+				const int32 j0 = int32(2*row) - 1;
+
+				float32 sum = 0.0f;
+				int32 jEnd = std::min(j0 + size, fineHeight);
+				int32 iEnd = std::min(i0 + size, fineWidth);
+				for (int32 j(std::max(j0, 0)); j < jEnd; ++j) {
+					const float32 * weightRow = weights + (j - j0) * size - i0;
+					const float32 * r = &f.r(0,j);
+					for (int32 i(std::max(i0, 0)); i < iEnd; ++i) {
+						sum += weightRow[i] * r[i];
+					}
+				}
+
+				c.b(col,row) = sum;
+			}
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::prolongateCorrection(uint32 coarse) {
+	const Level & c = m_levels[coarse];
+	Level & f = m_levels[coarse - 1];
+
+	const uint32 width = f.x.width();
+
+	parallelFor(m_execution, 0, f.x.height(), [&] (uint32 rowBegin, uint32 rowEnd) {
+		for (uint32 row(rowBegin); row < rowEnd; ++row) {
+			for (uint32 col(0); col < width; ++col) {
+				const ProlongationStencil & stencil = f.prolongation[row * width + col];
+
+				float32 correction = 0.0f;
+				for (uint32 k(0); k < stencil.count; ++k) {
+					correction += stencil.weight[k] * c.x(stencil.col[k], stencil.row[k]);
+				}
+				f.x(col,row) += correction;
+			}
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::vcycle(uint32 level) {
+	if (level + 1 == m_levels.size()) {
+		// Symmetric sweep ordering keeps the V-cycle usable as a preconditioner.
+		for (uint32 sweep(0); sweep < kCoarsestSweeps; ++sweep) {
+			smooth(level, 0);
+			smooth(level, 1);
+		}
+		for (uint32 sweep(0); sweep < kCoarsestSweeps; ++sweep) {
+			smooth(level, 1);
+			smooth(level, 0);
+		}
+		return;
+	}
+
+	for (uint32 sweep(0); sweep < m_smoothingSweeps; ++sweep) {
+		smooth(level, 0);
+		smooth(level, 1);
+	}
+
+	computeResidual(level);
+	restrictResidual(level);
+	vcycle(level + 1);
+	prolongateCorrection(level + 1);
+
+	for (uint32 sweep(0); sweep < m_smoothingSweeps; ++sweep) {
+		smooth(level, 1);
+		smooth(level, 0);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void MultigridSolver::precondition(const Grid<float32> & r, Grid<float32> & z) {
+	Level & fine = m_levels[0];
+	copyCells(r, fine.b);
+	fine.x.setAll(0);
+
+	vcycle(0);
+
+	copyCells(fine.x, z);
+}
+
+//---------------------------------------------------------------------------------------
+PressureSolveResult MultigridSolver::solve(
+		const Grid<CellType> & cells,
+		const Grid<float32> & rhs,
+		Grid<float32> & pressure
+) {
+	const GridSpec spec = rhs.gridSpec();
+	if (pressure.gridSpec() != spec ||
+		cells.width() != spec.width || cells.height() != spec.height)
+	{
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	m_stencil.build(cells);
+
+	return solve(m_stencil, rhs, pressure);
+}
+
+//---------------------------------------------------------------------------------------
+PressureSolveResult MultigridSolver::solve(
+		const PressureStencil & stencil,
+		const Grid<float32> & rhs,
+		Grid<float32> & pressure
+) {
+	const GridSpec spec = rhs.gridSpec();
+	if (pressure.gridSpec() != spec ||
+		stencil.width() != spec.width || stencil.height() != spec.height)
+	{
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	setup(stencil);
+
+	//-- Copy initial guess and right hand side, restricted to cells in the system.
+	Level & fine = m_levels[0];
+	for (uint32 row(0); row < spec.height; ++row) {
+		for (uint32 col(0); col < spec.width; ++col) {
+			bool active = fine.diag(col,row) != 0.0f;
+			fine.x(col,row) = active ? pressure(col,row) : 0.0f;
+			fine.b(col,row) = active ? rhs(col,row) : 0.0f;
+		}
+	}
+
+	computeResidual(0);
+
+	PressureSolveResult result;
+	result.iterations = 0;
+	result.residual = maxAbs(fine.r);
+	result.converged = false;
+
+	const float32 threshold = m_tolerance * maxAbs(rhs);
+
+	while (true) {
+		if (result.residual <= threshold) {
+			result.converged = true;
+			break;
+		}
+		if (result.iterations >= m_maxCycles) {
+			break;
+		}
+
+		vcycle(0);
+		++result.iterations;
+
+		computeResidual(0);
+		result.residual = maxAbs(fine.r);
+	}
+
+	pressure = fine.x;
+
+	return result;
+}
+
+} // end namespace FluidSim
@@ -0,0 +1,145 @@
+/**
+* MultigridSolver.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Grid.hpp"
+#include "FluidSim/CellType.hpp"
+#include "FluidSim/PressureStencil.hpp"
+#include "FluidSim/Parallel.hpp"
+#include "FluidSim/PressureSolveResult.hpp"
+
+#include <vector>
+
+namespace FluidSim {
+
+/**
+* Geometric multigrid solver for the same pressure system Ap = b as
+* PressureSolver.
+*
+* Each coarser level halves the grid resolution.  The coupling between two
+* neighboring coarse cells is the scaled sum of the couplings of the fine faces
+* crossing their shared edge, so solid walls and obstacles are respected on
+* every level.  A coarse cell whose couplings sum to zero is inactive, even if
+* some of its 2x2 children are fluid, as for a fluid pocket sealed off within
+* the cell.  Corrections are prolongated
+* bilinearly from active coarse cells only, and residuals are restricted with
+* the transpose of that interpolation.  Smoothing is red-black Gauss-Seidel,
+* which only reads cells of the opposite color and is therefore run over rows
+* in parallel when Execution::Parallel is selected.
+*
+* The V-cycle is symmetric (red-black pre-smoothing, black-red post-smoothing),
+* so it can also be used as a preconditioner for PressureSolver.
+*/
+class MultigridSolver {
+public:
+    MultigridSolver(float32 tolerance = 1.0e-5f, uint32 maxCycles = 50);
+
+    void setTolerance(float32 tolerance);
+
+    float32 tolerance() const;
+
+    void setMaxCycles(uint32 maxCycles);
+
+    uint32 maxCycles() const;
+
+    void setExecution(Execution execution);
+
+    /// Number of red-black sweeps performed before and after each coarse
+    /// grid correction.
+    void setSmoothingSweeps(uint32 sweeps);
+
+    /// Number of levels in the current hierarchy, valid after setup().
+    uint32 numLevels() const;
+
+    /// Builds the level hierarchy for \c cells.  Storage is reused if the grid
+    /// size is unchanged.
+    void setup(const Grid<CellType> & cells);
+
+    /// Builds the level hierarchy for \c stencil, unless it was already built
+    /// for the stencil's current revision.
+    void setup(const PressureStencil & stencil);
+
+    /// Applies one V-cycle, starting from a zero initial guess, to approximately
+    /// solve Az = r.  setup() must have been called with a matching grid.
+    void precondition(const Grid<float32> & r, Grid<float32> & z);
+
+    /// Solves Ap = \c rhs by repeated V-cycles, using the incoming \c pressure as
+    /// the initial guess.  The result reports V-cycles as iterations.  Throws a
+    /// FluidSim::Exception if the three grids differ in size.
+    PressureSolveResult solve(
+            const Grid<CellType> & cells,
+            const Grid<float32> & rhs,
+            Grid<float32> & pressure
+    );
+
+    /// As above, over the active cells of \c stencil.
+    PressureSolveResult solve(
+            const PressureStencil & stencil,
+            const Grid<float32> & rhs,
+            Grid<float32> & pressure
+    );
+
+private:
+    // Coarse cells, and their weights, that a fine cell interpolates its
+    // correction from.
+    struct ProlongationStencil {
+        uint32 col[4];
+        uint32 row[4];
+        float32 weight[4];
+        uint32 count;
+    };
+
+    struct Level {
+        Grid<float32> diag;    // Sum of couplings, zero for cells outside the system.
+        Grid<float32> couple_i; // Coupling between (col,row) and (col+1,row).
+        Grid<float32> couple_j; // Coupling between (col,row) and (col,row+1).
+        Grid<float32> x;
+        Grid<float32> b;
+        Grid<float32> r;
+
+        // Per cell, in row-major order, the stencil interpolating its correction
+        // from the next coarser level.  Empty on the coarsest level.
+        std::vector<ProlongationStencil> prolongation;
+
+        // Per cell, in row-major order, 4x4 restriction weights of the finer
+        // cells starting at (2*col-1, 2*row-1): the transpose of the finer
+        // level's prolongation.  Empty on the finest level.
+        std::vector<float32> restriction;
+    };
+
+    float32 m_tolerance;
+    uint32 m_maxCycles;
+    uint32 m_smoothingSweeps;
+    Execution m_execution;
+
+    std::vector<Level> m_levels;
+
+    // Stencil for the CellType overloads, and the stencil revision the levels
+    // were last built for, zero if they need building.
+    PressureStencil m_stencil;
+    uint64 m_revision;
+
+    static void prolongationStencil(
+            const Grid<float32> & coarseDiag,
+            int32 fineCol,
+            int32 fineRow,
+            ProlongationStencil & stencil
+    );
+
+    void allocate(const GridSpec & spec);
+    void buildFineLevel(const PressureStencil & stencil);
+    void buildCoarseLevel(uint32 fine);
+    void buildTransferWeights(uint32 fine);
+    void smooth(uint32 level, uint32 color);
+    void computeResidual(uint32 level);
+    void restrictResidual(uint32 fine);
+    void prolongateCorrection(uint32 coarse);
+    void vcycle(uint32 level);
+};
+
+} // end namespace FluidSim
@@ -0,0 +1,164 @@
+// NeighborList.cpp
+
+#include "NeighborList.hpp"
+#include "FluidSim/ParticleCellIndex.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace FluidSim;
+
+
+namespace {  // limit visibility to this file.
+
+//---------------------------------------------------------------------------------------
+// Calls func(j, r2) for every particle j != i within the squared distance band
+// [minR2, maxR2] of particle i, in increasing order of j.  The three cells of
+// each row around particle i are one contiguous range of particles.
+template <typename Func>
+inline void forEachNeighbor(
+		const ParticleCellIndex & cells,
+		const float32 * x,
+		const float32 * y,
+		uint32 i,
+		float32 minR2,
+		float32 maxR2,
+		Func && func
+) {
+	const uint32 width = cells.width();
+	const uint32 col = cells.col(x[i]);
+	const uint32 row = cells.row(y[i]);
+	const uint32 colBegin = (col > 0) ? col - 1 : col;
+	const uint32 colEnd = std::min(col + 1, width - 1);
+	const uint32 rowBegin = (row > 0) ? row - 1 : row;
+	const uint32 rowEnd = std::min(row + 1, cells.height() - 1);
+
+	for (uint32 r(rowBegin); r <= rowEnd; ++r) {
+		const uint32 begin = cells.cellBegin(r * width + colBegin);
+		const uint32 end = cells.cellEnd(r * width + colEnd);
+
+		for (uint32 j(begin); j < end; ++j) {
+			float32 dx = x[i] - x[j];
+			float32 dy = y[i] - y[j];
+			float32 r2 = dx*dx + dy*dy;
+
+			if (r2 > maxR2 || r2 < minR2 || j == i) {
+				continue;
+			}
+			func(j, r2);
+		}
+	}
+}
+
+} // end namespace
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+NeighborList::NeighborList()
+	: m_offsets(1, 0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+void NeighborList::build(
+		const ParticleCellIndex & cells,
+		const float32 * x,
+		const float32 * y,
+		uint32 count,
+		float32 radius,
+		float32 minDistance,
+		Execution execution
+) {
+	if (radius > cells.cellSize()) {
+		throw FluidSim::Exception("Neighbor radius is larger than the cell size.");
+	}
+	if (cells.size() != count) {
+		throw FluidSim::Exception("ParticleCellIndex does not match particle count.");
+	}
+
+	const float32 maxR2 = radius * radius;
+	const float32 minR2 = minDistance * minDistance;
+
+	// Count into m_offsets[i + 1], so the prefix sum lands in place.
+	m_offsets.resize(count + 1);
+	m_offsets[0] = 0;
+	parallelFor(execution, 0, count, [&] (uint32 begin, uint32 end) {
+		for (uint32 i(begin); i < end; ++i) {
+			uint32 n = 0;
+			forEachNeighbor(cells, x, y, i, minR2, maxR2, [&] (uint32, float32) {
+				++n;
+			});
+			m_offsets[i + 1] = n;
+		}
+	});
+	for (uint32 i(0); i < count; ++i) {
+		m_offsets[i + 1] += m_offsets[i];
+	}
+
+	m_indices.resize(m_offsets[count]);
+	m_distances.resize(m_offsets[count]);
+	parallelFor(execution, 0, count, [&] (uint32 begin, uint32 end) {
+		for (uint32 i(begin); i < end; ++i) {
+			uint32 k = m_offsets[i];
+			forEachNeighbor(cells, x, y, i, minR2, maxR2, [&] (uint32 j, float32 r2) {
+				m_indices[k] = j;
+				m_distances[k] = std::sqrt(r2);
+				++k;
+			});
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+void NeighborList::updateDistances(
+		const float32 * x,
+		const float32 * y,
+		Execution execution
+) {
+	parallelFor(execution, 0, size(), [&] (uint32 begin, uint32 end) {
+		for (uint32 i(begin); i < end; ++i) {
+			for (uint32 k(m_offsets[i]); k < m_offsets[i + 1]; ++k) {
+				const uint32 j = m_indices[k];
+				float32 dx = x[i] - x[j];
+				float32 dy = y[i] - y[j];
+				m_distances[k] = std::sqrt(dx*dx + dy*dy);
+			}
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+uint32 NeighborList::size() const {
+	return uint32(m_offsets.size()) - 1;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 NeighborList::numNeighbors() const {
+	return m_offsets.back();
+}
+
+//---------------------------------------------------------------------------------------
+uint32 NeighborList::begin(uint32 i) const {
+	return m_offsets[i];
+}
+
+//---------------------------------------------------------------------------------------
+uint32 NeighborList::end(uint32 i) const {
+	return m_offsets[i + 1];
+}
+
+//---------------------------------------------------------------------------------------
+const uint32 * NeighborList::indices() const {
+	return m_indices.data();
+}
+
+//---------------------------------------------------------------------------------------
+const float32 * NeighborList::distances() const {
+	return m_distances.data();
+}
+
+} // end namespace FluidSim
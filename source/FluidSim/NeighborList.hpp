@@ -0,0 +1,94 @@
+/**
+* NeighborList.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Parallel.hpp"
+
+#include <vector>
+
+namespace FluidSim {
+
+// Forward Declaration
+class ParticleCellIndex;
+
+/**
+* Fixed radius neighbor lists of a set of 2D particles, in compressed sparse row
+* form: the neighbors of particle i are entries begin(i) to end(i) - 1 of
+* indices() and distances().  Memory is proportional to the total number of
+* neighbors, and a particle may have any number of them.
+*/
+class NeighborList {
+public:
+    NeighborList();
+
+    /**
+    * Lists, for each particle i, every other particle j with
+    * minDistance <= |p_i - p_j| <= radius, in increasing order of j, along
+    * with that distance.
+    *
+    * \c cells must have been built from the same \c count positions, which
+    * must since have been reordered by cells.order(), see
+    * ParticleArrays::permute(), so that the particles of each cell are
+    * contiguous.  Throws a FluidSim::Exception if \c radius is larger than
+    * cells.cellSize(), as only the 3x3 cells around each particle are searched.
+    *
+    * Neighbors are counted in a first pass and written in a second, so no
+    * memory is allocated once the lists have reached their largest size.
+    * With Execution::Parallel, both passes run on ThreadPool::global(), with
+    * identical results.
+    */
+    void build(
+            const ParticleCellIndex & cells,
+            const float32 * x,
+            const float32 * y,
+            uint32 count,
+            float32 radius,
+            float32 minDistance = 0.0f,
+            Execution execution = Execution::Serial
+    );
+
+    /**
+    * Recomputes distances() from new positions of the same particles, in the
+    * same order, keeping the lists themselves.  Built with a radius padded by
+    * a skin distance, the lists still hold every pair within the unpadded
+    * radius until some particle has moved half the skin, so callers can skip
+    * the pairs now beyond it rather than rebuilding every step.
+    */
+    void updateDistances(
+            const float32 * x,
+            const float32 * y,
+            Execution execution = Execution::Serial
+    );
+
+    /// Number of particles.
+    uint32 size() const;
+
+    /// Total number of neighbors, over all particles.
+    uint32 numNeighbors() const;
+
+    /// Position in indices() and distances() of particle i's first neighbor.
+    uint32 begin(uint32 i) const;
+
+    /// Position in indices() and distances() one past particle i's last neighbor.
+    uint32 end(uint32 i) const;
+
+    /// Neighbor particle indices, numNeighbors() entries.
+    const uint32 * indices() const;
+
+    /// Distance to each neighbor in indices().
+    const float32 * distances() const;
+
+private:
+    // Prefix sum of neighbor counts, size() + 1 entries.
+    std::vector<uint32> m_offsets;
+
+    std::vector<uint32> m_indices;
+    std::vector<float32> m_distances;
+};
+
+} // end namespace FluidSim
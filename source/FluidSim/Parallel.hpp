@@ -0,0 +1,53 @@
+/**
+* Parallel.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace FluidSim {
+
+/// Selects whether a kernel runs on the calling thread only, or is split across
+/// ThreadPool::global().  Both produce bit-identical results.
+enum class Execution {
+	Serial,
+	Parallel
+};
+
+
+/**
+* Calls \c func(begin, end) once when \c execution is Execution::Serial.  Otherwise
+* splits [begin, end) into tiles and runs \c func(tileBegin, tileEnd) on the global
+* ThreadPool.  A \c grainSize of 0 picks about four tiles per thread.
+*/
+template <typename Func>
+void parallelFor(
+		Execution execution,
+		uint32 begin,
+		uint32 end,
+		Func && func,
+		uint32 grainSize = 0
+) {
+	if (execution == Execution::Serial) {
+		if (begin < end) {
+			func(begin, end);
+		}
+		return;
+	}
+
+	ThreadPool & pool = ThreadPool::global();
+	if (grainSize == 0) {
+		uint32 numTiles = 4 * pool.numThreads();
+		grainSize = std::max(1u, (end - begin + numTiles - 1) / numTiles);
+	}
+
+	pool.parallelFor(begin, end, grainSize, func);
+}
+
+} // end namespace FluidSim
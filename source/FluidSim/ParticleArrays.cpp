@@ -0,0 +1,128 @@
+// ParticleArrays.cpp
+
+#include "ParticleArrays.hpp"
+
+using namespace FluidSim;
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+ParticleArrays::ParticleArrays() {
+
+}
+
+//---------------------------------------------------------------------------------------
+ParticleArrays::ParticleArrays(uint32 size) {
+	resize(size);
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ParticleArrays::size() const {
+	return uint32(x.size());
+}
+
+//---------------------------------------------------------------------------------------
+bool ParticleArrays::empty() const {
+	return x.empty();
+}
+
+//---------------------------------------------------------------------------------------
+void ParticleArrays::resize(uint32 size) {
+	x.resize(size, 0.0f);
+	y.resize(size, 0.0f);
+	vx.resize(size, 0.0f);
+	vy.resize(size, 0.0f);
+	density.resize(size, 0.0f);
+	pressure.resize(size, 0.0f);
+}
+
+//---------------------------------------------------------------------------------------
+void ParticleArrays::reserve(uint32 capacity) {
+	x.reserve(capacity);
+	y.reserve(capacity);
+	vx.reserve(capacity);
+	vy.reserve(capacity);
+	density.reserve(capacity);
+	pressure.reserve(capacity);
+}
+
+//---------------------------------------------------------------------------------------
+void ParticleArrays::clear() {
+	x.clear();
+	y.clear();
+	vx.clear();
+	vy.clear();
+	density.clear();
+	pressure.clear();
+}
+
+//---------------------------------------------------------------------------------------
+void ParticleArrays::push_back(const vec2 & position, const vec2 & velocity) {
+	x.push_back(position.x);
+	y.push_back(position.y);
+	vx.push_back(velocity.x);
+	vy.push_back(velocity.y);
+	density.push_back(0.0f);
+	pressure.push_back(0.0f);
+}
+
+//---------------------------------------------------------------------------------------
+vec2 ParticleArrays::position(uint32 i) const {
+	return vec2(x[i], y[i]);
+}
+
+//---------------------------------------------------------------------------------------
+vec2 ParticleArrays::velocity(uint32 i) const {
+	return vec2(vx[i], vy[i]);
+}
+
+//---------------------------------------------------------------------------------------
+void ParticleArrays::setPosition(uint32 i, const vec2 & position) {
+	x[i] = position.x;
+	y[i] = position.y;
+}
+
+//---------------------------------------------------------------------------------------
+void ParticleArrays::setVelocity(uint32 i, const vec2 & velocity) {
+	vx[i] = velocity.x;
+	vy[i] = velocity.y;
+}
+
+//---------------------------------------------------------------------------------------
+void ParticleArrays::permute(const uint32 * order, ParticleArrays & scratch,
+		Execution execution)
+{
+	const uint32 count = size();
+	scratch.resize(count);
+
+	const Array * source[] = { &x, &y, &vx, &vy, &density, &pressure };
+	Array * destination[] = {
+		&scratch.x, &scratch.y, &scratch.vx, &scratch.vy, &scratch.density,
+		&scratch.pressure
+	};
+
+	parallelFor(execution, 0, count, [&] (uint32 begin, uint32 end) {
+		for (uint32 k(0); k < 6; ++k) {
+			const float32 * src = source[k]->data();
+			float32 * dst = destination[k]->data();
+			for (uint32 i(begin); i < end; ++i) {
+				dst[i] = src[order[i]];
+			}
+		}
+	});
+
+	swap(scratch);
+}
+
+//---------------------------------------------------------------------------------------
+void ParticleArrays::swap(ParticleArrays & other) {
+	x.swap(other.x);
+	y.swap(other.y);
+	vx.swap(other.vx);
+	vy.swap(other.vy);
+	density.swap(other.density);
+	pressure.swap(other.pressure);
+}
+
+} // end namespace FluidSim
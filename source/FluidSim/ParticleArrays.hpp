@@ -0,0 +1,79 @@
+/**
+* ParticleArrays.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/AlignedAllocator.hpp"
+#include "FluidSim/Parallel.hpp"
+
+#include <vector>
+
+namespace FluidSim {
+
+/**
+* Structure-of-arrays storage for 2D particles.  Each attribute lives in its own
+* cache line aligned array, indexed by particle, so a pass only streams the
+* attributes it reads, and loops over the raw arrays vectorize.  Particles all
+* share one mass, which is not stored.
+*
+* The attribute arrays are public, as Grid's components are in StaggeredGrid,
+* but must not be resized individually; use resize() instead.
+*/
+class ParticleArrays {
+public:
+    typedef std::vector< float32, AlignedAllocator<float32> > Array;
+
+    ParticleArrays();
+
+    /// \c size particles, with every attribute zero.
+    explicit ParticleArrays(uint32 size);
+
+    /// Number of particles.
+    uint32 size() const;
+
+    bool empty() const;
+
+    /// Resizes every attribute array.  New particles have every attribute zero.
+    void resize(uint32 size);
+
+    void reserve(uint32 capacity);
+
+    /// Removes every particle.
+    void clear();
+
+    /// Appends a particle with zero density and pressure.
+    void push_back(const vec2 & position, const vec2 & velocity = vec2(0.0f));
+
+    vec2 position(uint32 i) const;
+
+    vec2 velocity(uint32 i) const;
+
+    void setPosition(uint32 i, const vec2 & position);
+
+    void setVelocity(uint32 i, const vec2 & velocity);
+
+    /**
+    * Reorders the particles so that particle i becomes old particle
+    * \c order[i], e.g. to make the particles of each cell of a
+    * ParticleCellIndex contiguous.  \c order must be a permutation of
+    * 0 to size() - 1.  The particles are gathered into \c scratch, which is
+    * then swapped with this, so a scratch kept between calls allocates nothing.
+    */
+    void permute(const uint32 * order, ParticleArrays & scratch,
+            Execution execution = Execution::Serial);
+
+    void swap(ParticleArrays & other);
+
+    Array x;         // Position.
+    Array y;
+    Array vx;        // Velocity.
+    Array vy;
+    Array density;
+    Array pressure;
+};
+
+} // end namespace FluidSim
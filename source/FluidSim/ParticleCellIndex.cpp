@@ -0,0 +1,195 @@
+// ParticleCellIndex.cpp
+
+#include "ParticleCellIndex.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace FluidSim;
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+ParticleCellIndex::ParticleCellIndex()
+	: m_width(0),
+	  m_height(0),
+	  m_cellSize(1.0f),
+	  m_invCellSize(1.0f),
+	  m_origin(0.0f),
+	  m_cellBegin(1, 0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+ParticleCellIndex::ParticleCellIndex(uint32 width, uint32 height, float32 cellSize,
+		const vec2 & origin)
+	: ParticleCellIndex()
+{
+	resize(width, height, cellSize, origin);
+}
+
+//---------------------------------------------------------------------------------------
+void ParticleCellIndex::resize(uint32 width, uint32 height, float32 cellSize,
+		const vec2 & origin)
+{
+	if (width == 0 || height == 0) {
+		throw FluidSim::Exception("ParticleCellIndex needs at least one cell.");
+	}
+	if (!(cellSize > 0.0f)) {
+		throw FluidSim::Exception("ParticleCellIndex cell size must be positive.");
+	}
+
+	m_width = width;
+	m_height = height;
+	m_cellSize = cellSize;
+	m_invCellSize = 1.0f / cellSize;
+	m_origin = origin;
+
+	m_cells.clear();
+	m_order.clear();
+	m_cellBegin.assign(size_t(width) * height + 1, 0);
+	m_counters = std::vector< std::atomic<uint32> >(size_t(width) * height);
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ParticleCellIndex::width() const {
+	return m_width;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ParticleCellIndex::height() const {
+	return m_height;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ParticleCellIndex::numCells() const {
+	return m_width * m_height;
+}
+
+//---------------------------------------------------------------------------------------
+float32 ParticleCellIndex::cellSize() const {
+	return m_cellSize;
+}
+
+//---------------------------------------------------------------------------------------
+vec2 ParticleCellIndex::origin() const {
+	return m_origin;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ParticleCellIndex::col(float32 x) const {
+	float32 c = std::floor((x - m_origin.x) * m_invCellSize);
+	return uint32(std::min(std::max(c, 0.0f), float32(m_width - 1)));
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ParticleCellIndex::row(float32 y) const {
+	float32 r = std::floor((y - m_origin.y) * m_invCellSize);
+	return uint32(std::min(std::max(r, 0.0f), float32(m_height - 1)));
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ParticleCellIndex::cell(float32 x, float32 y) const {
+	return row(y) * m_width + col(x);
+}
+
+//---------------------------------------------------------------------------------------
+void ParticleCellIndex::build(const float32 * x, const float32 * y, uint32 count,
+		Execution execution)
+{
+	const uint32 cells = numCells();
+	m_cells.resize(count);
+	m_order.resize(count);
+
+	// Without other threads the atomic counters are pure overhead, and both
+	// paths give the same result.
+	if (execution == Execution::Serial || ThreadPool::global().numThreads() == 1) {
+		// Count into m_cellBegin[cell + 1], so the prefix sum lands in place.
+		std::fill(m_cellBegin.begin(), m_cellBegin.end(), 0);
+		for (uint32 i(0); i < count; ++i) {
+			uint32 c = cell(x[i], y[i]);
+			m_cells[i] = c;
+			++m_cellBegin[c + 1];
+		}
+		for (uint32 c(0); c < cells; ++c) {
+			m_cellBegin[c + 1] += m_cellBegin[c];
+		}
+
+		// Scattering in index order leaves each cell sorted.  m_cellBegin[c] is
+		// advanced to the end of cell c, then shifted back.
+		for (uint32 i(0); i < count; ++i) {
+			m_order[m_cellBegin[m_cells[i]]++] = i;
+		}
+		for (uint32 c(cells); c > 0; --c) {
+			m_cellBegin[c] = m_cellBegin[c - 1];
+		}
+		m_cellBegin[0] = 0;
+
+		return;
+	}
+
+	std::vector< std::atomic<uint32> > & counters = m_counters;
+
+	parallelFor(execution, 0, cells, [&] (uint32 begin, uint32 end) {
+		for (uint32 c(begin); c < end; ++c) {
+			counters[c].store(0, std::memory_order_relaxed);
+		}
+	});
+
+	parallelFor(execution, 0, count, [&] (uint32 begin, uint32 end) {
+		for (uint32 i(begin); i < end; ++i) {
+			uint32 c = cell(x[i], y[i]);
+			m_cells[i] = c;
+			counters[c].fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+
+	// The scan is linear in the number of cells, which is small next to the
+	// particle passes.
+	m_cellBegin[0] = 0;
+	for (uint32 c(0); c < cells; ++c) {
+		uint32 n = counters[c].load(std::memory_order_relaxed);
+		counters[c].store(m_cellBegin[c], std::memory_order_relaxed);
+		m_cellBegin[c + 1] = m_cellBegin[c] + n;
+	}
+
+	parallelFor(execution, 0, count, [&] (uint32 begin, uint32 end) {
+		for (uint32 i(begin); i < end; ++i) {
+			m_order[counters[m_cells[i]].fetch_add(1, std::memory_order_relaxed)] = i;
+		}
+	});
+
+	// Concurrent scatters leave each cell in arbitrary order.  Cells hold few
+	// particles, so sort them to match the serial build.
+	parallelFor(execution, 0, cells, [&] (uint32 begin, uint32 end) {
+		for (uint32 c(begin); c < end; ++c) {
+			std::sort(m_order.begin() + m_cellBegin[c],
+					m_order.begin() + m_cellBegin[c + 1]);
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ParticleCellIndex::size() const {
+	return uint32(m_order.size());
+}
+
+//---------------------------------------------------------------------------------------
+const std::vector<uint32> & ParticleCellIndex::order() const {
+	return m_order;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ParticleCellIndex::cellBegin(uint32 cell) const {
+	return m_cellBegin[cell];
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ParticleCellIndex::cellEnd(uint32 cell) const {
+	return m_cellBegin[cell + 1];
+}
+
+} // end namespace FluidSim
@@ -0,0 +1,105 @@
+/**
+* ParticleCellIndex.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Parallel.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace FluidSim {
+
+/**
+* Uniform grid of square cells over a 2D domain, mapping each cell to the
+* particles inside it, for neighbor searches over a fixed radius.
+*
+* build() counting sorts particle indices by cell: cells are counted, the
+* counts prefix summed into cellBegin(), and each particle is scattered into
+* its cell's range of order().  Within a cell, particles keep increasing index
+* order, so the result does not depend on the Execution.  Reordering particle
+* data by order(), see ParticleArrays::permute(), makes each cell's particles
+* contiguous in memory, so neighbor loops scan contiguous ranges instead of
+* chasing per-particle links.
+*
+* Cells are numbered row-major, row * width() + col, from the cell whose
+* lower left corner is origin().  Positions outside the grid belong to the
+* nearest edge cell.
+*/
+class ParticleCellIndex {
+public:
+    ParticleCellIndex();
+
+    /// Throws a FluidSim::Exception if \c width or \c height is zero, or if
+    /// \c cellSize is not positive.
+    ParticleCellIndex(uint32 width, uint32 height, float32 cellSize,
+            const vec2 & origin = vec2(0.0f));
+
+    /// Sets the grid dimensions, and empties the index.  Throws as the
+    /// constructor does.
+    void resize(uint32 width, uint32 height, float32 cellSize,
+            const vec2 & origin = vec2(0.0f));
+
+    uint32 width() const;
+
+    uint32 height() const;
+
+    uint32 numCells() const;
+
+    float32 cellSize() const;
+
+    vec2 origin() const;
+
+    /// Column of the cells containing x, clamped to the grid.
+    uint32 col(float32 x) const;
+
+    /// Row of the cells containing y, clamped to the grid.
+    uint32 row(float32 y) const;
+
+    /// Index of the cell containing (x,y), clamped to the grid.
+    uint32 cell(float32 x, float32 y) const;
+
+    /**
+    * Sorts particles 0 to \c count - 1, at positions (x[i], y[i]), by cell.
+    * With Execution::Parallel, cells are computed, counted and scattered
+    * concurrently on ThreadPool::global().
+    */
+    void build(const float32 * x, const float32 * y, uint32 count,
+            Execution execution = Execution::Serial);
+
+    /// Number of particles indexed by the last build().
+    uint32 size() const;
+
+    /// Particle indices sorted by cell, then by index.
+    const std::vector<uint32> & order() const;
+
+    /// Position in order() of the first particle in \c cell.
+    uint32 cellBegin(uint32 cell) const;
+
+    /// Position in order() one past the last particle in \c cell.
+    uint32 cellEnd(uint32 cell) const;
+
+private:
+    uint32 m_width;
+    uint32 m_height;
+    float32 m_cellSize;
+    float32 m_invCellSize;
+    vec2 m_origin;
+
+    // Cell of each particle.
+    std::vector<uint32> m_cells;
+
+    // Prefix sum of particles per cell, numCells() + 1 entries.
+    std::vector<uint32> m_cellBegin;
+
+    std::vector<uint32> m_order;
+
+    // Per cell counts, then scatter positions, of a parallel build().
+    std::vector< std::atomic<uint32> > m_counters;
+};
+
+} // end namespace FluidSim
@@ -3,15 +3,11 @@
 #pragma once
 
 #include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/GridFwd.hpp"
 
 #include <vector>
 #include <functional>
 
-// Forward Declaration
-namespace FluidSim {
-	template<typename T> class Grid;
-}
-
 
 namespace FluidSim {
 
@@ -73,6 +69,26 @@ void interpGridToParticles(
 );
 
 
+/**
+* Bilinearly interpolate grid attributes onto particles, sampling positions in
+* batches with the SIMD bilinear kernel.
+*
+* @param[out] attributes  attributes[i] is the value interpolated at positions[i].
+*
+* @param[in] positions  Particle positions.
+*
+* @param[in] grid  Grid that attributes are interpolated from.
+*
+*
+* @note Assumes attributes and positions are the same size.
+*/
+inline void interpGridToParticles(
+		std::vector<float32> & attributes,
+		const std::vector<vec2> & positions,
+		const Grid<float32> & grid
+);
+
+
 } // end namespace FluidSim
 
 
@@ -1,6 +1,7 @@
 #include "ParticleGridInterp.hpp"
 
 #include "FluidSim/Grid.hpp"
+#include "FluidSim/Interp.hpp"
 #include "FluidSim/Exception.hpp"
 #include "FluidSim/Utils.hpp"
 
@@ -105,5 +106,16 @@ void interpGridToParticles(
 
 }
 
+//---------------------------------------------------------------------------------------
+inline void interpGridToParticles(
+		std::vector<float32> & attributes,
+		const std::vector<vec2> & positions,
+		const Grid<float32> & grid
+) {
+	assert(attributes.size() == positions.size());
+
+	bilinear(grid, positions.data(), attributes.data(), uint32(positions.size()));
+}
+
 
 } // end namespace FluidSim
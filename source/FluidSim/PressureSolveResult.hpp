@@ -0,0 +1,20 @@
+/**
+* PressureSolveResult.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+
+namespace FluidSim {
+
+/// Outcome of a single pressure solve.
+struct PressureSolveResult {
+    uint32 iterations; // Number of iterations (or V-cycles) performed.
+    float32 residual;  // Max-norm of the residual b - Ap after the last iteration.
+    bool converged;    // True if residual reached the requested tolerance.
+};
+
+} // end namespace FluidSim
@@ -0,0 +1,396 @@
+// PressureSolver.cpp
+
+#include "PressureSolver.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace FluidSim;
+
+
+namespace {  // limit visibility to this file.
+
+// MIC(0) tuning constant, blends between incomplete Cholesky (0) and modified
+// incomplete Cholesky (1).
+const float64 kMicTau = 0.97;
+
+// Safety threshold guarding the MIC(0) factorization against tiny pivots.
+const float64 kMicSigma = 0.25;
+
+//---------------------------------------------------------------------------------------
+float64 dot(const Grid<float32> & a, const Grid<float32> & b) {
+	float64 sum = 0.0;
+	for (uint32 row(0); row < a.height(); ++row) {
+		const float32 * x = &a(0,row);
+		const float32 * y = &b(0,row);
+		for (uint32 col(0); col < a.width(); ++col) {
+			sum += float64(x[col]) * float64(y[col]);
+		}
+	}
+	return sum;
+}
+
+//---------------------------------------------------------------------------------------
+float32 maxAbs(const Grid<float32> & a) {
+	float32 result = 0.0f;
+	for (uint32 row(0); row < a.height(); ++row) {
+		const float32 * x = &a(0,row);
+		for (uint32 col(0); col < a.width(); ++col) {
+			result = std::max(result, std::abs(x[col]));
+		}
+	}
+	return result;
+}
+
+//---------------------------------------------------------------------------------------
+// y += alpha * x
+void addScaled(Grid<float32> & y, float64 alpha, const Grid<float32> & x) {
+	for (uint32 row(0); row < y.height(); ++row) {
+		for (uint32 col(0); col < y.width(); ++col) {
+			y(col,row) += float32(alpha * x(col,row));
+		}
+	}
+}
+
+} // end namespace
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+PressureSolver::PressureSolver(float32 tolerance, uint32 maxIterations)
+	: m_tolerance(tolerance),
+	  m_maxIterations(maxIterations),
+	  m_preconditioner(Preconditioner::MIC0),
+	  m_matrixRevision(0),
+	  m_preconRevision(0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+void PressureSolver::setTolerance(float32 tolerance) {
+	m_tolerance = tolerance;
+}
+
+//---------------------------------------------------------------------------------------
+float32 PressureSolver::tolerance() const {
+	return m_tolerance;
+}
+
+//---------------------------------------------------------------------------------------
+void PressureSolver::setMaxIterations(uint32 maxIterations) {
+	m_maxIterations = maxIterations;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 PressureSolver::maxIterations() const {
+	return m_maxIterations;
+}
+
+//---------------------------------------------------------------------------------------
+void PressureSolver::setPreconditioner(Preconditioner preconditioner) {
+	m_preconditioner = preconditioner;
+}
+
+//---------------------------------------------------------------------------------------
+Preconditioner PressureSolver::preconditioner() const {
+	return m_preconditioner;
+}
+
+//---------------------------------------------------------------------------------------
+MultigridSolver & PressureSolver::multigrid() {
+	return m_multigrid;
+}
+
+//---------------------------------------------------------------------------------------
+void PressureSolver::allocate(const GridSpec & spec) {
+	if (m_Adiag.gridSpec() == spec) {
+		return;
+	}
+	m_matrixRevision = 0;
+	m_preconRevision = 0;
+
+	const GridLayout layout(1);
+	Grid<float32> * grids[] = {
+		&m_Adiag, &m_Aplus_i, &m_Aplus_j, &m_precon,
+		&m_residual, &m_aux, &m_search, &m_As
+	};
+	for (Grid<float32> * grid : grids) {
+		*grid = Grid<float32>(spec, layout);
+		grid->setAll(0.0f);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+/**
+* Neighbor bits are only set for fluid cells, so solid cells get an empty row
+* without a separate test.
+*/
+void PressureSolver::buildMatrix(const PressureStencil & stencil) {
+	typedef PressureStencil S;
+
+	for (uint32 row(0); row < stencil.height(); ++row) {
+		const uint8 * mask = &stencil.neighborGrid()(0,row);
+		float32 * Adiag = &m_Adiag(0,row);
+		float32 * Aplus_i = &m_Aplus_i(0,row);
+		float32 * Aplus_j = &m_Aplus_j(0,row);
+
+		for (uint32 col(0); col < stencil.width(); ++col) {
+			const uint8 m = mask[col];
+			Adiag[col] = float32(((m & S::kLeftFluid) != 0) + ((m & S::kRightFluid) != 0) +
+					((m & S::kBottomFluid) != 0) + ((m & S::kTopFluid) != 0));
+			Aplus_i[col] = (m & S::kRightFluid) ? -1.0f : 0.0f;
+			Aplus_j[col] = (m & S::kTopFluid) ? -1.0f : 0.0f;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void PressureSolver::buildPreconditioner() {
+	// Couplings and factors in the border are zero, so cells on the lower and
+	// left edges need no special treatment.
+	for (uint32 row(0); row < m_Adiag.height(); ++row) {
+		const float32 * Adiag = &m_Adiag(0,row);
+		const float32 * Aplus_i = &m_Aplus_i(0,row);
+		const float32 * Aplus_j = &m_Aplus_j(0,row);
+		const float32 * Aplus_iBelow = &m_Aplus_i.at(0,int32(row)-1);
+		const float32 * Aplus_jBelow = &m_Aplus_j.at(0,int32(row)-1);
+		const float32 * preconBelow = &m_precon.at(0,int32(row)-1);
+		float32 * precon = &m_precon(0,row);
+
+		for (int32 col(0); col < int32(m_Adiag.width()); ++col) {
+			float64 diag = Adiag[col];
+			if (diag == 0.0) {
+				precon[col] = 0.0f;
+				continue;
+			}
+
+			float64 e = diag;
+			{
+				float64 a = Aplus_i[col-1];
+				float64 p = precon[col-1];
+				e -= (a * p) * (a * p);
+				e -= kMicTau * a * Aplus_j[col-1] * p * p;
+			}
+			{
+				float64 a = Aplus_jBelow[col];
+				float64 p = preconBelow[col];
+				e -= (a * p) * (a * p);
+				e -= kMicTau * a * Aplus_iBelow[col] * p * p;
+			}
+
+			if (e < kMicSigma * diag) {
+				e = diag;
+			}
+
+			precon[col] = float32(1.0 / std::sqrt(e));
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void PressureSolver::applyPreconditioner(const Grid<float32> & r, Grid<float32> & z) {
+	if (m_preconditioner == Preconditioner::Multigrid) {
+		m_multigrid.precondition(r, z);
+		return;
+	}
+
+	const int32 width = int32(r.width());
+	const int32 height = int32(r.height());
+
+	// z is one of the work grids, whose zero border stands in for the
+	// neighbors of edge cells in both triangular solves.
+
+	//-- Solve Lq = r, storing q in z.
+	for (int32 row(0); row < height; ++row) {
+		const float32 * Adiag = &m_Adiag(0,row);
+		const float32 * Aplus_i = &m_Aplus_i(0,row);
+		const float32 * Aplus_jBelow = &m_Aplus_j.at(0,row-1);
+		const float32 * precon = &m_precon(0,row);
+		const float32 * preconBelow = &m_precon.at(0,row-1);
+		const float32 * zBelow = &z.at(0,row-1);
+		float32 * zRow = &z(0,row);
+
+		for (int32 col(0); col < width; ++col) {
+			if (Adiag[col] == 0.0f) {
+				zRow[col] = 0.0f;
+				continue;
+			}
+
+			float32 t = r(col,row);
+			t -= Aplus_i[col-1] * precon[col-1] * zRow[col-1];
+			t -= Aplus_jBelow[col] * preconBelow[col] * zBelow[col];
+			zRow[col] = t * precon[col];
+		}
+	}
+
+	//-- Solve L^T z = q in place.
+	for (int32 row(height-1); row >= 0; --row) {
+		const float32 * Adiag = &m_Adiag(0,row);
+		const float32 * Aplus_i = &m_Aplus_i(0,row);
+		const float32 * Aplus_j = &m_Aplus_j(0,row);
+		const float32 * precon = &m_precon(0,row);
+		const float32 * zAbove = &z.at(0,row+1);
+		float32 * zRow = &z(0,row);
+
+		for (int32 col(width-1); col >= 0; --col) {
+			if (Adiag[col] == 0.0f) {
+				continue;
+			}
+
+			float32 t = zRow[col];
+			t -= Aplus_i[col] * precon[col] * zRow[col+1];
+			t -= Aplus_j[col] * precon[col] * zAbove[col];
+			zRow[col] = t * precon[col];
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void PressureSolver::applyA(const Grid<float32> & x, Grid<float32> & result) const {
+	const int32 width = int32(x.width());
+	const int32 height = int32(x.height());
+
+	// x is one of the work grids, so neighbors past the grid edges read as zero,
+	// as do the couplings to them.
+	for (int32 row(0); row < height; ++row) {
+		const float32 * Adiag = &m_Adiag(0,row);
+		const float32 * Aplus_i = &m_Aplus_i(0,row);
+		const float32 * Aplus_j = &m_Aplus_j(0,row);
+		const float32 * Aplus_jBelow = &m_Aplus_j.at(0,row-1);
+		const float32 * xBelow = &x.at(0,row-1);
+		const float32 * xRow = &x(0,row);
+		const float32 * xAbove = &x.at(0,row+1);
+		float32 * resultRow = &result(0,row);
+
+		for (int32 col(0); col < width; ++col) {
+			float32 value = Adiag[col] * xRow[col];
+			value += Aplus_i[col-1] * xRow[col-1];
+			value += Aplus_i[col] * xRow[col+1];
+			value += Aplus_jBelow[col] * xBelow[col];
+			value += Aplus_j[col] * xAbove[col];
+			resultRow[col] = value;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+PressureSolveResult PressureSolver::solve(
+		const Grid<CellType> & cells,
+		const Grid<float32> & rhs,
+		Grid<float32> & pressure
+) {
+	const GridSpec spec = rhs.gridSpec();
+	if (pressure.gridSpec() != spec ||
+		cells.width() != spec.width || cells.height() != spec.height)
+	{
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	// Keeps its revision unless the fluid cells changed since the last solve.
+	m_stencil.build(cells);
+
+	return solve(m_stencil, rhs, pressure);
+}
+
+//---------------------------------------------------------------------------------------
+PressureSolveResult PressureSolver::solve(
+		const PressureStencil & stencil,
+		const Grid<float32> & rhs,
+		Grid<float32> & pressure
+) {
+	const GridSpec spec = rhs.gridSpec();
+	if (pressure.gridSpec() != spec ||
+		stencil.width() != spec.width || stencil.height() != spec.height)
+	{
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	allocate(spec);
+	if (m_matrixRevision != stencil.revision()) {
+		buildMatrix(stencil);
+		m_matrixRevision = stencil.revision();
+	}
+	if (m_preconditioner == Preconditioner::Multigrid) {
+		m_multigrid.setup(stencil);
+	} else if (m_preconRevision != stencil.revision()) {
+		buildPreconditioner();
+		m_preconRevision = stencil.revision();
+	}
+
+	//-- Restrict the initial guess and right hand side to cells in the system.
+	for (uint32 row(0); row < spec.height; ++row) {
+		for (uint32 col(0); col < spec.width; ++col) {
+			if (m_Adiag(col,row) == 0.0f) {
+				pressure(col,row) = 0.0f;
+			}
+		}
+	}
+
+	//-- r = b - Ap, with p copied into a work grid for its border.
+	for (uint32 row(0); row < spec.height; ++row) {
+		for (uint32 col(0); col < spec.width; ++col) {
+			m_search(col,row) = pressure(col,row);
+		}
+	}
+	applyA(m_search, m_As);
+	for (uint32 row(0); row < spec.height; ++row) {
+		for (uint32 col(0); col < spec.width; ++col) {
+			m_residual(col,row) = (m_Adiag(col,row) == 0.0f) ?
+					0.0f : rhs(col,row) - m_As(col,row);
+		}
+	}
+
+	PressureSolveResult result;
+	result.iterations = 0;
+	result.residual = maxAbs(m_residual);
+	result.converged = false;
+
+	const float32 threshold = m_tolerance * maxAbs(rhs);
+	if (result.residual <= threshold) {
+		result.converged = true;
+		return result;
+	}
+
+	applyPreconditioner(m_residual, m_aux);
+	m_search = m_aux;
+	float64 sigma = dot(m_aux, m_residual);
+
+	while (result.iterations < m_maxIterations) {
+		applyA(m_search, m_As);
+
+		float64 sDotAs = dot(m_search, m_As);
+		if (sDotAs == 0.0) {
+			break;
+		}
+		float64 alpha = sigma / sDotAs;
+
+		addScaled(pressure, alpha, m_search);
+		addScaled(m_residual, -alpha, m_As);
+		++result.iterations;
+
+		result.residual = maxAbs(m_residual);
+		if (result.residual <= threshold) {
+			result.converged = true;
+			break;
+		}
+
+		applyPreconditioner(m_residual, m_aux);
+		float64 sigmaNew = dot(m_aux, m_residual);
+		float64 beta = sigmaNew / sigma;
+		sigma = sigmaNew;
+
+		//-- s = z + beta * s
+		for (uint32 row(0); row < spec.height; ++row) {
+			for (uint32 col(0); col < spec.width; ++col) {
+				m_search(col,row) = m_aux(col,row) + float32(beta * m_search(col,row));
+			}
+		}
+	}
+
+	return result;
+}
+
+} // end namespace FluidSim
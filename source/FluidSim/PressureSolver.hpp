@@ -0,0 +1,114 @@
+/**
+* PressureSolver.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Grid.hpp"
+#include "FluidSim/CellType.hpp"
+#include "FluidSim/PressureStencil.hpp"
+#include "FluidSim/PressureSolveResult.hpp"
+#include "FluidSim/MultigridSolver.hpp"
+
+namespace FluidSim {
+
+/// Preconditioners available to PressureSolver.
+enum class Preconditioner {
+    MIC0,     // Modified incomplete Cholesky, serial triangular solves.
+    Multigrid // One symmetric multigrid V-cycle per application.
+};
+
+/**
+* Preconditioned Conjugate Gradient solver for the pressure Poisson problem
+* Ap = b, with a MIC(0) (modified incomplete Cholesky) preconditioner by default,
+* or a multigrid V-cycle preconditioner.
+*
+* A is the 5-point Laplacian over Fluid cells of a CellType mask: the diagonal
+* entry of each fluid cell is its number of fluid neighbors, and each fluid
+* neighbor contributes -1.  Solid cells, and cells outside of the grid, impose a
+* zero pressure gradient and are left out of the system.  With unit spacing
+* this means b must already be scaled, e.g. b = -(density * dx / dt) * div(u).
+*
+* Iteration stops once max|b - Ap| <= tolerance * max|b|, or after
+* maxIterations.  Scratch grids are kept between calls and only reallocated
+* when the GridSpec changes.  A and its preconditioner are built from a
+* PressureStencil, and only rebuilt when the stencil's revision changes.
+*/
+class PressureSolver {
+public:
+    PressureSolver(float32 tolerance = 1.0e-5f, uint32 maxIterations = 200);
+
+    void setTolerance(float32 tolerance);
+
+    float32 tolerance() const;
+
+    void setMaxIterations(uint32 maxIterations);
+
+    uint32 maxIterations() const;
+
+    void setPreconditioner(Preconditioner preconditioner);
+
+    Preconditioner preconditioner() const;
+
+    /// Multigrid used when the preconditioner is Preconditioner::Multigrid.  Its
+    /// smoothing and execution settings may be changed through this reference.
+    MultigridSolver & multigrid();
+
+    /// Solves Ap = \c rhs over the Fluid cells of \c cells.  The incoming value of
+    /// \c pressure is used as the initial guess; non-fluid cells are set to zero.
+    /// Throws a FluidSim::Exception if the three grids differ in size.
+    PressureSolveResult solve(
+            const Grid<CellType> & cells,
+            const Grid<float32> & rhs,
+            Grid<float32> & pressure
+    );
+
+    /// As above, over the active cells of \c stencil.  Callers that keep their
+    /// own stencil avoid rescanning the CellType grid on every solve.
+    PressureSolveResult solve(
+            const PressureStencil & stencil,
+            const Grid<float32> & rhs,
+            Grid<float32> & pressure
+    );
+
+private:
+    float32 m_tolerance;
+    uint32 m_maxIterations;
+    Preconditioner m_preconditioner;
+    MultigridSolver m_multigrid;
+
+    // Stencil for the CellType overload of solve().
+    PressureStencil m_stencil;
+
+    // Stencil revisions that A and the MIC(0) factor were last built for, zero
+    // if they need building.
+    uint64 m_matrixRevision;
+    uint64 m_preconRevision;
+
+    // Matrix A in compressed form: diagonal, and coupling to the +x and +y
+    // neighbors.  Couplings to -x and -y follow from symmetry.
+    //
+    // All work grids carry a one cell border of zeros, so the matrix and
+    // preconditioner kernels read neighbors past the grid edges without
+    // bounds checks.
+    Grid<float32> m_Adiag;
+    Grid<float32> m_Aplus_i;
+    Grid<float32> m_Aplus_j;
+
+    Grid<float32> m_precon;  // MIC(0) factor, 1 / sqrt(E) per cell.
+    Grid<float32> m_residual;
+    Grid<float32> m_aux;     // Preconditioned residual z, and forward solve q.
+    Grid<float32> m_search;  // Search direction s.
+    Grid<float32> m_As;      // A applied to the search direction.
+
+    void allocate(const GridSpec & spec);
+    void buildMatrix(const PressureStencil & stencil);
+    void buildPreconditioner();
+    void applyPreconditioner(const Grid<float32> & r, Grid<float32> & z);
+    void applyA(const Grid<float32> & x, Grid<float32> & result) const;
+};
+
+} // end namespace FluidSim
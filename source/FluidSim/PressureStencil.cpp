@@ -0,0 +1,180 @@
+// PressureStencil.cpp
+
+#include "PressureStencil.hpp"
+
+#include <atomic>
+
+using namespace FluidSim;
+
+
+namespace {  // limit visibility to this file.
+
+// Source of PressureStencil revisions, shared by all instances so that no two
+// layouts are given the same revision.
+std::atomic<uint64> s_nextRevision(1);
+
+} // end namespace
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+PressureStencil::PressureStencil()
+	: m_revision(0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+PressureStencil::PressureStencil(const Grid<CellType> & cells)
+	: m_revision(0)
+{
+	build(cells);
+}
+
+//---------------------------------------------------------------------------------------
+/**
+* True if the stencil was built from a grid of the same size as \c cells, with
+* the same fluid cells.  The neighbor bits and sparse lists depend on nothing
+* else.
+*/
+bool PressureStencil::matches(const Grid<CellType> & cells) const {
+	if (m_revision == 0 || m_neighbors.gridSpec() != cells.gridSpec()) {
+		return false;
+	}
+
+	for (uint32 row(0); row < cells.height(); ++row) {
+		const CellType * cellRow = &cells(0,row);
+		const uint8 * maskRow = &m_neighbors(0,row);
+		for (uint32 col(0); col < cells.width(); ++col) {
+			if ((cellRow[col] == CellType::Fluid) != bool(maskRow[col] & kFluid)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+void PressureStencil::build(const Grid<CellType> & cells) {
+	if (matches(cells)) {
+		return;
+	}
+	m_revision = s_nextRevision++;
+
+	const GridSpec spec = cells.gridSpec();
+	if (m_neighbors.gridSpec() != spec) {
+		m_neighbors = Grid<uint8>(spec);
+		m_inverseDiagonal = Grid<float32>(spec);
+		m_fluidCells.resize(spec.width, spec.height);
+		m_uFaces.resize(spec.width + 1, spec.height);
+		m_vFaces.resize(spec.width, spec.height + 1);
+	} else {
+		m_fluidCells.clear();
+		m_uFaces.clear();
+		m_vFaces.clear();
+	}
+
+	auto isFluid = [&] (int32 col, int32 row) {
+		return cells.isValidCoord(col, row) && cells(col, row) == CellType::Fluid;
+	};
+
+	for (int32 row(0); row < int32(spec.height); ++row) {
+		for (int32 col(0); col < int32(spec.width); ++col) {
+			uint8 mask = 0;
+			uint32 numFluidNeighbors = 0;
+
+			if (isFluid(col, row)) {
+				mask |= kFluid;
+				if (isFluid(col-1, row)) { mask |= kLeftFluid; ++numFluidNeighbors; }
+				if (isFluid(col+1, row)) { mask |= kRightFluid; ++numFluidNeighbors; }
+				if (isFluid(col, row-1)) { mask |= kBottomFluid; ++numFluidNeighbors; }
+				if (isFluid(col, row+1)) { mask |= kTopFluid; ++numFluidNeighbors; }
+			}
+
+			m_neighbors(col,row) = mask;
+			m_inverseDiagonal(col,row) = (numFluidNeighbors > 0) ?
+					1.0f / numFluidNeighbors : 0.0f;
+		}
+	}
+
+	//-- Sparse lists, inserted in row-major order.
+	for (uint32 row(0); row < spec.height; ++row) {
+		for (uint32 col(0); col < spec.width; ++col) {
+			if (m_neighbors(col,row) & kFluid) {
+				m_fluidCells.insert(col, row);
+			}
+		}
+	}
+	for (uint32 row(0); row < spec.height; ++row) {
+		for (int32 col(0); col <= int32(spec.width); ++col) {
+			if (isFluid(col-1, row) || isFluid(col, row)) {
+				m_uFaces.insert(col, row);
+			}
+		}
+	}
+	for (int32 row(0); row <= int32(spec.height); ++row) {
+		for (uint32 col(0); col < spec.width; ++col) {
+			if (isFluid(col, row-1) || isFluid(col, row)) {
+				m_vFaces.insert(col, row);
+			}
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+uint64 PressureStencil::revision() const {
+	return m_revision;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 PressureStencil::width() const {
+	return m_neighbors.width();
+}
+
+//---------------------------------------------------------------------------------------
+uint32 PressureStencil::height() const {
+	return m_neighbors.height();
+}
+
+//---------------------------------------------------------------------------------------
+uint8 PressureStencil::neighbors(uint32 col, uint32 row) const {
+	return m_neighbors(col,row);
+}
+
+//---------------------------------------------------------------------------------------
+float32 PressureStencil::inverseDiagonal(uint32 col, uint32 row) const {
+	return m_inverseDiagonal(col,row);
+}
+
+//---------------------------------------------------------------------------------------
+bool PressureStencil::isActive(uint32 col, uint32 row) const {
+	return m_inverseDiagonal(col,row) != 0.0f;
+}
+
+//---------------------------------------------------------------------------------------
+const Grid<uint8> & PressureStencil::neighborGrid() const {
+	return m_neighbors;
+}
+
+//---------------------------------------------------------------------------------------
+const Grid<float32> & PressureStencil::inverseDiagonalGrid() const {
+	return m_inverseDiagonal;
+}
+
+//---------------------------------------------------------------------------------------
+const ActiveCellList & PressureStencil::fluidCells() const {
+	return m_fluidCells;
+}
+
+//---------------------------------------------------------------------------------------
+const ActiveCellList & PressureStencil::uFaces() const {
+	return m_uFaces;
+}
+
+//---------------------------------------------------------------------------------------
+const ActiveCellList & PressureStencil::vFaces() const {
+	return m_vFaces;
+}
+
+} // end namespace FluidSim
@@ -0,0 +1,92 @@
+/**
+* PressureStencil.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Grid.hpp"
+#include "FluidSim/CellType.hpp"
+#include "FluidSim/ActiveCellList.hpp"
+
+namespace FluidSim {
+
+/**
+* Per-cell summary of a CellType mask for the pressure projection: a bitmask of
+* which neighbors are fluid, and the reciprocal of the number of fluid
+* neighbors (the inverse diagonal of the pressure matrix).
+*
+* Build it once whenever the solid layout changes, then pass it to the pressure
+* kernels in place of the CellType grid so that their inner loops need no
+* branches on neighbor types.  Neighbors outside of the grid count as solid.
+*
+* The stencil also lists the fluid cells, and the u and v faces that touch at
+* least one fluid cell, for the sparse kernels that only visit those.
+*/
+class PressureStencil {
+public:
+    /// Bits stored in neighbors().
+    enum : uint8 {
+        kFluid = 1 << 0,       // The cell itself is fluid.
+        kLeftFluid = 1 << 1,   // (col-1, row) is fluid.
+        kRightFluid = 1 << 2,  // (col+1, row) is fluid.
+        kBottomFluid = 1 << 3, // (col, row-1) is fluid.
+        kTopFluid = 1 << 4     // (col, row+1) is fluid.
+    };
+
+    PressureStencil();
+
+    explicit PressureStencil(const Grid<CellType> & cells);
+
+    /// Rebuilds the stencil from \c cells.  Storage is reused if the grid size
+    /// is unchanged, and nothing is rebuilt if no cell changed between fluid and
+    /// non-fluid.
+    void build(const Grid<CellType> & cells);
+
+    /// Identifies the current layout.  Changes whenever build() changes the
+    /// stencil, and differs between separately built stencils, so solvers can
+    /// cache matrices derived from it.  Zero until the first build().
+    uint64 revision() const;
+
+    uint32 width() const;
+
+    uint32 height() const;
+
+    /// Neighbor bitmask of cell (col,row).  Zero for solid cells.
+    uint8 neighbors(uint32 col, uint32 row) const;
+
+    /// 1 / number of fluid neighbors of cell (col,row).  Zero for solid cells
+    /// and for fluid cells without fluid neighbors.
+    float32 inverseDiagonal(uint32 col, uint32 row) const;
+
+    /// True if cell (col,row) is fluid and has at least one fluid neighbor,
+    /// i.e. takes part in the pressure system.
+    bool isActive(uint32 col, uint32 row) const;
+
+    const Grid<uint8> & neighborGrid() const;
+
+    const Grid<float32> & inverseDiagonalGrid() const;
+
+    /// Fluid cells, in row-major order.
+    const ActiveCellList & fluidCells() const;
+
+    /// Faces of the (width+1) x height u grid with a fluid cell on either side.
+    const ActiveCellList & uFaces() const;
+
+    /// Faces of the width x (height+1) v grid with a fluid cell on either side.
+    const ActiveCellList & vFaces() const;
+
+private:
+    uint64 m_revision;
+    Grid<uint8> m_neighbors;
+    Grid<float32> m_inverseDiagonal;
+    ActiveCellList m_fluidCells;
+    ActiveCellList m_uFaces;
+    ActiveCellList m_vFaces;
+
+    bool matches(const Grid<CellType> & cells) const;
+};
+
+} // end namespace FluidSim
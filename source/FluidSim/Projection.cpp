@@ -0,0 +1,281 @@
+// Projection.cpp
+
+#include "Projection.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace FluidSim;
+
+
+namespace {  // limit visibility to this file.
+
+//---------------------------------------------------------------------------------------
+void checkStaggeredGridSize(
+		const StaggeredGrid<float32> & velocity,
+		const PressureStencil & stencil
+) {
+	if (velocity.u.width() != stencil.width() + 1 ||
+		velocity.u.height() != stencil.height() ||
+		velocity.v.width() != stencil.width() ||
+		velocity.v.height() != stencil.height() + 1)
+	{
+		throw FluidSim::Exception("StaggeredGrid does not match PressureStencil.");
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// Raises \c result to \c value if it is larger.  Max is order independent, so
+// combining tiles this way gives the same result as a serial scan.
+void atomicMax(std::atomic<float32> & result, float32 value) {
+	float32 current = result.load(std::memory_order_relaxed);
+	while (value > current &&
+			!result.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void checkCellList(const ActiveCellList & cells, const PressureStencil & stencil) {
+	if (cells.width() != stencil.width() || cells.height() != stencil.height()) {
+		throw FluidSim::Exception("ActiveCellList does not match PressureStencil.");
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// Right hand side of fluid cell (col,row) with neighbor bits \c mask.
+inline float32 rhsValue(
+		const Grid<float32> & u,
+		const Grid<float32> & v,
+		uint8 mask,
+		uint32 col,
+		uint32 row,
+		float32 scale,
+		const vec2 & solidVelocity
+) {
+	float32 delta_u( u(col+1, row) - u(col,row) );
+	float32 delta_v( v(col, row+1) - v(col, row) );
+	float32 value = scale * (delta_u + delta_v);
+
+	// Update based on solid boundaries:
+	if (!(mask & PressureStencil::kLeftFluid)) {
+		value += scale * (u(col,row) - solidVelocity.x);
+	}
+	if (!(mask & PressureStencil::kRightFluid)) {
+		value -= scale * (u(col+1,row) - solidVelocity.x);
+	}
+	if (!(mask & PressureStencil::kBottomFluid)) {
+		value += scale * (v(col,row) - solidVelocity.y);
+	}
+	if (!(mask & PressureStencil::kTopFluid)) {
+		value -= scale * (v(col,row+1) - solidVelocity.y);
+	}
+
+	return value;
+}
+
+} // end namespace
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+void computePressureRhs(
+		const StaggeredGrid<float32> & velocity,
+		const PressureStencil & stencil,
+		float32 rhsScale,
+		const vec2 & solidVelocity,
+		Grid<float32> & rhs,
+		Execution execution
+) {
+	checkStaggeredGridSize(velocity, stencil);
+	if (rhs.width() != stencil.width() || rhs.height() != stencil.height()) {
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	const Grid<float32> & u = velocity.u;
+	const Grid<float32> & v = velocity.v;
+	const float32 scale = rhsScale;
+	const uint32 width = stencil.width();
+
+	parallelFor(execution, 0, stencil.height(), [&] (uint32 rowBegin, uint32 rowEnd) {
+		for (uint32 row(rowBegin); row < rowEnd; ++row) {
+			for (uint32 col(0); col < width; ++col) {
+				uint8 mask = stencil.neighbors(col,row);
+				if (!(mask & PressureStencil::kFluid)) {
+					rhs(col,row) = 0.0f;
+					continue;
+				}
+
+				rhs(col,row) = rhsValue(u, v, mask, col, row, scale, solidVelocity);
+			}
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+void subtractPressureGradient(
+		StaggeredGrid<float32> & velocity,
+		const PressureStencil & stencil,
+		const Grid<float32> & pressure,
+		float32 gradientScale,
+		const vec2 & solidVelocity,
+		Execution execution
+) {
+	checkStaggeredGridSize(velocity, stencil);
+	if (pressure.width() != stencil.width() || pressure.height() != stencil.height()) {
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	Grid<float32> & u = velocity.u;
+	Grid<float32> & v = velocity.v;
+	const Grid<float32> & p = pressure;
+	const float32 scale = gradientScale;
+	const uint32 width = stencil.width();
+	const uint32 height = stencil.height();
+
+	//-- u faces, between cells (col-1,row) and (col,row).
+	parallelFor(execution, 0, height, [&] (uint32 rowBegin, uint32 rowEnd) {
+		for (uint32 row(rowBegin); row < rowEnd; ++row) {
+			u(0,row) = solidVelocity.x;
+			for (uint32 col(1); col < width; ++col) {
+				if (stencil.neighbors(col,row) & PressureStencil::kLeftFluid) {
+					u(col,row) = (u(col,row) + scale * p(col-1,row)) - scale * p(col,row);
+				} else {
+					u(col,row) = solidVelocity.x;
+				}
+			}
+			u(width,row) = solidVelocity.x;
+		}
+	});
+
+	//-- v faces, between cells (col,row-1) and (col,row).
+	parallelFor(execution, 0, height + 1, [&] (uint32 rowBegin, uint32 rowEnd) {
+		for (uint32 row(rowBegin); row < rowEnd; ++row) {
+			if (row == 0 || row == height) {
+				for (uint32 col(0); col < width; ++col) {
+					v(col,row) = solidVelocity.y;
+				}
+				continue;
+			}
+
+			for (uint32 col(0); col < width; ++col) {
+				if (stencil.neighbors(col,row) & PressureStencil::kBottomFluid) {
+					v(col,row) = (v(col,row) + scale * p(col,row-1)) - scale * p(col,row);
+				} else {
+					v(col,row) = solidVelocity.y;
+				}
+			}
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+void computePressureRhs(
+		const StaggeredGrid<float32> & velocity,
+		const PressureStencil & stencil,
+		const ActiveCellList & cells,
+		float32 rhsScale,
+		const vec2 & solidVelocity,
+		Grid<float32> & rhs,
+		Execution execution
+) {
+	checkStaggeredGridSize(velocity, stencil);
+	checkCellList(cells, stencil);
+	if (rhs.width() != stencil.width() || rhs.height() != stencil.height()) {
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	const Grid<float32> & u = velocity.u;
+	const Grid<float32> & v = velocity.v;
+	const float32 scale = rhsScale;
+
+	parallelFor(execution, 0, cells.size(), [&] (uint32 begin, uint32 end) {
+		cells.forEachSpan(begin, end, [&] (uint32 row, uint32 colBegin, uint32 colEnd) {
+			for (uint32 col(colBegin); col < colEnd; ++col) {
+				uint8 mask = stencil.neighbors(col,row);
+				rhs(col,row) = (mask & PressureStencil::kFluid) ?
+						rhsValue(u, v, mask, col, row, scale, solidVelocity) : 0.0f;
+			}
+		});
+	});
+}
+
+//---------------------------------------------------------------------------------------
+void subtractPressureGradient(
+		StaggeredGrid<float32> & velocity,
+		const PressureStencil & stencil,
+		const ActiveCellList & cells,
+		const Grid<float32> & pressure,
+		float32 gradientScale,
+		const vec2 & solidVelocity,
+		Execution execution,
+		vec2 * maxVelocity
+) {
+	checkStaggeredGridSize(velocity, stencil);
+	checkCellList(cells, stencil);
+	if (pressure.width() != stencil.width() || pressure.height() != stencil.height()) {
+		throw FluidSim::Exception("GridSpecs do not match.");
+	}
+
+	Grid<float32> & u = velocity.u;
+	Grid<float32> & v = velocity.v;
+	const Grid<float32> & p = pressure;
+	const float32 scale = gradientScale;
+	const float32 solidU = std::abs(solidVelocity.x);
+	const float32 solidV = std::abs(solidVelocity.y);
+	std::atomic<float32> maxU(0.0f);
+	std::atomic<float32> maxV(0.0f);
+
+	// Each fluid cell owns its left and bottom faces.  Its right and top faces
+	// belong to the neighbor if that is fluid, and are solid otherwise, so no
+	// face is written by two cells.
+	parallelFor(execution, 0, cells.size(), [&] (uint32 begin, uint32 end) {
+		float32 tileMaxU = 0.0f;
+		float32 tileMaxV = 0.0f;
+		cells.forEachSpan(begin, end, [&] (uint32 row, uint32 colBegin, uint32 colEnd) {
+			for (uint32 col(colBegin); col < colEnd; ++col) {
+				uint8 mask = stencil.neighbors(col,row);
+				if (!(mask & PressureStencil::kFluid)) {
+					continue;
+				}
+
+				if (mask & PressureStencil::kLeftFluid) {
+					u(col,row) = (u(col,row) + scale * p(col-1,row)) - scale * p(col,row);
+					tileMaxU = std::max(tileMaxU, std::abs(u(col,row)));
+				} else {
+					u(col,row) = solidVelocity.x;
+					tileMaxU = std::max(tileMaxU, solidU);
+				}
+				if (!(mask & PressureStencil::kRightFluid)) {
+					u(col+1,row) = solidVelocity.x;
+					tileMaxU = std::max(tileMaxU, solidU);
+				}
+
+				if (mask & PressureStencil::kBottomFluid) {
+					v(col,row) = (v(col,row) + scale * p(col,row-1)) - scale * p(col,row);
+					tileMaxV = std::max(tileMaxV, std::abs(v(col,row)));
+				} else {
+					v(col,row) = solidVelocity.y;
+					tileMaxV = std::max(tileMaxV, solidV);
+				}
+				if (!(mask & PressureStencil::kTopFluid)) {
+					v(col,row+1) = solidVelocity.y;
+					tileMaxV = std::max(tileMaxV, solidV);
+				}
+			}
+		});
+
+		if (maxVelocity) {
+			atomicMax(maxU, tileMaxU);
+			atomicMax(maxV, tileMaxV);
+		}
+	});
+
+	if (maxVelocity) {
+		*maxVelocity = vec2(maxU.load(), maxV.load());
+	}
+}
+
+} // end namespace FluidSim
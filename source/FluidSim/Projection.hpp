@@ -0,0 +1,88 @@
+/**
+* Projection.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Grid.hpp"
+#include "FluidSim/StaggeredGrid.hpp"
+#include "FluidSim/PressureStencil.hpp"
+#include "FluidSim/ActiveCellList.hpp"
+#include "FluidSim/Parallel.hpp"
+
+namespace FluidSim {
+
+/**
+* Computes the right hand side of the pressure system for every fluid cell:
+*
+*     rhs = rhsScale * (u(col+1,row) - u(col,row) + v(col,row+1) - v(col,row))
+*
+* plus the usual correction for each face shared with a solid neighbor, which
+* moves at \c solidVelocity.  Non-fluid cells get zero.  \c velocity must be the
+* staggered grid of a cell-centered grid with the same size as \c stencil.
+* SmokeSim uses rhsScale = -density * dx / dt.
+*/
+void computePressureRhs(
+        const StaggeredGrid<float32> & velocity,
+        const PressureStencil & stencil,
+        float32 rhsScale,
+        const vec2 & solidVelocity,
+        Grid<float32> & rhs,
+        Execution execution = Execution::Serial
+);
+
+/**
+* Makes \c velocity divergence free by subtracting gradientScale times the
+* pressure gradient from every face between two fluid cells.  Faces touching a
+* solid cell, or the edge of the grid, are set to \c solidVelocity.
+* SmokeSim uses gradientScale = dt / (density * dx).
+*/
+void subtractPressureGradient(
+        StaggeredGrid<float32> & velocity,
+        const PressureStencil & stencil,
+        const Grid<float32> & pressure,
+        float32 gradientScale,
+        const vec2 & solidVelocity,
+        Execution execution = Execution::Serial
+);
+
+/**
+* Sparse variant of computePressureRhs() that only writes the cells in \c cells,
+* typically stencil.fluidCells().  Other cells of \c rhs are left untouched.
+* Listed cells receive exactly the value the dense version computes.
+*/
+void computePressureRhs(
+        const StaggeredGrid<float32> & velocity,
+        const PressureStencil & stencil,
+        const ActiveCellList & cells,
+        float32 rhsScale,
+        const vec2 & solidVelocity,
+        Grid<float32> & rhs,
+        Execution execution = Execution::Serial
+);
+
+/**
+* Sparse variant of subtractPressureGradient() for \c cells, typically
+* stencil.fluidCells().  Updates the faces of the listed fluid cells with exactly
+* the values the dense version computes, and leaves every other face untouched.
+* Passing stencil.fluidCells() therefore updates exactly stencil.uFaces() and
+* stencil.vFaces(); faces between two solid cells keep whatever they held.
+*
+* If \c maxVelocity is given, it receives the largest |u| and |v| among the
+* updated faces, found in the same pass, which is what a CFL time step needs.
+*/
+void subtractPressureGradient(
+        StaggeredGrid<float32> & velocity,
+        const PressureStencil & stencil,
+        const ActiveCellList & cells,
+        const Grid<float32> & pressure,
+        float32 gradientScale,
+        const vec2 & solidVelocity,
+        Execution execution = Execution::Serial,
+        vec2 * maxVelocity = nullptr
+);
+
+} // end namespace FluidSim
@@ -0,0 +1,71 @@
+// Simulation.cpp
+
+#include "Simulation.hpp"
+#include "FluidSim/Grid.hpp"
+#include "FluidSim/Grid3.hpp"
+
+using namespace FluidSim;
+
+
+namespace FluidSim {
+
+//---------------------------------------------------------------------------------------
+size_t FieldView::size() const {
+	return size_t(width) * height * depth;
+}
+
+//---------------------------------------------------------------------------------------
+FieldView makeFieldView(const std::string & name, const Grid<float32> & grid) {
+	FieldView view;
+	view.name = name;
+	view.data = grid.data();
+	view.width = grid.width();
+	view.height = grid.height();
+	view.depth = 1;
+	view.components = 1;
+	view.elementStride = 1;
+	view.rowPitch = grid.pitch();
+	view.slicePitch = size_t(grid.pitch()) * grid.height();
+
+	return view;
+}
+
+//---------------------------------------------------------------------------------------
+FieldView makeFieldView(const std::string & name, const Grid3<float32> & grid) {
+	FieldView view;
+	view.name = name;
+	view.data = grid.data();
+	view.width = grid.width();
+	view.height = grid.height();
+	view.depth = grid.depth();
+	view.components = 1;
+	view.elementStride = 1;
+	view.rowPitch = grid.pitch();
+	view.slicePitch = grid.slicePitch();
+
+	return view;
+}
+
+//---------------------------------------------------------------------------------------
+FieldView makeFieldView(
+		const std::string & name,
+		const float32 * data,
+		uint32 count,
+		uint32 components,
+		size_t elementStride
+) {
+	FieldView view;
+	view.name = name;
+	view.data = data;
+	view.width = count;
+	view.height = 1;
+	view.depth = 1;
+	view.components = components;
+	view.elementStride = elementStride;
+	view.rowPitch = elementStride * count;
+	view.slicePitch = view.rowPitch;
+
+	return view;
+}
+
+} // end namespace FluidSim
@@ -0,0 +1,79 @@
+/**
+* Simulation.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/GridFwd.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace FluidSim {
+
+/**
+* Read only view of one output field of a Simulation, either a 1D, 2D or 3D
+* grid, or an array of particle attributes stored as a count x 1 x 1 grid.
+* Element (x,y,z) starts at
+*
+*     data[z * slicePitch + y * rowPitch + x * elementStride]
+*
+* and holds \c components consecutive float32s, e.g. 2 for particle
+* positions.  Strides are counted in float32s.
+*/
+struct FieldView {
+    std::string name;
+    const float32 * data;
+    uint32 width;
+    uint32 height;
+    uint32 depth;
+    uint32 components;
+    size_t elementStride;
+    size_t rowPitch;
+    size_t slicePitch;
+
+    /// Number of elements, width * height * depth.
+    size_t size() const;
+};
+
+/// View of the cells of \c grid, excluding border cells.
+FieldView makeFieldView(const std::string & name, const Grid<float32> & grid);
+
+/// View of the cells of \c grid, excluding border cells.
+FieldView makeFieldView(const std::string & name, const Grid3<float32> & grid);
+
+/// View of \c count elements of \c components float32s each, \c elementStride
+/// float32s apart, such as a member of every element of an array of structs.
+FieldView makeFieldView(
+        const std::string & name,
+        const float32 * data,
+        uint32 count,
+        uint32 components,
+        size_t elementStride
+);
+
+/**
+* Interface for simulations that can be stepped without a window or OpenGL
+* context, so that they can be driven either by a demo's frame loop or by
+* runHeadless() as fast as the hardware allows.
+*/
+class Simulation {
+public:
+    virtual ~Simulation() { }
+
+    /// Sets up, or resets, the simulation to its initial state.
+    virtual void init() = 0;
+
+    /// Advances the simulation by \c dt seconds.
+    virtual void step(float32 dt) = 0;
+
+    /// Views of the current output fields.  Views remain valid until the next
+    /// call to init() or step().
+    virtual std::vector<FieldView> fields() const = 0;
+};
+
+} // end namespace FluidSim
@@ -0,0 +1,531 @@
+// SmokeSim3D.cpp
+
+#include "SmokeSim3D.hpp"
+#include "FluidSim/Advect.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace FluidSim;
+
+
+namespace {  // limit visibility to this file.
+
+// Bits of SmokeSim3D::m_fluidNeighbors, in the style of PressureStencil.
+enum : uint8 {
+	kFluid = 1 << 0,       // The cell itself is fluid.
+	kLeftFluid = 1 << 1,   // (col-1, row, layer) is fluid.
+	kRightFluid = 1 << 2,  // (col+1, row, layer) is fluid.
+	kBottomFluid = 1 << 3, // (col, row-1, layer) is fluid.
+	kTopFluid = 1 << 4,    // (col, row+1, layer) is fluid.
+	kNearFluid = 1 << 5,   // (col, row, layer-1) is fluid.
+	kFarFluid = 1 << 6     // (col, row, layer+1) is fluid.
+};
+
+// Extents of the injection block and solid block of GpuSmokeSim3D, in cells of
+// its 64^3 grid.
+const uint32 kInjectSize = 5;
+const uint32 kInjectStartLayer = 1;
+const uint32 kInjectLayers = 2;
+const uint32 kSolidSize = 15;
+const uint32 kSolidStartLayer = 30;
+const uint32 kSolidEndLayer = 40; // Inclusive.
+
+//---------------------------------------------------------------------------------------
+// Scales a count of cells along a GpuSmokeSim3D grid axis to one of \c size cells.
+uint32 scaledCount(uint32 count, uint32 size) {
+	float32 scaled = float32(count) * size / SmokeSim3D::kGridSize;
+	return std::max(1u, uint32(scaled + 0.5f));
+}
+
+//---------------------------------------------------------------------------------------
+// Sets cells (col,row,layer) for col in [col0, col0 + width), and similarly for
+// rows and layers.
+template <typename T>
+void setBlock(
+		Grid3<T> & grid,
+		uint32 col0, uint32 row0, uint32 layer0,
+		uint32 width, uint32 height, uint32 depth,
+		const T & value
+) {
+	for (uint32 layer(layer0); layer < layer0 + depth; ++layer) {
+		for (uint32 row(row0); row < row0 + height; ++row) {
+			for (uint32 col(col0); col < col0 + width; ++col) {
+				grid(col, row, layer) = value;
+			}
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+// Sets every cell of \c grid, leaving its border untouched.
+template <typename T>
+void setCells(Grid3<T> & grid, const T & value) {
+	setBlock(grid, 0, 0, 0, grid.width(), grid.height(), grid.depth(), value);
+}
+
+//---------------------------------------------------------------------------------------
+// Copies the edge faces of each velocity component into its border, as sampling
+// the GPU velocity textures with GL_CLAMP_TO_EDGE does.
+void clampBorders(StaggeredGrid3<float32> & velocity) {
+	velocity.u.fillBorder(BorderPolicy::Clamp);
+	velocity.v.fillBorder(BorderPolicy::Clamp);
+	velocity.w.fillBorder(BorderPolicy::Clamp);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Func>
+double timeStage(Func && stage) {
+	using namespace std::chrono;
+
+	steady_clock::time_point start = steady_clock::now();
+	stage();
+	return duration_cast<duration<double> >(steady_clock::now() - start).count();
+}
+
+//---------------------------------------------------------------------------------------
+/**
+* Subtracts \c scale times the pressure difference across each face of
+* \c velocity, whose faces are normal to \c axis.  Face (col,row,layer) lies
+* between cells (col,row,layer) - axis and (col,row,layer).  Faces touching a
+* solid cell are set to zero.
+*/
+void projectComponent(
+		Grid3<float32> & velocity,
+		const ivec3 & axis,
+		const Grid3<CellType> & cellType,
+		const Grid3<float32> & pressure,
+		float32 scale,
+		Execution execution
+) {
+	const uint32 height = velocity.height();
+
+	parallelFor(execution, 0, height * velocity.depth(),
+			[&] (uint32 rowBegin, uint32 rowEnd) {
+		for (uint32 r(rowBegin); r < rowEnd; ++r) {
+			const int32 row = int32(r % height);
+			const int32 layer = int32(r / height);
+
+			float32 * face = &velocity(0, row, layer);
+			const CellType * cellHi = &cellType.at(0, row, layer);
+			const CellType * cellLo = &cellType.at(-axis.x, row - axis.y, layer - axis.z);
+			const float32 * pHi = &pressure.at(0, row, layer);
+			const float32 * pLo = &pressure.at(-axis.x, row - axis.y, layer - axis.z);
+
+			for (uint32 col(0); col < velocity.width(); ++col) {
+				if (cellHi[col] == CellType::Solid || cellLo[col] == CellType::Solid) {
+					face[col] = 0.0f;
+				} else {
+					face[col] -= scale * (pHi[col] - pLo[col]);
+				}
+			}
+		}
+	});
+}
+
+} // end namespace
+
+
+namespace FluidSim {
+
+const uint32 SmokeSim3D::kGridSize;
+const uint32 SmokeSim3D::kJacobiIterations;
+const uint32 SmokeSim3D::kInjectFrames;
+const float32 SmokeSim3D::kDt = 0.01f;
+const float32 SmokeSim3D::kTemp_0 = 273.0f;
+const float32 SmokeSim3D::kBuoyant_d = 0.8f;
+const float32 SmokeSim3D::kBuoyant_t = 0.34f;
+const float32 SmokeSim3D::kDensity = 1.0f;
+const float32 SmokeSim3D::kInjectDensity = 2.0f;
+const float32 SmokeSim3D::kInjectTemperature = 500.0f;
+
+//---------------------------------------------------------------------------------------
+double SmokeSim3DTimings::total() const {
+	return inject + advect + buoyancy + divergence + pressure + project;
+}
+
+//---------------------------------------------------------------------------------------
+SmokeSim3D::SmokeSim3D(uint32 width, uint32 height, uint32 depth)
+	: m_execution(Execution::Serial),
+	  m_jacobiIterations(kJacobiIterations),
+	  m_frame(0),
+	  m_timings()
+{
+	if (width == 0 || height == 0 || depth < kInjectStartLayer + kInjectLayers) {
+		throw FluidSim::Exception("SmokeSim3D grid is too small.");
+	}
+
+	const float32 dx = 1.0f / width;
+	m_spec.width = width;
+	m_spec.height = height;
+	m_spec.depth = depth;
+	m_spec.cellLength = dx;
+	m_spec.origin = vec3(0.5f * dx);
+
+	init();
+}
+
+//---------------------------------------------------------------------------------------
+void SmokeSim3D::init() {
+	m_frame = 0;
+	m_timings = SmokeSim3DTimings();
+
+	const GridLayout bordered(1);
+
+	m_velocity = StaggeredGrid3<float32>(m_spec, bordered);
+	m_tmpVelocity = StaggeredGrid3<float32>(m_spec, bordered);
+	m_velocity.setAll(0.0f);
+	m_tmpVelocity.setAll(0.0f);
+
+	m_density = Grid3<float32>(m_spec, bordered);
+	m_tmpDensity = Grid3<float32>(m_spec, bordered);
+	m_density.setAll(0.0f);
+	m_tmpDensity.setAll(0.0f);
+
+	// Ambient temperature everywhere, border included, matching the kTemp_0
+	// border color of the GPU temperature textures.  Advection never writes the
+	// border, so both grids keep it across swaps.
+	m_temperature = Grid3<float32>(m_spec, bordered);
+	m_tmpTemperature = Grid3<float32>(m_spec, bordered);
+	m_temperature.setAll(kTemp_0);
+	m_tmpTemperature.setAll(kTemp_0);
+
+	m_pressure = Grid3<float32>(m_spec, bordered);
+	m_tmpPressure = Grid3<float32>(m_spec, bordered);
+	m_pressure.setAll(0.0f);
+	m_tmpPressure.setAll(0.0f);
+
+	m_divergence = Grid3<float32>(m_spec);
+	m_divergence.setAll(0.0f);
+
+	m_cellType = Grid3<CellType>(m_spec, bordered);
+	m_cellType.setAll(CellType::Solid);
+	setCells(m_cellType, CellType::Fluid);
+
+	createSolidCells();
+}
+
+//---------------------------------------------------------------------------------------
+void SmokeSim3D::setExecution(Execution execution) {
+	m_execution = execution;
+}
+
+//---------------------------------------------------------------------------------------
+Execution SmokeSim3D::execution() const {
+	return m_execution;
+}
+
+//---------------------------------------------------------------------------------------
+void SmokeSim3D::setJacobiIterations(uint32 iterations) {
+	m_jacobiIterations = iterations;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 SmokeSim3D::jacobiIterations() const {
+	return m_jacobiIterations;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 SmokeSim3D::frame() const {
+	return m_frame;
+}
+
+//---------------------------------------------------------------------------------------
+const SmokeSim3DTimings & SmokeSim3D::lastStepTimings() const {
+	return m_timings;
+}
+
+//---------------------------------------------------------------------------------------
+float32 SmokeSim3D::cellLength() const {
+	return m_spec.cellLength;
+}
+
+//---------------------------------------------------------------------------------------
+const StaggeredGrid3<float32> & SmokeSim3D::velocity() const {
+	return m_velocity;
+}
+
+//---------------------------------------------------------------------------------------
+const Grid3<float32> & SmokeSim3D::density() const {
+	return m_density;
+}
+
+//---------------------------------------------------------------------------------------
+const Grid3<float32> & SmokeSim3D::temperature() const {
+	return m_temperature;
+}
+
+//---------------------------------------------------------------------------------------
+const Grid3<float32> & SmokeSim3D::pressure() const {
+	return m_pressure;
+}
+
+//---------------------------------------------------------------------------------------
+const Grid3<float32> & SmokeSim3D::divergence() const {
+	return m_divergence;
+}
+
+//---------------------------------------------------------------------------------------
+const Grid3<CellType> & SmokeSim3D::cellTypes() const {
+	return m_cellType;
+}
+
+//---------------------------------------------------------------------------------------
+/**
+* Places the solid block of GpuSmokeSim3D::createSolidCells(), centered in x and
+* y, then records which neighbors of every cell are fluid.
+*/
+void SmokeSim3D::createSolidCells() {
+	const uint32 width = scaledCount(kSolidSize, m_spec.width);
+	const uint32 height = scaledCount(kSolidSize, m_spec.height);
+	const uint32 layer0 = std::min(scaledCount(kSolidStartLayer, m_spec.depth),
+			m_spec.depth - 1);
+	const uint32 layer1 = std::min(scaledCount(kSolidEndLayer, m_spec.depth),
+			m_spec.depth - 1);
+
+	setBlock(m_cellType, (m_spec.width - width) / 2, (m_spec.height - height) / 2,
+			layer0, width, height, layer1 - layer0 + 1, CellType::Solid);
+
+	m_fluidNeighbors = Grid3<uint8>(m_spec);
+	for (int32 layer(0); layer < int32(m_spec.depth); ++layer) {
+		for (int32 row(0); row < int32(m_spec.height); ++row) {
+			for (int32 col(0); col < int32(m_spec.width); ++col) {
+				uint8 mask = 0;
+				if (m_cellType.at(col, row, layer) == CellType::Fluid) {
+					mask |= kFluid;
+				}
+				if (m_cellType.at(col-1, row, layer) == CellType::Fluid) {
+					mask |= kLeftFluid;
+				}
+				if (m_cellType.at(col+1, row, layer) == CellType::Fluid) {
+					mask |= kRightFluid;
+				}
+				if (m_cellType.at(col, row-1, layer) == CellType::Fluid) {
+					mask |= kBottomFluid;
+				}
+				if (m_cellType.at(col, row+1, layer) == CellType::Fluid) {
+					mask |= kTopFluid;
+				}
+				if (m_cellType.at(col, row, layer-1) == CellType::Fluid) {
+					mask |= kNearFluid;
+				}
+				if (m_cellType.at(col, row, layer+1) == CellType::Fluid) {
+					mask |= kFarFluid;
+				}
+				m_fluidNeighbors(col, row, layer) = mask;
+			}
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void SmokeSim3D::step() {
+	step(kDt);
+}
+
+//---------------------------------------------------------------------------------------
+void SmokeSim3D::step(float32 dt) {
+	m_timings.inject = 0.0;
+	if (m_frame < kInjectFrames) {
+		m_timings.inject = timeStage([this] { injectDensityAndTemperature(); });
+	}
+
+	m_timings.advect = timeStage([this, dt] { advectQuantities(dt); });
+	m_timings.buoyancy = timeStage([this, dt] { addBuoyantForce(dt); });
+	m_timings.divergence = timeStage([this, dt] { computeDivergence(dt); });
+	m_timings.pressure = timeStage([this] { computePressure(); });
+	m_timings.project = timeStage([this, dt] { projectVelocity(dt); });
+
+	++m_frame;
+}
+
+//---------------------------------------------------------------------------------------
+std::vector<FieldView> SmokeSim3D::fields() const {
+	std::vector<FieldView> result;
+	result.push_back(makeFieldView("density", m_density));
+	result.push_back(makeFieldView("temperature", m_temperature));
+	result.push_back(makeFieldView("pressure", m_pressure));
+	result.push_back(makeFieldView("divergence", m_divergence));
+	result.push_back(makeFieldView("u", m_velocity.u));
+	result.push_back(makeFieldView("v", m_velocity.v));
+	result.push_back(makeFieldView("w", m_velocity.w));
+
+	return result;
+}
+
+//---------------------------------------------------------------------------------------
+/**
+* Sets density and temperature in a small block, centered in x and y, just
+* above the bottom of the domain.
+*/
+void SmokeSim3D::injectDensityAndTemperature() {
+	const uint32 width = scaledCount(kInjectSize, m_spec.width);
+	const uint32 height = scaledCount(kInjectSize, m_spec.height);
+	const uint32 col0 = (m_spec.width - width) / 2;
+	const uint32 row0 = (m_spec.height - height) / 2;
+
+	setBlock(m_density, col0, row0, kInjectStartLayer, width, height, kInjectLayers,
+			kInjectDensity);
+	setBlock(m_temperature, col0, row0, kInjectStartLayer, width, height,
+			kInjectLayers, kInjectTemperature);
+}
+
+//---------------------------------------------------------------------------------------
+void SmokeSim3D::advectQuantities(float32 dt) {
+	advect(m_velocity.u, m_tmpVelocity.u, m_velocity, dt, m_execution);
+	advect(m_velocity.v, m_tmpVelocity.v, m_velocity, dt, m_execution);
+	advect(m_velocity.w, m_tmpVelocity.w, m_velocity, dt, m_execution);
+	m_velocity.swap(m_tmpVelocity);
+	clampBorders(m_velocity);
+
+	const Grid3<float32> * quantities[] = { &m_density, &m_temperature };
+	Grid3<float32> * destinations[] = { &m_tmpDensity, &m_tmpTemperature };
+	advect(quantities, destinations, 2, m_velocity, dt, m_execution);
+	m_density.swap(m_tmpDensity);
+	m_temperature.swap(m_tmpTemperature);
+}
+
+//---------------------------------------------------------------------------------------
+/**
+* Density and temperature are interpolated to each w face from the two cells it
+* separates, including the border cells for the top and bottom faces, which
+* hold zero density and ambient temperature.
+*/
+void SmokeSim3D::addBuoyantForce(float32 dt) {
+	Grid3<float32> & w = m_velocity.w;
+	const uint32 height = w.height();
+
+	parallelFor(m_execution, 0, height * w.depth(), [&] (uint32 rowBegin, uint32 rowEnd) {
+		for (uint32 r(rowBegin); r < rowEnd; ++r) {
+			const int32 row = int32(r % height);
+			const int32 layer = int32(r / height);
+
+			float32 * face = &w(0, row, layer);
+			const float32 * densityLo = &m_density.at(0, row, layer-1);
+			const float32 * densityHi = &m_density.at(0, row, layer);
+			const float32 * tempLo = &m_temperature.at(0, row, layer-1);
+			const float32 * tempHi = &m_temperature.at(0, row, layer);
+
+			for (uint32 col(0); col < w.width(); ++col) {
+				float32 density = 0.5f * (densityLo[col] + densityHi[col]);
+				float32 temp = 0.5f * (tempLo[col] + tempHi[col]);
+				float32 force = -kBuoyant_d * density + (kBuoyant_t * (temp - kTemp_0));
+
+				face[col] += dt * force;
+			}
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+/**
+* Solid cells have zero velocity, so each face shared with a solid neighbor
+* simply drops out of the divergence.
+*/
+void SmokeSim3D::computeDivergence(float32 dt) {
+	const float32 scale = kDensity * m_spec.cellLength / dt;
+	const uint32 height = m_spec.height;
+
+	parallelFor(m_execution, 0, height * m_spec.depth,
+			[&] (uint32 rowBegin, uint32 rowEnd) {
+		for (uint32 r(rowBegin); r < rowEnd; ++r) {
+			const uint32 row = r % height;
+			const uint32 layer = r / height;
+
+			float32 * result = &m_divergence(0, row, layer);
+			const uint8 * mask = &m_fluidNeighbors(0, row, layer);
+			const float32 * u = &m_velocity.u(0, row, layer);
+			const float32 * vBottom = &m_velocity.v(0, row, layer);
+			const float32 * vTop = &m_velocity.v(0, row+1, layer);
+			const float32 * wNear = &m_velocity.w(0, row, layer);
+			const float32 * wFar = &m_velocity.w(0, row, layer+1);
+
+			for (uint32 col(0); col < m_spec.width; ++col) {
+				const uint8 m = mask[col];
+				if (!(m & kFluid)) {
+					result[col] = 0.0f;
+					continue;
+				}
+
+				float32 delta_u = u[col+1] - u[col];
+				float32 delta_v = vTop[col] - vBottom[col];
+				float32 delta_w = wFar[col] - wNear[col];
+				float32 value = scale * (delta_u + delta_v + delta_w);
+
+				// Update based on solid boundaries:
+				if (!(m & kLeftFluid))   value += scale * u[col];
+				if (!(m & kRightFluid))  value -= scale * u[col+1];
+				if (!(m & kBottomFluid)) value += scale * vBottom[col];
+				if (!(m & kTopFluid))    value -= scale * vTop[col];
+				if (!(m & kNearFluid))   value += scale * wNear[col];
+				if (!(m & kFarFluid))    value -= scale * wFar[col];
+
+				result[col] = value;
+			}
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+/**
+* Jacobi iterations, ping-ponging between m_pressure and m_tmpPressure.  Each
+* iteration reads only the previous one, so rows are updated in parallel.
+*/
+void SmokeSim3D::computePressure() {
+	const uint32 height = m_spec.height;
+	const std::ptrdiff_t pitch = m_pressure.pitch();
+	const std::ptrdiff_t slicePitch = m_pressure.slicePitch();
+
+	for (uint32 iteration(0); iteration < m_jacobiIterations; ++iteration) {
+		parallelFor(m_execution, 0, height * m_spec.depth,
+				[&] (uint32 rowBegin, uint32 rowEnd) {
+			for (uint32 r(rowBegin); r < rowEnd; ++r) {
+				const uint32 row = r % height;
+				const uint32 layer = r / height;
+
+				const float32 * p = &m_pressure(0, row, layer);
+				const float32 * d = &m_divergence(0, row, layer);
+				const uint8 * mask = &m_fluidNeighbors(0, row, layer);
+				float32 * result = &m_tmpPressure(0, row, layer);
+
+				for (uint32 col(0); col < m_spec.width; ++col) {
+					const uint8 m = mask[col];
+					if (!(m & kFluid)) {
+						result[col] = 0.0f;
+						continue;
+					}
+
+					// Solid neighbors take the center pressure, so their face
+					// contributes no gradient.
+					const float32 pC = p[col];
+					float32 pL = (m & kLeftFluid) ? p[col - 1] : pC;
+					float32 pR = (m & kRightFluid) ? p[col + 1] : pC;
+					float32 pB = (m & kBottomFluid) ? p[col - pitch] : pC;
+					float32 pT = (m & kTopFluid) ? p[col + pitch] : pC;
+					float32 pN = (m & kNearFluid) ? p[col - slicePitch] : pC;
+					float32 pF = (m & kFarFluid) ? p[col + slicePitch] : pC;
+
+					result[col] = (pL + pR + pB + pT + pN + pF - d[col]) / 6.0f;
+				}
+			}
+		});
+
+		m_pressure.swap(m_tmpPressure);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void SmokeSim3D::projectVelocity(float32 dt) {
+	const float32 scale = dt / (kDensity * m_spec.cellLength);
+
+	projectComponent(m_velocity.u, ivec3(1,0,0), m_cellType, m_pressure, scale,
+			m_execution);
+	projectComponent(m_velocity.v, ivec3(0,1,0), m_cellType, m_pressure, scale,
+			m_execution);
+	projectComponent(m_velocity.w, ivec3(0,0,1), m_cellType, m_pressure, scale,
+			m_execution);
+	clampBorders(m_velocity);
+}
+
+} // end namespace FluidSim
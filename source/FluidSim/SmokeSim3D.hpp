@@ -0,0 +1,159 @@
+/**
+* SmokeSim3D.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Grid3.hpp"
+#include "FluidSim/StaggeredGrid3.hpp"
+#include "FluidSim/CellType.hpp"
+#include "FluidSim/Parallel.hpp"
+#include "FluidSim/Simulation.hpp"
+
+namespace FluidSim {
+
+/// Wall clock seconds spent in each stage of a single SmokeSim3D::step().
+struct SmokeSim3DTimings {
+    double inject;
+    double advect;
+    double buoyancy;
+    double divergence;
+    double pressure;
+    double project;
+
+    /// Sum of all stages.
+    double total() const;
+};
+
+/**
+* CPU implementation of the GpuSmokeSim3D pipeline, which needs no window or
+* OpenGL context.  Each step() runs the same stages as GpuSmokeSim3D::logic(),
+* with the same parameters and boundary handling, so its fields can be compared
+* against what the GPU shaders produce:
+*
+*   inject      Density and temperature are set in a small block at the bottom
+*               of the domain for the first kInjectFrames frames.
+*   advect      u, v and w are advected through the old velocity, then density
+*               and temperature through the new one (Advect.fs).
+*   buoyancy    w += dt * (-kBuoyant_d * density + kBuoyant_t * (T - kTemp_0))
+*               at every w face (BuoyantForce.fs).
+*   divergence  Pressure right hand side, scaled by kDensity * dx / dt, with
+*               solid wall corrections (ComputeDivergence.fs).
+*   pressure    Jacobi iterations, warm started from the previous frame, where
+*               solid neighbors take the pressure of the center cell
+*               (PressureSolve.fs).
+*   project     Subtracts dt / (kDensity * dx) times the pressure gradient, and
+*               zeros faces touching a solid cell (ProjectU/V/W.fs).
+*
+* The domain is the unit cube, with layers stacked along +z, which is up.  Cells
+* outside the grid are solid, and a block of solid cells sits above the
+* injection point as in GpuSmokeSim3D::createSolidCells().  Each field has a
+* one cell border that reproduces how the GPU samples its texture: velocity
+* components copy their edge faces, as GL_CLAMP_TO_EDGE does, and are refreshed
+* after advection and projection.  Density has a border of zeros and
+* temperature one of kTemp_0, the GL_CLAMP_TO_BORDER colors of those textures.
+*
+* Stages that the GPU applies to solid cells as well, divergence and pressure,
+* are only evaluated for fluid cells here.  Solid cells keep a zero divergence
+* and pressure, which never affects the velocity.
+*
+* As a Simulation, its fields() are density, temperature, pressure,
+* divergence, u, v and w.
+*/
+class SmokeSim3D : public Simulation {
+public:
+    static const uint32 kGridSize = 64;
+    static const uint32 kJacobiIterations = 30;
+    static const uint32 kInjectFrames = 10;
+    static const float32 kDt;
+    static const float32 kTemp_0;
+    static const float32 kBuoyant_d;
+    static const float32 kBuoyant_t;
+    static const float32 kDensity;
+    static const float32 kInjectDensity;
+    static const float32 kInjectTemperature;
+
+    /// Builds the GpuSmokeSim3D scene on a width x height x depth grid
+    /// spanning the unit cube.  Throws a FluidSim::Exception if depth < 3,
+    /// which leaves no room for the injection block.
+    explicit SmokeSim3D(uint32 width = kGridSize,
+            uint32 height = kGridSize,
+            uint32 depth = kGridSize);
+
+    /// Resets every field, and the frame count, to the initial scene.
+    virtual void init();
+
+    /// Advances the simulation by one frame of \c dt seconds, recording the
+    /// wall time of each stage in lastStepTimings().
+    virtual void step(float32 dt);
+
+    /// Advances the simulation by one frame of kDt seconds, as GpuSmokeSim3D
+    /// does.
+    void step();
+
+    virtual std::vector<FieldView> fields() const;
+
+    void setExecution(Execution execution);
+
+    Execution execution() const;
+
+    void setJacobiIterations(uint32 iterations);
+
+    uint32 jacobiIterations() const;
+
+    /// Number of completed calls to step().
+    uint32 frame() const;
+
+    const SmokeSim3DTimings & lastStepTimings() const;
+
+    /// Edge length of each cell, 1 / width.
+    float32 cellLength() const;
+
+    const StaggeredGrid3<float32> & velocity() const;
+
+    const Grid3<float32> & density() const;
+
+    const Grid3<float32> & temperature() const;
+
+    const Grid3<float32> & pressure() const;
+
+    const Grid3<float32> & divergence() const;
+
+    const Grid3<CellType> & cellTypes() const;
+
+private:
+    GridSpec3 m_spec;
+    Execution m_execution;
+    uint32 m_jacobiIterations;
+    uint32 m_frame;
+    SmokeSim3DTimings m_timings;
+
+    StaggeredGrid3<float32> m_velocity;
+    StaggeredGrid3<float32> m_tmpVelocity;
+    Grid3<float32> m_density;
+    Grid3<float32> m_tmpDensity;
+    Grid3<float32> m_temperature;
+    Grid3<float32> m_tmpTemperature;
+    Grid3<float32> m_pressure;
+    Grid3<float32> m_tmpPressure;
+    Grid3<float32> m_divergence;
+
+    // Solid outside the grid, via a one cell border.
+    Grid3<CellType> m_cellType;
+
+    // Per cell fluid neighbor bits, see SmokeSim3D.cpp.
+    Grid3<uint8> m_fluidNeighbors;
+
+    void createSolidCells();
+    void injectDensityAndTemperature();
+    void advectQuantities(float32 dt);
+    void addBuoyantForce(float32 dt);
+    void computeDivergence(float32 dt);
+    void computePressure();
+    void projectVelocity(float32 dt);
+};
+
+} // end namespace FluidSim
@@ -12,8 +12,8 @@
 namespace FluidSim {
 
 // Forward Declaration
-template <typename T>
-T bilinear(const Grid<T> & grid, const vec2 & worldPos);
+template <typename T, typename Allocator, typename Layout>
+T bilinear(const Grid<T, Allocator, Layout> & grid, const vec2 & worldPos);
 
 template <typename T>
 using interpFunc = T (*) (const Grid<T> &, const vec2 &);
@@ -44,6 +44,16 @@ public:
 
     StaggeredGrid<T> & operator = (const StaggeredGrid<T> & other);
 
+    /// Function used by interpolate(), bilinear unless given otherwise.
+    interpFunc<T> interp() const;
+
+    void setInterp(interpFunc<T> interp);
+
+    /// Samples u and v at \c worldPos through interp().  Hot loops that know
+    /// the scheme at compile time should use an interpolation policy instead,
+    /// see Interp.hpp.
+    tvec2<T> interpolate(const vec2 & worldPos) const;
+
 
     Grid<T> u; // Horizontal component grid.
     Grid<T> v; // Vertical component grid.
@@ -54,7 +54,8 @@ StaggeredGrid<T>::StaggeredGrid(const StaggeredGrid<T> & other)
 template <typename T>
 StaggeredGrid<T>::StaggeredGrid(StaggeredGrid<T> && other)
     : u(std::move(other.u)),
-      v(std::move(other.v))
+      v(std::move(other.v)),
+      m_interp(other.m_interp)
 {
 
 }
@@ -71,6 +72,7 @@ StaggeredGrid<T> & StaggeredGrid<T>::operator = (StaggeredGrid<T> && other) {
     if (&other != this) {
         u = std::move(other.u);
         v = std::move(other.v);
+        m_interp = other.m_interp;
     }
 
     return *this;
@@ -81,10 +83,29 @@ template <typename T>
 StaggeredGrid<T> & StaggeredGrid<T>::operator = (const StaggeredGrid<T> & other) {
     u = other.u;
     v = other.v;
+    m_interp = other.m_interp;
 
     return *this;
 }
 
+//----------------------------------------------------------------------------------------
+template <typename T>
+interpFunc<T> StaggeredGrid<T>::interp() const {
+    return m_interp;
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+void StaggeredGrid<T>::setInterp(interpFunc<T> interp) {
+    m_interp = interp;
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+tvec2<T> StaggeredGrid<T>::interpolate(const vec2 & worldPos) const {
+    return tvec2<T>(m_interp(u, worldPos), m_interp(v, worldPos));
+}
+
 } // end namespace FluidSim
 
 
@@ -0,0 +1,56 @@
+/**
+* StaggeredGrid3.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+#include "FluidSim/Grid3.hpp"
+
+namespace FluidSim {
+
+/**
+* 3D MAC grid: each velocity component lives on the centers of the cell faces
+* normal to it, so for a width x height x depth cell grid u is
+* (width+1) x height x depth, v is width x (height+1) x depth and w is
+* width x height x (depth+1).
+*/
+template <typename T>
+class StaggeredGrid3 {
+public:
+    StaggeredGrid3();
+
+    /// Face grids for the cells of \c cells, whose origin is the center of
+    /// cell (0,0,0).  Every component is stored with \c layout.
+    explicit StaggeredGrid3(const GridSpec3 & cells,
+            const GridLayout & layout = GridLayout());
+
+    StaggeredGrid3(const Grid3<T> & u, const Grid3<T> & v, const Grid3<T> & w);
+
+    StaggeredGrid3(Grid3<T> && u, Grid3<T> && v, Grid3<T> && w);
+
+    StaggeredGrid3(const StaggeredGrid3<T> & other);
+
+    StaggeredGrid3(StaggeredGrid3<T> && other); // move constructor
+
+    StaggeredGrid3<T> & operator = (StaggeredGrid3<T> && other);
+
+    StaggeredGrid3<T> & operator = (const StaggeredGrid3<T> & other);
+
+    /// Sets every face of all three components.
+    void setAll(const T & val);
+
+    /// Exchanges all three components with \c other without copying.
+    void swap(StaggeredGrid3<T> & other);
+
+
+    Grid3<T> u; // x component, on faces normal to x.
+    Grid3<T> v; // y component, on faces normal to y.
+    Grid3<T> w; // z component, on faces normal to z.
+};
+
+} // end namespace FluidSim.
+
+#include "StaggeredGrid3.inl"
@@ -0,0 +1,123 @@
+#include "FluidSim/StaggeredGrid3.hpp"
+
+#include <utility>
+
+namespace FluidSim {
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+StaggeredGrid3<T>::StaggeredGrid3()
+    : u(),
+      v(),
+      w()
+{
+
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+StaggeredGrid3<T>::StaggeredGrid3(const GridSpec3 & cells, const GridLayout & layout)
+{
+    const float32 halfCell = 0.5f * cells.cellLength;
+
+    GridSpec3 spec = cells;
+    spec.width = cells.width + 1;
+    spec.origin = cells.origin - vec3(halfCell, 0.0f, 0.0f);
+    u = Grid3<T>(spec, layout);
+
+    spec = cells;
+    spec.height = cells.height + 1;
+    spec.origin = cells.origin - vec3(0.0f, halfCell, 0.0f);
+    v = Grid3<T>(spec, layout);
+
+    spec = cells;
+    spec.depth = cells.depth + 1;
+    spec.origin = cells.origin - vec3(0.0f, 0.0f, halfCell);
+    w = Grid3<T>(spec, layout);
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+StaggeredGrid3<T>::StaggeredGrid3(
+        const Grid3<T> & u,
+        const Grid3<T> & v,
+        const Grid3<T> & w)
+    : u(u),
+      v(v),
+      w(w)
+{
+
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+StaggeredGrid3<T>::StaggeredGrid3(
+        Grid3<T> && u,
+        Grid3<T> && v,
+        Grid3<T> && w)
+    : u(std::move(u)),
+      v(std::move(v)),
+      w(std::move(w))
+{
+
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+StaggeredGrid3<T>::StaggeredGrid3(const StaggeredGrid3<T> & other)
+    : u(other.u),
+      v(other.v),
+      w(other.w)
+{
+
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+StaggeredGrid3<T>::StaggeredGrid3(StaggeredGrid3<T> && other)
+    : u(std::move(other.u)),
+      v(std::move(other.v)),
+      w(std::move(other.w))
+{
+
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+StaggeredGrid3<T> & StaggeredGrid3<T>::operator = (StaggeredGrid3<T> && other) {
+    if (&other != this) {
+        u = std::move(other.u);
+        v = std::move(other.v);
+        w = std::move(other.w);
+    }
+
+    return *this;
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+StaggeredGrid3<T> & StaggeredGrid3<T>::operator = (const StaggeredGrid3<T> & other) {
+    u = other.u;
+    v = other.v;
+    w = other.w;
+
+    return *this;
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+void StaggeredGrid3<T>::setAll(const T & val) {
+    u.setAll(val);
+    v.setAll(val);
+    w.setAll(val);
+}
+
+//----------------------------------------------------------------------------------------
+template <typename T>
+void StaggeredGrid3<T>::swap(StaggeredGrid3<T> & other) {
+    u.swap(other.u);
+    v.swap(other.v);
+    w.swap(other.w);
+}
+
+} // end namespace FluidSim
@@ -0,0 +1,188 @@
+// ThreadPool.cpp
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace FluidSim;
+using namespace std;
+
+namespace {
+	// True while the current thread is executing a parallelFor() body.
+	thread_local bool t_insideParallelRegion = false;
+
+	// Marks the current thread as inside a parallel region for its lifetime,
+	// restoring the previous state however the scope is left.
+	class ParallelRegionGuard {
+	public:
+		ParallelRegionGuard()
+			: m_wasInside(t_insideParallelRegion)
+		{
+			t_insideParallelRegion = true;
+		}
+
+		~ParallelRegionGuard() {
+			t_insideParallelRegion = m_wasInside;
+		}
+
+	private:
+		bool m_wasInside;
+	};
+}
+
+//---------------------------------------------------------------------------------------
+ThreadPool::ThreadPool(uint32 numThreads)
+	: m_func(nullptr),
+	  m_begin(0),
+	  m_end(0),
+	  m_grainSize(1),
+	  m_jobId(0),
+	  m_activeWorkers(0),
+	  m_shutdown(false),
+	  m_nextChunk(0),
+	  m_numChunks(0)
+{
+	if (numThreads == 0) {
+		numThreads = std::max(1u, thread::hardware_concurrency());
+	}
+
+	// The calling thread of parallelFor() also processes chunks.
+	for (uint32 i(1); i < numThreads; ++i) {
+		m_workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+ThreadPool::~ThreadPool() {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_workReady.notify_all();
+
+	for (thread & worker : m_workers) {
+		worker.join();
+	}
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ThreadPool::numThreads() const {
+	return uint32(m_workers.size()) + 1;
+}
+
+//---------------------------------------------------------------------------------------
+ThreadPool & ThreadPool::global() {
+	static ThreadPool pool ( [] {
+		const char * value = getenv("FLUIDSIM_NUM_THREADS");
+		return value ? uint32(strtoul(value, nullptr, 10)) : 0u;
+	}() );
+
+	return pool;
+}
+
+//---------------------------------------------------------------------------------------
+// Claims and runs chunks of the current job until none remain.  An exception
+// from a chunk is kept for parallelFor() to rethrow, and stops further chunks
+// from being claimed.
+void ThreadPool::runChunks() {
+	const uint32 numChunks = m_numChunks.load();
+	ParallelRegionGuard guard;
+
+	try {
+		for (uint32 chunk = m_nextChunk++; chunk < numChunks; chunk = m_nextChunk++) {
+			uint32 chunkBegin = m_begin + chunk * m_grainSize;
+			uint32 chunkEnd = std::min(chunkBegin + m_grainSize, m_end);
+			(*m_func)(chunkBegin, chunkEnd);
+		}
+	} catch (...) {
+		m_nextChunk = numChunks;
+
+		lock_guard<mutex> lock(m_mutex);
+		if (!m_exception) {
+			m_exception = current_exception();
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void ThreadPool::workerLoop() {
+	uint64 lastJobId = 0;
+
+	while (true) {
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_workReady.wait(lock, [&] {
+				return m_shutdown || m_jobId != lastJobId;
+			});
+
+			if (m_shutdown) {
+				return;
+			}
+
+			lastJobId = m_jobId;
+			++m_activeWorkers;
+		}
+
+		runChunks();
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+			--m_activeWorkers;
+		}
+		m_workDone.notify_all();
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void ThreadPool::parallelFor(
+		uint32 begin,
+		uint32 end,
+		uint32 grainSize,
+		const RangeFunc & func
+) {
+	if (begin >= end) {
+		return;
+	}
+
+	grainSize = std::max(grainSize, 1u);
+	uint32 numChunks = (end - begin + grainSize - 1) / grainSize;
+
+	// Nothing to share, or already running inside a parallel region.
+	if (m_workers.empty() || numChunks == 1 || t_insideParallelRegion) {
+		func(begin, end);
+		return;
+	}
+
+	lock_guard<mutex> submitLock(m_submitMutex);
+
+	{
+		// Workers that woke too late to help with the previous job may still be
+		// leaving runChunks(). Wait for them before replacing the job.
+		unique_lock<mutex> lock(m_mutex);
+		m_workDone.wait(lock, [&] { return m_activeWorkers == 0; });
+
+		m_func = &func;
+		m_begin = begin;
+		m_end = end;
+		m_grainSize = grainSize;
+		m_nextChunk = 0;
+		m_numChunks = numChunks;
+		++m_jobId;
+	}
+	m_workReady.notify_all();
+
+	runChunks();
+
+	// Wait for workers that claimed chunks of this job to finish them.  Workers that
+	// wake late find no chunks left and return immediately.
+	unique_lock<mutex> lock(m_mutex);
+	m_workDone.wait(lock, [&] { return m_activeWorkers == 0; });
+	m_func = nullptr;
+
+	if (m_exception) {
+		exception_ptr exception = m_exception;
+		m_exception = nullptr;
+		rethrow_exception(exception);
+	}
+}
@@ -0,0 +1,91 @@
+/**
+* ThreadPool.hpp
+*
+* @author Dustin Biser
+*/
+
+#pragma once
+
+#include "FluidSim/NumericTypes.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FluidSim {
+
+/**
+* Fixed size pool of worker threads for running data parallel loops.
+*
+* Work is submitted through parallelFor(), which splits an index range into chunks
+* that the workers and the calling thread claim until the range is exhausted.  The
+* call blocks until every chunk has completed.  Calls made from within a running
+* parallelFor() body execute serially on the calling thread.
+*
+* If a chunk throws, no further chunks are started, and the first exception is
+* rethrown from parallelFor() once the chunks already running have finished.
+*/
+class ThreadPool {
+public:
+	typedef std::function<void (uint32 begin, uint32 end)> RangeFunc;
+
+	/// Creates a pool whose parallelFor() calls use \c numThreads threads in total,
+	/// including the calling thread.  A value of 0 uses the hardware concurrency.
+	explicit ThreadPool(uint32 numThreads = 0);
+
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool & operator = (const ThreadPool &) = delete;
+
+	/// Number of threads, including the calling thread, that execute parallelFor().
+	uint32 numThreads() const;
+
+	/**
+	* Calls \c func(chunkBegin, chunkEnd) for consecutive chunks of at most
+	* \c grainSize indices covering [begin, end).  Chunks may run concurrently and in
+	* any order.
+	*/
+	void parallelFor(uint32 begin, uint32 end, uint32 grainSize, const RangeFunc & func);
+
+	/**
+	* Pool shared by the library's parallel kernels.  Its size is taken from the
+	* FLUIDSIM_NUM_THREADS environment variable when set, and the hardware
+	* concurrency otherwise.
+	*/
+	static ThreadPool & global();
+
+private:
+	void workerLoop();
+	void runChunks();
+
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_workReady;
+	std::condition_variable m_workDone;
+
+	// Current job, guarded by m_mutex except for the atomic chunk counters.
+	const RangeFunc * m_func;
+	uint32 m_begin;
+	uint32 m_end;
+	uint32 m_grainSize;
+	uint64 m_jobId;
+	uint32 m_activeWorkers;
+	bool m_shutdown;
+
+	std::atomic<uint32> m_nextChunk;
+	std::atomic<uint32> m_numChunks;
+
+	// First exception thrown by a chunk of the current job, guarded by m_mutex.
+	std::exception_ptr m_exception;
+
+	// Serializes parallelFor() calls made from different threads.
+	std::mutex m_submitMutex;
+};
+
+} // end namespace FluidSim
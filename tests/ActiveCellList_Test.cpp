@@ -0,0 +1,173 @@
+/**
+* ActiveCellList_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/ActiveCellList.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+using namespace FluidSim;
+
+
+//------------------------------------------------------------------------------
+TEST(ActiveCellList_Test, insert_and_erase) {
+    ActiveCellList cells(5, 4);
+    EXPECT_TRUE(cells.empty());
+
+    cells.insert(1, 2);
+    cells.insert(4, 0);
+    cells.insert(1, 2);
+
+    EXPECT_EQ(2u, cells.size());
+    EXPECT_TRUE(cells.contains(1, 2));
+    EXPECT_TRUE(cells.contains(4, 0));
+    EXPECT_FALSE(cells.contains(2, 1));
+    EXPECT_EQ(1u, cells.col(0));
+    EXPECT_EQ(2u, cells.row(0));
+    EXPECT_EQ(2u * 5 + 1, cells[0]);
+
+    cells.erase(1, 2);
+    cells.erase(3, 3);
+
+    EXPECT_EQ(1u, cells.size());
+    EXPECT_FALSE(cells.contains(1, 2));
+    EXPECT_TRUE(cells.contains(4, 0));
+    EXPECT_EQ(4u, cells.col(0));
+
+    cells.clear();
+    EXPECT_TRUE(cells.empty());
+    EXPECT_FALSE(cells.contains(4, 0));
+}
+
+//------------------------------------------------------------------------------
+TEST(ActiveCellList_Test, erase_keeps_remaining_cells_findable) {
+    ActiveCellList cells(8, 8);
+    for (uint32 i(0); i < 8; ++i) {
+        cells.insert(i, i);
+    }
+
+    cells.erase(0, 0);
+    cells.erase(5, 5);
+    cells.erase(7, 7);
+
+    EXPECT_EQ(5u, cells.size());
+    for (uint32 i(0); i < 8; ++i) {
+        bool expected = (i != 0 && i != 5 && i != 7);
+        EXPECT_EQ(expected, cells.contains(i, i));
+    }
+
+    // Erasing through the moved slots must still work.
+    cells.erase(6, 6);
+    cells.erase(1, 1);
+    EXPECT_EQ(3u, cells.size());
+    EXPECT_TRUE(cells.contains(2, 2));
+    EXPECT_TRUE(cells.contains(3, 3));
+    EXPECT_TRUE(cells.contains(4, 4));
+}
+
+//------------------------------------------------------------------------------
+TEST(ActiveCellList_Test, dilate_clamps_to_grid) {
+    ActiveCellList cells(6, 5);
+    cells.insert(0, 0);
+    cells.insert(4, 3);
+
+    cells.dilate(1);
+
+    // 2x2 block at the corner, plus a full 3x3 block.
+    EXPECT_EQ(4u + 9u, cells.size());
+    EXPECT_TRUE(cells.contains(1, 1));
+    EXPECT_TRUE(cells.contains(5, 4));
+    EXPECT_TRUE(cells.contains(3, 2));
+    EXPECT_FALSE(cells.contains(2, 0));
+    EXPECT_FALSE(cells.contains(2, 2));
+}
+
+//------------------------------------------------------------------------------
+TEST(ActiveCellList_Test, sort_restores_row_major_order) {
+    ActiveCellList cells(4, 4);
+    cells.insert(3, 3);
+    cells.insert(0, 2);
+    cells.insert(1, 0);
+    cells.insert(2, 2);
+    cells.erase(0, 2);
+
+    cells.sort();
+
+    ASSERT_EQ(3u, cells.size());
+    EXPECT_TRUE(std::is_sorted(cells.begin(), cells.end()));
+
+    // Slots must follow the sorted positions.
+    cells.erase(1, 0);
+    EXPECT_EQ(2u, cells.size());
+    EXPECT_TRUE(cells.contains(2, 2));
+    EXPECT_TRUE(cells.contains(3, 3));
+}
+
+//------------------------------------------------------------------------------
+TEST(ActiveCellList_Test, spans_cover_every_cell_once) {
+    ActiveCellList cells(7, 3);
+    // Row 0: 1 2 3 _ 5 6, row 1: 0 1 2 3 4 5 6, row 2: 6.
+    const uint32 cols[] = { 1, 2, 3, 5, 6 };
+    for (uint32 col : cols) {
+        cells.insert(col, 0);
+    }
+    for (uint32 col(0); col < 7; ++col) {
+        cells.insert(col, 1);
+    }
+    cells.insert(6, 2);
+
+    auto collectSpans = [&] () {
+        std::vector<uint32> spans;
+        cells.forEachSpan(0, cells.size(), [&] (uint32 row, uint32 begin, uint32 end) {
+            spans.push_back(row);
+            spans.push_back(begin);
+            spans.push_back(end);
+        });
+        return spans;
+    };
+
+    EXPECT_TRUE(cells.isSorted());
+    const uint32 expected[] = { 0,1,4,  0,5,7,  1,0,7,  2,6,7 };
+    EXPECT_EQ(std::vector<uint32>(std::begin(expected), std::end(expected)),
+            collectSpans());
+
+    // Unsorted lists still yield valid spans, in list order.
+    cells.erase(2, 0);
+    EXPECT_FALSE(cells.isSorted());
+    uint32 numVisited = 0;
+    cells.forEachSpan(0, cells.size(), [&] (uint32 row, uint32 begin, uint32 end) {
+        for (uint32 col(begin); col < end; ++col) {
+            EXPECT_TRUE(cells.contains(col, row));
+            ++numVisited;
+        }
+    });
+    EXPECT_EQ(cells.size(), numVisited);
+
+    cells.sort();
+    EXPECT_TRUE(cells.isSorted());
+    const uint32 sortedSpans[] = { 0,1,2,  0,3,4,  0,5,7,  1,0,7,  2,6,7 };
+    EXPECT_EQ(std::vector<uint32>(std::begin(sortedSpans), std::end(sortedSpans)),
+            collectSpans());
+}
+
+//------------------------------------------------------------------------------
+TEST(ActiveCellList_Test, spans_respect_entry_range) {
+    ActiveCellList cells(10, 1);
+    for (uint32 col(0); col < 10; ++col) {
+        cells.insert(col, 0);
+    }
+
+    std::vector<uint32> spans;
+    cells.forEachSpan(3, 8, [&] (uint32, uint32 begin, uint32 end) {
+        spans.push_back(begin);
+        spans.push_back(end);
+    });
+
+    const uint32 expected[] = { 3, 8 };
+    EXPECT_EQ(std::vector<uint32>(std::begin(expected), std::end(expected)), spans);
+}
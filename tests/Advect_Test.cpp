@@ -7,6 +7,9 @@
 #include "gtest/gtest.h"
 #include "FluidSim/Advect.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace FluidSim;
 
 
@@ -132,3 +135,568 @@ TEST_F(Advect_Test, advect_velocity_u) {
     EXPECT_FLOAT_EQ(1, staggered_grid.u(1,1));
     EXPECT_FLOAT_EQ(1.5f, staggered_grid.u(2,1));
 }
+
+//------------------------------------------------------------------------------
+TEST_F(Advect_Test, parallel_matches_serial) {
+    const uint32 n = 67; // Not a multiple of the tile count.
+    const float32 dx = 1.0f / n;
+
+    Grid<float32> u(n+1, n, dx, vec2(0, 0.5f*dx));
+    Grid<float32> v(n, n+1, dx, vec2(0.5f*dx, 0));
+    for (uint32 row(0); row < u.height(); ++row) {
+        for (uint32 col(0); col < u.width(); ++col) {
+            u(col,row) = 0.3f * float32(row) / n - 0.1f;
+        }
+    }
+    for (uint32 row(0); row < v.height(); ++row) {
+        for (uint32 col(0); col < v.width(); ++col) {
+            v(col,row) = 0.2f - 0.4f * float32(col) / n;
+        }
+    }
+    StaggeredGrid<float32> swirl(std::move(u), std::move(v));
+
+    Grid<float32> serial(n, n, dx, vec2(0.5f*dx));
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            serial(col,row) = float32((col * 7 + row * 13) % 17);
+        }
+    }
+    Grid<float32> parallel = serial;
+
+    for (int step(0); step < 3; ++step) {
+        advect(serial, swirl, 0.05, Execution::Serial);
+        advect(parallel, swirl, 0.05, Execution::Parallel);
+    }
+
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            ASSERT_EQ(serial(col,row), parallel(col,row));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Advect_Test, fused_matches_single_field) {
+    const uint32 n = 23;
+    const float32 dx = 1.0f / n;
+
+    Grid<float32> u(n+1, n, dx, vec2(0, 0.5f*dx));
+    Grid<float32> v(n, n+1, dx, vec2(0.5f*dx, 0));
+    u.setAll(0.35f);
+    v.setAll(-0.2f);
+    StaggeredGrid<float32> drift(std::move(u), std::move(v));
+
+    Grid<float32> density(n, n, dx, vec2(0.5f*dx));
+    Grid<float32> temperature(n, n, dx, vec2(0.5f*dx));
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            density(col,row) = float32((col * 5 + row * 3) % 11);
+            temperature(col,row) = 273.0f + float32(col * row);
+        }
+    }
+
+    Grid<float32> expectedDensity = density;
+    Grid<float32> expectedTemperature = temperature;
+    advect(expectedDensity, drift, 0.1);
+    advect(expectedTemperature, drift, 0.1);
+
+    Grid<float32> newDensity(density.gridSpec());
+    Grid<float32> newTemperature(temperature.gridSpec());
+    const Grid<float32> * quantities[] = { &density, &temperature };
+    Grid<float32> * destinations[] = { &newDensity, &newTemperature };
+    advect(quantities, destinations, 2, drift, 0.1, Execution::Parallel);
+
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            ASSERT_EQ(expectedDensity(col,row), newDensity(col,row));
+            ASSERT_EQ(expectedTemperature(col,row), newTemperature(col,row));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Advect_Test, fused_throws_on_mismatched_grids) {
+    Grid<float32> a(3, 3, kCellLength, vec2(0,0));
+    Grid<float32> b(4, 3, kCellLength, vec2(0,0));
+    Grid<float32> result(3, 3, kCellLength, vec2(0,0));
+
+    const Grid<float32> * quantities[] = { &a, &b };
+    Grid<float32> * destinations[] = { &result, &result };
+    EXPECT_THROW(advect(quantities, destinations, 2, velocity, kDt),
+            FluidSim::Exception);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Advect_Test, destination_matches_in_place) {
+    Grid<float32> v(2,3, kCellLength, vec2(0.5*kCellLength, 0));
+    Grid<float32> u(3,2, kCellLength, vec2(0, 0.5*kCellLength));
+    v.setAll(0.25f);
+    u(0,1) = 1; u(1,1) = 2; u(2,1) = 3;
+    u(0,0) = 0; u(1,0) = 1; u(2,0) = 2;
+    StaggeredGrid<float32> staggered_grid(u, v);
+
+    Grid<float32> expected = staggered_grid.u;
+    advect(expected, staggered_grid, kDt);
+
+    Grid<float32> destination(u.gridSpec());
+    advect(staggered_grid.u, destination, staggered_grid, kDt);
+
+    for (uint32 row(0); row < u.height(); ++row) {
+        for (uint32 col(0); col < u.width(); ++col) {
+            EXPECT_EQ(expected(col,row), destination(col,row));
+        }
+    }
+    // Source is left untouched.
+    EXPECT_FLOAT_EQ(3, staggered_grid.u(2,1));
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Advect_Test, double_buffered_advect_swaps_buffers) {
+    q(0,1) = 0.0f; q(1,1) = 0.0f;
+    q(0,0) = 1.0f; q(1,0) = 1.0f;
+
+    DoubleBufferedGrid<float32> buffers(q);
+    const float32 * frontData = buffers.front().data();
+    const float32 * backData = buffers.back().data();
+
+    velocity.u.setAll(0);
+    velocity.v.setAll(kCellLength);
+    advect(buffers, velocity, kDt);
+
+    EXPECT_EQ(backData, buffers.front().data());
+    EXPECT_EQ(frontData, buffers.back().data());
+
+    EXPECT_FLOAT_EQ(1, buffers.front()(0,0));
+    EXPECT_FLOAT_EQ(1, buffers.front()(1,0));
+    EXPECT_FLOAT_EQ(1, buffers.front()(0,1));
+    EXPECT_FLOAT_EQ(1, buffers.front()(1,1));
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Advect_Test, sparse_matches_dense_on_listed_cells) {
+    const uint32 n = 31;
+    const float32 dx = 1.0f / n;
+
+    Grid<float32> u(n+1, n, dx, vec2(0, 0.5f*dx));
+    Grid<float32> v(n, n+1, dx, vec2(0.5f*dx, 0));
+    u.setAll(0.4f);
+    v.setAll(-0.25f);
+    StaggeredGrid<float32> drift(std::move(u), std::move(v));
+
+    Grid<float32> quantity(n, n, dx, vec2(0.5f*dx));
+    Grid<float32> temperature(n, n, dx, vec2(0.5f*dx));
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            quantity(col,row) = float32((col * 5 + row * 3) % 11);
+            temperature(col,row) = float32(col) - float32(row);
+        }
+    }
+
+    ActiveCellList cells(n, n);
+    for (uint32 row(4); row < 20; ++row) {
+        for (uint32 col(row % 3); col < n; col += 2) {
+            cells.insert(col, row);
+        }
+    }
+
+    Grid<float32> dense(quantity.gridSpec());
+    advect(quantity, dense, drift, 0.05, Execution::Serial);
+
+    Grid<float32> sparse(quantity.gridSpec());
+    Grid<float32> sparseTemperature(quantity.gridSpec());
+    sparse.setAll(-1.0f);
+    sparseTemperature.setAll(-1.0f);
+    const Grid<float32> * quantities[] = { &quantity, &temperature };
+    Grid<float32> * destinations[] = { &sparse, &sparseTemperature };
+    advect(quantities, destinations, 2, drift, 0.05, cells, Execution::Parallel);
+
+    Grid<float32> denseTemperature(quantity.gridSpec());
+    advect(temperature, denseTemperature, drift, 0.05);
+
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            if (cells.contains(col, row)) {
+                ASSERT_EQ(dense(col,row), sparse(col,row));
+                ASSERT_EQ(denseTemperature(col,row), sparseTemperature(col,row));
+            } else {
+                ASSERT_EQ(-1.0f, sparse(col,row));
+                ASSERT_EQ(-1.0f, sparseTemperature(col,row));
+            }
+        }
+    }
+
+    ActiveCellList wrongSize(n + 1, n);
+    EXPECT_THROW(advect(quantity, sparse, drift, 0.05, wrongSize), FluidSim::Exception);
+}
+
+//------------------------------------------------------------------------------
+namespace {
+
+// Advects a patterned n x n field through a shear flow for a few steps, using
+// cell layout L for the quantity, and returns the result in row-major order.
+template <typename L>
+Grid<float32> advectWithLayout(uint32 n) {
+    const float32 dx = 1.0f / n;
+
+    Grid<float32> u(n+1, n, dx, vec2(0, 0.5f*dx));
+    Grid<float32> v(n, n+1, dx, vec2(0.5f*dx, 0));
+    for (uint32 row(0); row < u.height(); ++row) {
+        for (uint32 col(0); col < u.width(); ++col) {
+            u(col,row) = 0.3f * float32(row) / n - 0.1f;
+        }
+    }
+    for (uint32 row(0); row < v.height(); ++row) {
+        for (uint32 col(0); col < v.width(); ++col) {
+            v(col,row) = 0.2f - 0.4f * float32(col) / n;
+        }
+    }
+    StaggeredGrid<float32> swirl(std::move(u), std::move(v));
+
+    Grid<float32, AlignedAllocator<float32>, L> q(n, n, dx, vec2(0.5f*dx));
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            q(col,row) = float32((col * 7 + row * 13) % 17);
+        }
+    }
+    Grid<float32, AlignedAllocator<float32>, L> q_new(q.gridSpec());
+
+    for (int step(0); step < 3; ++step) {
+        advect(q, q_new, swirl, 0.05, Execution::Parallel);
+        q.swap(q_new);
+    }
+
+    Grid<float32> result(q.gridSpec());
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            result(col,row) = q(col,row);
+        }
+    }
+    return result;
+}
+
+} // end namespace
+
+TEST_F(Advect_Test, cell_layouts_match_row_major) {
+    const uint32 n = 37; // Not a multiple of the brick size.
+    Grid<float32> expected = advectWithLayout<RowMajorLayout>(n);
+    Grid<float32> bricked = advectWithLayout<BrickedLayout<>>(n);
+    Grid<float32> zOrder = advectWithLayout<ZOrderLayout>(n);
+
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            ASSERT_EQ(expected(col,row), bricked(col,row));
+            ASSERT_EQ(expected(col,row), zOrder(col,row));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+namespace {
+
+// Swirling 3D velocity field and a patterned quantity on an n^3 grid.
+void makeSwirl3(uint32 n, StaggeredGrid3<float32> & velocity, Grid3<float32> & q) {
+    const float32 dx = 1.0f / n;
+    GridSpec3 cells = { n, n, n, dx, vec3(0.5f * dx) };
+
+    velocity = StaggeredGrid3<float32>(cells);
+    for (uint32 layer(0); layer < n; ++layer) {
+        for (uint32 row(0); row < n; ++row) {
+            for (uint32 col(0); col <= n; ++col) {
+                velocity.u(col,row,layer) = 0.3f * float32(row) / n - 0.1f;
+            }
+        }
+    }
+    for (uint32 layer(0); layer < n; ++layer) {
+        for (uint32 row(0); row <= n; ++row) {
+            for (uint32 col(0); col < n; ++col) {
+                velocity.v(col,row,layer) = 0.2f - 0.4f * float32(layer) / n;
+            }
+        }
+    }
+    for (uint32 layer(0); layer <= n; ++layer) {
+        for (uint32 row(0); row < n; ++row) {
+            for (uint32 col(0); col < n; ++col) {
+                velocity.w(col,row,layer) = 0.25f * float32(col) / n;
+            }
+        }
+    }
+
+    q = Grid3<float32>(cells);
+    for (uint32 layer(0); layer < n; ++layer) {
+        for (uint32 row(0); row < n; ++row) {
+            for (uint32 col(0); col < n; ++col) {
+                q(col,row,layer) = float32((col * 7 + row * 13 + layer * 5) % 17);
+            }
+        }
+    }
+}
+
+} // end namespace
+
+TEST_F(Advect_Test, advect3_uniform_flow_shifts_quantity) {
+    const uint32 n = 6;
+    GridSpec3 cells = { n, n, n, 1.0f, vec3(0.5f) };
+    StaggeredGrid3<float32> velocity(cells);
+    velocity.u.setAll(0.0f);
+    velocity.v.setAll(0.0f);
+    velocity.w.setAll(1.0f);
+
+    Grid3<float32> q(cells);
+    for (uint32 layer(0); layer < n; ++layer) {
+        for (uint32 row(0); row < n; ++row) {
+            for (uint32 col(0); col < n; ++col) {
+                q(col,row,layer) = float32(layer);
+            }
+        }
+    }
+
+    Grid3<float32> dest(cells);
+    advect(q, dest, velocity, 1.0);
+
+    // Each layer takes the value of the layer below, the bottom one clamps.
+    EXPECT_FLOAT_EQ(0.0f, dest(2,3,0));
+    EXPECT_FLOAT_EQ(0.0f, dest(2,3,1));
+    EXPECT_FLOAT_EQ(3.0f, dest(1,1,4));
+    EXPECT_FLOAT_EQ(4.0f, dest(5,0,5));
+}
+
+TEST_F(Advect_Test, advect3_parallel_and_fused_match_serial) {
+    const uint32 n = 13;
+    StaggeredGrid3<float32> velocity;
+    Grid3<float32> q;
+    makeSwirl3(n, velocity, q);
+
+    Grid3<float32> serial(q.gridSpec());
+    Grid3<float32> parallel(q.gridSpec());
+    advect(q, serial, velocity, 0.05, Execution::Serial);
+    advect(q, parallel, velocity, 0.05, Execution::Parallel);
+
+    Grid3<float32> q2 = q;
+    Grid3<float32> fused(q.gridSpec());
+    Grid3<float32> fused2(q.gridSpec());
+    const Grid3<float32> * quantities[] = { &q, &q2 };
+    Grid3<float32> * destinations[] = { &fused, &fused2 };
+    advect(quantities, destinations, 2, velocity, 0.05, Execution::Parallel);
+
+    for (uint32 layer(0); layer < n; ++layer) {
+        for (uint32 row(0); row < n; ++row) {
+            for (uint32 col(0); col < n; ++col) {
+                ASSERT_EQ(serial(col,row,layer), parallel(col,row,layer));
+                ASSERT_EQ(serial(col,row,layer), fused(col,row,layer));
+                ASSERT_EQ(serial(col,row,layer), fused2(col,row,layer));
+            }
+        }
+    }
+}
+
+TEST_F(Advect_Test, advect3_throws_on_mismatched_grids) {
+    StaggeredGrid3<float32> velocity;
+    Grid3<float32> q;
+    makeSwirl3(4, velocity, q);
+
+    Grid3<float32> wrong(5, 4, 4, q.cellLength(), q.origin());
+    EXPECT_THROW(advect(q, wrong, velocity, 0.05), FluidSim::Exception);
+}
+
+//------------------------------------------------------------------------------
+namespace {
+
+// Uniform flow of \c cellsPerStep cells per step of 0.05 along +x, on an n x n
+// grid with cell length 1/n.
+StaggeredGrid<float32> uniformFlow(uint32 n, float32 cellsPerStep) {
+    const float32 dx = 1.0f / n;
+    Grid<float32> u(n+1, n, dx, vec2(0, 0.5f*dx));
+    Grid<float32> v(n, n+1, dx, vec2(0.5f*dx, 0));
+    u.setAll(cellsPerStep * dx / 0.05f);
+    v.setAll(0.0f);
+    return StaggeredGrid<float32>(std::move(u), std::move(v));
+}
+
+// Gaussian bump in x, centered on column \c center.  Wide enough that
+// MacCormack's small phase lag does not dominate its error.
+float32 bump(float32 col, float32 center) {
+    float32 d = (col - center) / 4.0f;
+    return std::exp(-d * d);
+}
+
+} // end namespace
+
+//------------------------------------------------------------------------------
+TEST_F(Advect_Test, maccormack_is_less_diffusive_without_new_extrema) {
+    const uint32 n = 64;
+    const uint32 steps = 40;
+    const float32 cellsPerStep = 0.35f;
+    StaggeredGrid<float32> flow = uniformFlow(n, cellsPerStep);
+
+    Grid<float32> semiLagrangian(n, n, 1.0f / n, vec2(0.5f / n));
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            semiLagrangian(col,row) = bump(float32(col), 15.0f);
+        }
+    }
+    Grid<float32> macCormack = semiLagrangian;
+    Grid<float32> destination(semiLagrangian.gridSpec());
+    Grid<float32> scratch(semiLagrangian.gridSpec());
+
+    for (uint32 step(0); step < steps; ++step) {
+        advect(semiLagrangian, destination, flow, 0.05);
+        semiLagrangian.swap(destination);
+
+        advectMacCormack(macCormack, destination, scratch, flow, 0.05);
+        macCormack.swap(destination);
+    }
+
+    const float32 center = 15.0f + steps * cellsPerStep;
+    float32 errorSL = 0.0f;
+    float32 errorMC = 0.0f;
+    float32 peakSL = 0.0f;
+    float32 peakMC = 0.0f;
+    for (uint32 col(0); col < n; ++col) {
+        float32 exact = bump(float32(col), center);
+        errorSL += std::abs(semiLagrangian(col, n/2) - exact);
+        errorMC += std::abs(macCormack(col, n/2) - exact);
+        peakSL = std::max(peakSL, semiLagrangian(col, n/2));
+        peakMC = std::max(peakMC, macCormack(col, n/2));
+
+        EXPECT_GE(macCormack(col, n/2), 0.0f);
+        EXPECT_LE(macCormack(col, n/2), 1.0f);
+    }
+
+    EXPECT_LT(errorMC, 0.5f * errorSL);
+    EXPECT_GT(peakMC, peakSL);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Advect_Test, maccormack_sparse_and_parallel_match_dense) {
+    const uint32 n = 31;
+    const float32 dx = 1.0f / n;
+
+    Grid<float32> u(n+1, n, dx, vec2(0, 0.5f*dx));
+    Grid<float32> v(n, n+1, dx, vec2(0.5f*dx, 0));
+    for (uint32 row(0); row < u.height(); ++row) {
+        for (uint32 col(0); col < u.width(); ++col) {
+            u(col,row) = 0.3f * float32(row) / n - 0.1f;
+        }
+    }
+    for (uint32 row(0); row < v.height(); ++row) {
+        for (uint32 col(0); col < v.width(); ++col) {
+            v(col,row) = 0.2f - 0.4f * float32(col) / n;
+        }
+    }
+    StaggeredGrid<float32> swirl(std::move(u), std::move(v));
+
+    Grid<float32> quantity(n, n, dx, vec2(0.5f*dx));
+    Grid<float32> temperature(n, n, dx, vec2(0.5f*dx));
+    ActiveCellList cells(n, n);
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            quantity(col,row) = float32((col * 5 + row * 3) % 11);
+            temperature(col,row) = float32(col) - float32(row);
+            cells.insert(col, row);
+        }
+    }
+
+    Grid<float32> dense(quantity.gridSpec());
+    Grid<float32> denseTemperature(quantity.gridSpec());
+    Grid<float32> scratch(quantity.gridSpec());
+    advectMacCormack(quantity, dense, scratch, swirl, 0.05);
+    advectMacCormack(temperature, denseTemperature, scratch, swirl, 0.05);
+
+    Grid<float32> parallel(quantity.gridSpec());
+    advectMacCormack(quantity, parallel, scratch, swirl, 0.05, Execution::Parallel);
+
+    Grid<float32> sparse(quantity.gridSpec());
+    Grid<float32> sparseTemperature(quantity.gridSpec());
+    Grid<float32> scratchTemperature(quantity.gridSpec());
+    const Grid<float32> * quantities[] = { &quantity, &temperature };
+    Grid<float32> * destinations[] = { &sparse, &sparseTemperature };
+    Grid<float32> * scratches[] = { &scratch, &scratchTemperature };
+    advectMacCormack(quantities, destinations, scratches, 2, swirl, 0.05, cells,
+            Execution::Parallel);
+
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            ASSERT_EQ(dense(col,row), parallel(col,row));
+            ASSERT_EQ(dense(col,row), sparse(col,row));
+            ASSERT_EQ(denseTemperature(col,row), sparseTemperature(col,row));
+        }
+    }
+
+    Grid<float32> wrongSize(n + 1, n, dx, vec2(0.5f*dx));
+    EXPECT_THROW(advectMacCormack(quantity, dense, wrongSize, swirl, 0.05),
+            FluidSim::Exception);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Advect_Test, monotone_cubic_policy_is_less_diffusive) {
+    const uint32 n = 64;
+    const uint32 steps = 40;
+    const float32 cellsPerStep = 0.35f;
+    StaggeredGrid<float32> flow = uniformFlow(n, cellsPerStep);
+
+    Grid<float32> linear(n, n, 1.0f / n, vec2(0.5f / n));
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            linear(col,row) = bump(float32(col), 15.0f);
+        }
+    }
+    Grid<float32> cubic = linear;
+    Grid<float32> destination(linear.gridSpec());
+
+    for (uint32 step(0); step < steps; ++step) {
+        advect(linear, destination, flow, 0.05);
+        linear.swap(destination);
+
+        advect<MonotoneCubicInterp>(cubic, destination, flow, 0.05);
+        cubic.swap(destination);
+    }
+
+    const float32 center = 15.0f + steps * cellsPerStep;
+    float32 errorLinear = 0.0f;
+    float32 errorCubic = 0.0f;
+    for (uint32 col(0); col < n; ++col) {
+        float32 exact = bump(float32(col), center);
+        errorLinear += std::abs(linear(col, n/2) - exact);
+        errorCubic += std::abs(cubic(col, n/2) - exact);
+
+        EXPECT_GE(cubic(col, n/2), 0.0f);
+        EXPECT_LE(cubic(col, n/2), 1.0f);
+    }
+
+    EXPECT_LT(errorCubic, 0.5f * errorLinear);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Advect_Test, monotone_cubic_policy_sparse_and_parallel_match_dense) {
+    const uint32 n = 32;
+    StaggeredGrid<float32> flow = uniformFlow(n, 0.6f);
+
+    Grid<float32> q(n, n, 1.0f / n, vec2(0.5f / n));
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            q(col,row) = bump(float32(col), 10.0f) * bump(float32(row), 16.0f);
+        }
+    }
+
+    Grid<float32> dense(q.gridSpec());
+    advect<MonotoneCubicInterp>(q, dense, flow, 0.05);
+
+    Grid<float32> parallel(q.gridSpec());
+    advect<MonotoneCubicInterp>(q, parallel, flow, 0.05, Execution::Parallel);
+
+    ActiveCellList cells(n, n);
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            cells.insert(col, row);
+        }
+    }
+    Grid<float32> sparse(q.gridSpec());
+    advect<MonotoneCubicInterp>(q, sparse, flow, 0.05, cells);
+
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            EXPECT_EQ(dense(col,row), parallel(col,row));
+            EXPECT_EQ(dense(col,row), sparse(col,row));
+        }
+    }
+}
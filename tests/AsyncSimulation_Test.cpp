@@ -0,0 +1,191 @@
+/**
+* AsyncSimulation_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/AsyncSimulation.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <chrono>
+#include <thread>
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+// Accumulates time, and throws once it has taken failAfter steps if set.
+class ClockSimulation : public Simulation {
+public:
+    uint32 steps;
+    float32 time;
+    float32 scale;
+    uint32 failAfter;
+
+    ClockSimulation()
+        : steps(0), time(0.0f), scale(1.0f), failAfter(0)
+    {
+
+    }
+
+    virtual void init() {
+        steps = 0;
+        time = 0.0f;
+    }
+
+    virtual void step(float32 dt) {
+        if (failAfter > 0 && steps == failAfter) {
+            throw FluidSim::Exception("ClockSimulation failure.");
+        }
+        ++steps;
+        time += dt * scale;
+    }
+
+    virtual std::vector<FieldView> fields() const {
+        return std::vector<FieldView>();
+    }
+};
+
+struct ClockFrame {
+    uint32 steps;
+    float32 time;
+};
+
+class AsyncSimulation_Test : public ::testing::Test {
+protected:
+    static void snapshot(const Simulation & simulation, ClockFrame & frame) {
+        const ClockSimulation & clock = static_cast<const ClockSimulation &>(simulation);
+        frame.steps = clock.steps;
+        frame.time = clock.time;
+    }
+
+    // Reads frames until one with at least \c steps steps arrives.
+    static ClockFrame waitForSteps(AsyncSimulation<ClockFrame> & async, uint32 steps) {
+        ClockFrame result = ClockFrame();
+        while (result.steps < steps) {
+            const ClockFrame * frame = async.beginReadLatest();
+            if (frame == nullptr) {
+                std::this_thread::yield();
+                continue;
+            }
+            EXPECT_GT(frame->steps, result.steps);
+            result = *frame;
+            async.endRead();
+        }
+        return result;
+    }
+};
+
+} // end namespace
+
+
+//----------------------------------------------------------------------------------------
+TEST_F(AsyncSimulation_Test, frames_snapshot_consecutive_steps) {
+    ClockSimulation sim;
+    AsyncSimulation<ClockFrame> async(sim, snapshot);
+    EXPECT_FALSE(async.isRunning());
+
+    async.start(0.5f);
+    EXPECT_TRUE(async.isRunning());
+    ClockFrame frame = waitForSteps(async, 100);
+    async.stop();
+
+    EXPECT_FALSE(async.isRunning());
+    EXPECT_EQ(frame.steps * 0.5f, frame.time);
+    EXPECT_EQ(uint64(sim.steps), async.stepsCompleted());
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(AsyncSimulation_Test, waits_for_renderer_to_take_each_frame) {
+    ClockSimulation sim;
+    AsyncSimulation<ClockFrame> async(sim, snapshot, 3);
+    async.start(1.0f);
+
+    // With no frames read, the simulation stops after publishing one.
+    while (async.stepsCompleted() < 1) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(1u, async.stepsCompleted());
+
+    // Taking it lets the simulation compute exactly one more frame.
+    const ClockFrame * frame = async.beginReadLatest();
+    ASSERT_NE(nullptr, frame);
+    EXPECT_EQ(1u, frame->steps);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(2u, async.stepsCompleted());
+    async.endRead();
+    async.stop();
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(AsyncSimulation_Test, slow_renderer_slows_step_rate) {
+    ClockSimulation sim;
+    AsyncSimulation<ClockFrame> async(sim, snapshot);
+    async.start(1.0f);
+
+    // A renderer drawing one frame every 2 ms, far slower than ClockSimulation
+    // steps.
+    uint32 framesDrawn = 0;
+    uint32 lastSteps = 0;
+    for (uint32 i(0); i < 25; ++i) {
+        const ClockFrame * frame = async.beginReadLatest();
+        if (frame != nullptr) {
+            EXPECT_EQ(lastSteps + 1, frame->steps);
+            lastSteps = frame->steps;
+            ++framesDrawn;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        async.endRead();
+    }
+    async.stop();
+
+    // One step per frame drawn, plus the one computed ahead.
+    EXPECT_GT(framesDrawn, 0u);
+    EXPECT_LE(async.stepsCompleted(), uint64(framesDrawn) + 1);
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(AsyncSimulation_Test, posted_commands_run_between_steps) {
+    ClockSimulation sim;
+    AsyncSimulation<ClockFrame> async(sim, snapshot);
+
+    // Runs immediately when stopped.
+    async.post([](Simulation & s) { static_cast<ClockSimulation &>(s).scale = 2.0f; });
+    EXPECT_EQ(2.0f, sim.scale);
+
+    async.start(1.0f);
+    ClockFrame before = waitForSteps(async, 10);
+    async.post([](Simulation & s) { static_cast<ClockSimulation &>(s).scale = 0.0f; });
+    ClockFrame after = waitForSteps(async, before.steps + 10);
+    async.stop();
+
+    EXPECT_EQ(2.0f * before.steps, before.time);
+    EXPECT_EQ(0.0f, sim.scale);
+    EXPECT_LT(after.time, 2.0f * after.steps);
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(AsyncSimulation_Test, rethrows_simulation_exceptions_on_read) {
+    ClockSimulation sim;
+    sim.failAfter = 5;
+    AsyncSimulation<ClockFrame> async(sim, snapshot, 8);
+    async.start(1.0f);
+
+    bool thrown = false;
+    while (!thrown) {
+        try {
+            if (async.beginReadLatest() != nullptr) {
+                async.endRead();
+            }
+            std::this_thread::yield();
+        } catch (const FluidSim::Exception &) {
+            thrown = true;
+        }
+    }
+
+    EXPECT_FALSE(async.isRunning());
+    EXPECT_EQ(5u, async.stepsCompleted());
+}
@@ -0,0 +1,97 @@
+/**
+* CflTimeStep_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/CflTimeStep.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <cmath>
+#include <vector>
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+class CflTimeStep_Test : public ::testing::Test {
+protected:
+    static const float32 kFrameDt;
+    static const float32 kCellLength;
+
+    // Substeps of one frame at a constant max speed.
+    static std::vector<float32> substeps(const CflTimeStep & timeStep, float32 maxSpeed) {
+        std::vector<float32> result;
+        float32 remaining = kFrameDt;
+        while (remaining > 0.0f) {
+            float32 dt = timeStep.substep(kFrameDt, remaining, maxSpeed, kCellLength);
+            result.push_back(dt);
+            remaining -= dt;
+            if (result.size() > 100) break;
+        }
+        return result;
+    }
+};
+
+const float32 CflTimeStep_Test::kFrameDt = 0.01f;
+const float32 CflTimeStep_Test::kCellLength = 0.01f;
+
+} // end namespace
+
+
+//----------------------------------------------------------------------------------------
+TEST_F(CflTimeStep_Test, throws_on_invalid_settings) {
+    EXPECT_THROW(CflTimeStep(0.0f), FluidSim::Exception);
+    EXPECT_THROW(CflTimeStep(1.0f, 0), FluidSim::Exception);
+
+    CflTimeStep timeStep;
+    EXPECT_THROW(timeStep.setTargetCfl(-1.0f), FluidSim::Exception);
+    EXPECT_EQ(1.0f, timeStep.targetCfl());
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(CflTimeStep_Test, cfl_time_step_moves_target_cells) {
+    CflTimeStep timeStep(2.0f);
+    EXPECT_FLOAT_EQ(0.01f, timeStep.cflTimeStep(2.0f, kCellLength));
+    EXPECT_TRUE(std::isinf(timeStep.cflTimeStep(0.0f, kCellLength)));
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(CflTimeStep_Test, calm_flow_takes_one_step_per_frame) {
+    CflTimeStep timeStep(1.0f);
+    std::vector<float32> steps = substeps(timeStep, 0.5f);
+    ASSERT_EQ(1u, steps.size());
+    EXPECT_EQ(kFrameDt, steps[0]);
+
+    EXPECT_EQ(1u, substeps(timeStep, 0.0f).size());
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(CflTimeStep_Test, fast_flow_substeps_within_target) {
+    // Three and a half CFL steps per frame: three full steps would leave a
+    // sliver, so the last two split the remainder evenly.
+    CflTimeStep timeStep(1.0f);
+    const float32 maxSpeed = 3.5f;
+    std::vector<float32> steps = substeps(timeStep, maxSpeed);
+    ASSERT_EQ(4u, steps.size());
+
+    float32 total = 0.0f;
+    for (float32 dt : steps) {
+        EXPECT_LE(maxSpeed * dt / kCellLength, 1.0f + 1.0e-5f);
+        total += dt;
+    }
+    EXPECT_FLOAT_EQ(kFrameDt, total);
+    EXPECT_EQ(steps[2], steps[3]);
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(CflTimeStep_Test, substeps_are_bounded_by_max_substeps) {
+    CflTimeStep timeStep(1.0f, 4);
+    std::vector<float32> steps = substeps(timeStep, 1000.0f);
+    EXPECT_LE(steps.size(), 5u);
+    for (float32 dt : steps) {
+        EXPECT_GE(dt, 0.5f * kFrameDt / 4);
+    }
+}
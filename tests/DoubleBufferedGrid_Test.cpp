@@ -0,0 +1,66 @@
+/**
+* DoubleBufferedGrid_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/DoubleBufferedGrid.hpp"
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+class DoubleBufferedGrid_Test : public ::testing::Test {
+protected:
+    static GridSpec gridSpec;
+
+};
+
+GridSpec DoubleBufferedGrid_Test::gridSpec = { 3, 2, 0.5f, vec2(0.0f) };
+
+} // end namespace
+
+
+//------------------------------------------------------------------------------
+TEST_F(DoubleBufferedGrid_Test, buffers_share_grid_spec) {
+    DoubleBufferedGrid<float32> buffers(gridSpec);
+
+    EXPECT_TRUE(buffers.front().gridSpec() == gridSpec);
+    EXPECT_TRUE(buffers.back().gridSpec() == gridSpec);
+    EXPECT_TRUE(buffers.gridSpec() == gridSpec);
+    EXPECT_NE(buffers.front().data(), buffers.back().data());
+}
+
+//------------------------------------------------------------------------------
+TEST_F(DoubleBufferedGrid_Test, construct_from_grid_copies_front) {
+    Grid<int32> grid(gridSpec);
+    grid.setAll(5);
+
+    DoubleBufferedGrid<int32> buffers(grid);
+
+    EXPECT_EQ(5, buffers.front()(2,1));
+    EXPECT_NE(grid.data(), buffers.front().data());
+}
+
+//------------------------------------------------------------------------------
+TEST_F(DoubleBufferedGrid_Test, swap_exchanges_front_and_back) {
+    DoubleBufferedGrid<int32> buffers(gridSpec);
+    buffers.front().setAll(1);
+    buffers.back().setAll(2);
+
+    const int32 * frontData = buffers.front().data();
+    const int32 * backData = buffers.back().data();
+
+    buffers.swap();
+
+    EXPECT_EQ(backData, buffers.front().data());
+    EXPECT_EQ(frontData, buffers.back().data());
+    EXPECT_EQ(2, buffers.front()(0,0));
+    EXPECT_EQ(1, buffers.back()(0,0));
+
+    buffers.swap();
+
+    EXPECT_EQ(frontData, buffers.front().data());
+}
@@ -0,0 +1,123 @@
+/**
+* FrameQueue_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/FrameQueue.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <thread>
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+class FrameQueue_Test : public ::testing::Test {
+protected:
+    // Writes \c value into the next free slot, returning false if full.
+    static bool push(FrameQueue<uint32> & queue, uint32 value) {
+        uint32 * frame = queue.beginWrite();
+        if (frame == nullptr) {
+            return false;
+        }
+        *frame = value;
+        queue.endWrite();
+        return true;
+    }
+};
+
+} // end namespace
+
+
+//----------------------------------------------------------------------------------------
+TEST_F(FrameQueue_Test, throws_on_capacity_less_than_two) {
+    EXPECT_THROW(FrameQueue<uint32>(1), FluidSim::Exception);
+    EXPECT_EQ(2u, FrameQueue<uint32>(2).capacity());
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(FrameQueue_Test, empty_queue_has_no_frame_to_read) {
+    FrameQueue<uint32> queue(3);
+    EXPECT_EQ(nullptr, queue.beginReadLatest());
+    EXPECT_EQ(0u, queue.size());
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(FrameQueue_Test, reads_latest_and_drops_older_frames) {
+    FrameQueue<uint32> queue(4);
+    EXPECT_TRUE(push(queue, 1));
+    EXPECT_TRUE(push(queue, 2));
+    EXPECT_TRUE(push(queue, 3));
+    EXPECT_EQ(3u, queue.size());
+    EXPECT_EQ(3u, queue.unreadFrames());
+
+    const uint32 * frame = queue.beginReadLatest();
+    ASSERT_NE(nullptr, frame);
+    EXPECT_EQ(3u, *frame);
+    EXPECT_EQ(2u, queue.droppedFrames());
+    EXPECT_EQ(1u, queue.size());
+    EXPECT_EQ(0u, queue.unreadFrames());
+    queue.endRead();
+
+    EXPECT_EQ(0u, queue.size());
+    EXPECT_EQ(nullptr, queue.beginReadLatest());
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(FrameQueue_Test, producer_waits_when_full) {
+    FrameQueue<uint32> queue(2);
+    EXPECT_TRUE(push(queue, 1));
+    EXPECT_TRUE(push(queue, 2));
+    EXPECT_FALSE(push(queue, 3));
+
+    // The frame being read is still not available to the producer.
+    const uint32 * frame = queue.beginReadLatest();
+    ASSERT_NE(nullptr, frame);
+    EXPECT_EQ(2u, *frame);
+    EXPECT_TRUE(push(queue, 3));
+    EXPECT_FALSE(push(queue, 4));
+    EXPECT_EQ(2u, *frame);
+
+    queue.endRead();
+    EXPECT_TRUE(push(queue, 4));
+
+    frame = queue.beginReadLatest();
+    ASSERT_NE(nullptr, frame);
+    EXPECT_EQ(4u, *frame);
+    queue.endRead();
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(FrameQueue_Test, consumer_sees_increasing_frames_across_threads) {
+    const uint32 numFrames = 20000;
+    FrameQueue<uint32> queue(3);
+
+    std::thread producer([&]() {
+        for (uint32 i(1); i <= numFrames; ) {
+            if (push(queue, i)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32 last = 0;
+    while (last < numFrames) {
+        const uint32 * frame = queue.beginReadLatest();
+        if (frame == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        EXPECT_GT(*frame, last);
+        last = *frame;
+        queue.endRead();
+    }
+    producer.join();
+
+    EXPECT_EQ(numFrames, last);
+    EXPECT_EQ(0u, queue.size());
+}
@@ -0,0 +1,225 @@
+/**
+* GaussSeidel_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/GaussSeidel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+class GaussSeidel_Test : public ::testing::Test {
+protected:
+    static const uint32 kGridSize;
+
+    Grid<CellType> cells;
+    Grid<float32> rhs;
+    Grid<float32> pressure;
+
+    GaussSeidel_Test()
+        : cells(kGridSize, kGridSize, 1.0f, vec2(0.5f)),
+          rhs(kGridSize, kGridSize, 1.0f, vec2(0.5f)),
+          pressure(kGridSize, kGridSize, 1.0f, vec2(0.5f))
+    {
+        // Solid border, as in SmokeSim, with a solid block inside.
+        cells.setAll(CellType::Fluid);
+        for (uint32 i(0); i < kGridSize; ++i) {
+            cells(0, i) = CellType::Solid;
+            cells(kGridSize-1, i) = CellType::Solid;
+            cells(i, 0) = CellType::Solid;
+            cells(i, kGridSize-1) = CellType::Solid;
+        }
+        for (uint32 row(10); row < 14; ++row) {
+            for (uint32 col(6); col < 25; ++col) {
+                cells(col, row) = CellType::Solid;
+            }
+        }
+
+        // Negative divergence of a velocity field that is zero on solid faces, so
+        // that the system is solvable.
+        auto isFluid = [&] (int32 col, int32 row) {
+            return cells(col, row) == CellType::Fluid;
+        };
+        auto u = [&] (int32 col, int32 row) {
+            return (isFluid(col-1, row) && isFluid(col, row)) ?
+                    std::sin(0.5f * col + 0.2f * row) : 0.0f;
+        };
+        auto v = [&] (int32 col, int32 row) {
+            return (isFluid(col, row-1) && isFluid(col, row)) ?
+                    std::cos(0.3f * col - 0.7f * row) : 0.0f;
+        };
+        rhs.setAll(0);
+        for (int32 row(1); row < int32(kGridSize) - 1; ++row) {
+            for (int32 col(1); col < int32(kGridSize) - 1; ++col) {
+                rhs(col,row) = -(u(col+1,row) - u(col,row) + v(col,row+1) - v(col,row));
+            }
+        }
+        pressure.setAll(0);
+    }
+
+    // Max-norm of rhs - Ap over fluid cells.
+    float32 residual() const {
+        float32 result = 0.0f;
+        for (int32 row(1); row < int32(kGridSize) - 1; ++row) {
+            for (int32 col(1); col < int32(kGridSize) - 1; ++col) {
+                if (cells(col,row) != CellType::Fluid) {
+                    continue;
+                }
+                float32 Ap = 0.0f;
+                const int32 offsets[4][2] = { {-1,0}, {1,0}, {0,-1}, {0,1} };
+                for (const auto & offset : offsets) {
+                    int32 i = col + offset[0];
+                    int32 j = row + offset[1];
+                    if (cells(i,j) == CellType::Fluid) {
+                        Ap += pressure(col,row) - pressure(i,j);
+                    }
+                }
+                result = std::max(result, std::abs(rhs(col,row) - Ap));
+            }
+        }
+        return result;
+    }
+};
+
+const uint32 GaussSeidel_Test::kGridSize = 31;
+
+} // end namespace
+
+
+//------------------------------------------------------------------------------
+TEST_F(GaussSeidel_Test, lexicographic_matches_original_sweep) {
+    // The sweep SmokeSim::computePressure used before it moved to gaussSeidel().
+    Grid<float32> p = pressure;
+    for (int32 iteration(0); iteration < 5; ++iteration) {
+        for (int32 row(0); row < int32(kGridSize); ++row) {
+            for (int32 col(0); col < int32(kGridSize); ++col) {
+                if (cells(col,row) == CellType::Fluid) {
+                    float32 numFluidNeighbors = 0;
+                    float32 neighborPressureSum = 0;
+                    if (cells(col-1,row) == CellType::Fluid) {
+                        ++numFluidNeighbors;
+                        neighborPressureSum += p(col-1,row);
+                    }
+                    if (cells(col+1,row) == CellType::Fluid) {
+                        ++numFluidNeighbors;
+                        neighborPressureSum += p(col+1,row);
+                    }
+                    if (cells(col,row-1) == CellType::Fluid) {
+                        ++numFluidNeighbors;
+                        neighborPressureSum += p(col,row-1);
+                    }
+                    if (cells(col,row+1) == CellType::Fluid) {
+                        ++numFluidNeighbors;
+                        neighborPressureSum += p(col,row+1);
+                    }
+                    p(col,row) = (rhs(col,row) + neighborPressureSum) / numFluidNeighbors;
+                }
+            }
+        }
+    }
+
+    gaussSeidel(cells, rhs, pressure, 5, GaussSeidelOrdering::Lexicographic);
+
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            ASSERT_EQ(p(col,row), pressure(col,row));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(GaussSeidel_Test, red_black_parallel_matches_serial) {
+    Grid<float32> serial = pressure;
+
+    gaussSeidel(cells, rhs, serial, 7, GaussSeidelOrdering::RedBlack, Execution::Serial);
+    gaussSeidel(cells, rhs, pressure, 7, GaussSeidelOrdering::RedBlack,
+            Execution::Parallel);
+
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            ASSERT_EQ(serial(col,row), pressure(col,row));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(GaussSeidel_Test, red_black_converges_like_lexicographic) {
+    // Compare the asymptotic reduction per sweep, measured over sweeps 40-80.
+    const GaussSeidelOrdering orderings[2] = {
+        GaussSeidelOrdering::Lexicographic, GaussSeidelOrdering::RedBlack
+    };
+    float32 reduction[2];
+
+    for (uint32 i(0); i < 2; ++i) {
+        pressure.setAll(0);
+        gaussSeidel(cells, rhs, pressure, 40, orderings[i]);
+        float32 before = residual();
+        gaussSeidel(cells, rhs, pressure, 40, orderings[i]);
+        float32 after = residual();
+
+        reduction[i] = std::pow(after / before, 1.0f / 40);
+        EXPECT_LT(reduction[i], 1.0f);
+    }
+
+    EXPECT_NEAR(reduction[0], reduction[1], 0.01f);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(GaussSeidel_Test, solid_cells_untouched) {
+    pressure.setAll(2.0f);
+
+    gaussSeidel(cells, rhs, pressure, 3);
+
+    EXPECT_EQ(2.0f, pressure(0,0));
+    EXPECT_EQ(2.0f, pressure(10,12));
+}
+
+//------------------------------------------------------------------------------
+TEST_F(GaussSeidel_Test, stencil_matches_cell_types) {
+    Grid<float32> expected = pressure;
+    gaussSeidel(cells, rhs, expected, 10, GaussSeidelOrdering::RedBlack);
+
+    PressureStencil stencil(cells);
+    Grid<float32> serial = pressure;
+    gaussSeidel(stencil, rhs, serial, 10, GaussSeidelOrdering::RedBlack,
+            Execution::Serial);
+    gaussSeidel(stencil, rhs, pressure, 10, GaussSeidelOrdering::RedBlack,
+            Execution::Parallel);
+
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            ASSERT_EQ(serial(col,row), pressure(col,row));
+            ASSERT_NEAR(expected(col,row), pressure(col,row), 1.0e-5f);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(GaussSeidel_Test, sparse_matches_dense_stencil) {
+    PressureStencil stencil(cells);
+
+    const GaussSeidelOrdering orderings[] = {
+        GaussSeidelOrdering::Lexicographic, GaussSeidelOrdering::RedBlack
+    };
+    for (GaussSeidelOrdering ordering : orderings) {
+        Grid<float32> dense = pressure;
+        gaussSeidel(stencil, rhs, dense, 10, ordering, Execution::Serial);
+
+        Grid<float32> sparse = pressure;
+        gaussSeidel(stencil, stencil.fluidCells(), rhs, sparse, 10, ordering,
+                Execution::Parallel);
+
+        for (uint32 row(0); row < kGridSize; ++row) {
+            for (uint32 col(0); col < kGridSize; ++col) {
+                ASSERT_EQ(dense(col,row), sparse(col,row));
+            }
+        }
+    }
+}
@@ -0,0 +1,166 @@
+/**
+* Grid3_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "Grid3.hpp"
+#include "StaggeredGrid3.hpp"
+#include "NumericTypes.hpp"
+
+#include <cstdint>
+#include <utility>
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+class Grid3_Test : public ::testing::Test {
+protected:
+    static constexpr float32 kCellLength = 0.5f;
+
+    // Fills grid with cell (col,row,layer) = 100 * layer + 10 * row + col.
+    static void fillPattern(Grid3<int32> & grid) {
+        for (uint32 layer(0); layer < grid.depth(); ++layer) {
+            for (uint32 row(0); row < grid.height(); ++row) {
+                for (uint32 col(0); col < grid.width(); ++col) {
+                    grid(col,row,layer) = int32(100 * layer + 10 * row + col);
+                }
+            }
+        }
+    }
+};
+
+} // end namespace
+
+constexpr float32 Grid3_Test::kCellLength;
+
+
+//------------------------------------------------------------------------------
+TEST_F(Grid3_Test, grid_spec) {
+    Grid3<float32> a(3, 4, 5, kCellLength, vec3(1.0f, 2.0f, 3.0f));
+    GridSpec3 spec = a.gridSpec();
+
+    EXPECT_EQ(3u, spec.width);
+    EXPECT_EQ(4u, spec.height);
+    EXPECT_EQ(5u, spec.depth);
+    EXPECT_FLOAT_EQ(kCellLength, spec.cellLength);
+
+    Grid3<float32> b(spec);
+    EXPECT_TRUE(a.gridSpec() == b.gridSpec());
+
+    spec.depth = 6;
+    EXPECT_TRUE(a.gridSpec() != spec);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Grid3_Test, cells_are_stored_col_row_layer) {
+    Grid3<int32> a(3, 4, 5, kCellLength, vec3(0.0f));
+    fillPattern(a);
+
+    EXPECT_EQ(3u, a.pitch());
+    EXPECT_EQ(12u, a.slicePitch());
+    EXPECT_EQ(&a(0,0,0) + 1, &a(1,0,0));
+    EXPECT_EQ(&a(0,0,0) + 3, &a(0,1,0));
+    EXPECT_EQ(&a(0,0,0) + 12, &a(0,0,1));
+    EXPECT_EQ(432, a(2,3,4));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(a.data()) % kCacheLineSize);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Grid3_Test, get_position) {
+    Grid3<float32> a(3, 4, 5, kCellLength, vec3(1.0f, 2.0f, 3.0f));
+    vec3 p = a.getPosition(2, 1, 4);
+
+    EXPECT_FLOAT_EQ(2.0f, p.x);
+    EXPECT_FLOAT_EQ(2.5f, p.y);
+    EXPECT_FLOAT_EQ(5.0f, p.z);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Grid3_Test, aligned_rows) {
+    Grid3<float32> a(5, 3, 2, kCellLength, vec3(0.0f), GridLayout(1, true));
+
+    EXPECT_EQ(0u, a.pitch() % (kCacheLineSize / sizeof(float32)));
+    for (uint32 layer(0); layer < 2; ++layer) {
+        for (uint32 row(0); row < 3; ++row) {
+            EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(&a(0,row,layer)) % kCacheLineSize);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Grid3_Test, fill_border) {
+    Grid3<int32> a(3, 2, 4, kCellLength, vec3(0.0f), GridLayout(1));
+    a.setAll(-1);
+    fillPattern(a);
+
+    a.fillBorder(BorderPolicy::Clamp);
+    EXPECT_EQ(0, a.at(-1,-1,-1));
+    EXPECT_EQ(312, a.at(3,2,4));
+    EXPECT_EQ(211, a.at(1,2,2));
+    EXPECT_EQ(10, a.at(-1,1,-1));
+
+    a.fillBorder(BorderPolicy::Periodic);
+    EXPECT_EQ(312, a.at(-1,-1,-1));
+    EXPECT_EQ(0, a.at(3,2,4));
+    EXPECT_EQ(102, a.at(-1,0,1));
+
+    a.fillBorder(BorderPolicy::Zero);
+    for (int32 layer(-1); layer < 5; ++layer) {
+        for (int32 row(-1); row < 3; ++row) {
+            for (int32 col(-1); col < 4; ++col) {
+                int32 expected = a.isValidCoord(col, row, layer) ?
+                        100 * layer + 10 * row + col : 0;
+                ASSERT_EQ(expected, a.at(col,row,layer));
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Grid3_Test, copy_move_and_swap) {
+    Grid3<int32> a(3, 2, 2, kCellLength, vec3(0.0f), GridLayout(1, true));
+    fillPattern(a);
+
+    Grid3<int32> b(a);
+    EXPECT_EQ(a.layout(), b.layout());
+    EXPECT_EQ(112, b(2,1,1));
+
+    Grid3<int32> c(std::move(b));
+    EXPECT_EQ(112, c(2,1,1));
+    EXPECT_EQ(0u, b.width());
+
+    Grid3<int32> d(1, 1, 1, kCellLength, vec3(0.0f));
+    d.setAll(7);
+    d.swap(c);
+    EXPECT_EQ(112, d(2,1,1));
+    EXPECT_EQ(7, c(0,0,0));
+
+    c = d;
+    EXPECT_EQ(101, c(1,0,1));
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Grid3_Test, staggered_grid_faces) {
+    GridSpec3 cells = { 4, 3, 2, kCellLength, vec3(0.25f) };
+    StaggeredGrid3<float32> velocity(cells);
+
+    EXPECT_EQ(5u, velocity.u.width());
+    EXPECT_EQ(3u, velocity.u.height());
+    EXPECT_EQ(4u, velocity.v.width());
+    EXPECT_EQ(4u, velocity.v.height());
+    EXPECT_EQ(3u, velocity.w.depth());
+
+    // Face (col,row,layer) of u lies on the left side of cell (col,row,layer).
+    vec3 face = velocity.u.getPosition(1, 2, 1);
+    EXPECT_FLOAT_EQ(0.5f, face.x);
+    EXPECT_FLOAT_EQ(1.25f, face.y);
+    EXPECT_FLOAT_EQ(0.75f, face.z);
+
+    face = velocity.w.getPosition(0, 0, 2);
+    EXPECT_FLOAT_EQ(0.25f, face.x);
+    EXPECT_FLOAT_EQ(1.0f, face.z);
+}
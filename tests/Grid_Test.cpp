@@ -8,6 +8,7 @@
 #include "Grid.hpp"
 #include "NumericTypes.hpp"
 
+#include <cstdint>
 #include <utility>
 
 using namespace FluidSim;
@@ -193,3 +194,269 @@ TEST_F(Grid_Test, divide_equals) {
 
 
 
+
+//------------------------------------------------------------------------------
+TEST_F(Grid_Test, swap) {
+    Grid<int32> a(1,2,kCellLength,vec2(0.0f));
+    Grid<int32> b(3,1,2*kCellLength,vec2(1.0f));
+
+    a(0,0) = 1;
+    a(0,1) = 2;
+    b.setAll(7);
+
+    const int32 * aData = a.data();
+    const int32 * bData = b.data();
+
+    a.swap(b);
+
+    EXPECT_EQ(a.data(), bData);
+    EXPECT_EQ(b.data(), aData);
+
+    EXPECT_EQ(a.width(), 3);
+    EXPECT_EQ(a.height(), 1);
+    EXPECT_FLOAT_EQ(a.cellLength(), 2*kCellLength);
+    EXPECT_EQ(a(2,0), 7);
+
+    EXPECT_EQ(b.width(), 1);
+    EXPECT_EQ(b.height(), 2);
+    EXPECT_EQ(b(0,1), 2);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Grid_Test, storage_is_cache_line_aligned) {
+    Grid<float32> a(5, 3, kCellLength, vec2(0.0f));
+    Grid<uint8> b(7, 2, kCellLength, vec2(0.0f));
+
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(a.data()) % kCacheLineSize);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(b.data()) % kCacheLineSize);
+
+    // The default layout is tightly packed.
+    EXPECT_EQ(5u, a.pitch());
+    EXPECT_EQ(0u, a.border());
+    EXPECT_EQ(&a(0,2), a.data() + 2 * 5);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Grid_Test, aligned_rows) {
+    Grid<float32> a(5, 3, kCellLength, vec2(0.0f), GridLayout(0, true));
+
+    EXPECT_EQ(16u, a.pitch());
+    for (uint32 row(0); row < a.height(); ++row) {
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(&a(0,row)) % kCacheLineSize);
+        EXPECT_EQ(&a(0,row), a.data() + row * a.pitch());
+    }
+
+    // 12 byte elements need 3 cache lines (16 elements) to realign.
+    Grid<vec3> b(3, 2, kCellLength, vec2(0.0f), GridLayout(0, true));
+    EXPECT_EQ(16u, b.pitch());
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(&b(0,1)) % kCacheLineSize);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Grid_Test, border_cells_are_addressable) {
+    Grid<int32> a(3, 2, kCellLength, vec2(0.0f), GridLayout(2));
+
+    EXPECT_EQ(2u, a.border());
+    EXPECT_EQ(3u + 2 * 2, a.pitch());
+
+    a.setAll(5);
+    for (uint32 row(0); row < 2; ++row) {
+        for (uint32 col(0); col < 3; ++col) {
+            a(col,row) = int32(10 * row + col);
+        }
+    }
+
+    // Border cells keep the value from setAll(), interior cells are unaffected.
+    const int32 * p = a.data();
+    EXPECT_EQ(5, p[-1]);
+    EXPECT_EQ(5, p[-2 * int32(a.pitch()) - 2]);
+    EXPECT_EQ(5, p[3]);
+    EXPECT_EQ(12, p[a.pitch() + 2]);
+    EXPECT_EQ(5, p[3 * int32(a.pitch()) + 4]);
+
+    // Copies keep layout and border contents.
+    Grid<int32> b(a);
+    EXPECT_EQ(a.pitch(), b.pitch());
+    EXPECT_EQ(5, b.data()[-1]);
+    EXPECT_EQ(12, b(2,1));
+
+    Grid<int32> c(1, 1, kCellLength, vec2(0.0f));
+    c = a;
+    EXPECT_EQ(a.layout(), c.layout());
+    EXPECT_EQ(5, c.data()[-int32(c.pitch())]);
+    EXPECT_EQ(11, c(1,1));
+}
+
+//------------------------------------------------------------------------------
+namespace {
+
+uint32 g_numAllocations = 0;
+
+template <typename T>
+class CountingAllocator : public AlignedAllocator<T> {
+public:
+    T * allocate(size_t n) {
+        ++g_numAllocations;
+        return AlignedAllocator<T>::allocate(n);
+    }
+};
+
+} // end namespace
+
+TEST_F(Grid_Test, custom_allocator) {
+    g_numAllocations = 0;
+    {
+        Grid<float32, CountingAllocator<float32>> a(4, 4, kCellLength, vec2(0.0f));
+        a.setAll(1.0f);
+        Grid<float32, CountingAllocator<float32>> b(a);
+        Grid<float32, CountingAllocator<float32>> c(std::move(b));
+        EXPECT_FLOAT_EQ(1.0f, c(3,3));
+    }
+    EXPECT_EQ(2u, g_numAllocations);
+}
+
+//------------------------------------------------------------------------------
+namespace {
+
+// 3x2 grid with cell (col,row) = 10 * row + col, and a border of 2 cells that
+// is wider than the grid is tall.
+Grid<int32> makeBorderedGrid() {
+    Grid<int32> a(3, 2, 1.0f, vec2(0.0f), GridLayout(2));
+    a.setAll(-1);
+    for (uint32 row(0); row < 2; ++row) {
+        for (uint32 col(0); col < 3; ++col) {
+            a(col,row) = int32(10 * row + col);
+        }
+    }
+    return a;
+}
+
+} // end namespace
+
+TEST_F(Grid_Test, fill_border_clamp) {
+    Grid<int32> a = makeBorderedGrid();
+    a.fillBorder(BorderPolicy::Clamp);
+
+    EXPECT_EQ(0, a.at(-1,0));
+    EXPECT_EQ(0, a.at(-2,-2));
+    EXPECT_EQ(2, a.at(4,0));
+    EXPECT_EQ(12, a.at(4,3));
+    EXPECT_EQ(11, a.at(1,3));
+    EXPECT_EQ(1, a.at(1,-1));
+    EXPECT_EQ(10, a(0,1));
+}
+
+TEST_F(Grid_Test, fill_border_zero) {
+    Grid<int32> a = makeBorderedGrid();
+    a.fillBorder(BorderPolicy::Zero);
+
+    for (int32 row(-2); row < 4; ++row) {
+        for (int32 col(-2); col < 5; ++col) {
+            if (a.isValidCoord(col, row)) {
+                EXPECT_EQ(10 * row + col, a.at(col,row));
+            } else {
+                EXPECT_EQ(0, a.at(col,row)) << col << "," << row;
+            }
+        }
+    }
+}
+
+TEST_F(Grid_Test, fill_border_periodic) {
+    Grid<int32> a = makeBorderedGrid();
+    a.fillBorder(BorderPolicy::Periodic);
+
+    for (int32 row(-2); row < 4; ++row) {
+        for (int32 col(-2); col < 5; ++col) {
+            int32 srcCol = (col + 3) % 3;
+            int32 srcRow = (row + 2) % 2;
+            EXPECT_EQ(10 * srcRow + srcCol, a.at(col,row)) << col << "," << row;
+        }
+    }
+}
+
+TEST_F(Grid_Test, fill_border_reflect) {
+    Grid<int32> a = makeBorderedGrid();
+    a.fillBorder(BorderPolicy::Reflect);
+
+    // Mirrored across each edge: columns -2..4 copy 1 0 | 0 1 2 | 2 1, and
+    // rows -2..3 copy 1 0 | 0 1 | 1 0.
+    const int32 cols[] = { 1, 0, 0, 1, 2, 2, 1 };
+    const int32 rows[] = { 1, 0, 0, 1, 1, 0 };
+    for (int32 row(-2); row < 4; ++row) {
+        for (int32 col(-2); col < 5; ++col) {
+            EXPECT_EQ(10 * rows[row + 2] + cols[col + 2], a.at(col,row))
+                    << col << "," << row;
+        }
+    }
+}
+
+TEST_F(Grid_Test, fill_border_without_border_is_noop) {
+    Grid<int32> a(2, 2, kCellLength, vec2(0.0f));
+    a.setAll(7);
+    a.fillBorder(BorderPolicy::Zero);
+    EXPECT_EQ(7, a(0,0));
+    EXPECT_EQ(7, a(1,1));
+}
+
+//------------------------------------------------------------------------------
+namespace {
+
+// Checks that every cell of a width x height grid with the given border, stored
+// in cell layout L, maps to a distinct element within the allocation, and that
+// values written through at() read back through operator() and fillBorder().
+template <typename L>
+void checkCellLayout(uint32 width, uint32 height, uint32 border) {
+    Grid<int32, AlignedAllocator<int32>, L> a(width, height, 1.0f, vec2(0.0f),
+            GridLayout(border));
+    a.setAll(-1);
+
+    const int32 b = int32(border);
+    for (int32 row(-b); row < int32(height) + b; ++row) {
+        for (int32 col(-b); col < int32(width) + b; ++col) {
+            ASSERT_EQ(-1, a.at(col,row)) << "cells alias at " << col << "," << row;
+            a.at(col,row) = 1000 * row + col;
+        }
+    }
+    for (uint32 row(0); row < height; ++row) {
+        for (uint32 col(0); col < width; ++col) {
+            ASSERT_EQ(int32(1000 * row + col), a(col,row));
+        }
+    }
+
+    a.fillBorder(BorderPolicy::Periodic);
+    if (border > 0) {
+        EXPECT_EQ(a(width - 1, height - 1), a.at(-1,-1));
+        EXPECT_EQ(a(0, 1), a.at(int32(width), 1));
+    }
+
+    Grid<int32, AlignedAllocator<int32>, L> copy(a);
+    EXPECT_EQ(a(width - 1, 0), copy(width - 1, 0));
+    EXPECT_EQ(a.getPosition(3, 2), copy.getPosition(3, 2));
+}
+
+} // end namespace
+
+TEST_F(Grid_Test, bricked_layout) {
+    checkCellLayout<BrickedLayout<>>(19, 7, 0);
+    checkCellLayout<BrickedLayout<>>(19, 7, 2);
+    checkCellLayout<BrickedLayout<2>>(16, 16, 1);
+}
+
+TEST_F(Grid_Test, z_order_layout) {
+    checkCellLayout<ZOrderLayout>(16, 16, 0);
+    checkCellLayout<ZOrderLayout>(19, 7, 0);
+    checkCellLayout<ZOrderLayout>(5, 33, 3);
+}
+
+TEST_F(Grid_Test, z_order_layout_is_contiguous_in_squares) {
+    Grid<int32, AlignedAllocator<int32>, ZOrderLayout> a(4, 4, 1.0f, vec2(0.0f));
+
+    // Cells (0,0), (1,0), (0,1), (1,1) come first, then the next 2x2 square.
+    const int32 * p = a.data();
+    EXPECT_EQ(p + 0, &a(0,0));
+    EXPECT_EQ(p + 1, &a(1,0));
+    EXPECT_EQ(p + 2, &a(0,1));
+    EXPECT_EQ(p + 3, &a(1,1));
+    EXPECT_EQ(p + 4, &a(2,0));
+    EXPECT_EQ(p + 15, &a(3,3));
+}
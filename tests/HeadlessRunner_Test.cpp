@@ -0,0 +1,206 @@
+/**
+* HeadlessRunner_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/HeadlessRunner.hpp"
+#include "FluidSim/Grid.hpp"
+#include "FluidSim/Grid3.hpp"
+#include "FluidSim/SmokeSim3D.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+// Records the calls made by runHeadless(), and exposes a small grid as its only
+// field, filled with the number of steps taken.
+class CountingSimulation : public Simulation {
+public:
+    uint32 initCount;
+    uint32 stepCount;
+    float32 lastDt;
+    Grid<float32> grid;
+
+    CountingSimulation()
+        : initCount(0),
+          stepCount(0),
+          lastDt(0.0f),
+          grid(GridSpec{3, 2, 1.0f, vec2(0.0f)}, GridLayout(1, true))
+    {
+
+    }
+
+    virtual void init() {
+        ++initCount;
+        stepCount = 0;
+        grid.setAll(0.0f);
+    }
+
+    virtual void step(float32 dt) {
+        ++stepCount;
+        lastDt = dt;
+        grid.setAll(float32(stepCount));
+    }
+
+    virtual std::vector<FieldView> fields() const {
+        return std::vector<FieldView>(1, makeFieldView("count", grid));
+    }
+};
+
+class HeadlessRunner_Test : public ::testing::Test {
+protected:
+    static const std::string kPrefix;
+
+    static std::string fileName(const std::string & field, const char * frame) {
+        return kPrefix + field + "." + frame + ".raw";
+    }
+
+    // Reads, then removes, a file written by writeFields().  Returns an empty
+    // vector if the file does not exist.
+    static std::vector<float32> readAndRemove(const std::string & fileName) {
+        std::vector<float32> values;
+        std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+        float32 value;
+        while (file.read(reinterpret_cast<char *>(&value), sizeof(value))) {
+            values.push_back(value);
+        }
+        file.close();
+        std::remove(fileName.c_str());
+
+        return values;
+    }
+};
+
+const std::string HeadlessRunner_Test::kPrefix = "HeadlessRunner_Test_";
+
+} // end namespace
+
+
+//----------------------------------------------------------------------------------------
+TEST_F(HeadlessRunner_Test, steps_requested_frames_without_output) {
+    CountingSimulation sim;
+    HeadlessSettings settings(7, 0.25f);
+
+    HeadlessResult result = runHeadless(sim, settings);
+
+    EXPECT_EQ(1u, sim.initCount);
+    EXPECT_EQ(7u, sim.stepCount);
+    EXPECT_EQ(0.25f, sim.lastDt);
+    EXPECT_EQ(7u, result.frames);
+    EXPECT_EQ(0u, result.framesWritten);
+    EXPECT_EQ(0.0, result.outputSeconds);
+    EXPECT_GE(result.framesPerSecond(), 0.0);
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(HeadlessRunner_Test, writes_every_interval_frames) {
+    CountingSimulation sim;
+    HeadlessSettings settings(5, 0.1f);
+    settings.outputPrefix = kPrefix;
+    settings.outputInterval = 2;
+
+    HeadlessResult result = runHeadless(sim, settings);
+    EXPECT_EQ(5u, result.frames);
+    EXPECT_EQ(2u, result.framesWritten);
+
+    // Frames 2 and 4 are written, excluding the border and row padding.
+    std::vector<float32> frame2 = readAndRemove(fileName("count", "000002"));
+    std::vector<float32> frame4 = readAndRemove(fileName("count", "000004"));
+    ASSERT_EQ(6u, frame2.size());
+    ASSERT_EQ(6u, frame4.size());
+    for (uint32 i(0); i < 6; ++i) {
+        EXPECT_EQ(2.0f, frame2[i]);
+        EXPECT_EQ(4.0f, frame4[i]);
+    }
+
+    EXPECT_TRUE(readAndRemove(fileName("count", "000001")).empty());
+    EXPECT_TRUE(readAndRemove(fileName("count", "000005")).empty());
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(HeadlessRunner_Test, writes_grid3_cells_x_fastest) {
+    Grid3<float32> grid(GridSpec3{2, 2, 2, 1.0f, vec3(0.0f)}, GridLayout(1, true));
+    for (uint32 layer(0); layer < 2; ++layer) {
+        for (uint32 row(0); row < 2; ++row) {
+            for (uint32 col(0); col < 2; ++col) {
+                grid(col,row,layer) = float32(col + 10*row + 100*layer);
+            }
+        }
+    }
+
+    writeFields(std::vector<FieldView>(1, makeFieldView("grid3", grid)), kPrefix, 3);
+
+    std::vector<float32> values = readAndRemove(fileName("grid3", "000003"));
+    const float32 expected[] = {0, 1, 10, 11, 100, 101, 110, 111};
+    ASSERT_EQ(8u, values.size());
+    for (uint32 i(0); i < 8; ++i) {
+        EXPECT_EQ(expected[i], values[i]);
+    }
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(HeadlessRunner_Test, packs_interleaved_particle_attributes) {
+    // Array of structs: x, y, mass for each of three particles.
+    const float32 particles[] = {
+        1, 2, 0.5f,
+        3, 4, 0.5f,
+        5, 6, 0.5f
+    };
+
+    std::vector<FieldView> fields;
+    fields.push_back(makeFieldView("position", particles, 3, 2, 3));
+    fields.push_back(makeFieldView("mass", particles + 2, 3, 1, 3));
+    EXPECT_EQ(3u, fields[0].size());
+
+    writeFields(fields, kPrefix, 0);
+
+    std::vector<float32> positions = readAndRemove(fileName("position", "000000"));
+    std::vector<float32> masses = readAndRemove(fileName("mass", "000000"));
+    const float32 expectedPositions[] = {1, 2, 3, 4, 5, 6};
+    ASSERT_EQ(6u, positions.size());
+    for (uint32 i(0); i < 6; ++i) {
+        EXPECT_EQ(expectedPositions[i], positions[i]);
+    }
+    ASSERT_EQ(3u, masses.size());
+    for (uint32 i(0); i < 3; ++i) {
+        EXPECT_EQ(0.5f, masses[i]);
+    }
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(HeadlessRunner_Test, throws_if_file_can_not_be_opened) {
+    CountingSimulation sim;
+    sim.init();
+
+    EXPECT_THROW(writeFields(sim.fields(), "no_such_directory/", 0), FluidSim::Exception);
+}
+
+//----------------------------------------------------------------------------------------
+TEST_F(HeadlessRunner_Test, smoke_sim_3d_exposes_all_fields) {
+    SmokeSim3D sim(8, 8, 8);
+    runHeadless(sim, HeadlessSettings(2, SmokeSim3D::kDt));
+    EXPECT_EQ(2u, sim.frame());
+
+    std::vector<FieldView> fields = sim.fields();
+    const char * names[] = {"density", "temperature", "pressure", "divergence",
+            "u", "v", "w"};
+    ASSERT_EQ(7u, fields.size());
+    for (uint32 i(0); i < 7; ++i) {
+        EXPECT_EQ(names[i], fields[i].name);
+        EXPECT_EQ(1u, fields[i].components);
+    }
+    EXPECT_EQ(512u, fields[0].size());
+    EXPECT_EQ(9u, fields[4].width);
+    EXPECT_EQ(9u, fields[6].depth);
+    EXPECT_EQ(sim.density()(3,4,5),
+            fields[0].data[5*fields[0].slicePitch + 4*fields[0].rowPitch + 3]);
+}
@@ -7,7 +7,10 @@
 #include "gtest/gtest.h"
 #include "FluidSim/Interp.hpp"
 
+#include <vector>
+
 using namespace FluidSim;
+using namespace std;
 
 
 namespace {  // limit class visibility to this file.
@@ -143,3 +146,276 @@ TEST_F(Interp_Test, bilinear_staggered_grid_one_one) {
     EXPECT_FLOAT_EQ(2.5f, result[1]);
 }
 
+
+//------------------------------------------------------------------------------
+// Test batched bilinear
+//------------------------------------------------------------------------------
+TEST_F(Interp_Test, bilinear_batch_matches_scalar) {
+    // Mix of interior, edge and out of range positions.  Count is not a multiple
+    // of the SIMD width so the scalar tail is exercised as well.
+    const uint32 count = 37;
+    vector<float32> x(count);
+    vector<float32> y(count);
+    for (uint32 i(0); i < count; ++i) {
+        x[i] = -1.0f + 0.11f * i;
+        y[i] = 4.5f - 0.17f * i;
+    }
+
+    vector<float32> result(count);
+    bilinear(float_grid, x.data(), y.data(), result.data(), count);
+
+    for (uint32 i(0); i < count; ++i) {
+        EXPECT_NEAR(bilinear(float_grid, vec2(x[i], y[i])), result[i], 1.0e-5f)
+                << "sample " << i;
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Interp_Test, bilinear_batch_positions) {
+    vector<vec2> positions = {
+        vec2(0.5f, 0.5f),
+        vec2(0.5f, 1.5f),
+        vec2(-1.0f, 4.3f),
+        vec2(0.5f, 1.0f)
+    };
+
+    vector<float32> result(positions.size());
+    bilinear(float_grid, positions.data(), result.data(), uint32(positions.size()));
+
+    EXPECT_FLOAT_EQ(1.5f, result[0]);
+    EXPECT_FLOAT_EQ(3.5f, result[1]);
+    EXPECT_FLOAT_EQ(4.0f, result[2]);
+    EXPECT_FLOAT_EQ(2.5f, result[3]);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Interp_Test, bilinear_padded_grid_matches_packed) {
+    Grid<float32> padded(float_grid.gridSpec(), GridLayout(0, true));
+    padded.setAll(-100.0f);
+    for (uint32 row(0); row < float_grid.height(); ++row) {
+        for (uint32 col(0); col < float_grid.width(); ++col) {
+            padded(col,row) = float_grid(col,row);
+        }
+    }
+    ASSERT_NE(padded.width(), padded.pitch());
+
+    const uint32 count = 37;
+    vector<float32> x(count);
+    vector<float32> y(count);
+    for (uint32 i(0); i < count; ++i) {
+        x[i] = -1.0f + 0.11f * i;
+        y[i] = 4.5f - 0.17f * i;
+    }
+
+    vector<float32> expected(count);
+    vector<float32> result(count);
+    bilinear(float_grid, x.data(), y.data(), expected.data(), count);
+    bilinear(padded, x.data(), y.data(), result.data(), count);
+
+    for (uint32 i(0); i < count; ++i) {
+        EXPECT_EQ(expected[i], result[i]) << "sample " << i;
+        EXPECT_EQ(bilinear(float_grid, vec2(x[i], y[i])),
+                bilinear(padded, vec2(x[i], y[i])));
+    }
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(Interp_Test, bilinear_clamp_border_matches_borderless) {
+    Grid<float32> bordered(float_grid.gridSpec(), GridLayout(2));
+    for (uint32 row(0); row < float_grid.height(); ++row) {
+        for (uint32 col(0); col < float_grid.width(); ++col) {
+            bordered(col,row) = float_grid(col,row);
+        }
+    }
+    bordered.fillBorder(BorderPolicy::Clamp);
+
+    const uint32 count = 37;
+    vector<float32> x(count);
+    vector<float32> y(count);
+    for (uint32 i(0); i < count; ++i) {
+        x[i] = -4.0f + 0.27f * i;
+        y[i] = 6.5f - 0.31f * i;
+    }
+
+    vector<float32> expected(count);
+    vector<float32> result(count);
+    bilinear(float_grid, x.data(), y.data(), expected.data(), count);
+    bilinear(bordered, x.data(), y.data(), result.data(), count);
+
+    for (uint32 i(0); i < count; ++i) {
+        EXPECT_FLOAT_EQ(expected[i], result[i]) << "sample " << i;
+        EXPECT_FLOAT_EQ(bilinear(float_grid, vec2(x[i], y[i])),
+                bilinear(bordered, vec2(x[i], y[i])));
+    }
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(Interp_Test, bilinear_periodic_border_wraps) {
+    // Cells 0 1 2 3 along x, constant along y.
+    Grid<float32> grid(4, 2, kCellLength, vec2(0.0f), GridLayout(1));
+    for (uint32 row(0); row < 2; ++row) {
+        for (uint32 col(0); col < 4; ++col) {
+            grid(col,row) = float32(col);
+        }
+    }
+    grid.fillBorder(BorderPolicy::Periodic);
+
+    // Halfway between the last cell and the first one, across the seam.
+    float32 x[] = { 3.5f, -0.5f, 1.25f };
+    float32 y[] = { 0.5f, 1.5f, -0.75f };
+    float32 result[3];
+    bilinear(grid, x, y, result, 3);
+
+    EXPECT_FLOAT_EQ(1.5f, result[0]);
+    EXPECT_FLOAT_EQ(1.5f, result[1]);
+    EXPECT_FLOAT_EQ(1.25f, result[2]);
+    EXPECT_FLOAT_EQ(1.5f, bilinear(grid, vec2(3.5f, 0.5f)));
+    EXPECT_FLOAT_EQ(1.5f, bilinear(grid, vec2(-0.5f, 1.5f)));
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(Interp_Test, trilinear_reproduces_linear_field) {
+    Grid3<float32> grid(4, 3, 5, 0.5f, vec3(1.0f, 0.0f, -1.0f));
+    auto f = [] (const vec3 & p) { return 2.0f * p.x - 3.0f * p.y + 0.5f * p.z + 1.0f; };
+    for (uint32 layer(0); layer < grid.depth(); ++layer) {
+        for (uint32 row(0); row < grid.height(); ++row) {
+            for (uint32 col(0); col < grid.width(); ++col) {
+                grid(col,row,layer) = f(grid.getPosition(col,row,layer));
+            }
+        }
+    }
+
+    const vec3 samples[] = {
+        vec3(1.1f, 0.3f, -0.8f),
+        vec3(2.5f, 1.0f, 1.0f),  // Upper corner, on the last plane of every axis.
+        vec3(1.7f, 0.99f, 0.2f),
+    };
+    for (const vec3 & p : samples) {
+        EXPECT_NEAR(f(p), trilinear(grid, p), 1.0e-5f);
+    }
+
+    // Outside the grid, samples clamp to the nearest cell.
+    EXPECT_NEAR(f(vec3(1.0f, 0.0f, -1.0f)), trilinear(grid, vec3(-5.0f)), 1.0e-5f);
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(Interp_Test, trilinear_staggered_grid) {
+    GridSpec3 cells = { 2, 2, 2, 1.0f, vec3(0.5f) };
+    StaggeredGrid3<float32> velocity(cells);
+    velocity.u.setAll(1.0f);
+    velocity.v.setAll(2.0f);
+    velocity.w.setAll(3.0f);
+
+    vec3 u = trilinear(velocity, vec3(0.3f, 1.7f, 1.2f));
+    EXPECT_FLOAT_EQ(1.0f, u.x);
+    EXPECT_FLOAT_EQ(2.0f, u.y);
+    EXPECT_FLOAT_EQ(3.0f, u.z);
+}
+
+//------------------------------------------------------------------------------
+// Test monotone cubic
+//------------------------------------------------------------------------------
+namespace {
+
+// n x n grid with a unit step between columns n/2 - 1 and n/2, whose overshoot
+// is the classic failure of unlimited cubic interpolation.
+Grid<float32> stepGrid(uint32 n) {
+    Grid<float32> grid(n, n, 1.0f, vec2(0, 0));
+    for (uint32 row(0); row < n; ++row) {
+        for (uint32 col(0); col < n; ++col) {
+            grid(col, row) = (col < n/2) ? 0.0f : 1.0f;
+        }
+    }
+    return grid;
+}
+
+} // end namespace
+
+//------------------------------------------------------------------------------
+TEST_F(Interp_Test, monotone_cubic_reproduces_linear_field) {
+    Grid<float32> grid(8, 8, 0.5f, vec2(0.25f, 0.25f));
+    for (uint32 row(0); row < 8; ++row) {
+        for (uint32 col(0); col < 8; ++col) {
+            vec2 p = grid.getPosition(col, row);
+            grid(col, row) = 2.0f * p.x - 3.0f * p.y + 1.0f;
+        }
+    }
+
+    // Interior positions, where the full 4x4 stencil fits in the grid.
+    for (float32 y(1.3f); y < 2.7f; y += 0.13f) {
+        for (float32 x(1.3f); x < 2.7f; x += 0.17f) {
+            EXPECT_NEAR(2.0f * x - 3.0f * y + 1.0f, monotoneCubic(grid, vec2(x, y)),
+                    1.0e-5f);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Interp_Test, monotone_cubic_has_no_overshoot) {
+    Grid<float32> grid = stepGrid(8);
+
+    for (float32 x(-1.0f); x < 9.0f; x += 0.05f) {
+        vec2 p(x, 3.4f);
+        float32 value = monotoneCubic(grid, p);
+
+        float32 minValue, maxValue;
+        bilinearMinMax(grid, p, minValue, maxValue);
+        EXPECT_GE(value, minValue) << "x = " << x;
+        EXPECT_LE(value, maxValue) << "x = " << x;
+    }
+
+    // Steeper than bilinear across the step, as the flat sides have zero slope.
+    EXPECT_LT(monotoneCubic(grid, vec2(3.2f, 3.0f)), bilinear(grid, vec2(3.2f, 3.0f)));
+    EXPECT_GT(monotoneCubic(grid, vec2(3.8f, 3.0f)), bilinear(grid, vec2(3.8f, 3.0f)));
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Interp_Test, monotone_cubic_batch_matches_scalar) {
+    Grid<float32> grid(9, 7, 0.5f, vec2(0.25f, 0.25f));
+    for (uint32 row(0); row < 7; ++row) {
+        for (uint32 col(0); col < 9; ++col) {
+            grid(col, row) = std::sin(0.7f * col) * std::cos(1.1f * row);
+        }
+    }
+
+    // Interior, edge and out of range positions, with a scalar tail.
+    const uint32 count = 45;
+    vector<float32> x(count);
+    vector<float32> y(count);
+    for (uint32 i(0); i < count; ++i) {
+        x[i] = -0.5f + 0.113f * i;
+        y[i] = 4.0f - 0.097f * i;
+    }
+
+    vector<float32> result(count);
+    monotoneCubic(grid, x.data(), y.data(), result.data(), count);
+
+    for (uint32 i(0); i < count; ++i) {
+        EXPECT_NEAR(monotoneCubic(grid, vec2(x[i], y[i])), result[i], 1.0e-5f)
+                << "sample " << i;
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Interp_Test, staggered_grid_keeps_interp_through_moves) {
+    Grid<float32> u = stepGrid(8);
+    Grid<float32> v = stepGrid(8);
+    StaggeredGrid<float32> a(std::move(u), std::move(v), &monotoneCubic);
+
+    StaggeredGrid<float32> moved(std::move(a));
+    EXPECT_EQ(interpFunc<float32>(&monotoneCubic), moved.interp());
+
+    StaggeredGrid<float32> assigned;
+    EXPECT_EQ(interpFunc<float32>(&bilinear), assigned.interp());
+    assigned = std::move(moved);
+    EXPECT_EQ(interpFunc<float32>(&monotoneCubic), assigned.interp());
+
+    StaggeredGrid<float32> copied;
+    copied = assigned;
+    EXPECT_EQ(interpFunc<float32>(&monotoneCubic), copied.interp());
+
+    vec2 p(3.2f, 3.0f);
+    vec2 value = copied.interpolate(p);
+    EXPECT_EQ(monotoneCubic(copied.u, p), value.x);
+    EXPECT_EQ(monotoneCubic(copied.v, p), value.y);
+}
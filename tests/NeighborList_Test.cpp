@@ -0,0 +1,153 @@
+/**
+* NeighborList_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/NeighborList.hpp"
+#include "FluidSim/ParticleCellIndex.hpp"
+#include "FluidSim/ParticleArrays.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <cmath>
+#include <vector>
+
+using namespace FluidSim;
+using namespace std;
+
+
+namespace {  // limit class visibility to this file.
+
+const uint32 kNumParticles = 3000;
+const float32 kRadius = 0.1f;
+
+class NeighborList_Test : public ::testing::Test {
+protected:
+    ParticleArrays particles;
+    ParticleArrays scratch;
+    ParticleCellIndex cells;
+
+    // Ran before each test.
+    virtual void SetUp() {
+        // Scattered particles over a 2 x 1.5 box, with a dense clump of 300
+        // particles packed well within kRadius of each other.
+        for (uint32 i(0); i < kNumParticles - 300; ++i) {
+            particles.push_back(vec2(2.0f * float32((i * 37) % 1009) / 1009.0f,
+                                     1.5f * float32((i * 53) % 997) / 997.0f));
+        }
+        for (uint32 i(0); i < 300; ++i) {
+            particles.push_back(vec2(1.0f + 0.001f * (i % 20), 0.7f + 0.001f * (i / 20)));
+        }
+
+        cells.resize(20, 15, 0.1f);
+        cells.build(particles.x.data(), particles.y.data(), particles.size());
+        particles.permute(cells.order().data(), scratch);
+    }
+
+    float32 distance(uint32 i, uint32 j) const {
+        float32 dx = particles.x[i] - particles.x[j];
+        float32 dy = particles.y[i] - particles.y[j];
+        return std::sqrt(dx*dx + dy*dy);
+    }
+};
+
+} // end namespace
+
+
+//------------------------------------------------------------------------------
+TEST_F(NeighborList_Test, matches_brute_force) {
+    NeighborList neighbors;
+    neighbors.build(cells, particles.x.data(), particles.y.data(), kNumParticles,
+            kRadius, 0.0005f);
+
+    ASSERT_EQ(kNumParticles, neighbors.size());
+
+    uint32 total = 0;
+    for (uint32 i(0); i < kNumParticles; ++i) {
+        vector<uint32> expected;
+        for (uint32 j(0); j < kNumParticles; ++j) {
+            float32 dx = particles.x[i] - particles.x[j];
+            float32 dy = particles.y[i] - particles.y[j];
+            float32 r2 = dx*dx + dy*dy;
+            if (j != i && r2 <= kRadius * kRadius && r2 >= 0.0005f * 0.0005f) {
+                expected.push_back(j);
+            }
+        }
+
+        vector<uint32> listed(neighbors.indices() + neighbors.begin(i),
+                              neighbors.indices() + neighbors.end(i));
+        ASSERT_EQ(expected, listed) << "particle " << i;
+
+        for (uint32 k(neighbors.begin(i)); k < neighbors.end(i); ++k) {
+            EXPECT_FLOAT_EQ(distance(i, neighbors.indices()[k]), neighbors.distances()[k]);
+        }
+        total += uint32(expected.size());
+    }
+    EXPECT_EQ(total, neighbors.numNeighbors());
+}
+
+//------------------------------------------------------------------------------
+TEST_F(NeighborList_Test, dense_regions_are_not_truncated) {
+    NeighborList neighbors;
+    neighbors.build(cells, particles.x.data(), particles.y.data(), kNumParticles,
+            kRadius);
+
+    // Every clump particle sees the 299 others.
+    uint32 mostNeighbors = 0;
+    for (uint32 i(0); i < kNumParticles; ++i) {
+        mostNeighbors = std::max(mostNeighbors, neighbors.end(i) - neighbors.begin(i));
+    }
+    EXPECT_GE(mostNeighbors, 299u);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(NeighborList_Test, parallel_matches_serial) {
+    NeighborList serial;
+    serial.build(cells, particles.x.data(), particles.y.data(), kNumParticles,
+            kRadius);
+
+    NeighborList parallel;
+    parallel.build(cells, particles.x.data(), particles.y.data(), kNumParticles,
+            kRadius, 0.0f, Execution::Parallel);
+
+    ASSERT_EQ(serial.numNeighbors(), parallel.numNeighbors());
+    for (uint32 i(0); i <= kNumParticles; ++i) {
+        EXPECT_EQ(serial.begin(i), parallel.begin(i));
+    }
+    for (uint32 k(0); k < serial.numNeighbors(); ++k) {
+        EXPECT_EQ(serial.indices()[k], parallel.indices()[k]);
+        EXPECT_EQ(serial.distances()[k], parallel.distances()[k]);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(NeighborList_Test, update_distances_follows_moved_particles) {
+    NeighborList neighbors;
+    neighbors.build(cells, particles.x.data(), particles.y.data(), kNumParticles,
+            kRadius);
+    const uint32 numNeighbors = neighbors.numNeighbors();
+
+    for (uint32 i(0); i < kNumParticles; ++i) {
+        particles.x[i] += 0.01f * float32(i % 7);
+        particles.y[i] -= 0.02f * float32(i % 5);
+    }
+    neighbors.updateDistances(particles.x.data(), particles.y.data(),
+            Execution::Parallel);
+
+    ASSERT_EQ(numNeighbors, neighbors.numNeighbors());
+    for (uint32 i(0); i < kNumParticles; ++i) {
+        for (uint32 k(neighbors.begin(i)); k < neighbors.end(i); ++k) {
+            EXPECT_FLOAT_EQ(distance(i, neighbors.indices()[k]), neighbors.distances()[k]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(NeighborList_Test, throws_if_radius_exceeds_cell_size) {
+    NeighborList neighbors;
+    EXPECT_THROW(neighbors.build(cells, particles.x.data(), particles.y.data(),
+            kNumParticles, 0.2f), FluidSim::Exception);
+    EXPECT_THROW(neighbors.build(cells, particles.x.data(), particles.y.data(),
+            10, kRadius), FluidSim::Exception);
+}
@@ -0,0 +1,109 @@
+/**
+* ParticleArrays_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/ParticleArrays.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace FluidSim;
+
+
+//------------------------------------------------------------------------------
+TEST(ParticleArrays_Test, push_back_and_accessors) {
+    ParticleArrays particles;
+    EXPECT_TRUE(particles.empty());
+
+    particles.push_back(vec2(1.0f, 2.0f), vec2(3.0f, 4.0f));
+    particles.push_back(vec2(5.0f, 6.0f));
+
+    EXPECT_EQ(2u, particles.size());
+    EXPECT_EQ(vec2(1.0f, 2.0f), particles.position(0));
+    EXPECT_EQ(vec2(3.0f, 4.0f), particles.velocity(0));
+    EXPECT_EQ(vec2(5.0f, 6.0f), particles.position(1));
+    EXPECT_EQ(vec2(0.0f, 0.0f), particles.velocity(1));
+    EXPECT_EQ(0.0f, particles.density[1]);
+    EXPECT_EQ(0.0f, particles.pressure[1]);
+
+    particles.setPosition(1, vec2(7.0f, 8.0f));
+    particles.setVelocity(1, vec2(-1.0f, -2.0f));
+    EXPECT_EQ(7.0f, particles.x[1]);
+    EXPECT_EQ(8.0f, particles.y[1]);
+    EXPECT_EQ(-1.0f, particles.vx[1]);
+    EXPECT_EQ(-2.0f, particles.vy[1]);
+}
+
+//------------------------------------------------------------------------------
+TEST(ParticleArrays_Test, resize_keeps_arrays_in_step) {
+    ParticleArrays particles(3);
+    particles.x[2] = 1.0f;
+
+    particles.resize(1000);
+    EXPECT_EQ(1000u, particles.size());
+    EXPECT_EQ(1000u, particles.y.size());
+    EXPECT_EQ(1000u, particles.vx.size());
+    EXPECT_EQ(1000u, particles.vy.size());
+    EXPECT_EQ(1000u, particles.density.size());
+    EXPECT_EQ(1000u, particles.pressure.size());
+    EXPECT_EQ(1.0f, particles.x[2]);
+    EXPECT_EQ(0.0f, particles.x[999]);
+
+    particles.clear();
+    EXPECT_TRUE(particles.empty());
+    EXPECT_EQ(0u, particles.pressure.size());
+}
+
+//------------------------------------------------------------------------------
+TEST(ParticleArrays_Test, arrays_are_cache_line_aligned) {
+    ParticleArrays particles(17);
+
+    const ParticleArrays::Array * arrays[] = {
+        &particles.x, &particles.y, &particles.vx, &particles.vy,
+        &particles.density, &particles.pressure
+    };
+    for (const ParticleArrays::Array * array : arrays) {
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(array->data()) % kCacheLineSize);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST(ParticleArrays_Test, permute_gathers_every_attribute) {
+    const uint32 n = 1000;
+    ParticleArrays particles(n);
+    std::vector<uint32> order(n);
+    for (uint32 i(0); i < n; ++i) {
+        particles.x[i] = float32(i);
+        particles.y[i] = float32(i) + 0.25f;
+        particles.vx[i] = -float32(i);
+        particles.vy[i] = 2.0f * i;
+        particles.density[i] = 3.0f * i;
+        particles.pressure[i] = 4.0f * i;
+        order[i] = (i * 7919) % n;
+    }
+
+    ParticleArrays serial = particles;
+    ParticleArrays scratch;
+    serial.permute(order.data(), scratch);
+
+    ParticleArrays parallel = particles;
+    parallel.permute(order.data(), scratch, Execution::Parallel);
+
+    for (uint32 i(0); i < n; ++i) {
+        float32 j = float32(order[i]);
+        EXPECT_EQ(j, serial.x[i]);
+        EXPECT_EQ(j + 0.25f, serial.y[i]);
+        EXPECT_EQ(-j, serial.vx[i]);
+        EXPECT_EQ(2.0f * j, serial.vy[i]);
+        EXPECT_EQ(3.0f * j, serial.density[i]);
+        EXPECT_EQ(4.0f * j, serial.pressure[i]);
+        EXPECT_EQ(serial.x[i], parallel.x[i]);
+        EXPECT_EQ(serial.pressure[i], parallel.pressure[i]);
+    }
+
+    // The previous order is left in scratch.
+    EXPECT_EQ(n, scratch.size());
+}
@@ -0,0 +1,100 @@
+/**
+* ParticleCellIndex_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/ParticleCellIndex.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace FluidSim;
+using namespace std;
+
+
+namespace {  // limit visibility to this file.
+
+// Deterministic positions spread over [-0.5, 4.5) x [-0.5, 3.5), so that some
+// fall outside a 4 x 3 grid of unit cells.
+void makePositions(uint32 count, vector<float32> & x, vector<float32> & y) {
+    x.resize(count);
+    y.resize(count);
+    for (uint32 i(0); i < count; ++i) {
+        x[i] = -0.5f + 5.0f * float32((i * 37) % 101) / 101.0f;
+        y[i] = -0.5f + 4.0f * float32((i * 53) % 97) / 97.0f;
+    }
+}
+
+} // end namespace
+
+
+//------------------------------------------------------------------------------
+TEST(ParticleCellIndex_Test, cells_are_clamped_to_grid) {
+    ParticleCellIndex index(4, 3, 0.5f, vec2(1.0f, 2.0f));
+
+    EXPECT_EQ(12u, index.numCells());
+    EXPECT_EQ(0u, index.col(0.0f));
+    EXPECT_EQ(0u, index.col(1.49f));
+    EXPECT_EQ(1u, index.col(1.5f));
+    EXPECT_EQ(3u, index.col(100.0f));
+    EXPECT_EQ(0u, index.row(-5.0f));
+    EXPECT_EQ(2u, index.row(3.1f));
+    EXPECT_EQ(2u * 4 + 1, index.cell(1.6f, 3.2f));
+}
+
+//------------------------------------------------------------------------------
+TEST(ParticleCellIndex_Test, build_groups_particles_by_cell) {
+    vector<float32> x, y;
+    makePositions(500, x, y);
+
+    ParticleCellIndex index(4, 3, 1.0f);
+    index.build(x.data(), y.data(), 500);
+
+    ASSERT_EQ(500u, index.size());
+    EXPECT_EQ(0u, index.cellBegin(0));
+    EXPECT_EQ(500u, index.cellEnd(index.numCells() - 1));
+
+    vector<uint32> seen(500, 0);
+    for (uint32 c(0); c < index.numCells(); ++c) {
+        for (uint32 k(index.cellBegin(c)); k < index.cellEnd(c); ++k) {
+            uint32 i = index.order()[k];
+            EXPECT_EQ(c, index.cell(x[i], y[i]));
+            if (k > index.cellBegin(c)) {
+                EXPECT_LT(index.order()[k - 1], i);
+            }
+            ++seen[i];
+        }
+    }
+    EXPECT_EQ(500, count(seen.begin(), seen.end(), 1u));
+}
+
+//------------------------------------------------------------------------------
+TEST(ParticleCellIndex_Test, parallel_build_matches_serial) {
+    vector<float32> x, y;
+    makePositions(20000, x, y);
+
+    ParticleCellIndex serial(4, 3, 1.0f);
+    serial.build(x.data(), y.data(), 20000);
+
+    ParticleCellIndex parallel(4, 3, 1.0f);
+    parallel.build(x.data(), y.data(), 20000, Execution::Parallel);
+
+    EXPECT_EQ(serial.order(), parallel.order());
+    for (uint32 c(0); c <= serial.numCells(); ++c) {
+        EXPECT_EQ(serial.cellBegin(c), parallel.cellBegin(c));
+    }
+
+    // Rebuilding with fewer particles reuses the index.
+    parallel.build(x.data(), y.data(), 10);
+    EXPECT_EQ(10u, parallel.size());
+    EXPECT_EQ(10u, parallel.cellEnd(parallel.numCells() - 1));
+}
+
+//------------------------------------------------------------------------------
+TEST(ParticleCellIndex_Test, throws_on_empty_grid) {
+    EXPECT_THROW(ParticleCellIndex(0, 3, 1.0f), FluidSim::Exception);
+    EXPECT_THROW(ParticleCellIndex(4, 3, 0.0f), FluidSim::Exception);
+}
@@ -212,3 +212,28 @@ TEST_F(ParticleGridInterp_Test, grid3x2_test1) {
 	EXPECT_NEAR(grid3x2(2,1), 2.0f, epsilon);
 }
 
+
+
+//----------------------------------------------------------------------------------------
+// Test interpGridToParticles
+//----------------------------------------------------------------------------------------
+TEST_F(ParticleGridInterp_Test, grid_to_particles_batch) {
+	grid3x2(0,0) = 0.0f; grid3x2(1,0) = 1.0f; grid3x2(2,0) = 2.0f;
+	grid3x2(0,1) = 3.0f; grid3x2(1,1) = 4.0f; grid3x2(2,1) = 5.0f;
+
+	vector<vec2> positions;
+	for (uint32 i(0); i < 21; ++i) {
+		positions.push_back(vec2(0.1f * i, 0.05f * i));
+	}
+
+	vector<float32> expected(positions.size());
+	interpGridToParticles<float32>(expected, positions, grid3x2,
+			[] (const Grid<float32> & grid, const vec2 & p) { return bilinear(grid, p); });
+
+	vector<float32> attributes(positions.size());
+	interpGridToParticles(attributes, positions, grid3x2);
+
+	for (uint32 i(0); i < positions.size(); ++i) {
+		EXPECT_NEAR(expected[i], attributes[i], 1.0e-5f);
+	}
+}
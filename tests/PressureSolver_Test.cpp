@@ -0,0 +1,211 @@
+/**
+* PressureSolver_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/PressureSolver.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+class PressureSolver_Test : public ::testing::Test {
+protected:
+    static const uint32 kGridSize;
+
+    Grid<CellType> cells;
+    Grid<float32> rhs;
+    Grid<float32> pressure;
+
+    PressureSolver_Test()
+        : cells(kGridSize, kGridSize, 1.0f, vec2(0.5f)),
+          rhs(kGridSize, kGridSize, 1.0f, vec2(0.5f)),
+          pressure(kGridSize, kGridSize, 1.0f, vec2(0.5f))
+    {
+        // Solid border with a solid block in the middle of the domain.
+        cells.setAll(CellType::Fluid);
+        for (uint32 i(0); i < kGridSize; ++i) {
+            cells(0, i) = CellType::Solid;
+            cells(kGridSize-1, i) = CellType::Solid;
+            cells(i, 0) = CellType::Solid;
+            cells(i, kGridSize-1) = CellType::Solid;
+        }
+        for (uint32 row(12); row < 16; ++row) {
+            for (uint32 col(8); col < 20; ++col) {
+                cells(col, row) = CellType::Solid;
+            }
+        }
+
+        pressure.setAll(0);
+    }
+
+    bool isFluid(int32 col, int32 row) const {
+        return cells.isValidCoord(col, row) && cells(col, row) == CellType::Fluid;
+    }
+
+    // Reference application of the fluid-cell Laplacian at (col,row).
+    float32 applyLaplacian(const Grid<float32> & p, int32 col, int32 row) const {
+        float32 value = 0.0f;
+        const int32 offsets[4][2] = { {-1,0}, {1,0}, {0,-1}, {0,1} };
+        for (const auto & offset : offsets) {
+            int32 i = col + offset[0];
+            int32 j = row + offset[1];
+            if (isFluid(i, j)) {
+                value += p(col,row) - p(i,j);
+            }
+        }
+        return value;
+    }
+
+    // Right hand side with zero sum, so that the enclosed problem is solvable.
+    void fillCompatibleRhs() {
+        Grid<float32> source(rhs.gridSpec());
+        for (uint32 row(0); row < kGridSize; ++row) {
+            for (uint32 col(0); col < kGridSize; ++col) {
+                source(col,row) = std::sin(0.3f * col) * std::cos(0.2f * row);
+            }
+        }
+        rhs.setAll(0);
+        for (uint32 row(0); row < kGridSize; ++row) {
+            for (uint32 col(0); col < kGridSize; ++col) {
+                if (isFluid(col, row)) {
+                    rhs(col,row) = applyLaplacian(source, col, row);
+                }
+            }
+        }
+    }
+};
+
+const uint32 PressureSolver_Test::kGridSize = 32;
+
+} // end namespace
+
+
+//------------------------------------------------------------------------------
+TEST_F(PressureSolver_Test, converges_to_tolerance) {
+    fillCompatibleRhs();
+
+    PressureSolver solver(1.0e-5f, 500);
+    PressureSolveResult result = solver.solve(cells, rhs, pressure);
+
+    EXPECT_TRUE(result.converged);
+    EXPECT_GT(result.iterations, 0u);
+    EXPECT_LT(result.iterations, 100u);
+
+    float32 maxRhs = 0.0f;
+    float32 maxResidual = 0.0f;
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            if (isFluid(col, row)) {
+                maxRhs = std::max(maxRhs, std::abs(rhs(col,row)));
+                maxResidual = std::max(maxResidual,
+                        std::abs(rhs(col,row) - applyLaplacian(pressure, col, row)));
+            }
+        }
+    }
+    EXPECT_LE(result.residual, 1.0e-5f * maxRhs);
+    EXPECT_LE(maxResidual, 1.0e-4f * maxRhs);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureSolver_Test, solid_cells_have_zero_pressure) {
+    fillCompatibleRhs();
+    pressure.setAll(3.0f);
+
+    PressureSolver solver;
+    solver.solve(cells, rhs, pressure);
+
+    EXPECT_EQ(0.0f, pressure(0,0));
+    EXPECT_EQ(0.0f, pressure(10,13));
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureSolver_Test, respects_iteration_cap) {
+    fillCompatibleRhs();
+
+    PressureSolver solver(1.0e-7f, 3);
+    PressureSolveResult result = solver.solve(cells, rhs, pressure);
+
+    EXPECT_EQ(3u, result.iterations);
+    EXPECT_FALSE(result.converged);
+    EXPECT_GT(result.residual, 0.0f);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureSolver_Test, warm_start_from_solution) {
+    fillCompatibleRhs();
+
+    PressureSolver solver(1.0e-4f, 500);
+    solver.solve(cells, rhs, pressure);
+    PressureSolveResult result = solver.solve(cells, rhs, pressure);
+
+    EXPECT_TRUE(result.converged);
+    EXPECT_EQ(0u, result.iterations);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureSolver_Test, stencil_overload_matches_cell_types) {
+    fillCompatibleRhs();
+    Grid<float32> expected = pressure;
+
+    PressureSolver cellSolver;
+    PressureSolveResult expectedResult = cellSolver.solve(cells, rhs, expected);
+
+    PressureStencil stencil(cells);
+    PressureSolver stencilSolver;
+    PressureSolveResult result = stencilSolver.solve(stencil, rhs, pressure);
+
+    EXPECT_EQ(expectedResult.iterations, result.iterations);
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            EXPECT_EQ(expected(col,row), pressure(col,row));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureSolver_Test, rebuilds_matrix_after_solid_change) {
+    fillCompatibleRhs();
+
+    PressureSolver solver(1.0e-5f, 500);
+    solver.solve(cells, rhs, pressure);
+
+    // Extend the solid block, then solve again with the same solver.
+    for (uint32 row(16); row < 20; ++row) {
+        for (uint32 col(8); col < 20; ++col) {
+            cells(col, row) = CellType::Solid;
+        }
+    }
+    fillCompatibleRhs();
+    PressureSolveResult result = solver.solve(cells, rhs, pressure);
+    EXPECT_TRUE(result.converged);
+
+    float32 maxRhs = 0.0f;
+    float32 maxResidual = 0.0f;
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            if (isFluid(col, row)) {
+                maxRhs = std::max(maxRhs, std::abs(rhs(col,row)));
+                maxResidual = std::max(maxResidual,
+                        std::abs(rhs(col,row) - applyLaplacian(pressure, col, row)));
+            }
+        }
+    }
+    EXPECT_LE(maxResidual, 1.0e-4f * maxRhs);
+    EXPECT_EQ(0.0f, pressure(10,17));
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureSolver_Test, throws_on_mismatched_grids) {
+    Grid<float32> small(4, 4, 1.0f, vec2(0.5f));
+
+    PressureSolver solver;
+    EXPECT_THROW(solver.solve(cells, rhs, small), FluidSim::Exception);
+}
@@ -0,0 +1,136 @@
+/**
+* PressureStencil_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/PressureStencil.hpp"
+
+#include <algorithm>
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+class PressureStencil_Test : public ::testing::Test {
+protected:
+    Grid<CellType> cells;
+
+    PressureStencil_Test()
+        : cells(4, 3, 1.0f, vec2(0.5f))
+    {
+        // Cell layout, S = Solid, F = Fluid:
+        //   F F F S
+        //   F S F F
+        //   F F F F
+        cells.setAll(CellType::Fluid);
+        cells(1,1) = CellType::Solid;
+        cells(3,2) = CellType::Solid;
+    }
+};
+
+} // end namespace
+
+
+//------------------------------------------------------------------------------
+TEST_F(PressureStencil_Test, neighbor_bits) {
+    PressureStencil stencil(cells);
+
+    EXPECT_EQ(4u, stencil.width());
+    EXPECT_EQ(3u, stencil.height());
+
+    // Bottom left corner, neighbors outside of the grid count as solid.
+    EXPECT_EQ(PressureStencil::kFluid | PressureStencil::kRightFluid |
+              PressureStencil::kTopFluid, stencil.neighbors(0,0));
+
+    // Right of the solid cell.
+    EXPECT_EQ(PressureStencil::kFluid | PressureStencil::kRightFluid |
+              PressureStencil::kBottomFluid | PressureStencil::kTopFluid,
+              stencil.neighbors(2,1));
+
+    EXPECT_EQ(0, stencil.neighbors(1,1));
+    EXPECT_EQ(0, stencil.neighbors(3,2));
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureStencil_Test, inverse_diagonal) {
+    PressureStencil stencil(cells);
+
+    EXPECT_FLOAT_EQ(1.0f / 2, stencil.inverseDiagonal(0,0));
+    EXPECT_FLOAT_EQ(1.0f / 2, stencil.inverseDiagonal(1,0));
+    EXPECT_FLOAT_EQ(1.0f / 3, stencil.inverseDiagonal(2,1));
+    EXPECT_FLOAT_EQ(1.0f / 2, stencil.inverseDiagonal(2,2));
+    EXPECT_EQ(0.0f, stencil.inverseDiagonal(1,1));
+
+    EXPECT_TRUE(stencil.isActive(0,0));
+    EXPECT_FALSE(stencil.isActive(1,1));
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureStencil_Test, isolated_fluid_cell_is_inactive) {
+    cells.setAll(CellType::Solid);
+    cells(2,1) = CellType::Fluid;
+
+    PressureStencil stencil(cells);
+
+    EXPECT_EQ(PressureStencil::kFluid, stencil.neighbors(2,1));
+    EXPECT_FALSE(stencil.isActive(2,1));
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureStencil_Test, rebuild_after_solid_change) {
+    PressureStencil stencil(cells);
+    EXPECT_TRUE(stencil.isActive(1,0));
+
+    cells(1,0) = CellType::Solid;
+    stencil.build(cells);
+
+    EXPECT_FALSE(stencil.isActive(1,0));
+    EXPECT_FALSE(stencil.neighbors(0,0) & PressureStencil::kRightFluid);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureStencil_Test, revision_changes_with_fluid_cells) {
+    PressureStencil stencil;
+    EXPECT_EQ(0u, stencil.revision());
+
+    stencil.build(cells);
+    const uint64 revision = stencil.revision();
+    EXPECT_NE(0u, revision);
+
+    stencil.build(cells);
+    EXPECT_EQ(revision, stencil.revision());
+
+    cells(0,0) = CellType::Solid;
+    stencil.build(cells);
+    EXPECT_NE(revision, stencil.revision());
+
+    PressureStencil other(cells);
+    EXPECT_NE(stencil.revision(), other.revision());
+}
+
+//------------------------------------------------------------------------------
+TEST_F(PressureStencil_Test, sparse_lists) {
+    PressureStencil stencil(cells);
+
+    const ActiveCellList & fluid = stencil.fluidCells();
+    EXPECT_EQ(10u, fluid.size());
+    EXPECT_TRUE(std::is_sorted(fluid.begin(), fluid.end()));
+    EXPECT_FALSE(fluid.contains(1,1));
+    EXPECT_TRUE(fluid.contains(2,1));
+
+    // Every u face touches a fluid cell except the right edge of the top row,
+    // which only borders the solid cell (3,2).
+    const ActiveCellList & uFaces = stencil.uFaces();
+    EXPECT_EQ(5u, uFaces.width());
+    EXPECT_EQ(5u * 3 - 1, uFaces.size());
+    EXPECT_FALSE(uFaces.contains(4,2));
+    EXPECT_TRUE(uFaces.contains(3,2));
+
+    const ActiveCellList & vFaces = stencil.vFaces();
+    EXPECT_EQ(4u, vFaces.height());
+    EXPECT_EQ(4u * 4 - 1, vFaces.size());
+    EXPECT_FALSE(vFaces.contains(3,3));
+}
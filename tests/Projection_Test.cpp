@@ -0,0 +1,279 @@
+/**
+* Projection_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/Projection.hpp"
+#include "FluidSim/PressureSolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+class Projection_Test : public ::testing::Test {
+protected:
+    static const uint32 kGridSize;
+    static const float32 kRhsScale;
+    static const float32 kGradientScale;
+    static const vec2 kSolidVelocity;
+
+    Grid<CellType> cells;
+    StaggeredGrid<float32> velocity;
+
+    Projection_Test()
+        : cells(kGridSize, kGridSize, 1.0f, vec2(0.5f))
+    {
+        // Solid border, as in SmokeSim, with a solid block inside.
+        cells.setAll(CellType::Fluid);
+        for (uint32 i(0); i < kGridSize; ++i) {
+            cells(0, i) = CellType::Solid;
+            cells(kGridSize-1, i) = CellType::Solid;
+            cells(i, 0) = CellType::Solid;
+            cells(i, kGridSize-1) = CellType::Solid;
+        }
+        for (uint32 row(8); row < 11; ++row) {
+            for (uint32 col(5); col < 15; ++col) {
+                cells(col, row) = CellType::Solid;
+            }
+        }
+
+        Grid<float32> u(kGridSize+1, kGridSize, 1.0f, vec2(0.0f, 0.5f));
+        Grid<float32> v(kGridSize, kGridSize+1, 1.0f, vec2(0.5f, 0.0f));
+        for (uint32 row(0); row < u.height(); ++row) {
+            for (uint32 col(0); col < u.width(); ++col) {
+                u(col,row) = std::sin(0.4f * col + 0.9f * row);
+            }
+        }
+        for (uint32 row(0); row < v.height(); ++row) {
+            for (uint32 col(0); col < v.width(); ++col) {
+                v(col,row) = std::cos(0.7f * col - 0.2f * row);
+            }
+        }
+        velocity = StaggeredGrid<float32>(std::move(u), std::move(v));
+    }
+};
+
+const uint32 Projection_Test::kGridSize = 21;
+const float32 Projection_Test::kRhsScale = -1.5f;
+const float32 Projection_Test::kGradientScale = 0.75f;
+const vec2 Projection_Test::kSolidVelocity = vec2(0.0f);
+
+} // end namespace
+
+
+//------------------------------------------------------------------------------
+TEST_F(Projection_Test, rhs_matches_cell_type_loops) {
+    // The loops SmokeSim::computeRHS used before the stencil existed.
+    const Grid<float32> & u = velocity.u;
+    const Grid<float32> & v = velocity.v;
+    const float32 scale = kRhsScale;
+    Grid<float32> expected(cells.gridSpec());
+    expected.setAll(0);
+    for (int32 row(0); row < int32(kGridSize); ++row) {
+        for (int32 col(0); col < int32(kGridSize); ++col) {
+            if (cells(col,row) == CellType::Fluid) {
+                expected(col,row) = scale * ((u(col+1,row) - u(col,row)) +
+                                             (v(col,row+1) - v(col,row)));
+                if (cells(col-1,row) == CellType::Solid) {
+                    expected(col,row) += scale * (u(col,row) - kSolidVelocity.x);
+                }
+                if (cells(col+1,row) == CellType::Solid) {
+                    expected(col,row) -= scale * (u(col+1,row) - kSolidVelocity.x);
+                }
+                if (cells(col,row-1) == CellType::Solid) {
+                    expected(col,row) += scale * (v(col,row) - kSolidVelocity.y);
+                }
+                if (cells(col,row+1) == CellType::Solid) {
+                    expected(col,row) -= scale * (v(col,row+1) - kSolidVelocity.y);
+                }
+            }
+        }
+    }
+
+    PressureStencil stencil(cells);
+    Grid<float32> rhs(cells.gridSpec());
+    computePressureRhs(velocity, stencil, kRhsScale, kSolidVelocity, rhs,
+            Execution::Parallel);
+
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            ASSERT_EQ(expected(col,row), rhs(col,row));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Projection_Test, gradient_matches_cell_type_loops) {
+    Grid<float32> p(cells.gridSpec());
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            p(col,row) = 0.1f * col - 0.05f * row * row;
+        }
+    }
+
+    // The loops SmokeSim::subtractPressureGradient used before the stencil existed.
+    StaggeredGrid<float32> expected = velocity;
+    Grid<float32> & u = expected.u;
+    Grid<float32> & v = expected.v;
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            if (cells(col,row) == CellType::Fluid) {
+                float32 value = kGradientScale * p(col,row);
+                u(col,row) -= value;
+                u(col+1,row) += value;
+                v(col,row) -= value;
+                v(col,row+1) += value;
+            }
+        }
+    }
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            if (cells(col,row) == CellType::Solid) {
+                u(col,row) = kSolidVelocity.x;
+                u(col+1,row) = kSolidVelocity.x;
+                v(col,row) = kSolidVelocity.y;
+                v(col,row+1) = kSolidVelocity.y;
+            }
+        }
+    }
+
+    PressureStencil stencil(cells);
+    subtractPressureGradient(velocity, stencil, p, kGradientScale, kSolidVelocity,
+            Execution::Parallel);
+
+    for (uint32 row(0); row < u.height(); ++row) {
+        for (uint32 col(0); col < u.width(); ++col) {
+            ASSERT_EQ(u(col,row), velocity.u(col,row));
+        }
+    }
+    for (uint32 row(0); row < v.height(); ++row) {
+        for (uint32 col(0); col < v.width(); ++col) {
+            ASSERT_EQ(v(col,row), velocity.v(col,row));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Projection_Test, projection_removes_divergence) {
+    // With unit scales, rhs = -div(u) and the gradient step subtracts grad(p).
+    PressureStencil stencil(cells);
+    Grid<float32> rhs(cells.gridSpec());
+    computePressureRhs(velocity, stencil, -1.0f, kSolidVelocity, rhs);
+
+    Grid<float32> p(cells.gridSpec());
+    p.setAll(0);
+    PressureSolver solver(1.0e-6f, 500);
+    ASSERT_TRUE(solver.solve(cells, rhs, p).converged);
+
+    subtractPressureGradient(velocity, stencil, p, 1.0f, kSolidVelocity);
+    computePressureRhs(velocity, stencil, -1.0f, kSolidVelocity, rhs);
+
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            EXPECT_NEAR(0.0f, rhs(col,row), 1.0e-4f);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Projection_Test, sparse_matches_dense_on_fluid_cells) {
+    PressureStencil stencil(cells);
+
+    Grid<float32> dense(cells.gridSpec());
+    computePressureRhs(velocity, stencil, kRhsScale, kSolidVelocity, dense);
+
+    Grid<float32> sparse(cells.gridSpec());
+    sparse.setAll(-1.0f);
+    computePressureRhs(velocity, stencil, stencil.fluidCells(), kRhsScale,
+            kSolidVelocity, sparse, Execution::Parallel);
+
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            if (cells(col,row) == CellType::Fluid) {
+                ASSERT_EQ(dense(col,row), sparse(col,row));
+            } else {
+                ASSERT_EQ(-1.0f, sparse(col,row));
+            }
+        }
+    }
+
+    Grid<float32> p(cells.gridSpec());
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            p(col,row) = 0.2f * col - 0.03f * row * col;
+        }
+    }
+
+    const StaggeredGrid<float32> original = velocity;
+    StaggeredGrid<float32> denseVelocity = velocity;
+    subtractPressureGradient(denseVelocity, stencil, p, kGradientScale, kSolidVelocity);
+    subtractPressureGradient(velocity, stencil, stencil.fluidCells(), p,
+            kGradientScale, kSolidVelocity, Execution::Parallel);
+
+    // Fluid faces match, faces between two solid cells are left alone.
+    const ActiveCellList & uFaces = stencil.uFaces();
+    const ActiveCellList & vFaces = stencil.vFaces();
+    for (uint32 row(0); row < velocity.u.height(); ++row) {
+        for (uint32 col(0); col < velocity.u.width(); ++col) {
+            ASSERT_EQ(uFaces.contains(col, row) ? denseVelocity.u(col,row) :
+                    original.u(col,row), velocity.u(col,row));
+        }
+    }
+    for (uint32 row(0); row < velocity.v.height(); ++row) {
+        for (uint32 col(0); col < velocity.v.width(); ++col) {
+            ASSERT_EQ(vFaces.contains(col, row) ? denseVelocity.v(col,row) :
+                    original.v(col,row), velocity.v(col,row));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_F(Projection_Test, sparse_gradient_reports_max_fluid_face_velocity) {
+    PressureStencil stencil(cells);
+    Grid<float32> p(cells.gridSpec());
+    for (uint32 row(0); row < kGridSize; ++row) {
+        for (uint32 col(0); col < kGridSize; ++col) {
+            p(col,row) = 0.2f * col - 0.03f * row * col;
+        }
+    }
+
+    StaggeredGrid<float32> serial = velocity;
+    vec2 serialMax(-1.0f);
+    subtractPressureGradient(serial, stencil, stencil.fluidCells(), p,
+            kGradientScale, kSolidVelocity, Execution::Serial, &serialMax);
+
+    vec2 parallelMax(-1.0f);
+    subtractPressureGradient(velocity, stencil, stencil.fluidCells(), p,
+            kGradientScale, kSolidVelocity, Execution::Parallel, &parallelMax);
+
+    // The fused maximum matches a separate scan over the faces it updates.
+    float32 maxU = 0.0f;
+    float32 maxV = 0.0f;
+    const ActiveCellList & uFaces = stencil.uFaces();
+    const ActiveCellList & vFaces = stencil.vFaces();
+    for (uint32 row(0); row < velocity.u.height(); ++row) {
+        for (uint32 col(0); col < velocity.u.width(); ++col) {
+            if (uFaces.contains(col, row)) {
+                maxU = std::max(maxU, std::abs(serial.u(col,row)));
+            }
+        }
+    }
+    for (uint32 row(0); row < velocity.v.height(); ++row) {
+        for (uint32 col(0); col < velocity.v.width(); ++col) {
+            if (vFaces.contains(col, row)) {
+                maxV = std::max(maxV, std::abs(serial.v(col,row)));
+            }
+        }
+    }
+
+    EXPECT_GT(maxU, 0.0f);
+    EXPECT_EQ(maxU, serialMax.x);
+    EXPECT_EQ(maxV, serialMax.y);
+    EXPECT_EQ(serialMax, parallelMax);
+}
@@ -0,0 +1,247 @@
+/**
+* SmokeSim3D_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/SmokeSim3D.hpp"
+#include "FluidSim/Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace FluidSim;
+
+
+namespace {  // limit class visibility to this file.
+
+class SmokeSim3D_Test : public ::testing::Test {
+protected:
+    static const uint32 kGridSize;
+
+    static bool isFluid(const SmokeSim3D & sim, int32 col, int32 row, int32 layer) {
+        return sim.cellTypes().at(col, row, layer) == CellType::Fluid;
+    }
+
+    // Max-norm of the discrete divergence of the velocity over fluid cells.
+    static float32 maxDivergence(const SmokeSim3D & sim) {
+        const StaggeredGrid3<float32> & vel = sim.velocity();
+        const Grid3<CellType> & cells = sim.cellTypes();
+
+        float32 maxDiv = 0.0f;
+        for (uint32 layer(0); layer < cells.depth(); ++layer) {
+            for (uint32 row(0); row < cells.height(); ++row) {
+                for (uint32 col(0); col < cells.width(); ++col) {
+                    if (cells(col,row,layer) != CellType::Fluid) continue;
+
+                    float32 div = vel.u(col+1,row,layer) - vel.u(col,row,layer) +
+                            vel.v(col,row+1,layer) - vel.v(col,row,layer) +
+                            vel.w(col,row,layer+1) - vel.w(col,row,layer);
+                    maxDiv = std::max(maxDiv, std::abs(div));
+                }
+            }
+        }
+        return maxDiv;
+    }
+
+    static void expectGridsEqual(const Grid3<float32> & a, const Grid3<float32> & b) {
+        ASSERT_EQ(a.gridSpec(), b.gridSpec());
+        for (uint32 layer(0); layer < a.depth(); ++layer) {
+            for (uint32 row(0); row < a.height(); ++row) {
+                for (uint32 col(0); col < a.width(); ++col) {
+                    ASSERT_EQ(a(col,row,layer), b(col,row,layer));
+                }
+            }
+        }
+    }
+};
+
+} // end namespace
+
+const uint32 SmokeSim3D_Test::kGridSize = 16;
+
+
+//---------------------------------------------------------------------------------------
+TEST_F(SmokeSim3D_Test, defaults_match_gpu_smoke_sim) {
+    SmokeSim3D sim;
+
+    EXPECT_EQ(64u, sim.density().width());
+    EXPECT_EQ(64u, sim.density().height());
+    EXPECT_EQ(64u, sim.density().depth());
+    EXPECT_FLOAT_EQ(1.0f / 64.0f, sim.cellLength());
+    EXPECT_EQ(30u, sim.jacobiIterations());
+    EXPECT_EQ(0u, sim.frame());
+
+    EXPECT_FLOAT_EQ(0.01f, SmokeSim3D::kDt);
+    EXPECT_FLOAT_EQ(0.8f, SmokeSim3D::kBuoyant_d);
+    EXPECT_FLOAT_EQ(0.34f, SmokeSim3D::kBuoyant_t);
+    EXPECT_FLOAT_EQ(273.0f, SmokeSim3D::kTemp_0);
+
+    // Solid block of GpuSmokeSim3D::createSolidCells(), 15x15 cells over layers
+    // 30 to 40.
+    EXPECT_FALSE(isFluid(sim, 32, 32, 30));
+    EXPECT_FALSE(isFluid(sim, 32, 32, 40));
+    EXPECT_TRUE(isFluid(sim, 32, 32, 29));
+    EXPECT_TRUE(isFluid(sim, 32, 32, 41));
+    EXPECT_FALSE(isFluid(sim, 24, 24, 35));
+    EXPECT_FALSE(isFluid(sim, 38, 38, 35));
+    EXPECT_TRUE(isFluid(sim, 23, 32, 35));
+    EXPECT_TRUE(isFluid(sim, 39, 32, 35));
+
+    // Outside the domain is solid.
+    EXPECT_FALSE(isFluid(sim, -1, 0, 0));
+    EXPECT_FALSE(isFluid(sim, 0, 0, 64));
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(SmokeSim3D_Test, throws_on_too_small_grid) {
+    EXPECT_THROW(SmokeSim3D(kGridSize, kGridSize, 2), FluidSim::Exception);
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(SmokeSim3D_Test, first_step_injects_and_lifts_smoke) {
+    SmokeSim3D sim(kGridSize, kGridSize, kGridSize);
+    sim.step();
+
+    // The fluid starts at rest, so advection leaves the injected block, a
+    // single column of cells (7,7) at this resolution, in place.
+    const Grid3<float32> & density = sim.density();
+    const Grid3<float32> & temperature = sim.temperature();
+    EXPECT_EQ(SmokeSim3D::kInjectDensity, density(7, 7, 1));
+    EXPECT_EQ(SmokeSim3D::kInjectTemperature, temperature(7, 7, 2));
+    EXPECT_EQ(0.0f, density(7, 7, 3));
+    EXPECT_EQ(0.0f, density(8, 7, 1));
+    EXPECT_EQ(0.0f, density(0, 0, 1));
+    EXPECT_EQ(SmokeSim3D::kTemp_0, temperature(0, 0, 1));
+
+    // Hot smoke rises.
+    EXPECT_GT(sim.velocity().w(7, 7, 2), 0.0f);
+    EXPECT_EQ(1u, sim.frame());
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(SmokeSim3D_Test, temperature_never_drops_below_ambient) {
+    // Smoke reaching the walls samples the temperature border, which must hold
+    // ambient temperature rather than cool the domain.
+    SmokeSim3D sim(32, 32, 32);
+
+    for (uint32 i(0); i < 60; ++i) {
+        sim.step();
+    }
+
+    const Grid3<float32> & temperature = sim.temperature();
+    float32 minTemp = temperature(0, 0, 0);
+    for (uint32 layer(0); layer < temperature.depth(); ++layer) {
+        for (uint32 row(0); row < temperature.height(); ++row) {
+            for (uint32 col(0); col < temperature.width(); ++col) {
+                minTemp = std::min(minTemp, temperature(col, row, layer));
+            }
+        }
+    }
+    EXPECT_GE(minTemp, SmokeSim3D::kTemp_0);
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(SmokeSim3D_Test, velocity_border_clamps_to_edge) {
+    SmokeSim3D sim(kGridSize, kGridSize, kGridSize);
+    for (uint32 i(0); i < 3; ++i) {
+        sim.step();
+    }
+
+    const Grid3<float32> & w = sim.velocity().w;
+    const int32 width = int32(w.width());
+    const int32 height = int32(w.height());
+    const int32 depth = int32(w.depth());
+    for (int32 layer(0); layer < depth; ++layer) {
+        for (int32 row(0); row < height; ++row) {
+            EXPECT_EQ(w.at(0, row, layer), w.at(-1, row, layer));
+            EXPECT_EQ(w.at(width - 1, row, layer), w.at(width, row, layer));
+        }
+    }
+    for (int32 row(0); row < height; ++row) {
+        for (int32 col(0); col < width; ++col) {
+            EXPECT_EQ(w.at(col, row, 0), w.at(col, row, -1));
+            EXPECT_EQ(w.at(col, row, depth - 1), w.at(col, row, depth));
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(SmokeSim3D_Test, projection_zeros_solid_faces) {
+    SmokeSim3D sim(kGridSize, kGridSize, kGridSize);
+    for (uint32 i(0); i < 3; ++i) {
+        sim.step();
+    }
+
+    const StaggeredGrid3<float32> & vel = sim.velocity();
+    for (uint32 layer(0); layer < kGridSize; ++layer) {
+        for (uint32 row(0); row < kGridSize; ++row) {
+            EXPECT_EQ(0.0f, vel.u(0, row, layer));
+            EXPECT_EQ(0.0f, vel.u(kGridSize, row, layer));
+            EXPECT_EQ(0.0f, vel.v(row, 0, layer));
+            EXPECT_EQ(0.0f, vel.v(row, kGridSize, layer));
+            EXPECT_EQ(0.0f, vel.w(row, layer, 0));
+            EXPECT_EQ(0.0f, vel.w(row, layer, kGridSize));
+        }
+    }
+
+    // Faces of the solid block.
+    for (uint32 layer(0); layer <= kGridSize; ++layer) {
+        if (!isFluid(sim, 8, 8, layer) || !isFluid(sim, 8, 8, int32(layer) - 1)) {
+            EXPECT_EQ(0.0f, vel.w(8, 8, layer));
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(SmokeSim3D_Test, converged_jacobi_makes_velocity_divergence_free) {
+    SmokeSim3D sim(kGridSize, kGridSize, kGridSize);
+    sim.step();
+    const float32 speed = sim.velocity().w(7, 7, 2);
+    ASSERT_GT(speed, 0.0f);
+
+    sim.setJacobiIterations(3000);
+    sim.step();
+
+    EXPECT_LT(maxDivergence(sim), 1.0e-3f * speed);
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(SmokeSim3D_Test, parallel_matches_serial) {
+    SmokeSim3D serial(kGridSize, kGridSize, kGridSize);
+    SmokeSim3D parallel(kGridSize, kGridSize, kGridSize);
+    parallel.setExecution(Execution::Parallel);
+
+    for (uint32 i(0); i < 12; ++i) {
+        serial.step();
+        parallel.step();
+    }
+
+    expectGridsEqual(serial.velocity().u, parallel.velocity().u);
+    expectGridsEqual(serial.velocity().v, parallel.velocity().v);
+    expectGridsEqual(serial.velocity().w, parallel.velocity().w);
+    expectGridsEqual(serial.density(), parallel.density());
+    expectGridsEqual(serial.temperature(), parallel.temperature());
+    expectGridsEqual(serial.pressure(), parallel.pressure());
+}
+
+//---------------------------------------------------------------------------------------
+TEST_F(SmokeSim3D_Test, reports_stage_timings) {
+    SmokeSim3D sim(kGridSize, kGridSize, kGridSize);
+
+    for (uint32 i(0); i <= SmokeSim3D::kInjectFrames; ++i) {
+        sim.step();
+
+        const SmokeSim3DTimings & timings = sim.lastStepTimings();
+        EXPECT_GE(timings.inject, 0.0);
+        EXPECT_GT(timings.advect, 0.0);
+        EXPECT_GT(timings.pressure, 0.0);
+        EXPECT_DOUBLE_EQ(timings.inject + timings.advect + timings.buoyancy +
+                timings.divergence + timings.pressure + timings.project,
+                timings.total());
+    }
+
+    // Injection stops after kInjectFrames frames.
+    EXPECT_EQ(0.0, sim.lastStepTimings().inject);
+}
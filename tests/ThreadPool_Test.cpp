@@ -0,0 +1,140 @@
+/**
+* ThreadPool_Test.cpp
+*
+* @author Dustin Biser
+*/
+
+#include "gtest/gtest.h"
+#include "FluidSim/ThreadPool.hpp"
+#include "FluidSim/Parallel.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace FluidSim;
+using namespace std;
+
+
+namespace {  // limit class visibility to this file.
+
+class ThreadPool_Test : public ::testing::Test {
+protected:
+	static const uint32 kNumThreads;
+
+	ThreadPool pool;
+
+	ThreadPool_Test()
+		: pool(kNumThreads) { }
+};
+
+const uint32 ThreadPool_Test::kNumThreads = 4;
+
+} // end namespace
+
+
+//------------------------------------------------------------------------------
+TEST_F(ThreadPool_Test, num_threads) {
+	EXPECT_EQ(pool.numThreads(), kNumThreads);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(ThreadPool_Test, parallel_for_visits_each_index_once) {
+	const uint32 n = 1000;
+	vector<atomic<uint32>> visits(n);
+	for (atomic<uint32> & v : visits) {
+		v = 0;
+	}
+
+	pool.parallelFor(0, n, 7, [&] (uint32 begin, uint32 end) {
+		for (uint32 i(begin); i < end; ++i) {
+			++visits[i];
+		}
+	});
+
+	for (uint32 i(0); i < n; ++i) {
+		EXPECT_EQ(1u, visits[i].load()) << "index " << i;
+	}
+}
+
+//------------------------------------------------------------------------------
+TEST_F(ThreadPool_Test, chunks_respect_grain_size) {
+	atomic<uint32> maxChunk(0);
+
+	pool.parallelFor(10, 110, 16, [&] (uint32 begin, uint32 end) {
+		uint32 size = end - begin;
+		uint32 prev = maxChunk.load();
+		while (size > prev && !maxChunk.compare_exchange_weak(prev, size));
+	});
+
+	EXPECT_EQ(16u, maxChunk.load());
+}
+
+//------------------------------------------------------------------------------
+TEST_F(ThreadPool_Test, empty_range_is_a_no_op) {
+	bool called = false;
+	pool.parallelFor(5, 5, 1, [&] (uint32, uint32) { called = true; });
+
+	EXPECT_FALSE(called);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(ThreadPool_Test, nested_parallel_for_runs_serially) {
+	atomic<uint32> sum(0);
+
+	pool.parallelFor(0, 8, 1, [&] (uint32, uint32) {
+		pool.parallelFor(0, 10, 1, [&] (uint32 innerBegin, uint32 innerEnd) {
+			sum += innerEnd - innerBegin;
+		});
+	});
+
+	EXPECT_EQ(80u, sum.load());
+}
+
+//------------------------------------------------------------------------------
+TEST_F(ThreadPool_Test, repeated_jobs) {
+	atomic<uint64> sum(0);
+
+	for (uint32 job(0); job < 200; ++job) {
+		pool.parallelFor(0, 64, 3, [&] (uint32 begin, uint32 end) {
+			for (uint32 i(begin); i < end; ++i) {
+				sum += i;
+			}
+		});
+	}
+
+	EXPECT_EQ(200u * (63u * 64u / 2), sum.load());
+}
+
+//------------------------------------------------------------------------------
+TEST_F(ThreadPool_Test, serial_execution_calls_once) {
+	uint32 calls = 0;
+	parallelFor(Execution::Serial, 0, 100, [&] (uint32 begin, uint32 end) {
+		EXPECT_EQ(0u, begin);
+		EXPECT_EQ(100u, end);
+		++calls;
+	});
+
+	EXPECT_EQ(1u, calls);
+}
+
+//------------------------------------------------------------------------------
+TEST_F(ThreadPool_Test, exceptions_are_rethrown_on_caller) {
+	// Every chunk throws, so the calling thread and any worker that claims a
+	// chunk both do.
+	EXPECT_THROW(pool.parallelFor(0, 64, 1, [&] (uint32, uint32) {
+		throw std::runtime_error("chunk failed");
+	}), std::runtime_error);
+
+	// The pool is still usable, and still splits work into chunks rather than
+	// running it as a nested, serial region.
+	atomic<uint32> calls(0);
+	atomic<uint32> sum(0);
+	pool.parallelFor(0, 8, 1, [&] (uint32 begin, uint32 end) {
+		sum += end - begin;
+		++calls;
+	});
+
+	EXPECT_EQ(8u, sum.load());
+	EXPECT_EQ(8u, calls.load());
+}